@@ -46,7 +46,10 @@
 HugeObjectCount::HugeObjectCount(Context* context) :
     Sample(context),
     animate_(false),
-    useGroups_(false)
+    useGroups_(false),
+    threadedOctree_(false),
+    renderUpdateTime_(0),
+    numMeasuredFrames_(0)
 {
 }
 
@@ -85,7 +88,8 @@ void HugeObjectCount::CreateScene()
 
     // Create the Octree component to the scene so that drawable objects can be rendered. Use default volume
     // (-1000, -1000, -1000) to (1000, 1000, 1000)
-    scene_->CreateComponent<Octree>();
+    auto* octree = scene_->CreateComponent<Octree>();
+    octree->SetThreadedUpdate(threadedOctree_);
 
     // Create a Zone for ambient light & fog control
     Node* zoneNode = scene_->CreateChild("Zone");
@@ -170,7 +174,8 @@ void HugeObjectCount::CreateInstructions()
     instructionText->SetText(
         "Use WASD keys and mouse/touch to move\n"
         "Space to toggle animation\n"
-        "G to toggle object group optimization"
+        "G to toggle object group optimization\n"
+        "T to toggle threaded octree update"
     );
     instructionText->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
     // The text has multiple rows. Center them in relation to each other
@@ -180,6 +185,11 @@ void HugeObjectCount::CreateInstructions()
     instructionText->SetHorizontalAlignment(HA_CENTER);
     instructionText->SetVerticalAlignment(VA_CENTER);
     instructionText->SetPosition(0, ui->GetRoot()->GetHeight() / 4);
+
+    // Construct text for render update statistics in the top left corner
+    statisticsText_ = ui->GetRoot()->CreateChild<Text>();
+    statisticsText_->SetFont(cache->GetResource<Font>("Fonts/Anonymous Pro.ttf"), 15);
+    statisticsText_->SetPosition(10, 10);
 }
 
 void HugeObjectCount::SetupViewport()
@@ -195,6 +205,11 @@ void HugeObjectCount::SubscribeToEvents()
 {
     // Subscribe HandleUpdate() function for processing update events
     SubscribeToEvent(E_UPDATE, URHO3D_HANDLER(HugeObjectCount, HandleUpdate));
+
+    // Measure time spent from the end of post-update until post-render update. Renderer subscribes to render update
+    // before the sample and updates the octree there, so the timer must already be running when render update starts
+    SubscribeToEvent(E_POSTUPDATE, URHO3D_HANDLER(HugeObjectCount, HandlePostUpdate));
+    SubscribeToEvent(E_POSTRENDERUPDATE, URHO3D_HANDLER(HugeObjectCount, HandlePostRenderUpdate));
 }
 
 void HugeObjectCount::MoveCamera(float timeStep)
@@ -261,6 +276,15 @@ void HugeObjectCount::HandleUpdate(StringHash eventType, VariantMap& eventData)
         CreateScene();
     }
 
+    // Toggle serial / threaded octree update
+    if (input->GetKeyPress(KEY_T))
+    {
+        threadedOctree_ = !threadedOctree_;
+        scene_->GetComponent<Octree>()->SetThreadedUpdate(threadedOctree_);
+        renderUpdateTime_ = 0;
+        numMeasuredFrames_ = 0;
+    }
+
     // Move the camera, scale movement with time step
     MoveCamera(timeStep);
 
@@ -268,3 +292,24 @@ void HugeObjectCount::HandleUpdate(StringHash eventType, VariantMap& eventData)
     if (animate_)
         AnimateObjects(timeStep);
 }
+
+void HugeObjectCount::HandlePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    renderUpdateTimer_.Reset();
+}
+
+void HugeObjectCount::HandlePostRenderUpdate(StringHash eventType, VariantMap& eventData)
+{
+    renderUpdateTime_ += renderUpdateTimer_.GetUSec(false);
+    ++numMeasuredFrames_;
+
+    // Report average over 30 frames to keep the numbers readable
+    if (numMeasuredFrames_ >= 30)
+    {
+        const float averageMs = renderUpdateTime_ / 1000.0f / numMeasuredFrames_;
+        statisticsText_->SetText(Format("Octree update: {}\nRender update: {:.2f} ms",
+            threadedOctree_ ? "threaded" : "serial", averageMs));
+        renderUpdateTime_ = 0;
+        numMeasuredFrames_ = 0;
+    }
+}
@@ -29,6 +29,7 @@ namespace Urho3D
 
 class Node;
 class Scene;
+class Text;
 
 }
 
@@ -39,6 +40,7 @@ class Scene;
 ///     - Allowing examination of performance hotspots in the rendering code
 ///     - Using the profiler to measure the time taken to animate the scene
 ///     - Optionally speeding up rendering by grouping objects with the StaticModelGroup component
+///     - Comparing serial and threaded octree update of moving objects
 class HugeObjectCount : public Sample
 {
     URHO3D_OBJECT(HugeObjectCount, Sample);
@@ -88,6 +90,10 @@ private:
     void AnimateObjects(float timeStep);
     /// Handle the logic update event.
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the post-update event. Start measuring render update time.
+    void HandlePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle the post-render update event. Accumulate render update time and refresh the statistics text.
+    void HandlePostRenderUpdate(StringHash eventType, VariantMap& eventData);
 
     /// Box scene nodes.
     ea::vector<SharedPtr<Node> > boxNodes_;
@@ -95,4 +101,14 @@ private:
     bool animate_;
     /// Group optimization flag.
     bool useGroups_;
+    /// Threaded octree update flag.
+    bool threadedOctree_;
+    /// Render update statistics text.
+    SharedPtr<Text> statisticsText_;
+    /// Timer for measuring render update, which includes octree update and reinsertion.
+    HiresTimer renderUpdateTimer_;
+    /// Accumulated render update time in microseconds.
+    long long renderUpdateTime_;
+    /// Number of measured frames.
+    unsigned numMeasuredFrames_;
 };
@@ -176,6 +176,8 @@ float defaultTicksPerSecond_ = 4800.0f;
 float importStartTime_ = 0.0f;
 float importEndTime_ = 0.0f;
 bool suppressFbxPivotNodes_ = true;
+bool compressAnimations_ = false;
+AnimationCompressionSettings animationCompression_;
 
 int main(int argc, char** argv);
 void Run(const ea::vector<ea::string>& arguments);
@@ -308,6 +310,8 @@ void Run(const ea::vector<ea::string>& arguments)
             "-split <start> <end> (animation model only)\n"
             "            Split animation, will only import from start frame to end frame\n"
             "-np         Do not suppress $fbx pivot nodes (FBX files only)\n"
+            "-ac         Compress animations: quantize keyframes and remove redundant ones\n"
+            "-acu <rate> Compress animations resampled uniformly at rate keyframes per second\n"
         );
     }
 
@@ -463,6 +467,14 @@ void Run(const ea::vector<ea::string>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "ac")
+                compressAnimations_ = true;
+            else if (argument == "acu" && !value.empty())
+            {
+                compressAnimations_ = true;
+                animationCompression_.sampleRate_ = ToFloat(value);
+                ++i;
+            }
             else if (argument == "split")
             {
                 ea::string value2 = i + 2 < arguments.size() ? arguments[i + 2] : EMPTY_STRING;
@@ -1499,6 +1511,8 @@ void BuildAndSaveAnimations(OutModel* model)
         File outFile(context_);
         if (!outFile.Open(animOutName, FILE_WRITE))
             ErrorExit("Could not open output file " + animOutName);
+        if (compressAnimations_)
+            outAnim->Compress(animationCompression_);
         outAnim->Save(outFile);
     }
 }
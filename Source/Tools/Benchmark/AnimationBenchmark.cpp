@@ -0,0 +1,170 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/Animation.h>
+#include <Urho3D/Graphics/AnimationState.h>
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Number of bones in the character skeleton.
+static const unsigned numBones = 64;
+/// Number of keyframes per animation track.
+static const unsigned numKeyFrames = 60;
+/// Animation length in seconds.
+static const float animationLength = 2.0f;
+
+/// Create character model with a branching skeleton and no geometry.
+SharedPtr<Model> CreateCharacterModel(Context* context)
+{
+    Skeleton skeleton;
+    ea::vector<Bone>& bones = skeleton.GetModifiableBones();
+    bones.resize(numBones);
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        Bone& bone = bones[i];
+        bone.name_ = Format("Bone{}", i);
+        bone.nameHash_ = bone.name_;
+        bone.parentIndex_ = i > 0 ? (i - 1) / 2 : 0;
+        bone.initialPosition_ = Vector3(0.0f, 0.2f, 0.0f);
+        bone.radius_ = 0.1f;
+    }
+    skeleton.SetRootBoneIndex(0);
+
+    auto model = MakeShared<Model>(context);
+    model->SetSkeleton(skeleton);
+    model->SetBoundingBox(BoundingBox(-1.0f, 1.0f));
+    return model;
+}
+
+/// Create animation that moves every bone of the character model.
+SharedPtr<Animation> CreateCharacterAnimation(Context* context, RandomEngine& random)
+{
+    auto animation = MakeShared<Animation>(context);
+    animation->SetLength(animationLength);
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        AnimationTrack* track = animation->CreateTrack(Format("Bone{}", i));
+        track->channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION;
+
+        const Vector3 axis = random.GetDirectionVector3();
+        for (unsigned j = 0; j < numKeyFrames; ++j)
+        {
+            AnimationKeyFrame keyFrame;
+            keyFrame.time_ = j * animationLength / numKeyFrames;
+            keyFrame.position_ = Vector3(0.0f, 0.2f, 0.0f) + random.GetVector3(Vector3::ONE * -0.01f, Vector3::ONE * 0.01f);
+            keyFrame.rotation_ = Quaternion(Sin(j * 360.0f / numKeyFrames) * 30.0f, axis);
+            track->AddKeyFrame(keyFrame);
+        }
+    }
+    return animation;
+}
+
+}
+
+URHO3D_BENCHMARK(AnimationUpdate)
+{
+    static const float sceneSize = 500.0f;
+    static const float timeStep = 1.0f / 60.0f;
+
+    Context* context = runner.GetContext();
+    auto* workQueue = context->GetSubsystem<WorkQueue>();
+    runner.Report(Format("Worker threads: {}", workQueue ? workQueue->GetNumThreads() : 0));
+
+    RandomEngine random(0u);
+    SharedPtr<Model> model = CreateCharacterModel(context);
+    SharedPtr<Animation> walkAnimation = CreateCharacterAnimation(context, random);
+    SharedPtr<Animation> upperAnimation = CreateCharacterAnimation(context, random);
+
+    for (unsigned numCharacters : {250u, 1000u, 4000u})
+    {
+        auto scene = MakeShared<Scene>(context);
+        auto octree = scene->CreateComponent<Octree>();
+        octree->SetSize(BoundingBox(-sceneSize, sceneSize), 8);
+
+        // Two blended layers per character
+        ea::vector<AnimatedModel*> animatedModels;
+        ea::vector<AnimationState*> animationStates;
+        for (unsigned i = 0; i < numCharacters; ++i)
+        {
+            Node* node = scene->CreateChild();
+            node->SetPosition(random.GetVector3(Vector3::ONE * -sceneSize, Vector3::ONE * sceneSize));
+
+            auto animatedModel = node->CreateComponent<AnimatedModel>();
+            animatedModel->SetModel(model);
+            animatedModel->SetUpdateInvisible(true);
+            animatedModels.push_back(animatedModel);
+
+            AnimationState* walkState = animatedModel->AddAnimationState(walkAnimation);
+            walkState->SetLooped(true);
+            walkState->SetWeight(1.0f);
+            walkState->SetTime(random.GetFloat(0.0f, animationLength));
+            animationStates.push_back(walkState);
+
+            AnimationState* upperState = animatedModel->AddAnimationState(upperAnimation);
+            upperState->SetLooped(true);
+            upperState->SetWeight(0.5f);
+            upperState->SetLayer(1);
+            upperState->SetTime(random.GetFloat(0.0f, animationLength));
+            animationStates.push_back(upperState);
+        }
+
+        FrameInfo frame{};
+        frame.timeStep_ = timeStep;
+        octree->Update(frame);
+
+        const auto advanceAnimations = [&]
+        {
+            for (AnimationState* state : animationStates)
+                state->AddTime(timeStep);
+        };
+
+        runner.Measure(Format("{} characters, serial apply", numCharacters), [&]
+        {
+            advanceAnimations();
+            for (AnimatedModel* animatedModel : animatedModels)
+                animatedModel->ApplyAnimation();
+        });
+
+        runner.Measure(Format("{} characters, octree update", numCharacters), [&]
+        {
+            advanceAnimations();
+            ++frame.frameNumber_;
+            octree->Update(frame);
+        });
+    }
+}
+
+}
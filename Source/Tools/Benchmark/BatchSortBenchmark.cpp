@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Graphics/Batch.h>
+#include <Urho3D/Math/RandomEngine.h>
+
+#include <EASTL/sort.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+bool CompareBatchesState(const Batch* lhs, const Batch* rhs)
+{
+    if (lhs->renderOrder_ != rhs->renderOrder_)
+        return lhs->renderOrder_ < rhs->renderOrder_;
+    else if (lhs->sortKey_ != rhs->sortKey_)
+        return lhs->sortKey_ < rhs->sortKey_;
+    else
+        return lhs->distance_ < rhs->distance_;
+}
+
+bool CompareBatchesFrontToBack(const Batch* lhs, const Batch* rhs)
+{
+    if (lhs->renderOrder_ != rhs->renderOrder_)
+        return lhs->renderOrder_ < rhs->renderOrder_;
+    else if (lhs->distance_ != rhs->distance_)
+        return lhs->distance_ < rhs->distance_;
+    else
+        return lhs->sortKey_ < rhs->sortKey_;
+}
+
+bool CompareBatchesBackToFront(const Batch* lhs, const Batch* rhs)
+{
+    if (lhs->renderOrder_ != rhs->renderOrder_)
+        return lhs->renderOrder_ < rhs->renderOrder_;
+    else if (lhs->distance_ != rhs->distance_)
+        return lhs->distance_ > rhs->distance_;
+    else
+        return lhs->sortKey_ < rhs->sortKey_;
+}
+
+/// Comparison sort front to back with state remapping, as done before radix sorting.
+void SortFrontToBackComparison(ea::vector<Batch*>& batches)
+{
+    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesFrontToBack);
+
+    ea::unordered_map<unsigned long long, unsigned long long> shaderRemapping;
+    ea::unordered_map<unsigned long long, unsigned long long> materialRemapping;
+    ea::unordered_map<unsigned long long, unsigned long long> geometryRemapping;
+    for (Batch* batch : batches)
+    {
+        const unsigned long long shaderID = batch->sortKey_ >> 32u;
+        const unsigned long long materialID = (batch->sortKey_ >> 16u) & 0xffffu;
+        const unsigned long long geometryID = batch->sortKey_ & 0xffffu;
+        const unsigned long long newShaderID = shaderRemapping.emplace(shaderID, shaderRemapping.size() | (shaderID & 0x80000000u)).first->second;
+        const unsigned long long newMaterialID = materialRemapping.emplace(materialID, materialRemapping.size()).first->second;
+        const unsigned long long newGeometryID = geometryRemapping.emplace(geometryID, geometryRemapping.size()).first->second;
+        batch->sortKey_ = (newShaderID << 32u) | (newMaterialID << 16u) | newGeometryID;
+    }
+
+    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
+}
+
+/// Return fake object pointer. Sorting never dereferences it.
+template <class T> T* GetFakePointer(RandomEngine& random, unsigned count)
+{
+    return reinterpret_cast<T*>(static_cast<size_t>(random.GetUInt(1, count)) * 4096);
+}
+
+}
+
+URHO3D_BENCHMARK(BatchSorting)
+{
+    static const unsigned numBatches = 50000;
+
+    RandomEngine random(0u);
+    ea::vector<Batch> sourceBatches(numBatches);
+    for (Batch& batch : sourceBatches)
+    {
+        batch.distance_ = random.GetFloat(0.1f, 1000.0f);
+        batch.renderOrder_ = random.GetBool(0.1f) ? 0 : DEFAULT_RENDER_ORDER;
+        batch.isBase_ = random.GetBool(0.5f);
+        batch.vertexShader_ = GetFakePointer<ShaderVariation>(random, 32);
+        batch.pixelShader_ = GetFakePointer<ShaderVariation>(random, 32);
+        batch.material_ = GetFakePointer<Material>(random, 200);
+        batch.geometry_ = GetFakePointer<Geometry>(random, 500);
+        batch.CalculateSortKey();
+    }
+
+    BatchQueue queue;
+    queue.Clear(0);
+    queue.batches_ = sourceBatches;
+
+    ea::vector<Batch> batches;
+    ea::vector<Batch*> sortedBatches;
+    runner.Measure("Comparison sort, front to back", [&]
+    {
+        batches = sourceBatches;
+        sortedBatches.resize(numBatches);
+        for (unsigned i = 0; i < numBatches; ++i)
+            sortedBatches[i] = &batches[i];
+        SortFrontToBackComparison(sortedBatches);
+    });
+
+    runner.Measure("Radix sort, front to back", [&]
+    {
+        queue.batches_ = sourceBatches;
+        queue.SortFrontToBack();
+    });
+
+    unsigned numMismatches = 0;
+    for (unsigned i = 0; i < numBatches; ++i)
+    {
+        if (sortedBatches[i]->sortKey_ != queue.sortedBatches_[i]->sortKey_)
+            ++numMismatches;
+    }
+
+    runner.Measure("Comparison sort, back to front", [&]
+    {
+        sortedBatches.resize(numBatches);
+        for (unsigned i = 0; i < numBatches; ++i)
+            sortedBatches[i] = &batches[i];
+        ea::quick_sort(sortedBatches.begin(), sortedBatches.end(), CompareBatchesBackToFront);
+    });
+
+    runner.Measure("Radix sort, back to front", [&]
+    {
+        queue.SortBackToFront();
+    });
+
+    runner.Report(Format("State keys differing from comparison sort: {} of {} (equal distances may be ordered differently)",
+        numMismatches, numBatches));
+}
+
+}
@@ -0,0 +1,161 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Command line utility always uses console.
+#define URHO3D_WIN32_CONSOLE
+
+#include <Urho3D/Core/CommandLine.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Engine/Application.h>
+#include <Urho3D/Engine/EngineDefs.h>
+
+#include "Benchmark.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+/// Number of allocations made through the global operator new.
+std::atomic<unsigned long long> numAllocations{};
+
+}
+
+void* operator new(std::size_t size)
+{
+    numAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t size) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t size) noexcept
+{
+    std::free(ptr);
+}
+
+namespace Urho3D
+{
+
+ea::vector<BenchmarkCase>& GetBenchmarkCases()
+{
+    static ea::vector<BenchmarkCase> cases;
+    return cases;
+}
+
+double BenchmarkRunner::Measure(const ea::string& label, const std::function<void()>& workload)
+{
+    workload();
+
+    HiresTimer timer;
+    for (unsigned i = 0; i < iterations_; ++i)
+        workload();
+    const double averageTime = static_cast<double>(timer.GetUSec(false)) / Max(iterations_, 1u);
+
+    PrintLine(Format("  {:<48} {:>12.2f} us", label, averageTime));
+    return averageTime;
+}
+
+void BenchmarkRunner::Report(const ea::string& text)
+{
+    PrintLine(Format("  {}", text));
+}
+
+unsigned long long BenchmarkRunner::GetNumAllocations()
+{
+    return numAllocations.load(std::memory_order_relaxed);
+}
+
+}
+
+using namespace Urho3D;
+
+class BenchmarkApplication : public Application
+{
+    URHO3D_OBJECT(BenchmarkApplication, Application);
+public:
+    explicit BenchmarkApplication(Context* context) : Application(context)
+    {
+    }
+
+    void Setup() override
+    {
+        engineParameters_[EP_ENGINE_CLI_PARAMETERS] = false;
+        engineParameters_[EP_SOUND] = false;
+        engineParameters_[EP_HEADLESS] = true;
+        engineParameters_[EP_RESOURCE_PATHS] = "";
+        engineParameters_[EP_RESOURCE_PREFIX_PATHS] = "";
+
+        auto& app = GetCommandLineParser();
+        app.add_option("-f,--filter", filter_, "Run only benchmarks with names containing this string.");
+        app.add_option("-i,--iterations", iterations_, "Number of measured iterations per workload.")->set_default_str("100");
+        app.add_flag_function("--nothreads", [this](size_t) { engineParameters_[EP_WORKER_THREADS] = false; },
+            "Disable worker threads.");
+        app.add_flag("-l,--list", list_, "List benchmarks and exit.");
+    }
+
+    void Start() override
+    {
+        BenchmarkRunner runner(context_, iterations_);
+        for (const BenchmarkCase& benchmarkCase : GetBenchmarkCases())
+        {
+            if (!filter_.empty() && !ea::string(benchmarkCase.name_).contains(filter_))
+                continue;
+
+            PrintLine(benchmarkCase.name_);
+            if (!list_)
+                benchmarkCase.function_(runner);
+        }
+
+        engine_->Exit();
+    }
+
+    ea::string filter_;
+    unsigned iterations_{100};
+    bool list_{};
+};
+
+URHO3D_DEFINE_APPLICATION_MAIN(BenchmarkApplication);
@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Core/Context.h>
+
+#include <EASTL/string.h>
+#include <EASTL/vector.h>
+
+#include <functional>
+
+namespace Urho3D
+{
+
+class BenchmarkRunner;
+
+/// Registered benchmark case.
+struct BenchmarkCase
+{
+    /// Name of the case, used for filtering.
+    const char* name_{};
+    /// Case function.
+    void (*function_)(BenchmarkRunner& runner){};
+};
+
+/// Return all registered benchmark cases.
+ea::vector<BenchmarkCase>& GetBenchmarkCases();
+
+/// Helper that registers benchmark case on static initialization.
+struct BenchmarkRegistrar
+{
+    BenchmarkRegistrar(const char* name, void (*function)(BenchmarkRunner& runner))
+    {
+        GetBenchmarkCases().push_back(BenchmarkCase{name, function});
+    }
+};
+
+/// Runs workloads of benchmark cases and reports timings.
+class BenchmarkRunner
+{
+public:
+    /// Construct.
+    BenchmarkRunner(Context* context, unsigned iterations) : context_(context), iterations_(iterations) {}
+
+    /// Run workload once for warm-up and then specified number of iterations. Print and return average time in microseconds.
+    double Measure(const ea::string& label, const std::function<void()>& workload);
+    /// Print arbitrary information line.
+    void Report(const ea::string& text);
+    /// Return number of allocations made through the global operator new since the start of the process.
+    static unsigned long long GetNumAllocations();
+
+    /// Return context.
+    Context* GetContext() const { return context_; }
+    /// Return number of measured iterations.
+    unsigned GetIterations() const { return iterations_; }
+
+private:
+    /// Context.
+    Context* context_{};
+    /// Number of measured iterations.
+    unsigned iterations_{};
+};
+
+}
+
+/// Define and register benchmark case.
+#define URHO3D_BENCHMARK(name) \
+    static void Benchmark_##name(Urho3D::BenchmarkRunner& runner); \
+    static Urho3D::BenchmarkRegistrar benchmarkRegistrar_##name(#name, Benchmark_##name); \
+    static void Benchmark_##name(Urho3D::BenchmarkRunner& runner)
@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Graphics/Drawable.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/OctreeQuery.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Drawable with fixed unit bounding box.
+class BenchmarkDrawable : public Drawable
+{
+    URHO3D_OBJECT(BenchmarkDrawable, Drawable);
+
+public:
+    explicit BenchmarkDrawable(Context* context) : Drawable(context, DRAWABLE_GEOMETRY)
+    {
+        boundingBox_ = BoundingBox(-0.5f, 0.5f);
+    }
+
+protected:
+    void OnWorldBoundingBoxUpdate() override { worldBoundingBox_ = boundingBox_.Transformed(node_->GetWorldTransform()); }
+};
+
+/// Frustum query that tests drawables one by one.
+class ScalarFrustumOctreeQuery : public FrustumOctreeQuery
+{
+public:
+    ScalarFrustumOctreeQuery(ea::vector<Drawable*>& result, const Frustum& frustum)
+        : FrustumOctreeQuery(result, frustum, DRAWABLE_GEOMETRY)
+    {
+    }
+
+    void TestOctantDrawables(const Octant& octant, bool inside) override { OctreeQuery::TestOctantDrawables(octant, inside); }
+};
+
+}
+
+URHO3D_BENCHMARK(FrustumCulling)
+{
+    static const unsigned numDrawables = 100000;
+    static const float sceneSize = 1000.0f;
+
+    Context* context = runner.GetContext();
+    context->RegisterFactory<BenchmarkDrawable>();
+
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->CreateComponent<Octree>();
+    octree->SetSize(BoundingBox(-sceneSize, sceneSize), 8);
+
+    RandomEngine random(0u);
+    for (unsigned i = 0; i < numDrawables; ++i)
+    {
+        Node* node = scene->CreateChild();
+        node->SetPosition(random.GetVector3(Vector3::ONE * -sceneSize, Vector3::ONE * sceneSize));
+        node->SetRotation(random.GetQuaternion());
+        node->SetScale(random.GetFloat(0.5f, 4.0f));
+        node->CreateComponent<BenchmarkDrawable>();
+    }
+
+    FrameInfo frame{};
+    octree->Update(frame);
+
+    Frustum frustum;
+    frustum.Define(60.0f, 16.0f / 9.0f, 1.0f, 0.1f, sceneSize, Matrix3x4(Vector3::ZERO, Quaternion(30.0f, 45.0f, 0.0f), 1.0f));
+
+    ea::vector<Drawable*> result;
+    result.reserve(numDrawables);
+
+    runner.Measure("Octree query, per-drawable test", [&]
+    {
+        result.clear();
+        ScalarFrustumOctreeQuery query(result, frustum);
+        octree->GetDrawables(query);
+    });
+    const unsigned numScalarVisible = result.size();
+
+    runner.Measure("Octree query, vectorized test", [&]
+    {
+        result.clear();
+        FrustumOctreeQuery query(result, frustum, DRAWABLE_GEOMETRY);
+        octree->GetDrawables(query);
+    });
+    const unsigned numVectorizedVisible = result.size();
+
+    // Flat arrays without octree traversal
+    ea::vector<BoundingBox> boxes;
+    ea::vector<float> minX, minY, minZ, maxX, maxY, maxZ;
+    for (Node* node : scene->GetChildren())
+    {
+        const BoundingBox& box = node->GetComponent<BenchmarkDrawable>()->GetWorldBoundingBox();
+        boxes.push_back(box);
+        minX.push_back(box.min_.x_);
+        minY.push_back(box.min_.y_);
+        minZ.push_back(box.min_.z_);
+        maxX.push_back(box.max_.x_);
+        maxY.push_back(box.max_.y_);
+        maxZ.push_back(box.max_.z_);
+    }
+
+    ea::vector<unsigned> visibleIndices(numDrawables);
+    unsigned numVisible = 0;
+    runner.Measure("Flat array, per-box test", [&]
+    {
+        numVisible = 0;
+        for (unsigned i = 0; i < numDrawables; ++i)
+        {
+            if (frustum.IsInsideFast(boxes[i]) != OUTSIDE)
+                visibleIndices[numVisible++] = i;
+        }
+    });
+
+    runner.Measure("Flat array, vectorized test", [&]
+    {
+        numVisible = frustum.CullBoxesFast(minX.data(), minY.data(), minZ.data(),
+            maxX.data(), maxY.data(), maxZ.data(), numDrawables, visibleIndices.data());
+    });
+
+    runner.Report(Format("Visible: {} per-drawable, {} vectorized, {} flat", numScalarVisible, numVectorizedVisible, numVisible));
+}
+
+}
@@ -0,0 +1,151 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Scene/LogicComponent.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Receiver of both VariantMap and typed events.
+class EventDispatchReceiver : public Object
+{
+    URHO3D_OBJECT(EventDispatchReceiver, Object);
+
+public:
+    explicit EventDispatchReceiver(Context* context) : Object(context) {}
+
+    void Subscribe(Object* sender, EventChannel<SceneUpdateEventData>& channel)
+    {
+        SubscribeToEvent(sender, E_SCENEUPDATE, URHO3D_HANDLER(EventDispatchReceiver, HandleEvent));
+        channel.Subscribe<&EventDispatchReceiver::HandleTypedEvent>(this);
+    }
+
+    void HandleEvent(StringHash eventType, VariantMap& eventData)
+    {
+        using namespace SceneUpdate;
+        elapsedTime_ += eventData[P_TIMESTEP].GetFloat();
+    }
+
+    void HandleTypedEvent(const SceneUpdateEventData& eventData)
+    {
+        elapsedTime_ += eventData.timeStep_;
+    }
+
+    float elapsedTime_{};
+};
+
+/// Logic component with trivial update.
+class EventDispatchLogic : public LogicComponent
+{
+    URHO3D_OBJECT(EventDispatchLogic, LogicComponent);
+
+public:
+    explicit EventDispatchLogic(Context* context) : LogicComponent(context)
+    {
+        SetUpdateEventMask(USE_UPDATE | USE_POSTUPDATE);
+    }
+
+    void Update(float timeStep) override { elapsedTime_ += timeStep; }
+    void PostUpdate(float timeStep) override { elapsedTime_ += timeStep; }
+
+    float elapsedTime_{};
+};
+
+}
+
+URHO3D_BENCHMARK(EventDispatch)
+{
+    static const unsigned numSubscribers = 10000;
+    static const unsigned numEvents = 10;
+    static const float timeStep = 1.0f / 60.0f;
+
+    Context* context = runner.GetContext();
+    const auto reportPerSubscriber = [&](double time)
+    {
+        runner.Report(Format("  {:.2f} ns per subscriber", time * 1000.0 / (numSubscribers * numEvents)));
+    };
+
+    auto sender = MakeShared<EventDispatchReceiver>(context);
+    EventChannel<SceneUpdateEventData> channel;
+    ea::vector<SharedPtr<EventDispatchReceiver> > receivers;
+    for (unsigned i = 0; i < numSubscribers; ++i)
+    {
+        auto receiver = MakeShared<EventDispatchReceiver>(context);
+        receiver->Subscribe(sender, channel);
+        receivers.push_back(receiver);
+    }
+
+    runner.Report(Format("{} subscribers, {} events per iteration", numSubscribers, numEvents));
+
+    reportPerSubscriber(runner.Measure("Send VariantMap event", [&]
+    {
+        for (unsigned i = 0; i < numEvents; ++i)
+        {
+            using namespace SceneUpdate;
+            VariantMap& eventData = sender->GetEventDataMap();
+            eventData[P_SCENE] = sender;
+            eventData[P_TIMESTEP] = timeStep;
+            sender->SendEvent(E_SCENEUPDATE, eventData);
+        }
+    }));
+
+    reportPerSubscriber(runner.Measure("Send typed event", [&]
+    {
+        for (unsigned i = 0; i < numEvents; ++i)
+            sender->SendEvent(channel, SceneUpdateEventData{ nullptr, timeStep });
+    }));
+
+    runner.Measure("Subscribe and unsubscribe typed", [&]
+    {
+        for (EventDispatchReceiver* receiver : receivers)
+            channel.Unsubscribe(receiver);
+        for (EventDispatchReceiver* receiver : receivers)
+            channel.Subscribe<&EventDispatchReceiver::HandleTypedEvent>(receiver);
+    });
+
+    receivers.clear();
+
+    // End-to-end scene update, logic components receive both update and post-update
+    auto scene = MakeShared<Scene>(context);
+    for (unsigned i = 0; i < numSubscribers; ++i)
+    {
+        Node* node = scene->CreateChild(EMPTY_STRING, LOCAL);
+        node->AddComponent(new EventDispatchLogic(context), 0, LOCAL);
+    }
+
+    reportPerSubscriber(runner.Measure("Scene update with logic components", [&]
+    {
+        for (unsigned i = 0; i < numEvents; ++i)
+            scene->Update(timeStep);
+    }));
+}
+
+}
@@ -0,0 +1,106 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Resource/Decompress.h>
+#include <Urho3D/Resource/Image.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+URHO3D_BENCHMARK(ImageProcessing)
+{
+    static const int imageSize = 4096;
+
+    Context* context = runner.GetContext();
+
+    RandomEngine random(0u);
+    auto image = MakeShared<Image>(context);
+    image->SetSize(imageSize, imageSize, 4);
+    unsigned char* data = image->GetData();
+    for (int i = 0; i < imageSize * imageSize * 4; ++i)
+        data[i] = static_cast<unsigned char>(random.GetUInt(0, 64) + (i / 4) % imageSize);
+
+    auto rgbImage = MakeShared<Image>(context);
+    rgbImage->SetSize(imageSize, imageSize, 3);
+    for (int i = 0; i < imageSize * imageSize; ++i)
+        memcpy(rgbImage->GetData() + i * 3, data + i * 4, 3);
+
+    // Random DXT5 blocks are enough to exercise the decoder
+    ea::vector<unsigned char> dxtData(imageSize * imageSize);
+    for (unsigned char& value : dxtData)
+        value = static_cast<unsigned char>(random.GetUInt(0, 256));
+
+    runner.Report(Format("{}x{} RGBA", imageSize, imageSize));
+
+    runner.Measure("Mip chain", [&]
+    {
+        image->PrecalculateLevels();
+        image->CleanupLevels();
+    });
+
+    runner.Measure("Mip chain, sRGB", [&]
+    {
+        image->SetSRGB(true);
+        image->PrecalculateLevels();
+        image->CleanupLevels();
+        image->SetSRGB(false);
+    });
+
+    runner.Measure("Resize to 3/4", [&]
+    {
+        auto copy = MakeShared<Image>(context);
+        copy->SetSize(imageSize, imageSize, 4);
+        copy->SetData(data);
+        copy->Resize(imageSize * 3 / 4, imageSize * 3 / 4);
+    });
+
+    runner.Measure("Resize to 1/5", [&]
+    {
+        auto copy = MakeShared<Image>(context);
+        copy->SetSize(imageSize, imageSize, 4);
+        copy->SetData(data);
+        copy->Resize(imageSize / 5, imageSize / 5);
+    });
+
+    runner.Measure("Convert RGB to RGBA", [&]
+    {
+        rgbImage->ConvertToRGBA();
+    });
+
+    runner.Measure("Decompress DXT5", [&]
+    {
+        CompressedLevel level;
+        level.data_ = dxtData.data();
+        level.format_ = CF_DXT5;
+        level.width_ = imageSize;
+        level.height_ = imageSize;
+        level.depth_ = 1;
+        level.Decompress(image->GetData());
+    });
+}
+
+}
@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Resource/Image.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+URHO3D_BENCHMARK(BackgroundLoading)
+{
+    static const unsigned numImages = 64;
+    static const int imageSize = 256;
+
+    Context* context = runner.GetContext();
+    auto fileSystem = context->GetSubsystem<FileSystem>();
+    auto cache = context->GetSubsystem<ResourceCache>();
+
+    // Write noisy images so that PNG decoding dominates over file reads
+    const ea::string resourceDir = fileSystem->GetTemporaryDir() + "BackgroundLoadingBenchmark/";
+    fileSystem->CreateDirsRecursive(resourceDir + "Images");
+
+    RandomEngine random(0u);
+    ea::vector<ea::string> imageNames;
+    for (unsigned i = 0; i < numImages; ++i)
+    {
+        auto image = MakeShared<Image>(context);
+        image->SetSize(imageSize, imageSize, 4);
+        unsigned char* data = image->GetData();
+        for (int j = 0; j < imageSize * imageSize * 4; ++j)
+            data[j] = static_cast<unsigned char>(random.GetUInt(0, 64) + (j / 4) % imageSize);
+
+        imageNames.push_back(Format("Images/Image{}.png", i));
+        image->SavePNG(resourceDir + imageNames.back());
+    }
+    cache->AddResourceDir(resourceDir);
+    runner.Report(Format("{} images {}x{}", numImages, imageSize, imageSize));
+
+    runner.Measure("Synchronous load", [&]
+    {
+        for (const ea::string& name : imageNames)
+            cache->GetResource<Image>(name);
+        cache->ReleaseAllResources(true);
+    });
+
+    runner.Measure("Background load", [&]
+    {
+        for (const ea::string& name : imageNames)
+            cache->BackgroundLoadResource<Image>(name);
+        // Requesting a queued resource waits for the loader and finishes it
+        for (const ea::string& name : imageNames)
+            cache->GetResource<Image>(name);
+        cache->ReleaseAllResources(true);
+    });
+
+    cache->RemoveResourceDir(resourceDir);
+    fileSystem->RemoveDir(resourceDir, true);
+}
+
+}
@@ -0,0 +1,98 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+URHO3D_BENCHMARK(Logging)
+{
+    static const unsigned numMessages = 100000;
+
+    Context* context = runner.GetContext();
+    auto* log = context->GetSubsystem<Log>();
+    auto* fileSystem = context->GetSubsystem<FileSystem>();
+    auto* workQueue = context->GetSubsystem<WorkQueue>();
+
+    const ea::string fileName = fileSystem->GetTemporaryDir() + "LoggingBenchmark.log";
+    const LogLevel oldLevel = log->GetLevel();
+    const bool oldQuiet = log->IsQuiet();
+    log->SetLevel(LOG_DEBUG);
+    log->SetQuiet(true);
+    log->Open(fileName);
+
+    runner.Report(Format("{} messages", numMessages));
+
+    runner.Measure("Write, main thread", [&]
+    {
+        for (unsigned i = 0; i < numMessages; ++i)
+            URHO3D_LOGINFO("Message {} of {}", i, numMessages);
+    });
+
+    runner.Measure("Write and flush, main thread", [&]
+    {
+        for (unsigned i = 0; i < numMessages; ++i)
+            URHO3D_LOGINFO("Message {} of {}", i, numMessages);
+        log->Flush();
+    });
+
+    log->SetBlockingLevel(LOG_TRACE);
+    runner.Measure("Write and flush without dropping", [&]
+    {
+        for (unsigned i = 0; i < numMessages; ++i)
+            URHO3D_LOGINFO("Message {} of {}", i, numMessages);
+        log->Flush();
+    });
+    log->SetBlockingLevel(LOG_WARNING);
+
+    runner.Measure("Write, work queue", [&]
+    {
+        workQueue->ParallelFor(numMessages, 256, [&](unsigned begin, unsigned end, unsigned threadIndex)
+        {
+            for (unsigned i = begin; i < end; ++i)
+                URHO3D_LOGINFO("Message {} from thread {}", i, threadIndex);
+        });
+    });
+
+    runner.Measure("Write below level", [&]
+    {
+        for (unsigned i = 0; i < numMessages; ++i)
+            URHO3D_LOGTRACE("Message {} of {}", i, numMessages);
+    });
+
+    log->Flush();
+    runner.Report(Format("{} messages dropped", log->GetNumDroppedMessages()));
+
+    log->Close();
+    log->SetQuiet(oldQuiet);
+    log->SetLevel(oldLevel);
+    fileSystem->Delete(fileName);
+}
+
+}
@@ -0,0 +1,110 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifdef URHO3D_PHYSICS
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Create scene with boxes stacked in layers on a static floor, like a large-scale PhysicsStressTest sample.
+SharedPtr<Scene> CreateBoxStacks(Context* context, unsigned numBodies)
+{
+    static const unsigned numLayers = 5;
+    static const float spacing = 1.5f;
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<PhysicsWorld>();
+
+    const unsigned numColumns = numBodies / numLayers;
+    const unsigned side = static_cast<unsigned>(Ceil(Sqrt(static_cast<float>(numColumns))));
+    const float extent = side * spacing;
+
+    Node* floorNode = scene->CreateChild("Floor");
+    floorNode->SetPosition(Vector3(0.0f, -0.5f, 0.0f));
+    floorNode->SetScale(Vector3(extent + 10.0f, 1.0f, extent + 10.0f));
+    floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    for (unsigned i = 0; i < numBodies; ++i)
+    {
+        const unsigned column = i / numLayers;
+        const unsigned layer = i % numLayers;
+
+        Node* boxNode = scene->CreateChild("Box");
+        boxNode->SetPosition(Vector3((column % side) * spacing - extent * 0.5f, 0.5f + layer * 1.05f, (column / side) * spacing - extent * 0.5f));
+
+        auto* body = boxNode->CreateComponent<RigidBody>();
+        body->SetMass(1.0f);
+        body->SetFriction(0.75f);
+        boxNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+    }
+
+    return scene;
+}
+
+}
+
+URHO3D_BENCHMARK(PhysicsScaling)
+{
+    static const unsigned bodyCounts[] = { 5000, 10000, 25000, 50000 };
+    static const unsigned numSettleSteps = 30;
+    static const float timeStep = 1.0f / 60.0f;
+
+    Context* context = runner.GetContext();
+    auto* workQueue = context->GetSubsystem<WorkQueue>();
+    runner.Report(Format("{} threads", workQueue->GetNumThreads() + 1));
+
+    const bool multiThreaded = PhysicsWorld::config.multiThreaded_;
+    for (unsigned numBodies : bodyCounts)
+    {
+        for (bool useMultiThreaded : { false, true })
+        {
+            // The world type is chosen when the component is created
+            PhysicsWorld::config.multiThreaded_ = useMultiThreaded;
+            SharedPtr<Scene> scene = CreateBoxStacks(context, numBodies);
+            auto* physicsWorld = scene->GetComponent<PhysicsWorld>();
+
+            // Let the stacks settle into resting contact before measuring
+            for (unsigned i = 0; i < numSettleSteps; ++i)
+                physicsWorld->Update(timeStep);
+
+            const char* worldName = physicsWorld->IsMultiThreaded() ? "multithreaded" : "single-threaded";
+            runner.Measure(Format("{} bodies, {} world", numBodies, worldName), [&] { physicsWorld->Update(timeStep); });
+        }
+    }
+    PhysicsWorld::config.multiThreaded_ = multiThreaded;
+}
+
+}
+#endif
@@ -0,0 +1,120 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/ScenePrefab.h>
+#include <Urho3D/Scene/SmoothedTransform.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+URHO3D_BENCHMARK(PrefabInstantiation)
+{
+    static const unsigned numInstances = 500;
+    static const unsigned numChildren = 8;
+
+    Context* context = runner.GetContext();
+
+    // Source hierarchy with a few typical components
+    auto sourceScene = MakeShared<Scene>(context);
+    sourceScene->CreateComponent<Octree>();
+    Node* sourceRoot = sourceScene->CreateChild("Prefab");
+    sourceRoot->AddTags("Spawned;Enemy");
+    sourceRoot->SetVar("Health", 100);
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        Node* child = sourceRoot->CreateChild(Format("Child{}", i));
+        child->SetPosition(Vector3(static_cast<float>(i), 1.0f, 0.0f));
+        child->SetScale(0.5f);
+        child->CreateComponent<StaticModel>()->SetCastShadows(true);
+        auto* light = child->CreateComponent<Light>();
+        light->SetRange(static_cast<float>(i + 1));
+        light->SetColor(Color::RED);
+        child->CreateComponent<SmoothedTransform>();
+    }
+
+    XMLFile xmlFile(context);
+    XMLElement xmlRoot = xmlFile.CreateRoot("node");
+    sourceRoot->SaveXML(xmlRoot);
+
+    VectorBuffer binaryData;
+    sourceRoot->Save(binaryData);
+
+    auto prefab = MakeShared<ScenePrefab>(context);
+    prefab->Capture(sourceRoot);
+
+    runner.Report(Format("{} instances of {} nodes, {} components", numInstances, prefab->GetNumNodes(),
+        prefab->GetNumComponents()));
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+    runner.Measure("InstantiateXML", [&]
+    {
+        for (unsigned i = 0; i < numInstances; ++i)
+            scene->InstantiateXML(xmlRoot, Vector3::ZERO, Quaternion::IDENTITY);
+        scene->RemoveAllChildren();
+    });
+
+    runner.Measure("Instantiate binary", [&]
+    {
+        for (unsigned i = 0; i < numInstances; ++i)
+        {
+            MemoryBuffer buffer(binaryData.GetBuffer());
+            scene->Instantiate(buffer, Vector3::ZERO, Quaternion::IDENTITY);
+        }
+        scene->RemoveAllChildren();
+    });
+
+    runner.Measure("InstantiatePrefab", [&]
+    {
+        for (unsigned i = 0; i < numInstances; ++i)
+            scene->InstantiatePrefab(prefab, Vector3::ZERO, Quaternion::IDENTITY);
+        scene->RemoveAllChildren();
+    });
+
+    runner.Measure("Load prefab from XML", [&]
+    {
+        ScenePrefab loadedPrefab(context);
+        loadedPrefab.LoadXML(xmlRoot);
+    });
+
+    VectorBuffer prefabData;
+    prefab->Save(prefabData);
+    runner.Measure("Load prefab from binary", [&]
+    {
+        ScenePrefab loadedPrefab(context);
+        MemoryBuffer buffer(prefabData.GetBuffer());
+        loadedPrefab.Load(buffer);
+    });
+}
+
+}
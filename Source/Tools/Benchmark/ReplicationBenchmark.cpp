@@ -0,0 +1,398 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#ifdef URHO3D_NETWORK
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Graphics/StaticModel.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Network/Connection.h>
+#include <Urho3D/Network/LoopbackNetwork.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/NetworkInterestGrid.h>
+#include <Urho3D/Network/Protocol.h>
+#ifdef URHO3D_PHYSICS
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#endif
+#include <Urho3D/Scene/Scene.h>
+
+#include <slikenet/types.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Create server side connection to a client that has loaded the scene. Messages are dropped as there is no peer.
+SharedPtr<Connection> CreateLoadedConnection(Context* context, Scene* scene)
+{
+    auto connection = MakeShared<Connection>(context);
+    connection->Initialize(true, SLNet::AddressOrGUID(), nullptr);
+    connection->SetScene(scene);
+
+    VectorBuffer sceneLoaded;
+    sceneLoaded.WriteUInt(scene->GetChecksum());
+    VectorBuffer packet;
+    packet.WriteVLE(MSG_SCENELOADED);
+    packet.WriteVLE(sceneLoaded.GetSize());
+    packet.Write(sceneLoaded.GetData(), sceneLoaded.GetSize());
+
+    MemoryBuffer buffer(packet.GetData(), packet.GetSize());
+    connection->ProcessMessage(MSG_PACKED_MESSAGE, buffer);
+    return connection;
+}
+
+}
+
+URHO3D_BENCHMARK(Replication)
+{
+    static const unsigned numNodes = 2000;
+    static const unsigned numVars = 4;
+    static const unsigned clientCounts[] = { 1, 8, 32 };
+
+    Context* context = runner.GetContext();
+    auto* workQueue = context->GetSubsystem<WorkQueue>();
+
+    auto scene = MakeShared<Scene>(context);
+    ea::vector<Node*> nodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = scene->CreateChild(Format("Node{}", i));
+        for (unsigned j = 0; j < numVars; ++j)
+            node->SetVar(Format("Var{}", j), Format("Value{}", j));
+        nodes.push_back(node);
+    }
+
+    RandomEngine random(0u);
+    const auto moveNodes = [&]
+    {
+        for (Node* node : nodes)
+        {
+            node->SetPosition(random.GetVector3({ -100.0f, -100.0f, -100.0f }, { 100.0f, 100.0f, 100.0f }));
+            node->SetRotation(random.GetQuaternion());
+        }
+    };
+
+    runner.Report(Format("{} replicated nodes moving every update, {} threads", numNodes, workQueue->GetNumThreads() + 1));
+
+    for (unsigned numClients : clientCounts)
+    {
+        ea::vector<SharedPtr<Connection> > connections;
+        for (unsigned i = 0; i < numClients; ++i)
+            connections.push_back(CreateLoadedConnection(context, scene));
+
+        // Same steps as Network::PostUpdate on the server
+        const auto update = [&]
+        {
+            scene->PrepareNetworkUpdate();
+            workQueue->ParallelFor(connections.size(), 1, [&](unsigned begin, unsigned end, unsigned threadIndex)
+            {
+                for (unsigned i = begin; i < end; ++i)
+                    connections[i]->SendServerUpdate();
+            });
+            for (Connection* connection : connections)
+                connection->SendAllBuffers();
+        };
+
+        // Send initial state outside of the measurement
+        update();
+
+        const double time = runner.Measure(Format("Server update, {} clients", numClients), [&]
+        {
+            moveNodes();
+            update();
+        });
+        runner.Report(Format("  {:.1f} us per client", time / numClients));
+    }
+}
+
+URHO3D_BENCHMARK(ReplicationInterest)
+{
+    static const unsigned nodeCounts[] = { 5000, 20000, 100000 };
+    static const unsigned maxFullScanNodes = 20000;
+    static const unsigned numClients = 8;
+    // Keep the same density for all node counts, so that each client sees about the same number of nodes
+    static const float areaPerNode = 100.0f;
+
+    Context* context = runner.GetContext();
+    auto* workQueue = context->GetSubsystem<WorkQueue>();
+
+    runner.Report(Format("{} clients, nodes moving every update, {} threads", numClients, workQueue->GetNumThreads() + 1));
+
+    for (unsigned numNodes : nodeCounts)
+    {
+        const float halfSize = Sqrt(numNodes * areaPerNode) * 0.5f;
+        RandomEngine random(0u);
+
+        auto scene = MakeShared<Scene>(context);
+        auto* interestGrid = scene->CreateComponent<NetworkInterestGrid>();
+        ea::vector<Node*> nodes;
+        for (unsigned i = 0; i < numNodes; ++i)
+        {
+            Node* node = scene->CreateChild(Format("Node{}", i));
+            node->SetPosition(random.GetVector3({ -halfSize, 0.0f, -halfSize }, { halfSize, 0.0f, halfSize }));
+            nodes.push_back(node);
+        }
+
+        ea::vector<SharedPtr<Connection> > connections;
+        for (unsigned i = 0; i < numClients; ++i)
+        {
+            connections.push_back(CreateLoadedConnection(context, scene));
+            connections.back()->SetPosition(random.GetVector3({ -halfSize, 0.0f, -halfSize }, { halfSize, 0.0f, halfSize }));
+        }
+
+        const auto moveNodes = [&]
+        {
+            for (Node* node : nodes)
+                node->Translate(random.GetVector3({ -1.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 1.0f }));
+        };
+
+        // Same steps as Network::PostUpdate on the server
+        const auto update = [&]
+        {
+            interestGrid->Update();
+            scene->PrepareNetworkUpdate();
+            workQueue->ParallelFor(connections.size(), 1, [&](unsigned begin, unsigned end, unsigned threadIndex)
+            {
+                for (unsigned i = begin; i < end; ++i)
+                    connections[i]->SendServerUpdate();
+            });
+            for (Connection* connection : connections)
+                connection->SendAllBuffers();
+        };
+
+        // Send initial state outside of the measurement
+        update();
+
+        runner.Measure(Format("{} nodes, interest grid", numNodes), [&]
+        {
+            moveNodes();
+            update();
+        });
+
+        if (numNodes <= maxFullScanNodes)
+        {
+            interestGrid->SetEnabled(false);
+            update();
+
+            runner.Measure(Format("{} nodes, full scan", numNodes), [&]
+            {
+                moveNodes();
+                update();
+            });
+        }
+    }
+}
+
+URHO3D_BENCHMARK(ReplicationLoopback)
+{
+    static const unsigned numNodes = 1000;
+    static const unsigned clientCounts[] = { 1, 8, 32, 64 };
+    static const unsigned numWarmupTicks = 30;
+    static const float latencyMs = 50.0f;
+    static const float packetLoss = 0.05f;
+    static const float timeStep = 1.0f / 30.0f;
+
+    Context* context = runner.GetContext();
+    auto* network = context->GetSubsystem<Network>();
+    auto* log = context->GetSubsystem<Log>();
+    network->SetUpdateFps(30);
+
+    // Keep the connection messages of the simulated clients out of the output
+    const LogLevel logLevel = log->GetLevel();
+    log->SetLevel(LOG_WARNING);
+
+    auto scene = MakeShared<Scene>(context);
+    ea::vector<Node*> nodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+        nodes.push_back(scene->CreateChild(Format("Node{}", i)));
+
+    RandomEngine random(0u);
+    const auto moveNodes = [&]
+    {
+        for (Node* node : nodes)
+            node->Translate(random.GetVector3({ -1.0f, -1.0f, -1.0f }, { 1.0f, 1.0f, 1.0f }));
+    };
+
+    runner.Report(Format("{} replicated nodes moving every update, {:.0f} ms latency, {:.0f}% packet loss",
+        numNodes, latencyMs, packetLoss * 100.0f));
+
+    for (unsigned numClients : clientCounts)
+    {
+        auto loopback = MakeShared<LoopbackNetwork>(context);
+        loopback->SetLatency(latencyMs);
+        loopback->SetPacketLoss(packetLoss);
+
+        ea::vector<SharedPtr<Scene> > clientScenes;
+        for (unsigned i = 0; i < numClients; ++i)
+        {
+            clientScenes.push_back(MakeShared<Scene>(context));
+            loopback->Connect(clientScenes.back());
+            loopback->GetServerConnection(i)->SetScene(scene);
+        }
+
+        // Full frame of the server and all clients. Only the server update is measured
+        HiresTimer timer;
+        long long serverTime = 0;
+        unsigned long long serverAllocations = 0;
+        const auto tick = [&]
+        {
+            moveNodes();
+            const unsigned long long allocationsBefore = BenchmarkRunner::GetNumAllocations();
+            timer.Reset();
+            network->PostUpdate(timeStep);
+            serverTime += timer.GetUSec(false);
+            serverAllocations += BenchmarkRunner::GetNumAllocations() - allocationsBefore;
+            loopback->Update(timeStep);
+        };
+
+        const auto getBytesOut = [&]
+        {
+            unsigned long long bytes = 0;
+            for (unsigned i = 0; i < numClients; ++i)
+                bytes += loopback->GetServerConnection(i)->GetTotalBytesOut();
+            return bytes;
+        };
+
+        // Let the clients load the scene and receive the initial state
+        for (unsigned i = 0; i < numWarmupTicks; ++i)
+            tick();
+
+        const unsigned numTicks = Max(runner.GetIterations(), 1u);
+        const unsigned long long bytesBefore = getBytesOut();
+        serverTime = 0;
+        serverAllocations = 0;
+        for (unsigned i = 0; i < numTicks; ++i)
+            tick();
+
+        const unsigned long long bytesPerClient = (getBytesOut() - bytesBefore) / (numTicks * numClients);
+        runner.Report(Format("{:>3} clients: server tick {:>10.2f} us, {:>6} bytes per client, {:>7} allocations",
+            numClients, static_cast<double>(serverTime) / numTicks, bytesPerClient, serverAllocations / numTicks));
+        runner.Report(Format("     replicated nodes on the first client: {} of {}",
+            clientScenes[0]->GetNumChildren(), numNodes));
+
+        loopback->DisconnectAll();
+    }
+
+    log->SetLevel(logLevel);
+}
+
+#ifdef URHO3D_PHYSICS
+URHO3D_BENCHMARK(ReplicationBandwidth)
+{
+    static const unsigned numBalls = 100;
+    static const unsigned numClients = 8;
+    static const unsigned numTicks = 300;
+    static const float timeStep = 1.0f / 30.0f;
+
+    Context* context = runner.GetContext();
+    auto* workQueue = context->GetSubsystem<WorkQueue>();
+
+    // Same content as in the SceneReplication sample: local static floor, replicated balls rolled by the players
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>(LOCAL);
+    scene->CreateComponent<PhysicsWorld>(LOCAL);
+
+    Node* floorNode = scene->CreateChild("Floor", LOCAL);
+    floorNode->SetPosition(Vector3(0.0f, -0.5f, 0.0f));
+    floorNode->SetScale(Vector3(400.0f, 1.0f, 400.0f));
+    floorNode->CreateComponent<RigidBody>()->SetFriction(1.0f);
+    floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    RandomEngine random(0u);
+    ea::vector<RigidBody*> bodies;
+    for (unsigned i = 0; i < numBalls; ++i)
+    {
+        Node* ballNode = scene->CreateChild("Ball");
+        ballNode->SetPosition(Vector3(random.GetFloat(-20.0f, 20.0f), 5.0f, random.GetFloat(-20.0f, 20.0f)));
+        ballNode->SetScale(0.5f);
+        ballNode->CreateComponent<StaticModel>();
+
+        auto* body = ballNode->CreateComponent<RigidBody>();
+        body->SetMass(1.0f);
+        body->SetFriction(1.0f);
+        body->SetLinearDamping(0.5f);
+        body->SetAngularDamping(0.5f);
+        ballNode->CreateComponent<CollisionShape>()->SetSphere(1.0f);
+
+        auto* light = ballNode->CreateComponent<Light>();
+        light->SetRange(3.0f);
+        bodies.push_back(body);
+    }
+
+    ea::vector<SharedPtr<Connection> > connections;
+    for (unsigned i = 0; i < numClients; ++i)
+        connections.push_back(CreateLoadedConnection(context, scene));
+
+    const auto getBytesOut = [&]
+    {
+        unsigned long long bytes = 0;
+        for (Connection* connection : connections)
+            bytes += connection->GetTotalBytesOut();
+        return bytes;
+    };
+
+    // Same steps as Network::PostUpdate on the server, preceded by the players pushing their balls around
+    const auto tick = [&]
+    {
+        for (RigidBody* body : bodies)
+            body->ApplyTorque(random.GetVector3({ -10.0f, 0.0f, -10.0f }, { 10.0f, 0.0f, 10.0f }));
+        scene->Update(timeStep);
+
+        scene->PrepareNetworkUpdate();
+        workQueue->ParallelFor(connections.size(), 1, [&](unsigned begin, unsigned end, unsigned threadIndex)
+        {
+            for (unsigned i = begin; i < end; ++i)
+                connections[i]->SendServerUpdate();
+        });
+        for (Connection* connection : connections)
+            connection->SendAllBuffers();
+    };
+
+    tick();
+    runner.Report(Format("{} rolling balls, {} clients", numBalls, numClients));
+    runner.Report(Format("  Initial state: {} bytes per client", getBytesOut() / numClients));
+
+    const unsigned long long bytesBefore = getBytesOut();
+    for (unsigned i = 0; i < numTicks; ++i)
+        tick();
+    const unsigned long long bytesPerTick = (getBytesOut() - bytesBefore) / (numTicks * numClients);
+    runner.Report(Format("  Updates: {} bytes per tick per client, {:.1f} bytes per ball", bytesPerTick, static_cast<float>(bytesPerTick) / numBalls));
+
+    runner.Measure("Server tick", tick);
+}
+#endif
+
+}
+#endif
@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/FileWatcher.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+URHO3D_BENCHMARK(ResourceReload)
+{
+    static const unsigned numFiles = 500;
+    static const unsigned numChangesPerFile = 10;
+
+    Context* context = runner.GetContext();
+    auto* fileSystem = context->GetSubsystem<FileSystem>();
+    auto* cache = context->GetSubsystem<ResourceCache>();
+
+    // Files as dropped by a build pipeline
+    const ea::string resourceDir = fileSystem->GetTemporaryDir() + "ResourceReloadBenchmark/";
+    fileSystem->CreateDirsRecursive(resourceDir);
+    ea::string content = "<root>\n";
+    for (unsigned i = 0; i < 100; ++i)
+        content += Format("\t<element index=\"{}\" value=\"Some value\" />\n", i);
+    content += "</root>\n";
+    for (unsigned i = 0; i < numFiles; ++i)
+    {
+        File file(context, Format("{}File{}.xml", resourceDir, i), FILE_WRITE);
+        file.Write(content.data(), content.size());
+    }
+
+    cache->AddResourceDir(resourceDir, 0);
+    ea::vector<SharedPtr<Resource> > resources;
+    for (unsigned i = 0; i < numFiles; ++i)
+        resources.emplace_back(cache->GetResource<XMLFile>(Format("File{}.xml", i)));
+
+    runner.Report(Format("{} files, {} changes per file", numFiles, numChangesPerFile));
+
+    runner.Measure("Drain changes one by one", [&]
+    {
+        FileWatcher watcher(context);
+        watcher.SetDelay(0.0f);
+        for (unsigned j = 0; j < numChangesPerFile; ++j)
+        {
+            for (unsigned i = 0; i < numFiles; ++i)
+                watcher.AddChange({ FILECHANGE_MODIFIED, Format("File{}.xml", i), EMPTY_STRING });
+        }
+        FileChange change;
+        while (watcher.GetNextChange(change))
+            ;
+    });
+
+    runner.Measure("Drain changes in a batch", [&]
+    {
+        FileWatcher watcher(context);
+        watcher.SetDelay(0.0f);
+        for (unsigned j = 0; j < numChangesPerFile; ++j)
+        {
+            for (unsigned i = 0; i < numFiles; ++i)
+                watcher.AddChange({ FILECHANGE_MODIFIED, Format("File{}.xml", i), EMPTY_STRING });
+        }
+        ea::vector<FileChange> changes;
+        watcher.GetNextBatch(changes);
+    });
+
+    runner.Measure("Reload one by one", [&]
+    {
+        for (Resource* resource : resources)
+            cache->ReloadResource(resource);
+    });
+
+    runner.Measure("Reload in a batch", [&]
+    {
+        cache->ReloadResources(resources);
+    });
+
+    resources.clear();
+    cache->ReleaseAllResources(true);
+    cache->RemoveResourceDir(resourceDir);
+    fileSystem->RemoveDir(resourceDir, true);
+}
+
+}
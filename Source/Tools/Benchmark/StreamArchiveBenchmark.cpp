@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/Resource/JSONArchive.h>
+#include <Urho3D/Resource/JSONFile.h>
+#include <Urho3D/Resource/XMLArchive.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+URHO3D_BENCHMARK(StreamArchives)
+{
+    static const unsigned numNodes = 1000;
+
+    Context* context = runner.GetContext();
+
+    // Scene with plenty of attributes and variables
+    auto sourceScene = MakeShared<Scene>(context);
+    sourceScene->CreateComponent<Octree>();
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = sourceScene->CreateChild(Format("Node{}", i));
+        node->SetPosition(Vector3(static_cast<float>(i), 1.0f, 0.0f));
+        node->AddTags("Spawned;Enemy");
+        node->SetVar("Health", 100);
+        node->SetVar("Target", Vector3::ONE * static_cast<float>(i));
+        node->SetVar("Description", "Description of the node");
+    }
+
+    JSONFile jsonFile(context);
+    {
+        JSONOutputArchive archive(&jsonFile);
+        sourceScene->Serialize(archive);
+    }
+    const ea::string jsonData = jsonFile.ToString();
+
+    XMLFile xmlFile(context);
+    {
+        XMLOutputArchive archive(&xmlFile);
+        sourceScene->Serialize(archive);
+    }
+    const ea::string xmlData = xmlFile.ToString();
+
+    // Tape memory
+    {
+        MemoryBuffer jsonBuffer(jsonData.data(), jsonData.size());
+        JSONStreamReader jsonReader;
+        jsonReader.Open(jsonBuffer);
+        JSONTape jsonTape;
+        jsonTape.Load(jsonReader);
+
+        MemoryBuffer xmlBuffer(xmlData.data(), xmlData.size());
+        XMLStreamReader xmlReader;
+        xmlReader.Open(xmlBuffer);
+        XMLTape xmlTape;
+        xmlTape.Load(xmlReader);
+
+        runner.Report(Format("{} nodes, JSON {} KiB (tape {} KiB), XML {} KiB (tape {} KiB)", numNodes,
+            jsonData.size() / 1024, jsonTape.GetMemoryUse() / 1024, xmlData.size() / 1024, xmlTape.GetMemoryUse() / 1024));
+    }
+
+    runner.Measure("Parse JSONFile", [&]
+    {
+        JSONFile file(context);
+        MemoryBuffer buffer(jsonData.data(), jsonData.size());
+        file.Load(buffer);
+    });
+
+    runner.Measure("Parse JSONTape", [&]
+    {
+        MemoryBuffer buffer(jsonData.data(), jsonData.size());
+        JSONStreamReader reader;
+        reader.Open(buffer);
+        JSONTape tape;
+        tape.Load(reader);
+    });
+
+    runner.Measure("Load scene via JSONInputArchive", [&]
+    {
+        JSONFile file(context);
+        MemoryBuffer buffer(jsonData.data(), jsonData.size());
+        file.Load(buffer);
+        JSONInputArchive archive(&file);
+        auto scene = MakeShared<Scene>(context);
+        scene->Serialize(archive);
+    });
+
+    runner.Measure("Load scene via JSONStreamInputArchive", [&]
+    {
+        MemoryBuffer buffer(jsonData.data(), jsonData.size());
+        JSONStreamReader reader;
+        reader.Open(buffer);
+        JSONTape tape;
+        tape.Load(reader);
+        JSONStreamInputArchive archive(context, tape);
+        auto scene = MakeShared<Scene>(context);
+        scene->Serialize(archive);
+    });
+
+    runner.Measure("Parse XMLFile", [&]
+    {
+        XMLFile file(context);
+        MemoryBuffer buffer(xmlData.data(), xmlData.size());
+        file.Load(buffer);
+    });
+
+    runner.Measure("Parse XMLTape", [&]
+    {
+        MemoryBuffer buffer(xmlData.data(), xmlData.size());
+        XMLStreamReader reader;
+        reader.Open(buffer);
+        XMLTape tape;
+        tape.Load(reader);
+    });
+
+    runner.Measure("Load scene via XMLInputArchive", [&]
+    {
+        XMLFile file(context);
+        MemoryBuffer buffer(xmlData.data(), xmlData.size());
+        file.Load(buffer);
+        XMLInputArchive archive(&file);
+        auto scene = MakeShared<Scene>(context);
+        scene->Serialize(archive);
+    });
+
+    runner.Measure("Load scene via XMLStreamInputArchive", [&]
+    {
+        MemoryBuffer buffer(xmlData.data(), xmlData.size());
+        XMLStreamReader reader;
+        reader.Open(buffer);
+        XMLTape tape;
+        tape.Load(reader);
+        XMLStreamInputArchive archive(context, tape);
+        auto scene = MakeShared<Scene>(context);
+        scene->Serialize(archive);
+    });
+}
+
+}
@@ -0,0 +1,86 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Graphics/Texture2D.h>
+#include <Urho3D/Graphics/TextureStreaming.h>
+#include <Urho3D/Math/RandomEngine.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+URHO3D_BENCHMARK(TextureStreaming)
+{
+    static const unsigned numTextures = 2048;
+    static const unsigned numVisible = 256;
+    static const unsigned numFrames = 100;
+    static const unsigned long long budget = 256ull * 1024 * 1024;
+
+    Context* context = runner.GetContext();
+
+    // Residency decisions run without a GPU: textures are registered with their dimensions only
+    auto streaming = MakeShared<TextureStreaming>(context);
+    streaming->SetBudget(budget);
+    streaming->SetMaxUpdatesPerFrame(64);
+
+    RandomEngine random(0u);
+    ea::vector<SharedPtr<Texture2D>> textures;
+    unsigned long long fullMemory = 0;
+    for (unsigned i = 0; i < numTextures; ++i)
+    {
+        const int size = 512 << random.GetUInt(0, 3);
+        auto texture = MakeShared<Texture2D>(context);
+        streaming->AddTexture(texture, EMPTY_STRING, size, size, LogBaseTwo(size) + 1, (unsigned long long)size * size * 4);
+        fullMemory += TextureStreaming::GetLevelMemory(*streaming->GetEntry(texture), 0);
+        textures.push_back(texture);
+    }
+
+    runner.Report(Format("{} textures, {} MB at full resolution, {} MB budget", numTextures, fullMemory >> 20, budget >> 20));
+    runner.Report(Format("Initially resident: {} MB", streaming->GetResidentMemory() >> 20));
+
+    // Visible set drifts over time, on-screen sizes vary from a few pixels to full screen
+    unsigned frameNumber = 0;
+    unsigned firstVisible = 0;
+    unsigned long long peakMemory = 0;
+    runner.Measure(Format("Request and update, {} frames", numFrames), [&]
+    {
+        for (unsigned frame = 0; frame < numFrames; ++frame)
+        {
+            for (unsigned i = 0; i < numVisible; ++i)
+            {
+                Texture2D* texture = textures[(firstVisible + i) % numTextures];
+                streaming->RequestScreenSize(texture, random.GetFloat(4.0f, 2048.0f));
+            }
+            firstVisible += 8;
+            streaming->Update(++frameNumber);
+            peakMemory = Max(peakMemory, streaming->GetResidentMemory());
+        }
+    });
+
+    runner.Report(Format("Resident after {} frames: {} MB, peak {} MB", frameNumber, streaming->GetResidentMemory() >> 20,
+        peakMemory >> 20));
+}
+
+}
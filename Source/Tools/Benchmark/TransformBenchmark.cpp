@@ -0,0 +1,109 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Scene/Scene.h>
+
+#include "Benchmark.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Create scene with a number of hierarchies of given depth and branching.
+SharedPtr<Scene> CreateHierarchyScene(Context* context, unsigned numRoots, unsigned depth, unsigned branching,
+    ea::vector<Node*>& roots, ea::vector<Node*>& nodes)
+{
+    RandomEngine random(0u);
+    auto scene = MakeShared<Scene>(context);
+
+    ea::vector<Node*> level;
+    for (unsigned i = 0; i < numRoots; ++i)
+        level.push_back(scene->CreateChild());
+    roots = level;
+
+    for (unsigned i = 1; i < depth; ++i)
+    {
+        ea::vector<Node*> nextLevel;
+        for (Node* parent : level)
+        {
+            for (unsigned j = 0; j < branching; ++j)
+                nextLevel.push_back(parent->CreateChild());
+        }
+        nodes.insert(nodes.end(), level.begin(), level.end());
+        level = ea::move(nextLevel);
+    }
+    nodes.insert(nodes.end(), level.begin(), level.end());
+
+    for (Node* node : nodes)
+        node->SetTransform(random.GetVector3(-Vector3::ONE, Vector3::ONE), random.GetQuaternion(), random.GetFloat(0.9f, 1.1f));
+    return scene;
+}
+
+}
+
+URHO3D_BENCHMARK(WorldTransformUpdate)
+{
+    static const unsigned numRoots = 256;
+    static const unsigned depth = 8;
+    static const unsigned branching = 2;
+
+    Context* context = runner.GetContext();
+
+    ea::vector<Node*> roots;
+    ea::vector<Node*> nodes;
+    SharedPtr<Scene> scene = CreateHierarchyScene(context, numRoots, depth, branching, roots, nodes);
+    runner.Report(Format("{} nodes, {} roots, depth {}", nodes.size(), numRoots, depth));
+
+    // Every root moves each frame and dirties its whole subtree
+    float angle = 0.0f;
+    const auto moveRoots = [&]
+    {
+        angle += 1.0f;
+        for (Node* root : roots)
+            root->SetRotation(Quaternion(angle, Vector3::UP));
+    };
+
+    runner.Measure("Lazy update on query", [&]
+    {
+        moveRoots();
+        for (Node* node : nodes)
+            node->GetWorldTransform();
+    });
+
+    scene->SetTransformHierarchyEnabled(true);
+    scene->UpdateWorldTransforms();
+
+    runner.Measure("Transform hierarchy pass", [&]
+    {
+        moveRoots();
+        scene->UpdateWorldTransforms();
+        for (Node* node : nodes)
+            node->GetWorldTransform();
+    });
+}
+
+}
@@ -26,6 +26,7 @@
 #include <Urho3D/Core/Thread.h>
 #include <Urho3D/IO/Log.h>
 #include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/PackageFile.h>
 #include <LZ4/lz4.h>
 #include <LZ4/lz4hc.h>
 
@@ -144,15 +145,15 @@ void Packager::WritePackage()
     AddFile(cachePath, "CacheInfo.json");   filesDone_++;
     AddFile(cachePath, "Settings.json");    filesDone_++;
 
+    // Sorted file index is aligned for use directly from the memory mapping
+    while (output_.GetSize() % alignof(PackageIndexEntry))
+        output_.WriteUByte(0);
     entriesOffset_ = output_.GetSize();
 
+    ea::vector<ea::pair<ea::string, PackageEntry>> index;
     for (const FileEntry& entry : entries_)
-    {
-        output_.WriteString(entry.name_);
-        output_.WriteUInt(entry.offset_);
-        output_.WriteUInt(entry.size_);
-        output_.WriteUInt(entry.checksum_);
-    }
+        index.emplace_back(entry.name_, PackageEntry{entry.offset_, entry.size_, entry.checksum_});
+    PackageFile::WriteIndex(output_, index);
     // Write package size to the end of file to allow finding it linked to an executable file
     unsigned currentSize = output_.GetSize();
     output_.WriteUInt(currentSize + sizeof(unsigned));
@@ -168,7 +169,7 @@ void Packager::WriteHeaders()
     output_.WriteFileID(compress_ ? "RLZ4" : "RPAK");
     output_.WriteUInt(entries_.size());
     output_.WriteUInt(checksum_);
-    output_.WriteUInt(0);                                   // Version. Reserved for future use.
+    output_.WriteUInt(PackageFile::INDEXED_VERSION);
     output_.WriteInt64(entriesOffset_);
 }
 
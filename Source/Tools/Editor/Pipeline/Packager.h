@@ -47,7 +47,8 @@ struct FileEntry
 ///
 /// rbfx uses modified Urho3D pak file format. File header is modified and extended. Version field was added to facilitate easy modification
 /// of file structure in the future. Package entry list was moved to the end of the file (much like in a zip file) in order to allow
-/// creation of package files without knowing full list of files before-hand.
+/// creation of package files without knowing full list of files before-hand. Version 1 stores the entry list as a sorted index
+/// which is used directly from the memory mapped package.
 ///
 
 /// %Packager is responsible for creating a package for specified flavor. Package will use new file format and have RPAK/RLZ4 file id.
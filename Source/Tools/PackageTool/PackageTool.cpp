@@ -24,6 +24,8 @@
 
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
 #include <Urho3D/IO/PackageFile.h>
@@ -33,6 +35,7 @@
 #endif
 
 #include <EASTL/unique_ptr.h>
+#include <EASTL/unordered_map.h>
 #include <LZ4/lz4.h>
 #include <LZ4/lz4hc.h>
 
@@ -42,13 +45,40 @@
 using namespace Urho3D;
 
 static const unsigned COMPRESSED_BLOCK_SIZE = 32768;
+static const unsigned long long MAX_BATCH_SIZE = 256 * 1024 * 1024;
+
+enum class Codec
+{
+    /// Store without compression.
+    Store,
+    /// Fast LZ4 compression.
+    LZ4,
+    /// LZ4HC compression at default level.
+    LZ4HC,
+    /// LZ4HC compression at maximum level.
+    LZ4HCMax
+};
 
 struct FileEntry
 {
     ea::string name_;
-    unsigned offset_{};
+    unsigned long long offset_{};
     unsigned size_{};
     unsigned checksum_{};
+    /// Index of an earlier entry with identical contents.
+    unsigned duplicateOf_{M_MAX_UNSIGNED};
+};
+
+struct CompressedBlock
+{
+    /// Entry index within the batch.
+    unsigned entry_{};
+    /// Offset of the block within the entry.
+    unsigned offset_{};
+    /// Uncompressed block size.
+    unsigned size_{};
+    /// Compressed data, empty if the block is stored.
+    ea::vector<unsigned char> data_;
 };
 
 Context* context_ = nullptr;
@@ -59,6 +89,10 @@ unsigned checksum_ = 0;
 bool compress_ = false;
 bool quiet_ = false;
 unsigned blockSize_ = COMPRESSED_BLOCK_SIZE;
+unsigned numThreads_ = 0;
+ea::vector<ea::string> fastExtensions_;
+ea::vector<ea::string> maxExtensions_;
+ea::vector<ea::string> storeExtensions_;
 
 ea::string ignoreExtensions_[] = {
     ".bak",
@@ -69,12 +103,17 @@ int main(int argc, char** argv);
 void Run(const ea::vector<ea::string>& arguments);
 void ProcessFile(const ea::string& fileName, const ea::string& rootDir);
 void WritePackageFile(const ea::string& fileName, const ea::string& rootDir);
-void WriteHeader(File& dest);
+void WriteHeader(File& dest, long long fileListOffset);
+unsigned GetCompressedSize(File& packageData, const PackageEntry& entry, unsigned version);
+Codec GetCodec(const ea::string& fileName);
+void CompressBlock(CompressedBlock& block, const unsigned char* data, Codec codec);
+unsigned SDBMHashPower(unsigned size);
 
 int main(int argc, char** argv)
 {
     SharedPtr<Context> context(new Context());
     SharedPtr<FileSystem> fileSystem(new FileSystem(context));
+    context->RegisterSubsystem(new WorkQueue(context));
     ea::vector<ea::string> arguments;
     context_ = context;
     fileSystem_ = fileSystem;
@@ -97,9 +136,14 @@ void Run(const ea::vector<ea::string>& arguments)
             "\n"
             "Options:\n"
             "-c      Enable package file LZ4 compression\n"
+            "-cf     <extensions> Use fast LZ4 compression for files with these comma separated extensions, e.g. hot runtime assets\n"
+            "-cx     <extensions> Use maximum LZ4HC compression for files with these extensions, e.g. cold assets\n"
+            "-cs     <extensions> Store files with these extensions without compression, e.g. already compressed formats\n"
+            "-j      <threads> Number of compression threads, all logical CPUs by default\n"
             "-q      Enable quiet mode\n"
             "\n"
-            "Basepath is an optional prefix that will be added to the file entries.\n\n"
+            "Basepath is an optional prefix that will be added to the file entries.\n"
+            "Files with identical contents are stored once.\n\n"
             "Alternative output usage: PackageTool <output option> <package name>\n"
             "Output option:\n"
             "-i      Output package file information\n"
@@ -118,26 +162,31 @@ void Run(const ea::vector<ea::string>& arguments)
                 basePath_ = AddTrailingSlash(arguments[i]);
             else
             {
-                if (arguments[i].length() > 1)
-                {
-                    switch (arguments[i][1])
-                    {
-                    case 'c':
-                        compress_ = true;
-                        break;
-                    case 'q':
-                        quiet_ = true;
-                        break;
-                    default:
-                        ErrorExit("Unrecognized option");
-                    }
-                }
+                const ea::string& option = arguments[i];
+                const bool hasValue = i + 1 < arguments.size();
+                if (option == "-cf" && hasValue)
+                    fastExtensions_ = arguments[++i].split(',');
+                else if (option == "-cx" && hasValue)
+                    maxExtensions_ = arguments[++i].split(',');
+                else if (option == "-cs" && hasValue)
+                    storeExtensions_ = arguments[++i].split(',');
+                else if (option == "-j" && hasValue)
+                    numThreads_ = ToUInt(arguments[++i]);
+                else if (option == "-c")
+                    compress_ = true;
+                else if (option == "-q")
+                    quiet_ = true;
+                else
+                    ErrorExit("Unrecognized option");
             }
         }
     }
 
     if (!isOutputMode)
     {
+        // Calling thread participates in parallel work
+        context_->GetSubsystem<WorkQueue>()->CreateThreads((numThreads_ ? numThreads_ : GetNumLogicalCPUs()) - 1);
+
         if (!quiet_)
             PrintLine("Scanning directory " + dirName + " for files");
 
@@ -214,18 +263,16 @@ void Run(const ea::vector<ea::string>& arguments)
             // Fallthrough
         case 'l':
             {
-                const ea::unordered_map<ea::string, PackageEntry>& entries = packageFile->GetEntries();
-                for (auto i = entries.begin(); i != entries.end();)
+                File packageData(context_, packageName);
+                for (unsigned i = 0; i < packageFile->GetNumFiles(); ++i)
                 {
-                    auto current = i++;
-                    ea::string fileEntry(current->first);
+                    ea::string fileEntry = packageFile->GetEntryName(i);
                     if (outputCompressionRatio)
                     {
-                        unsigned compressedSize =
-                            (i == entries.end() ? packageFile->GetTotalSize() - sizeof(unsigned) : i->second.offset_) -
-                            current->second.offset_;
-                        fileEntry.append_sprintf("\tin: %u\tout: %u\tratio: %f", current->second.size_, compressedSize,
-                            compressedSize ? 1.f * current->second.size_ / compressedSize : 0.f);
+                        const PackageEntry* entry = packageFile->GetEntry(fileEntry);
+                        unsigned compressedSize = GetCompressedSize(packageData, *entry, packageFile->GetVersion());
+                        fileEntry.append_sprintf("\tin: %u\tout: %u\tratio: %f", entry->size_, compressedSize,
+                            compressedSize ? 1.f * entry->size_ / compressedSize : 0.f);
                     }
                     PrintLine(fileEntry);
                 }
@@ -261,104 +308,194 @@ void WritePackageFile(const ea::string& fileName, const ea::string& rootDir)
     if (!dest.Open(fileName, FILE_WRITE))
         ErrorExit("Could not open output file " + fileName);
 
-    // Write ID, number of files & placeholder for checksum
-    WriteHeader(dest);
+    // Write ID, number of files, placeholder for checksum and file index offset
+    WriteHeader(dest, 0);
 
-    for (unsigned i = 0; i < entries_.size(); ++i)
-    {
-        // Write entry (correct offset is still unknown, will be filled in later)
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
-    }
+    auto workQueue = context_->GetSubsystem<WorkQueue>();
+    unsigned long long totalDataSize = 0;
+    unsigned long long duplicateDataSize = 0;
+    unsigned numDuplicates = 0;
 
-    unsigned totalDataSize = 0;
-    unsigned lastOffset;
+    // Entries by size and checksum, used to find duplicates
+    ea::unordered_map<ea::pair<unsigned, unsigned>, ea::vector<unsigned> > entriesByContent;
 
-    // Write file data, calculate checksums & correct offsets
-    for (unsigned i = 0; i < entries_.size(); ++i)
+    // Process files in batches to limit memory use. Reading and compression run in parallel, writing is in file order
+    // so that the package is reproducible
+    for (unsigned batchBegin = 0; batchBegin < entries_.size();)
     {
-        lastOffset = entries_[i].offset_ = dest.GetSize();
-        ea::string fileFullPath = rootDir + "/" + entries_[i].name_;
+        unsigned batchEnd = batchBegin;
+        unsigned long long batchSize = 0;
+        while (batchEnd < entries_.size() && (batchEnd == batchBegin || batchSize + entries_[batchEnd].size_ <= MAX_BATCH_SIZE))
+            batchSize += entries_[batchEnd++].size_;
+
+        // Read files and calculate checksums
+        const unsigned numBatchEntries = batchEnd - batchBegin;
+        ea::vector<ea::vector<unsigned char> > contents(numBatchEntries);
+        ea::vector<unsigned char> readFailed(numBatchEntries);
+        workQueue->ParallelFor(numBatchEntries, 1, [&](unsigned begin, unsigned end, unsigned)
+        {
+            for (unsigned i = begin; i < end; ++i)
+            {
+                FileEntry& entry = entries_[batchBegin + i];
+                File srcFile(context_, rootDir + "/" + entry.name_);
+                contents[i].resize(entry.size_);
+                if (!srcFile.IsOpen() || srcFile.Read(contents[i].data(), entry.size_) != entry.size_)
+                {
+                    readFailed[i] = true;
+                    continue;
+                }
+
+                for (unsigned char c : contents[i])
+                    entry.checksum_ = SDBMHash(entry.checksum_, c);
+            }
+        });
 
-        File srcFile(context_, fileFullPath);
-        if (!srcFile.IsOpen())
-            ErrorExit("Could not open file " + fileFullPath);
+        // Find duplicates of earlier entries
+        for (unsigned i = 0; i < numBatchEntries; ++i)
+        {
+            FileEntry& entry = entries_[batchBegin + i];
+            if (readFailed[i])
+                ErrorExit("Could not read file " + rootDir + "/" + entry.name_);
 
-        unsigned dataSize = entries_[i].size_;
-        totalDataSize += dataSize;
-        ea::unique_ptr<unsigned char[]> buffer(new unsigned char[dataSize]);
+            // Package checksum covers data of all files in order
+            checksum_ = checksum_ * SDBMHashPower(entry.size_) + entry.checksum_;
+            totalDataSize += entry.size_;
 
-        if (srcFile.Read(&buffer[0], dataSize) != dataSize)
-            ErrorExit("Could not read file " + fileFullPath);
-        srcFile.Close();
+            ea::vector<unsigned>& candidates = entriesByContent[ea::make_pair(entry.size_, entry.checksum_)];
+            for (unsigned candidate : candidates)
+            {
+                bool equal = false;
+                if (candidate >= batchBegin)
+                    equal = contents[candidate - batchBegin] == contents[i];
+                else
+                    equal = File(context_, rootDir + "/" + entries_[candidate].name_).ReadBinary() == contents[i];
 
-        for (unsigned j = 0; j < dataSize; ++j)
-        {
-            checksum_ = SDBMHash(checksum_, buffer[j]);
-            entries_[i].checksum_ = SDBMHash(entries_[i].checksum_, buffer[j]);
+                if (equal)
+                {
+                    entry.duplicateOf_ = candidate;
+                    break;
+                }
+            }
+
+            if (entry.duplicateOf_ == M_MAX_UNSIGNED)
+                candidates.push_back(batchBegin + i);
+            else
+            {
+                ++numDuplicates;
+                duplicateDataSize += entry.size_;
+                contents[i].clear();
+            }
         }
 
-        if (!compress_)
+        // Compress blocks of all unique files in the batch
+        ea::vector<CompressedBlock> blocks;
+        ea::vector<unsigned> firstBlocks(numBatchEntries + 1);
+        for (unsigned i = 0; i < numBatchEntries; ++i)
         {
-            if (!quiet_)
-                PrintLine(entries_[i].name_ + " size " + ea::to_string(dataSize));
-            dest.Write(&buffer[0], entries_[i].size_);
+            firstBlocks[i] = blocks.size();
+            const FileEntry& entry = entries_[batchBegin + i];
+            if (!compress_ || entry.duplicateOf_ != M_MAX_UNSIGNED)
+                continue;
+
+            for (unsigned pos = 0; pos < entry.size_; pos += blockSize_)
+            {
+                CompressedBlock& block = blocks.emplace_back();
+                block.entry_ = i;
+                block.offset_ = pos;
+                block.size_ = Min(blockSize_, entry.size_ - pos);
+            }
         }
-        else
-        {
-            ea::unique_ptr<unsigned char[]> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
+        firstBlocks[numBatchEntries] = blocks.size();
 
-            unsigned pos = 0;
+        workQueue->ParallelFor(blocks.size(), 1, [&](unsigned begin, unsigned end, unsigned)
+        {
+            for (unsigned i = begin; i < end; ++i)
+            {
+                CompressedBlock& block = blocks[i];
+                const FileEntry& entry = entries_[batchBegin + block.entry_];
+                CompressBlock(block, contents[block.entry_].data() + block.offset_, GetCodec(entry.name_));
+            }
+        });
 
-            while (pos < dataSize)
+        // Write file data and correct offsets
+        for (unsigned i = 0; i < numBatchEntries; ++i)
+        {
+            FileEntry& entry = entries_[batchBegin + i];
+            if (entry.duplicateOf_ != M_MAX_UNSIGNED)
             {
-                unsigned unpackedSize = blockSize_;
-                if (pos + unpackedSize > dataSize)
-                    unpackedSize = dataSize - pos;
+                entry.offset_ = entries_[entry.duplicateOf_].offset_;
+                if (!quiet_)
+                    PrintLine(entry.name_ + " duplicate of " + entries_[entry.duplicateOf_].name_);
+                continue;
+            }
 
-                auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)compressBuffer.get(), unpackedSize, LZ4_compressBound(unpackedSize), 0);
-                if (!packedSize)
-                    ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + ea::to_string(pos));
+            entry.offset_ = dest.GetSize();
+            if (entry.offset_ > M_MAX_UNSIGNED)
+                ErrorExit("Package file is too large");
 
-                dest.WriteUShort((unsigned short)unpackedSize);
-                dest.WriteUShort((unsigned short)packedSize);
-                dest.Write(compressBuffer.get(), packedSize);
+            if (!compress_)
+            {
+                if (!quiet_)
+                    PrintLine(entry.name_ + " size " + ea::to_string(entry.size_));
+                dest.Write(contents[i].data(), entry.size_);
+                continue;
+            }
 
-                pos += unpackedSize;
+            // Block size and block table allow random access to the blocks
+            dest.WriteUInt(blockSize_);
+            dest.WriteUInt(firstBlocks[i + 1] - firstBlocks[i]);
+            unsigned blockEnd = 0;
+            for (unsigned j = firstBlocks[i]; j < firstBlocks[i + 1]; ++j)
+            {
+                const CompressedBlock& block = blocks[j];
+                blockEnd += block.data_.empty() ? block.size_ : block.data_.size();
+                dest.WriteUInt(blockEnd | (block.data_.empty() ? PackageFile::STORED_BLOCK_FLAG : 0));
+            }
+            for (unsigned j = firstBlocks[i]; j < firstBlocks[i + 1]; ++j)
+            {
+                const CompressedBlock& block = blocks[j];
+                if (block.data_.empty())
+                    dest.Write(contents[i].data() + block.offset_, block.size_);
+                else
+                    dest.Write(block.data_.data(), block.data_.size());
             }
 
             if (!quiet_)
             {
-                unsigned totalPackedBytes = dest.GetSize() - lastOffset;
-                ea::string fileEntry(entries_[i].name_);
-                fileEntry.append_sprintf("\tin: %u\tout: %u\tratio: %f", dataSize, totalPackedBytes,
-                    totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f);
+                const unsigned totalPackedBytes = static_cast<unsigned>(dest.GetSize() - entry.offset_);
+                ea::string fileEntry(entry.name_);
+                fileEntry.append_sprintf("\tin: %u\tout: %u\tratio: %f", entry.size_, totalPackedBytes,
+                    totalPackedBytes ? 1.f * entry.size_ / totalPackedBytes : 0.f);
                 PrintLine(fileEntry);
             }
         }
+
+        batchBegin = batchEnd;
     }
 
+    // Write sorted file index after the data, aligned for use directly from the memory mapping
+    while (dest.GetSize() % alignof(PackageIndexEntry))
+        dest.WriteUByte(0);
+    const long long fileListOffset = dest.GetSize();
+
+    ea::vector<ea::pair<ea::string, PackageEntry> > index;
+    for (const FileEntry& entry : entries_)
+        index.emplace_back(basePath_ + entry.name_, PackageEntry{ entry.offset_, entry.size_, entry.checksum_ });
+    if (!PackageFile::WriteIndex(dest, index))
+        ErrorExit("Could not write file index");
+
     // Write package size to the end of file to allow finding it linked to an executable file
     unsigned currentSize = dest.GetSize();
     dest.WriteUInt(currentSize + sizeof(unsigned));
 
     // Write header again with correct offsets & checksums
     dest.Seek(0);
-    WriteHeader(dest);
-
-    for (unsigned i = 0; i < entries_.size(); ++i)
-    {
-        dest.WriteString(basePath_ + entries_[i].name_);
-        dest.WriteUInt(entries_[i].offset_);
-        dest.WriteUInt(entries_[i].size_);
-        dest.WriteUInt(entries_[i].checksum_);
-    }
+    WriteHeader(dest, fileListOffset);
 
     if (!quiet_)
     {
         PrintLine("Number of files: " + ea::to_string(entries_.size()));
+        PrintLine("Duplicate files: " + ea::to_string(numDuplicates) + " (" + ea::to_string(duplicateDataSize) + " bytes)");
         PrintLine("File data size: " + ea::to_string(totalDataSize));
         PrintLine("Package size: " + ea::to_string(dest.GetSize()));
         PrintLine("Checksum: " + ea::to_string(checksum_));
@@ -366,12 +503,105 @@ void WritePackageFile(const ea::string& fileName, const ea::string& rootDir)
     }
 }
 
-void WriteHeader(File& dest)
+void WriteHeader(File& dest, long long fileListOffset)
 {
     if (!compress_)
-        dest.WriteFileID("UPAK");
+        dest.WriteFileID("RPAK");
     else
-        dest.WriteFileID("ULZ4");
+        dest.WriteFileID("RLZ4");
     dest.WriteUInt(entries_.size());
     dest.WriteUInt(checksum_);
+    dest.WriteUInt(PackageFile::BLOCK_TABLE_VERSION);
+    dest.WriteInt64(fileListOffset);
+}
+
+unsigned GetCompressedSize(File& packageData, const PackageEntry& entry, unsigned version)
+{
+    packageData.Seek(static_cast<unsigned>(entry.offset_));
+
+    // Older packages store sequential blocks without block table
+    if (version < PackageFile::BLOCK_TABLE_VERSION)
+    {
+        unsigned unpackedTotal = 0;
+        unsigned compressedSize = 0;
+        while (unpackedTotal < entry.size_ && !packageData.IsEof())
+        {
+            const unsigned unpackedSize = packageData.ReadUShort();
+            const unsigned packedSize = packageData.ReadUShort();
+            if (!unpackedSize)
+                break;
+            packageData.Seek(packageData.GetPosition() + packedSize);
+            unpackedTotal += unpackedSize;
+            compressedSize += 2 * sizeof(unsigned short) + packedSize;
+        }
+        return compressedSize;
+    }
+
+    // The last block table entry is the size of all compressed blocks
+    const unsigned blockSize = packageData.ReadUInt();
+    const unsigned numBlocks = packageData.ReadUInt();
+    if (!blockSize || !numBlocks)
+        return 2 * sizeof(unsigned);
+    packageData.Seek(packageData.GetPosition() + (numBlocks - 1) * sizeof(unsigned));
+    const unsigned blocksSize = packageData.ReadUInt() & ~PackageFile::STORED_BLOCK_FLAG;
+    return (2 + numBlocks) * sizeof(unsigned) + blocksSize;
+}
+
+Codec GetCodec(const ea::string& fileName)
+{
+    const ea::string extension = GetExtension(fileName);
+    const auto matches = [&](const ea::vector<ea::string>& extensions)
+    {
+        for (const ea::string& entry : extensions)
+        {
+            if (!extension.comparei(entry.starts_with(".") ? entry : "." + entry))
+                return true;
+        }
+        return false;
+    };
+
+    if (matches(storeExtensions_))
+        return Codec::Store;
+    if (matches(fastExtensions_))
+        return Codec::LZ4;
+    if (matches(maxExtensions_))
+        return Codec::LZ4HCMax;
+    return Codec::LZ4HC;
+}
+
+void CompressBlock(CompressedBlock& block, const unsigned char* data, Codec codec)
+{
+    if (codec == Codec::Store)
+        return;
+
+    const int bound = LZ4_compressBound(block.size_);
+    block.data_.resize(bound);
+    const auto src = reinterpret_cast<const char*>(data);
+    const auto dest = reinterpret_cast<char*>(block.data_.data());
+
+    int packedSize = 0;
+    if (codec == Codec::LZ4)
+        packedSize = LZ4_compress_default(src, dest, block.size_, bound);
+    else
+        packedSize = LZ4_compress_HC(src, dest, block.size_, bound, codec == Codec::LZ4HCMax ? LZ4HC_CLEVEL_MAX : LZ4HC_CLEVEL_DEFAULT);
+
+    // Keep the block uncompressed if compression does not help
+    if (packedSize <= 0 || static_cast<unsigned>(packedSize) >= block.size_)
+        block.data_.clear();
+    else
+        block.data_.resize(packedSize);
+}
+
+unsigned SDBMHashPower(unsigned size)
+{
+    // SDBM hash of a sequence appended to existing hash is hash * 65599^size + hash of the sequence alone
+    unsigned result = 1;
+    unsigned base = 65599;
+    for (; size; size >>= 1)
+    {
+        if (size & 1)
+            result *= base;
+        base *= base;
+    }
+    return result;
 }
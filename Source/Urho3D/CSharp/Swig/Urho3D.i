@@ -345,6 +345,11 @@ namespace SDL
 %ignore Urho3D::GetWideNativePath;
 %ignore Urho3D::logLevelNames;
 %ignore Urho3D::LOG_LEVEL_COLORS;
+%ignore Urho3D::PackageIndexEntry;
+%ignore Urho3D::PackageFile::GetEntryData;
+%ignore Urho3D::PackageFile::GetMappedData;
+%ignore Urho3D::PackageFile::WriteIndex;
+%ignore Urho3D::File::GetMappedData;
 
 %extend Urho3D::Log {
 public:
@@ -431,20 +436,41 @@ public:
 %ignore Urho3D::DirtyBits::data_;
 %ignore Urho3D::SceneReplicationState::dirtyNodes_;		// Needs HashSet wrapped
 %ignore Urho3D::NodeReplicationState::dirtyVars_;		// Needs HashSet wrapped
+%ignore Urho3D::NetworkState::encodedValues_;
+%ignore Urho3D::NetworkState::encodedValueEnds_;
+%ignore Urho3D::NetworkState::nonDefaultAttributes_;
+%ignore Urho3D::NetworkState::encoded_;
+%ignore Urho3D::NetworkState::mutex_;
+%ignore Urho3D::NetworkState::quantizedValues_;
+%ignore Urho3D::NetworkState::baseline_;
+%ignore Urho3D::NetworkState::baselineIndex_;
+%ignore Urho3D::NetworkState::pendingLatestData_;
+%ignore Urho3D::PendingLatestData;
 %ignore Urho3D::Animatable::animatedNetworkAttributes_; // Needs HashSet wrapped
 %ignore Urho3D::AsyncProgress::resources_;
 %ignore Urho3D::ValueAnimation::GetKeyFrames;
 %ignore Urho3D::Serializable::networkState_;
 %ignore Urho3D::Serializable::instanceDefaultValues_;
 %ignore Urho3D::ReplicationState::connection_;
+%ignore Urho3D::ReplicationState::baseline_;
+%ignore Urho3D::ReplicationState::baselineIndex_;
+%ignore Urho3D::ReplicationState::baselineAge_;
+%ignore Urho3D::Serializable::WriteLatestDataUpdate;
+%ignore Urho3D::Serializable::UpdateLatestDataBaseline;
+%ignore Urho3D::Serializable::GetLatestDataBaselineAttributes;
 %ignore Urho3D::Component::CleanupConnection;
 %ignore Urho3D::Scene::CleanupConnection;
 %ignore Urho3D::Node::CleanupConnection;
+%ignore Urho3D::Component::RemoveReplicationState;
+%ignore Urho3D::Node::RemoveReplicationState;
+%ignore Urho3D::Scene::GetNetworkUpdateNodes;      // Needs HashSet wrapped
 %ignore Urho3D::NodeImpl;
 %ignore Urho3D::Node::GetEntity;
 %ignore Urho3D::Node::SetEntity;
 %ignore Urho3D::Scene::GetRegistry;
 %ignore Urho3D::Scene::GetComponentIndex;
+%ignore Urho3D::Scene::GetUpdateChannel;
+%ignore Urho3D::Scene::GetPostUpdateChannel;
 
 %include "Urho3D/Scene/AnimationDefs.h"
 %include "Urho3D/Scene/ValueAnimationInfo.h"
@@ -459,6 +485,10 @@ public:
 %include "Urho3D/Scene/LogicComponent.h"
 %include "Urho3D/Scene/ObjectAnimation.h"
 %include "Urho3D/Scene/SceneResolver.h"
+%ignore Urho3D::ScenePrefab::GetNodes;
+%ignore Urho3D::ScenePrefab::GetComponents;
+%ignore Urho3D::ScenePrefab::GetAttributes;
+%include "Urho3D/Scene/ScenePrefab.h"
 %include "Urho3D/Scene/SmoothedTransform.h"
 %include "Urho3D/Scene/UnknownComponent.h"
 
@@ -510,6 +540,12 @@ public:
 %ignore Urho3D::Renderer::SetLightVolumeBatchShaders;
 %ignore Urho3D::IndexBufferDesc;
 %ignore Urho3D::VertexBufferDesc;
+%ignore Urho3D::CompressedAnimationKeyFrames;
+%ignore Urho3D::AnimationTrack::compressedKeyFrames_;
+%ignore Urho3D::BonePose;
+%ignore Urho3D::Skeleton::ResetPose;
+%ignore Urho3D::Skeleton::ApplyPoseSilent;
+%ignore Urho3D::AnimationState::ApplyToPose;
 %ignore Urho3D::GPUObject::GetGraphics;
 %ignore Urho3D::Terrain::GetHeightData; // eastl::shared_array<float>
 %ignore Urho3D::Geometry::GetRawData;
@@ -531,9 +567,13 @@ public:
 %ignore Urho3D::CustomGeometry::MakeCircleGraph;
 %ignore Urho3D::CustomGeometry::ProcessRayQuery;
 %ignore Urho3D::OcclusionBufferData::dataWithSafety_;
+%ignore Urho3D::OcclusionBuffer::IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* results) const;
 %ignore Urho3D::ScenePassInfo::batchQueue_;
 %ignore Urho3D::LightQueryResult;
 %ignore Urho3D::View::GetLightQueues;
+%ignore Urho3D::TextureStreamingEntry;
+%ignore Urho3D::TextureStreaming::GetEntry;
+%ignore Urho3D::TextureStreaming::GetLevelMemory;
 %rename(DrawableFlags) Urho3D::DrawableFlag;
 
 %apply void* VOID_INT_PTR {
@@ -560,6 +600,7 @@ public:
 %include "Urho3D/Graphics/Texture2DArray.h"
 %include "Urho3D/Graphics/Texture3D.h"
 %include "Urho3D/Graphics/TextureCube.h"
+%include "Urho3D/Graphics/TextureStreaming.h"
 //%include "Urho3D/Graphics/Batch.h"
 %include "Urho3D/Graphics/Skeleton.h"
 %include "Urho3D/Graphics/Model.h"
@@ -645,18 +686,24 @@ public:
 // These methods use forward-declared types from SLikeNet.
 %ignore Urho3D::Connection::Connection;
 %ignore Urho3D::Connection::Initialize;
+%ignore Urho3D::Connection::InitializeTransport;
 %ignore Urho3D::Connection::GetAddressOrGUID;
 %ignore Urho3D::Connection::SetAddressOrGUID;
+%ignore Urho3D::NetworkTransport;
 %ignore Urho3D::Network::HandleMessage;
 %ignore Urho3D::Network::NewConnectionEstablished;
 %ignore Urho3D::Network::ClientDisconnected;
 %ignore Urho3D::Network::GetConnection;
 %ignore Urho3D::Network::OnServerConnect;
 %ignore Urho3D::Network::HandleIncomingPacket;
+%ignore Urho3D::NetworkInterestGrid::QueryResult;
+%ignore Urho3D::NetworkInterestGrid::Query;
+%ignore Urho3D::NetworkInterestGrid::GetAddedNodes;
 
 %include "Urho3D/Network/Connection.h"
 %include "Urho3D/Network/Network.h"
 %include "Urho3D/Network/NetworkPriority.h"
+%include "Urho3D/Network/NetworkInterestGrid.h"
 %include "Urho3D/Network/Protocol.h"
 #endif
 
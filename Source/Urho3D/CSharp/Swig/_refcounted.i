@@ -60,6 +60,7 @@ URHO3D_REFCOUNTED(Urho3D::Texture2D);
 URHO3D_REFCOUNTED(Urho3D::Texture2DArray);
 URHO3D_REFCOUNTED(Urho3D::Texture3D);
 URHO3D_REFCOUNTED(Urho3D::TextureCube);
+URHO3D_REFCOUNTED(Urho3D::TextureStreaming);
 URHO3D_REFCOUNTED(Urho3D::VertexBuffer);
 URHO3D_REFCOUNTED(Urho3D::View);
 URHO3D_REFCOUNTED(Urho3D::Viewport);
@@ -115,6 +116,7 @@ URHO3D_REFCOUNTED(Urho3D::Node);
 URHO3D_REFCOUNTED(Urho3D::ObjectAnimation);
 URHO3D_REFCOUNTED(Urho3D::Scene);
 URHO3D_REFCOUNTED(Urho3D::SceneManager);
+URHO3D_REFCOUNTED(Urho3D::ScenePrefab);
 URHO3D_REFCOUNTED(Urho3D::Serializable);
 URHO3D_REFCOUNTED(Urho3D::SmoothedTransform);
 URHO3D_REFCOUNTED(Urho3D::SplinePath);
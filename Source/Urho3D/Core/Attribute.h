@@ -70,6 +70,23 @@ public:
     virtual void Set(Serializable* ptr, const Variant& src) = 0;
 };
 
+/// Quantization of the floating point components of an attribute for network replication.
+struct AttributeQuantization
+{
+    /// Return whether quantization is enabled.
+    bool IsEnabled() const { return precision_ > 0.0f; }
+
+    /// Return whether components are limited to a range.
+    bool IsBounded() const { return max_ > min_; }
+
+    /// Quantization step. Zero disables quantization.
+    float precision_{};
+    /// Minimum component value.
+    float min_{};
+    /// Maximum component value. Components are unbounded unless greater than the minimum.
+    float max_{};
+};
+
 /// Description of an automatically serializable variable.
 struct AttributeInfo
 {
@@ -113,6 +130,7 @@ struct AttributeInfo
         defaultValue_ = other.defaultValue_;
         mode_ = other.mode_;
         metadata_ = other.metadata_;
+        quantization_ = other.quantization_;
         ptr_ = other.ptr_;
         enumNamesStorage_ = other.enumNamesStorage_;
 
@@ -167,6 +185,8 @@ struct AttributeInfo
     AttributeModeFlags mode_ = AM_DEFAULT;
     /// Attribute metadata.
     VariantMap metadata_;
+    /// Quantization for network replication. Applies to float, vector, quaternion and color attributes.
+    AttributeQuantization quantization_;
     /// Attribute data pointer if elsewhere than in the Serializable.
     void* ptr_ = nullptr;
     /// List of enum names. Used when names can not be stored externally.
@@ -214,6 +234,15 @@ public:
             networkAttributeInfo_->metadata_[key] = value;
         return *this;
     }
+    /// Set quantization of the components for network replication. Components are unbounded unless maximum is greater than minimum.
+    AttributeHandle& SetQuantization(float precision, float minValue = 0.0f, float maxValue = 0.0f)
+    {
+        if (attributeInfo_)
+            attributeInfo_->quantization_ = { precision, minValue, maxValue };
+        if (networkAttributeInfo_)
+            networkAttributeInfo_->quantization_ = { precision, minValue, maxValue };
+        return *this;
+    }
 };
 
 }
@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <EASTL/algorithm.h>
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Typed event channel owned by the sender. Unlike %Object::SendEvent, payload is passed as a plain struct and
+/// subscribers are stored in a contiguous array, so invocation costs one indirect call per subscriber.
+/// Subscribers are not tracked by weak pointers and must unsubscribe before destruction. Main thread only.
+template <typename T>
+class EventChannel
+{
+public:
+    /// Payload type.
+    using PayloadType = T;
+    /// Type-erased handler.
+    using HandlerFunction = void (*)(void* receiver, const T& payload);
+
+    /// Construct.
+    EventChannel() = default;
+    /// Prevent copy construction.
+    EventChannel(const EventChannel& other) = delete;
+    /// Prevent assignment.
+    EventChannel& operator=(const EventChannel& other) = delete;
+
+    /// Subscribe member function of receiver, e.g. Subscribe<&Receiver::HandleEvent>(this). Replaces previous handler of the receiver.
+    template <auto Handler, typename Receiver>
+    void Subscribe(Receiver* receiver)
+    {
+        Subscribe(receiver, [](void* receiver, const T& payload) { (static_cast<Receiver*>(receiver)->*Handler)(payload); });
+    }
+
+    /// Subscribe type-erased handler. Replaces previous handler of the receiver.
+    void Subscribe(void* receiver, HandlerFunction handler)
+    {
+        const auto iter = subscriberIndices_.find(receiver);
+        if (iter != subscriberIndices_.end())
+        {
+            subscribers_[iter->second].handler_ = handler;
+            return;
+        }
+
+        subscriberIndices_.emplace(receiver, subscribers_.size());
+        subscribers_.push_back(Subscriber{ receiver, handler });
+    }
+
+    /// Unsubscribe receiver. Safe to call during invocation.
+    void Unsubscribe(void* receiver)
+    {
+        const auto iter = subscriberIndices_.find(receiver);
+        if (iter == subscriberIndices_.end())
+            return;
+
+        // Leave a hole, it is cheaper to compact the array in one go
+        subscribers_[iter->second].receiver_ = nullptr;
+        subscriberIndices_.erase(iter);
+        ++numHoles_;
+
+        if (!invokeDepth_ && numHoles_ * 2 > subscribers_.size())
+            RemoveHoles();
+    }
+
+    /// Invoke all subscribers. Receivers subscribed during invocation are not invoked until the next time.
+    void Invoke(const T& payload)
+    {
+        ++invokeDepth_;
+
+        const unsigned numSubscribers = subscribers_.size();
+        for (unsigned i = 0; i < numSubscribers; ++i)
+        {
+            // Copy the subscriber, the array may grow during the call
+            const Subscriber subscriber = subscribers_[i];
+            if (subscriber.receiver_)
+                subscriber.handler_(subscriber.receiver_, payload);
+        }
+
+        --invokeDepth_;
+        if (!invokeDepth_ && numHoles_)
+            RemoveHoles();
+    }
+
+    /// Return whether the receiver is subscribed.
+    bool IsSubscribed(void* receiver) const { return subscriberIndices_.contains(receiver); }
+    /// Return number of subscribers.
+    unsigned GetNumSubscribers() const { return subscriberIndices_.size(); }
+    /// Return whether the channel has subscribers.
+    bool HasSubscribers() const { return !subscriberIndices_.empty(); }
+
+private:
+    /// Subscriber entry.
+    struct Subscriber
+    {
+        /// Receiver, null if unsubscribed.
+        void* receiver_;
+        /// Handler.
+        HandlerFunction handler_;
+    };
+
+    /// Remove unsubscribed entries, keeping subscription order.
+    void RemoveHoles()
+    {
+        const auto isHole = [](const Subscriber& subscriber) { return subscriber.receiver_ == nullptr; };
+        subscribers_.erase(ea::remove_if(subscribers_.begin(), subscribers_.end(), isHole), subscribers_.end());
+        numHoles_ = 0;
+
+        for (unsigned i = 0; i < subscribers_.size(); ++i)
+            subscriberIndices_[subscribers_[i].receiver_] = i;
+    }
+
+    /// Subscribers in subscription order.
+    ea::vector<Subscriber> subscribers_;
+    /// Index of each receiver in the subscriber array.
+    ea::unordered_map<void*, unsigned> subscriberIndices_;
+    /// Number of unsubscribed entries in the subscriber array.
+    unsigned numHoles_{};
+    /// Invocation depth.
+    unsigned invokeDepth_{};
+};
+
+}
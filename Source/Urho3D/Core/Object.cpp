@@ -394,6 +394,16 @@ void Object::SendEvent(StringHash eventType, VariantMap& eventData)
     context->EndSendEvent();
 }
 
+void Object::BeginChannelEvent()
+{
+    context_->BeginSendEvent(this, StringHash::ZERO);
+}
+
+void Object::EndChannelEvent()
+{
+    context_->EndSendEvent();
+}
+
 VariantMap& Object::GetEventDataMap() const
 {
     return context_->GetEventDataMap();
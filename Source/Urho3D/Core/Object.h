@@ -25,6 +25,7 @@
 #include <EASTL/intrusive_list.h>
 
 #include "../Container/Allocator.h"
+#include "../Core/EventChannel.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
 #include "../Core/StringHashRegister.h"
@@ -185,6 +186,16 @@ public:
     {
         SendEvent(eventType, GetEventDataMap().populate(args...));
     }
+    /// Invoke typed event channel owned by this object. Handlers see this object as the event sender and use nested event data maps, same as with SendEvent.
+    template <typename T> void SendEvent(EventChannel<T>& channel, const T& payload)
+    {
+        if (blockEvents_ || !channel.HasSubscribers())
+            return;
+
+        BeginChannelEvent();
+        channel.Invoke(payload);
+        EndChannelEvent();
+    }
 
     /// Return execution context.
     Context* GetContext() const { return context_; }
@@ -245,6 +256,10 @@ private:
     ea::intrusive_list<EventHandler>::iterator EraseEventHandler(ea::intrusive_list<EventHandler>::iterator handlerIter);
     /// Remove event handlers related to a specific sender.
     void RemoveEventSender(Object* sender);
+    /// Begin typed event channel invocation.
+    void BeginChannelEvent();
+    /// End typed event channel invocation.
+    void EndChannelEvent();
 
     /// Event handlers. Sender is null for non-specific handlers.
     ea::intrusive_list<EventHandler> eventHandlers_;
@@ -30,6 +30,10 @@
 #include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 
+#include <EASTL/shared_ptr.h>
+
+#include <thread>
+
 namespace Urho3D
 {
 
@@ -63,24 +67,39 @@ private:
     unsigned index_;
 };
 
+namespace
+{
+
+/// Index of the worker thread, or M_MAX_UNSIGNED if current thread is not a worker thread.
+thread_local unsigned currentThreadIndex = M_MAX_UNSIGNED;
+
+/// Number of spins a worker thread does before going to sleep.
+const unsigned numSpinsBeforeSleep = 64;
+
+}
+
 WorkQueue::WorkQueue(Context* context) :
     Object(context),
     shutDown_(false),
-    pausing_(false),
     paused_(false),
     completing_(false),
     tolerance_(10),
     lastSize_(0),
     maxNonThreadedWorkMs_(5)
 {
+    deques_.push_back(ea::make_unique<TaskDeque>());
     SubscribeToEvent(E_BEGINFRAME, URHO3D_HANDLER(WorkQueue, HandleBeginFrame));
 }
 
 WorkQueue::~WorkQueue()
 {
-    // Stop the worker threads. First make sure they are not waiting for work items
-    shutDown_ = true;
-    Resume();
+    // Stop the worker threads. First make sure they are not waiting for work items, also when they went to sleep while not paused
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        shutDown_ = true;
+        paused_ = false;
+        sleepCondition_.notify_all();
+    }
 
     for (unsigned i = 0; i < threads_.size(); ++i)
         threads_[i]->Stop();
@@ -94,6 +113,10 @@ void WorkQueue::CreateThreads(unsigned numThreads)
     if (!threads_.empty())
         return;
 
+    // Deques must exist before threads start stealing from each other
+    for (unsigned i = 0; i < numThreads; ++i)
+        deques_.push_back(ea::make_unique<TaskDeque>());
+
     // Start threads in paused mode
     Pause();
 
@@ -127,6 +150,18 @@ SharedPtr<WorkItem> WorkQueue::GetFreeItem()
 }
 
 void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
+{
+    static const ea::vector<SharedPtr<WorkItem> > noDependencies;
+    AddWorkItem(item, noDependencies);
+}
+
+SharedPtr<WorkItem> WorkQueue::AddWorkItem(std::function<void()> workFunction, unsigned priority)
+{
+    static const ea::vector<SharedPtr<WorkItem> > noDependencies;
+    return AddWorkItem(std::move(workFunction), noDependencies, priority);
+}
+
+void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item, const ea::vector<SharedPtr<WorkItem> >& dependencies)
 {
     if (!item)
     {
@@ -134,54 +169,258 @@ void WorkQueue::AddWorkItem(const SharedPtr<WorkItem>& item)
         return;
     }
 
+    // Clear completed flag in case item is reused
+    item->completed_ = false;
+    item->finished_ = false;
+    RegisterItem(item);
+
+    // Hold one extra dependency while subscribing so the item is not started before all dependencies are processed
+    item->pendingDependencies_.store(1);
+    for (const SharedPtr<WorkItem>& dependency : dependencies)
+    {
+        if (!dependency || dependency == item)
+            continue;
+
+        MutexLock<SpinLockMutex> lock(dependency->continuationsLock_);
+        if (!dependency->finished_)
+        {
+            item->pendingDependencies_.fetch_add(1);
+            dependency->continuations_.push_back(item);
+        }
+    }
+
+    if (item->pendingDependencies_.fetch_sub(1) == 1)
+        PushReadyItem(item);
+
+    // Adding work resumes worker threads
+    if (Thread::IsMainThread())
+        Resume();
+}
+
+SharedPtr<WorkItem> WorkQueue::AddWorkItem(std::function<void()> workFunction,
+    const ea::vector<SharedPtr<WorkItem> >& dependencies, unsigned priority)
+{
+    // Item pool is not thread-safe, allocate new items outside of the main thread
+    SharedPtr<WorkItem> item = Thread::IsMainThread() ? GetFreeItem() : MakeShared<WorkItem>();
+    item->workLambda_ = std::move(workFunction);
+    item->workFunction_ = [](const WorkItem* item, unsigned) { item->workLambda_(); };
+    item->priority_ = priority;
+    AddWorkItem(item, dependencies);
+    return item;
+}
+
+SharedPtr<WorkItem> WorkQueue::AddContinuation(const SharedPtr<WorkItem>& item, std::function<void()> workFunction)
+{
+    if (!item)
+        return AddWorkItem(std::move(workFunction));
+
+    return AddWorkItem(std::move(workFunction), { item }, item->priority_);
+}
+
+void WorkQueue::WaitForItem(const WorkItem* item)
+{
+    if (!item)
+        return;
+
+    unsigned threadIndex = GetThreadIndex();
+    if (threadIndex >= deques_.size())
+        threadIndex = 0;
+
+    while (!item->completed_.load(std::memory_order_acquire))
+    {
+        if (!ExecuteNextItem(threadIndex, item->priority_))
+        {
+            // Nothing to help with and nobody else to do the work: dependencies of the item are not going to complete
+            if (threads_.empty())
+            {
+                URHO3D_LOGERROR("Cannot wait for work item whose dependencies have lower priority when there are no worker threads");
+                return;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+void WorkQueue::ParallelFor(unsigned count, unsigned batchSize, const std::function<void(unsigned, unsigned, unsigned)>& function)
+{
+    if (count == 0)
+        return;
+
+    batchSize = Max(batchSize, 1u);
+    const unsigned numBatches = (count + batchSize - 1) / batchSize;
+    const unsigned threadIndex = GetThreadIndex();
+
+    // Run inline if there is nobody to share the work with
+    if (numBatches == 1 || threads_.empty())
+    {
+        function(0, count, threadIndex);
+        return;
+    }
+
+    // Shared state must outlive helper items that may start after the loop is finished
+    struct ParallelForState
+    {
+        std::function<void(unsigned, unsigned, unsigned)> function_;
+        unsigned count_{};
+        unsigned batchSize_{};
+        unsigned numBatches_{};
+        std::atomic<unsigned> nextBatch_{};
+        std::atomic<unsigned> numFinished_{};
+
+        void ProcessBatches(unsigned threadIndex)
+        {
+            for (;;)
+            {
+                const unsigned batch = nextBatch_.fetch_add(1);
+                if (batch >= numBatches_)
+                    return;
+
+                const unsigned begin = batch * batchSize_;
+                function_(begin, Min(begin + batchSize_, count_), threadIndex);
+                numFinished_.fetch_add(1, std::memory_order_release);
+            }
+        }
+    };
+
+    auto state = ea::make_shared<ParallelForState>();
+    state->function_ = function;
+    state->count_ = count;
+    state->batchSize_ = batchSize;
+    state->numBatches_ = numBatches;
+
+    // Helper items are not registered in the main thread list and do not affect Complete()
+    const unsigned numHelpers = Min<unsigned>(numBatches - 1, threads_.size());
+    for (unsigned i = 0; i < numHelpers; ++i)
+    {
+        auto item = MakeShared<WorkItem>();
+        item->workLambda_ = [state]() { state->ProcessBatches(WorkQueue::GetThreadIndex()); };
+        item->workFunction_ = [](const WorkItem* item, unsigned) { item->workLambda_(); };
+        item->priority_ = M_MAX_UNSIGNED;
+        item->pendingDependencies_.store(0);
+        PushReadyItem(item);
+    }
+    Resume();
+
+    state->ProcessBatches(threadIndex);
+
+    // Wait for batches still processed by other threads
+    while (state->numFinished_.load(std::memory_order_acquire) != numBatches)
+        std::this_thread::yield();
+}
+
+void WorkQueue::RegisterItem(const SharedPtr<WorkItem>& item)
+{
+    if (!Thread::IsMainThread())
+        return;
+
     // Check for duplicate items.
     assert(ea::find(workItems_.begin(), workItems_.end(), item) == workItems_.end());
 
     // Push to the main thread list to keep item alive
-    // Clear completed flag in case item is reused
     workItems_.push_back(item);
-    item->completed_ = false;
+}
 
-    // Make sure worker threads' list is safe to modify
-    if (threads_.size() && !paused_)
-        queueMutex_.Acquire();
+void WorkQueue::PushReadyItem(SharedPtr<WorkItem> item)
+{
+    unsigned threadIndex = GetThreadIndex();
+    if (threadIndex >= deques_.size())
+        threadIndex = 0;
+
+    TaskDeque& deque = *deques_[threadIndex];
+    deque.lock_.Acquire();
+    deque.items_.push_back(ea::move(item));
+    deque.lock_.Release();
+
+    // Both counters are sequentially consistent, so either the sleeping thread sees new item or this thread sees the sleeper
+    numQueued_.fetch_add(1);
+    if (numSleeping_.load() > 0)
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        sleepCondition_.notify_one();
+    }
+}
 
-    // Find position for new item
-    if (queue_.empty())
-        queue_.push_back(item.Get());
-    else
+SharedPtr<WorkItem> WorkQueue::TakeItem(unsigned threadIndex, unsigned minPriority)
+{
+    if (numQueued_.load(std::memory_order_relaxed) == 0)
+        return nullptr;
+
+    const unsigned numDeques = deques_.size();
+    for (unsigned i = 0; i < numDeques; ++i)
     {
-        bool inserted = false;
+        const unsigned dequeIndex = (threadIndex + i) % numDeques;
+        const bool ownDeque = i == 0;
+        TaskDeque& deque = *deques_[dequeIndex];
+
+        MutexLock<SpinLockMutex> lock(deque.lock_);
+        if (deque.items_.empty())
+            continue;
 
-        for (auto i = queue_.begin(); i != queue_.end(); ++i)
+        // Own items are taken in LIFO order to keep data hot in cache, stolen items are taken in FIFO order
+        if (minPriority == 0)
         {
-            if ((*i)->priority_ <= item->priority_)
+            SharedPtr<WorkItem> item;
+            if (ownDeque)
             {
-                queue_.insert(i, item.Get());
-                inserted = true;
-                break;
+                item = ea::move(deque.items_.back());
+                deque.items_.pop_back();
+            }
+            else
+            {
+                item = ea::move(deque.items_.front());
+                deque.items_.pop_front();
+            }
+            numQueued_.fetch_sub(1);
+            return item;
+        }
+
+        const unsigned numItems = deque.items_.size();
+        for (unsigned j = 0; j < numItems; ++j)
+        {
+            const unsigned itemIndex = ownDeque ? numItems - j - 1 : j;
+            if (deque.items_[itemIndex]->priority_ >= minPriority)
+            {
+                SharedPtr<WorkItem> item = ea::move(deque.items_[itemIndex]);
+                deque.items_.erase(deque.items_.begin() + itemIndex);
+                numQueued_.fetch_sub(1);
+                return item;
             }
         }
+    }
+
+    return nullptr;
+}
+
+void WorkQueue::ExecuteItem(WorkItem* item, unsigned threadIndex)
+{
+    item->workFunction_(item, threadIndex);
 
-        if (!inserted)
-            queue_.push_back(item.Get());
+    // Schedule continuations whose last dependency was this item
+    ea::vector<SharedPtr<WorkItem> > continuations;
+    {
+        MutexLock<SpinLockMutex> lock(item->continuationsLock_);
+        item->finished_ = true;
+        continuations.swap(item->continuations_);
     }
 
-    if (threads_.size())
+    for (SharedPtr<WorkItem>& continuation : continuations)
     {
-        queueMutex_.Release();
-        paused_ = false;
+        if (continuation->pendingDependencies_.fetch_sub(1) == 1)
+            PushReadyItem(ea::move(continuation));
     }
+
+    // The item may be returned to the pool by the main thread as soon as the flag is set
+    item->completed_.store(true, std::memory_order_release);
 }
 
-SharedPtr<WorkItem> WorkQueue::AddWorkItem(std::function<void()> workFunction, unsigned priority)
+bool WorkQueue::ExecuteNextItem(unsigned threadIndex, unsigned minPriority)
 {
-    SharedPtr<WorkItem> item = GetFreeItem();
-    item->workLambda_ = std::move(workFunction);
-    item->workFunction_ = [](const WorkItem* item, unsigned) { item->workLambda_(); };
-    item->priority_ = priority;
-    AddWorkItem(item);
-    return item;
+    SharedPtr<WorkItem> item = TakeItem(threadIndex, minPriority);
+    if (!item)
+        return false;
+
+    ExecuteItem(item.Get(), threadIndex);
+    return true;
 }
 
 bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
@@ -189,19 +428,23 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
     if (!item)
         return false;
 
-    MutexLock lock(queueMutex_);
-
     // Can only remove successfully if the item was not yet taken by threads for execution
-    auto i = ea::find(queue_.begin(), queue_.end(), item.Get());
-    if (i != queue_.end())
+    for (auto& deque : deques_)
     {
-        auto j = ea::find(workItems_.begin(), workItems_.end(), item);
-        if (j != workItems_.end())
+        MutexLock<SpinLockMutex> lock(deque->lock_);
+        auto i = ea::find(deque->items_.begin(), deque->items_.end(), item);
+        if (i != deque->items_.end())
         {
-            queue_.erase(i);
-            ReturnToPool(item);
-            workItems_.erase(j);
-            return true;
+            auto j = ea::find(workItems_.begin(), workItems_.end(), item);
+            if (j != workItems_.end())
+            {
+                deque->items_.erase(i);
+                numQueued_.fetch_sub(1);
+                ReturnToPool(item);
+                workItems_.erase(j);
+                return true;
+            }
+            return false;
         }
     }
 
@@ -210,23 +453,12 @@ bool WorkQueue::RemoveWorkItem(SharedPtr<WorkItem> item)
 
 unsigned WorkQueue::RemoveWorkItems(const ea::vector<SharedPtr<WorkItem> >& items)
 {
-    MutexLock lock(queueMutex_);
     unsigned removed = 0;
 
     for (auto i = items.begin(); i != items.end(); ++i)
     {
-        auto j = ea::find(queue_.begin(), queue_.end(), i->Get());
-        if (j != queue_.end())
-        {
-            auto k = ea::find(workItems_.begin(), workItems_.end(), *i);
-            if (k != workItems_.end())
-            {
-                queue_.erase(j);
-                ReturnToPool(*k);
-                workItems_.erase(k);
-                ++removed;
-            }
-        }
+        if (RemoveWorkItem(*i))
+            ++removed;
     }
 
     return removed;
@@ -234,72 +466,35 @@ unsigned WorkQueue::RemoveWorkItems(const ea::vector<SharedPtr<WorkItem> >& item
 
 void WorkQueue::Pause()
 {
-    if (!paused_)
-    {
-        pausing_ = true;
-
-        queueMutex_.Acquire();
-        paused_ = true;
-
-        pausing_ = false;
-    }
+    paused_ = true;
 }
 
 void WorkQueue::Resume()
 {
     if (paused_)
     {
-        queueMutex_.Release();
+        std::lock_guard<std::mutex> lock(sleepMutex_);
         paused_ = false;
+        sleepCondition_.notify_all();
     }
 }
 
-
 void WorkQueue::Complete(unsigned priority)
 {
     completing_ = true;
 
     if (threads_.size())
-    {
         Resume();
 
-        // Take work items also in the main thread until queue empty or no high-priority items anymore
-        while (!queue_.empty())
-        {
-            queueMutex_.Acquire();
-            if (!queue_.empty() && queue_.front()->priority_ >= priority)
-            {
-                WorkItem* item = queue_.front();
-                queue_.pop_front();
-                queueMutex_.Release();
-                item->workFunction_(item, 0);
-                item->completed_ = true;
-            }
-            else
-            {
-                queueMutex_.Release();
-                break;
-            }
-        }
-
-        // Wait for threaded work to complete
-        while (!IsCompleted(priority))
-        {
-        }
-
-        // If no work at all remaining, pause worker threads by leaving the mutex locked
-        if (queue_.empty())
-            Pause();
-    }
-    else
+    // Take work items also in the main thread until no high-priority items remain
+    while (!IsCompleted(priority))
     {
-        // No worker threads: ensure all high-priority items are completed in the main thread
-        while (!queue_.empty() && queue_.front()->priority_ >= priority)
+        if (!ExecuteNextItem(0, priority))
         {
-            WorkItem* item = queue_.front();
-            queue_.pop_front();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            // No worker threads: nothing else is going to complete the work
+            if (threads_.empty())
+                break;
+            std::this_thread::yield();
         }
     }
 
@@ -307,6 +502,13 @@ void WorkQueue::Complete(unsigned priority)
     completing_ = false;
 }
 
+unsigned WorkQueue::GetThreadIndex()
+{
+    if (currentThreadIndex != M_MAX_UNSIGNED)
+        return currentThreadIndex;
+    return Thread::IsMainThread() ? 0 : M_MAX_UNSIGNED;
+}
+
 unsigned WorkQueue::GetNumIncomplete(unsigned priority) const
 {
     unsigned incomplete = 0;
@@ -332,36 +534,32 @@ bool WorkQueue::IsCompleted(unsigned priority) const
 
 void WorkQueue::ProcessItems(unsigned threadIndex)
 {
-    bool wasActive = false;
+    currentThreadIndex = threadIndex;
+    unsigned numIdleSpins = 0;
 
     for (;;)
     {
         if (shutDown_)
             return;
 
-        if (pausing_ && !wasActive)
-            Time::Sleep(0);
-        else
+        if (!paused_ && ExecuteNextItem(threadIndex, 0))
         {
-            queueMutex_.Acquire();
-            if (!queue_.empty())
-            {
-                wasActive = true;
-
-                WorkItem* item = queue_.front();
-                queue_.pop_front();
-                queueMutex_.Release();
-                item->workFunction_(item, threadIndex);
-                item->completed_ = true;
-            }
-            else
-            {
-                wasActive = false;
+            numIdleSpins = 0;
+            continue;
+        }
 
-                queueMutex_.Release();
-                Time::Sleep(0);
-            }
+        if (++numIdleSpins < numSpinsBeforeSleep)
+        {
+            std::this_thread::yield();
+            continue;
         }
+
+        // Sleep until there is work to do
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        numSleeping_.fetch_add(1);
+        sleepCondition_.wait(lock, [this]() { return shutDown_ || (!paused_ && numQueued_.load() > 0); });
+        numSleeping_.fetch_sub(1);
+        numIdleSpins = 0;
     }
 }
 
@@ -416,6 +614,7 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
         item->end_ = nullptr;
         item->aux_ = nullptr;
         item->workFunction_ = nullptr;
+        item->workLambda_ = nullptr;
         item->priority_ = M_MAX_UNSIGNED;
         item->sendEvent_ = false;
         item->completed_ = false;
@@ -427,18 +626,16 @@ void WorkQueue::ReturnToPool(SharedPtr<WorkItem>& item)
 void WorkQueue::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
     // If no worker threads, complete low-priority work here
-    if (threads_.empty() && !queue_.empty())
+    if (threads_.empty() && numQueued_.load() > 0)
     {
         URHO3D_PROFILE("CompleteWorkNonthreaded");
 
         HiresTimer timer;
 
-        while (!queue_.empty() && timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
+        while (timer.GetUSec(false) < maxNonThreadedWorkMs_ * 1000LL)
         {
-            WorkItem* item = queue_.front();
-            queue_.pop_front();
-            item->workFunction_(item, 0);
-            item->completed_ = true;
+            if (!ExecuteNextItem(0, 0))
+                break;
         }
     }
 
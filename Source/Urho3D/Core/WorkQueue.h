@@ -22,13 +22,16 @@
 
 #pragma once
 
+#include <EASTL/deque.h>
 #include <EASTL/list.h>
-#include <atomic>
+#include <EASTL/unique_ptr.h>
 
 #include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
 
 namespace Urho3D
 {
@@ -67,6 +70,14 @@ private:
     bool pooled_{};
     /// Work function. Called without any parameters.
     std::function<void()> workLambda_;
+    /// Number of unfinished dependencies. Item is pushed to the scheduler when this reaches zero.
+    std::atomic<unsigned> pendingDependencies_{};
+    /// Lock for continuation list and finished flag.
+    SpinLockMutex continuationsLock_;
+    /// Items that are waiting for this item to finish.
+    ea::vector<SharedPtr<WorkItem> > continuations_;
+    /// Whether the work function has returned. Guarded by continuations lock.
+    bool finished_{};
 };
 
 /// Work queue subsystem for multithreading.
@@ -90,6 +101,17 @@ public:
     void AddWorkItem(const SharedPtr<WorkItem>& item);
     /// Add a work item and resume worker threads.
     SharedPtr<WorkItem> AddWorkItem(std::function<void()> workFunction, unsigned priority = 0);
+    /// Add a work item that is started only after all the dependencies are completed.
+    void AddWorkItem(const SharedPtr<WorkItem>& item, const ea::vector<SharedPtr<WorkItem> >& dependencies);
+    /// Add a work item that is started only after all the dependencies are completed.
+    SharedPtr<WorkItem> AddWorkItem(std::function<void()> workFunction, const ea::vector<SharedPtr<WorkItem> >& dependencies, unsigned priority = 0);
+    /// Add a work item that is started after the specified item is completed. Continuation inherits item priority.
+    SharedPtr<WorkItem> AddContinuation(const SharedPtr<WorkItem>& item, std::function<void()> workFunction);
+    /// Wait until the work item is completed. Calling thread executes other work with at least the same priority meanwhile.
+    void WaitForItem(const WorkItem* item);
+    /// Process range [0, count) in batches of at least batchSize elements in all threads including the calling one. Blocks until finished.
+    /// Function is called with range begin, range end and thread index.
+    void ParallelFor(unsigned count, unsigned batchSize, const std::function<void(unsigned, unsigned, unsigned)>& function);
     /// Remove a work item before it has started executing. Return true if successfully removed.
     bool RemoveWorkItem(SharedPtr<WorkItem> item);
     /// Remove a number of work items before they have started executing. Return the number of items successfully removed.
@@ -109,6 +131,8 @@ public:
 
     /// Return number of worker threads.
     unsigned GetNumThreads() const { return threads_.size(); }
+    /// Return index of the current thread: 0 for main thread, 1..N for worker threads, M_MAX_UNSIGNED for other threads.
+    static unsigned GetThreadIndex();
 
     /// Return number of incomplete tasks with at least the specified priority.
     unsigned GetNumIncomplete(unsigned priority) const;
@@ -124,8 +148,27 @@ public:
     int GetNonThreadedWorkMs() const { return maxNonThreadedWorkMs_; }
 
 private:
+    /// Per-thread double-ended queue of ready work items. Owner thread pops from the back, other threads steal from the front.
+    struct TaskDeque
+    {
+        /// Lock.
+        SpinLockMutex lock_;
+        /// Ready items.
+        ea::deque<SharedPtr<WorkItem> > items_;
+    };
+
     /// Process work items until shut down. Called by the worker threads.
     void ProcessItems(unsigned threadIndex);
+    /// Register work item in the main thread list if called from the main thread.
+    void RegisterItem(const SharedPtr<WorkItem>& item);
+    /// Push ready work item into the deque of the current thread and wake up a sleeping worker.
+    void PushReadyItem(SharedPtr<WorkItem> item);
+    /// Take work item with at least the specified priority from own deque, or steal one from other threads.
+    SharedPtr<WorkItem> TakeItem(unsigned threadIndex, unsigned minPriority);
+    /// Execute work item and schedule continuations which became ready.
+    void ExecuteItem(WorkItem* item, unsigned threadIndex);
+    /// Take and execute one work item with at least the specified priority. Return false if there was nothing to do.
+    bool ExecuteNextItem(unsigned threadIndex, unsigned minPriority);
     /// Purge completed work items which have at least the specified priority, and send completion events as necessary.
     void PurgeCompleted(unsigned priority);
     /// Purge the pool to reduce allocation where its unneeded.
@@ -141,16 +184,20 @@ private:
     ea::list<SharedPtr<WorkItem> > poolItems_;
     /// Work item collection. Accessed only by the main thread.
     ea::list<SharedPtr<WorkItem> > workItems_;
-    /// Work item prioritized queue for worker threads. Pointers are guaranteed to be valid (point to workItems).
-    ea::list<WorkItem*> queue_;
-    /// Worker queue mutex.
-    Mutex queueMutex_;
+    /// Ready item deques. Index 0 is used by the main thread and by threads not owned by the queue.
+    ea::vector<ea::unique_ptr<TaskDeque> > deques_;
+    /// Number of items in all deques.
+    std::atomic<unsigned> numQueued_{};
+    /// Number of worker threads waiting for work.
+    std::atomic<unsigned> numSleeping_{};
+    /// Mutex for sleeping worker threads.
+    std::mutex sleepMutex_;
+    /// Condition to wake up sleeping worker threads.
+    std::condition_variable sleepCondition_;
     /// Shutting down flag.
     std::atomic<bool> shutDown_;
-    /// Pausing flag. Indicates the worker threads should not contend for the queue mutex.
-    std::atomic<bool> pausing_;
-    /// Paused flag. Indicates the queue mutex being locked to prevent worker threads using up CPU time.
-    bool paused_;
+    /// Paused flag. Worker threads do not take new work items while paused.
+    std::atomic<bool> paused_;
     /// Completing work in the main thread flag.
     bool completing_;
     /// Tolerance for the shared pool before it begins to deallocate.
@@ -184,6 +184,10 @@ int Application::Run()
 
 void Application::ErrorExit(const ea::string& message)
 {
+    // Deliver queued log messages so that startup errors are collected
+    if (auto* log = GetSubsystem<Log>())
+        log->Flush();
+
     engine_->Exit(); // Close the rendering window
     exitCode_ = EXIT_FAILURE;
 
@@ -38,6 +38,7 @@
 #include "../Engine/EngineDefs.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../Input/Input.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -208,6 +209,7 @@ bool Engine::Initialize(const VariantMap& parameters)
         // Register graphics library objects explicitly in headless mode to allow them to work without using actual GPU resources
         RegisterGraphicsLibrary(context_);
     }
+    context_->RegisterSubsystem(new TextureStreaming(context_));
 
 #ifdef URHO3D_URHO2D
     // 2D graphics library is dependent on 3D graphics library
@@ -1024,6 +1026,10 @@ void Engine::DoExit()
     if (graphics)
         graphics->Close();
 
+    // In headless mode there is no window whose closing would end the main loop
+    if (headless_)
+        exiting_ = true;
+
 #if defined(__EMSCRIPTEN__) && defined(URHO3D_TESTING)
     emscripten_force_exit(EXIT_SUCCESS);    // Some how this is required to signal emrun to stop
 #endif
@@ -273,6 +273,12 @@ void AnimatedModel::Update(const FrameInfo& frame)
         UpdateBoneBoundingBox();
 }
 
+void AnimatedModel::FinishUpdate(const FrameInfo& frame)
+{
+    if (animationPosePending_)
+        ApplyAnimationPose();
+}
+
 void AnimatedModel::UpdateBatches(const FrameInfo& frame)
 {
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
@@ -956,7 +962,7 @@ void AnimatedModel::UpdateBoneBoundingBox()
     }
 
     boneBoundingBoxDirty_ = false;
-    worldBoundingBoxDirty_ = true;
+    MarkWorldBoundingBoxDirty();
 }
 
 void AnimatedModel::OnNodeSet(Node* node)
@@ -1209,25 +1215,36 @@ void AnimatedModel::ApplyAnimation()
         animationOrderDirty_ = false;
     }
 
-    // Reset skeleton, apply all animations, calculate bones' bounding box. Make sure this is only done for the master model
-    // (first AnimatedModel in a node)
+    // Reset pose and blend all animations into it. Make sure this is only done for the master model (first AnimatedModel
+    // in a node). Bone nodes are not touched, so models can be animated in parallel
     if (isMaster_)
     {
-        skeleton_.ResetSilent();
-        for (auto i = animationStates_.begin(); i !=
-            animationStates_.end(); ++i)
-            (*i)->Apply();
-
-        // Skeleton reset and animations apply the node transforms "silently" to avoid repeated marking dirty. Mark dirty now
-        node_->MarkDirty();
+        skeleton_.ResetPose(animationPose_);
+        for (auto i = animationStates_.begin(); i != animationStates_.end(); ++i)
+            (*i)->ApplyToPose(animationPose_);
 
-        // Calculate new bone bounding box
-        UpdateBoneBoundingBox();
+        // During threaded update the pose is applied later from the main thread, in deterministic order
+        Scene* scene = GetScene();
+        if (scene && scene->IsThreadedUpdate())
+            animationPosePending_ = true;
+        else
+            ApplyAnimationPose();
     }
 
     animationDirty_ = false;
 }
 
+void AnimatedModel::ApplyAnimationPose()
+{
+    // Pose is applied "silently" to avoid repeated marking dirty. Mark dirty now
+    skeleton_.ApplyPoseSilent(animationPose_);
+    node_->MarkDirty();
+
+    // Calculate new bone bounding box
+    UpdateBoneBoundingBox();
+    animationPosePending_ = false;
+}
+
 void AnimatedModel::UpdateSkinning()
 {
     // Note: the model's world transform will be baked in the skin matrices
@@ -63,6 +63,8 @@ public:
     void ProcessRayQuery(const RayOctreeQuery& query, ea::vector<RayQueryResult>& results) override;
     /// Update before octree reinsertion. Is called from a worker thread.
     void Update(const FrameInfo& frame) override;
+    /// Apply animation pose calculated in Update() to the bone nodes. Is called from the main thread.
+    void FinishUpdate(const FrameInfo& frame) override;
     /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
     void UpdateBatches(const FrameInfo& frame) override;
     /// Prepare geometry for rendering. Called from a worker thread if possible (no GPU update).
@@ -211,6 +213,8 @@ private:
     void CloneGeometries();
     /// Recalculate animations. Called from Update().
     void UpdateAnimation(const FrameInfo& frame);
+    /// Apply animation pose to the bone nodes and recalculate bone bounding box.
+    void ApplyAnimationPose();
     /// Recalculate skinning.
     void UpdateSkinning();
     /// Reapply all vertex morphs.
@@ -226,6 +230,8 @@ private:
     ea::vector<ModelMorph> morphs_;
     /// Animation states.
     ea::vector<SharedPtr<AnimationState> > animationStates_;
+    /// Bone transforms calculated from animation states.
+    ea::vector<BonePose> animationPose_;
     /// Skinning matrices.
     ea::vector<Matrix3x4> skinMatrices_;
     /// Mapping of subgeometry bone indices, used if more bones than skinning shader can manage.
@@ -270,6 +276,8 @@ private:
     bool assignBonesPending_;
     /// Force animation update after becoming visible flag.
     bool forceAnimationUpdate_;
+    /// Animation pose is calculated but not applied to the bone nodes yet.
+    bool animationPosePending_{};
 };
 
 }
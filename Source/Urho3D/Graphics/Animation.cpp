@@ -50,6 +50,170 @@ inline bool CompareKeyFrames(const AnimationKeyFrame& lhs, const AnimationKeyFra
     return lhs.time_ < rhs.time_;
 }
 
+namespace
+{
+
+/// Number of 16-bit values per compressed channel.
+static const unsigned COMPRESSED_CHANNEL_SIZE = 3;
+/// Largest magnitude of the three smallest quaternion components.
+static const float SMALLEST_THREE_RANGE = 0.70710678f;
+
+/// Quantize vector within range to 16 bits per component.
+void QuantizeVector3(const Vector3& value, const Vector3& min, const Vector3& range, unsigned short* dest)
+{
+    const Vector3 normalized = (value - min) / Vector3(Max(range.x_, M_EPSILON), Max(range.y_, M_EPSILON), Max(range.z_, M_EPSILON));
+    dest[0] = static_cast<unsigned short>(RoundToInt(Clamp(normalized.x_, 0.0f, 1.0f) * 65535.0f));
+    dest[1] = static_cast<unsigned short>(RoundToInt(Clamp(normalized.y_, 0.0f, 1.0f) * 65535.0f));
+    dest[2] = static_cast<unsigned short>(RoundToInt(Clamp(normalized.z_, 0.0f, 1.0f) * 65535.0f));
+}
+
+/// Dequantize vector within range.
+inline Vector3 DequantizeVector3(const unsigned short* source, const Vector3& min, const Vector3& range)
+{
+    const Vector3 step = range * (1.0f / 65535.0f);
+    return { min.x_ + source[0] * step.x_, min.y_ + source[1] * step.y_, min.z_ + source[2] * step.z_ };
+}
+
+/// Quantize rotation as the three smallest components, 15 bits each. Index of the omitted component is stored in the top bits.
+void QuantizeRotation(const Quaternion& rotation, unsigned short* dest)
+{
+    const float components[4] = { rotation.w_, rotation.x_, rotation.y_, rotation.z_ };
+    unsigned largest = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largest]))
+            largest = i;
+    }
+
+    // Quaternions q and -q are the same rotation, so the omitted component can always be positive
+    const float sign = components[largest] < 0.0f ? -1.0f : 1.0f;
+    unsigned j = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+
+        const float normalized = components[i] * sign / SMALLEST_THREE_RANGE * 0.5f + 0.5f;
+        dest[j++] = static_cast<unsigned short>(RoundToInt(Clamp(normalized, 0.0f, 1.0f) * 32767.0f));
+    }
+
+    dest[0] |= (largest & 1u) << 15u;
+    dest[1] |= (largest >> 1u) << 15u;
+}
+
+/// Dequantize rotation from the three smallest components.
+inline Quaternion DequantizeRotation(const unsigned short* source)
+{
+    const unsigned largest = (source[0] >> 15u) | ((source[1] >> 15u) << 1u);
+    float components[4];
+    float sumSquares = 0.0f;
+    unsigned j = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largest)
+            continue;
+
+        const float value = ((source[j++] & 0x7fffu) * (2.0f / 32767.0f) - 1.0f) * SMALLEST_THREE_RANGE;
+        components[i] = value;
+        sumSquares += value * value;
+    }
+    components[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+    return { components[0], components[1], components[2], components[3] };
+}
+
+/// Return whether keyframe matches the interpolation between two other keyframes within the error limits.
+bool IsKeyFrameInterpolated(const AnimationKeyFrame& first, const AnimationKeyFrame& second, const AnimationKeyFrame& keyFrame,
+    AnimationChannelFlags channelMask, const AnimationCompressionSettings& settings)
+{
+    const float timeInterval = second.time_ - first.time_;
+    const float t = timeInterval > 0.0f ? (keyFrame.time_ - first.time_) / timeInterval : 1.0f;
+
+    if (channelMask & CHANNEL_POSITION)
+    {
+        if ((first.position_.Lerp(second.position_, t) - keyFrame.position_).Length() > settings.positionError_)
+            return false;
+    }
+    if (channelMask & CHANNEL_ROTATION)
+    {
+        const Quaternion rotation = first.rotation_.Slerp(second.rotation_, t);
+        if (2.0f * Acos(Min(Abs(rotation.DotProduct(keyFrame.rotation_)), 1.0f)) > settings.rotationError_)
+            return false;
+    }
+    if (channelMask & CHANNEL_SCALE)
+    {
+        if ((first.scale_.Lerp(second.scale_, t) - keyFrame.scale_).Length() > settings.scaleError_)
+            return false;
+    }
+    return true;
+}
+
+/// Remove keyframes that are reproduced by interpolating their neighbours. Constant tracks are reduced to one keyframe.
+ea::vector<AnimationKeyFrame> RemoveRedundantKeyFrames(const ea::vector<AnimationKeyFrame>& keyFrames,
+    AnimationChannelFlags channelMask, const AnimationCompressionSettings& settings)
+{
+    bool isConstant = true;
+    for (unsigned i = 1; i < keyFrames.size() && isConstant; ++i)
+        isConstant = IsKeyFrameInterpolated(keyFrames[0], keyFrames[0], keyFrames[i], channelMask, settings);
+    if (isConstant)
+        return { keyFrames[0] };
+
+    ea::vector<AnimationKeyFrame> result;
+    result.push_back(keyFrames[0]);
+
+    // Skip a keyframe if all keyframes since the last kept one are reproduced by interpolating towards the next one
+    unsigned lastKept = 0;
+    for (unsigned i = 1; i + 1 < keyFrames.size(); ++i)
+    {
+        bool isRedundant = true;
+        for (unsigned j = lastKept + 1; j <= i && isRedundant; ++j)
+            isRedundant = IsKeyFrameInterpolated(keyFrames[lastKept], keyFrames[i + 1], keyFrames[j], channelMask, settings);
+
+        if (!isRedundant)
+        {
+            result.push_back(keyFrames[i]);
+            lastKept = i;
+        }
+    }
+
+    result.push_back(keyFrames.back());
+    return result;
+}
+
+/// Decode compressed keyframe.
+void DecodeKeyFrame(const CompressedAnimationKeyFrames& keyFrames, AnimationChannelFlags channelMask, unsigned index,
+    Vector3& position, Quaternion& rotation, Vector3& scale)
+{
+    const unsigned short* data = keyFrames.data_.data() + index * keyFrames.stride_;
+    if (channelMask & CHANNEL_POSITION)
+    {
+        position = DequantizeVector3(data, keyFrames.positionMin_, keyFrames.positionRange_);
+        data += COMPRESSED_CHANNEL_SIZE;
+    }
+    if (channelMask & CHANNEL_ROTATION)
+    {
+        rotation = DequantizeRotation(data);
+        data += COMPRESSED_CHANNEL_SIZE;
+    }
+    if (channelMask & CHANNEL_SCALE)
+        scale = DequantizeVector3(data, keyFrames.scaleMin_, keyFrames.scaleRange_);
+}
+
+/// Return compressed keyframe time.
+inline float GetCompressedKeyFrameTime(const CompressedAnimationKeyFrames& keyFrames, unsigned index)
+{
+    return keyFrames.times_.empty() ? index / keyFrames.sampleRate_ : keyFrames.times_[index];
+}
+
+/// Return memory use of a track.
+unsigned GetTrackMemoryUse(const AnimationTrack& track)
+{
+    const CompressedAnimationKeyFrames& compressed = track.compressedKeyFrames_;
+    return sizeof(AnimationTrack) + track.keyFrames_.size() * sizeof(AnimationKeyFrame) +
+        compressed.times_.size() * sizeof(float) + compressed.data_.size() * sizeof(unsigned short);
+}
+
+}
+
 void AnimationTrack::SetKeyFrame(unsigned index, const AnimationKeyFrame& keyFrame)
 {
     if (index < keyFrames_.size())
@@ -112,6 +276,193 @@ bool AnimationTrack::GetKeyFrameIndex(float time, unsigned& index) const
     return true;
 }
 
+void AnimationTrack::Compress(const AnimationCompressionSettings& settings, float length)
+{
+    if (keyFrames_.empty())
+        return;
+
+    CompressedAnimationKeyFrames& compressed = compressedKeyFrames_;
+    compressed = CompressedAnimationKeyFrames{};
+
+    // Uniform resampling makes keyframe lookup a multiplication, otherwise keep the source times and drop redundant keyframes
+    ea::vector<AnimationKeyFrame> keyFrames = RemoveRedundantKeyFrames(keyFrames_, channelMask_, settings);
+    if (settings.sampleRate_ > 0.0f && length > 0.0f && keyFrames.size() > 1)
+    {
+        const unsigned numIntervals = static_cast<unsigned>(Max(RoundToInt(length * settings.sampleRate_), 1));
+        compressed.sampleRate_ = numIntervals / length;
+
+        keyFrames.resize(numIntervals + 1);
+        unsigned index = 0;
+        for (unsigned i = 0; i <= numIntervals; ++i)
+        {
+            AnimationKeyFrame& keyFrame = keyFrames[i];
+            keyFrame.time_ = i / compressed.sampleRate_;
+            Sample(keyFrame.time_, length, false, index, keyFrame.position_, keyFrame.rotation_, keyFrame.scale_);
+        }
+    }
+    else if (keyFrames.size() > 1)
+    {
+        compressed.times_.resize(keyFrames.size());
+        for (unsigned i = 0; i < keyFrames.size(); ++i)
+            compressed.times_[i] = keyFrames[i].time_;
+    }
+
+    // Calculate quantization ranges
+    Vector3 positionMax = keyFrames[0].position_;
+    Vector3 scaleMax = keyFrames[0].scale_;
+    compressed.positionMin_ = keyFrames[0].position_;
+    compressed.scaleMin_ = keyFrames[0].scale_;
+    for (const AnimationKeyFrame& keyFrame : keyFrames)
+    {
+        compressed.positionMin_ = VectorMin(compressed.positionMin_, keyFrame.position_);
+        compressed.scaleMin_ = VectorMin(compressed.scaleMin_, keyFrame.scale_);
+        positionMax = VectorMax(positionMax, keyFrame.position_);
+        scaleMax = VectorMax(scaleMax, keyFrame.scale_);
+    }
+    compressed.positionRange_ = positionMax - compressed.positionMin_;
+    compressed.scaleRange_ = scaleMax - compressed.scaleMin_;
+
+    // Quantize keyframes
+    compressed.numKeyFrames_ = keyFrames.size();
+    compressed.stride_ = COMPRESSED_CHANNEL_SIZE * CountSetBits(channelMask_.AsInteger());
+    compressed.data_.resize(compressed.numKeyFrames_ * compressed.stride_);
+    unsigned short* data = compressed.data_.data();
+    for (const AnimationKeyFrame& keyFrame : keyFrames)
+    {
+        if (channelMask_ & CHANNEL_POSITION)
+        {
+            QuantizeVector3(keyFrame.position_, compressed.positionMin_, compressed.positionRange_, data);
+            data += COMPRESSED_CHANNEL_SIZE;
+        }
+        if (channelMask_ & CHANNEL_ROTATION)
+        {
+            QuantizeRotation(keyFrame.rotation_, data);
+            data += COMPRESSED_CHANNEL_SIZE;
+        }
+        if (channelMask_ & CHANNEL_SCALE)
+        {
+            QuantizeVector3(keyFrame.scale_, compressed.scaleMin_, compressed.scaleRange_, data);
+            data += COMPRESSED_CHANNEL_SIZE;
+        }
+    }
+
+    keyFrames_.clear();
+    keyFrames_.shrink_to_fit();
+}
+
+void AnimationTrack::Decompress()
+{
+    if (!IsCompressed())
+        return;
+
+    const CompressedAnimationKeyFrames& compressed = compressedKeyFrames_;
+    keyFrames_.resize(compressed.numKeyFrames_);
+    for (unsigned i = 0; i < compressed.numKeyFrames_; ++i)
+    {
+        AnimationKeyFrame& keyFrame = keyFrames_[i];
+        keyFrame.time_ = compressed.numKeyFrames_ > 1 ? GetCompressedKeyFrameTime(compressed, i) : 0.0f;
+        DecodeKeyFrame(compressed, channelMask_, i, keyFrame.position_, keyFrame.rotation_, keyFrame.scale_);
+    }
+
+    compressedKeyFrames_ = CompressedAnimationKeyFrames{};
+}
+
+bool AnimationTrack::Sample(float time, float length, bool looped, unsigned& index,
+    Vector3& position, Quaternion& rotation, Vector3& scale) const
+{
+    if (IsCompressed())
+    {
+        const CompressedAnimationKeyFrames& compressed = compressedKeyFrames_;
+        const unsigned numKeyFrames = compressed.numKeyFrames_;
+        if (numKeyFrames == 1)
+        {
+            index = 0;
+            DecodeKeyFrame(compressed, channelMask_, 0, position, rotation, scale);
+            return true;
+        }
+
+        // Uniformly sampled keyframes need no search
+        if (compressed.times_.empty())
+            index = Min(static_cast<unsigned>(Max(time, 0.0f) * compressed.sampleRate_), numKeyFrames - 1);
+        else
+        {
+            const float searchTime = Max(time, 0.0f);
+            if (index >= numKeyFrames)
+                index = numKeyFrames - 1;
+            while (index && searchTime < compressed.times_[index])
+                --index;
+            while (index < numKeyFrames - 1 && searchTime >= compressed.times_[index + 1])
+                ++index;
+        }
+
+        unsigned nextIndex = index + 1;
+        if (nextIndex >= numKeyFrames)
+        {
+            if (!looped)
+            {
+                DecodeKeyFrame(compressed, channelMask_, index, position, rotation, scale);
+                return true;
+            }
+            nextIndex = 0;
+        }
+
+        Vector3 nextPosition;
+        Quaternion nextRotation;
+        Vector3 nextScale;
+        DecodeKeyFrame(compressed, channelMask_, index, position, rotation, scale);
+        DecodeKeyFrame(compressed, channelMask_, nextIndex, nextPosition, nextRotation, nextScale);
+
+        const float keyTime = GetCompressedKeyFrameTime(compressed, index);
+        float timeInterval = GetCompressedKeyFrameTime(compressed, nextIndex) - keyTime;
+        if (timeInterval < 0.0f)
+            timeInterval += length;
+        const float t = timeInterval > 0.0f ? (time - keyTime) / timeInterval : 1.0f;
+
+        if (channelMask_ & CHANNEL_POSITION)
+            position = position.Lerp(nextPosition, t);
+        if (channelMask_ & CHANNEL_ROTATION)
+            rotation = rotation.Slerp(nextRotation, t);
+        if (channelMask_ & CHANNEL_SCALE)
+            scale = scale.Lerp(nextScale, t);
+        return true;
+    }
+
+    if (!GetKeyFrameIndex(time, index))
+        return false;
+
+    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
+    const AnimationKeyFrame* keyFrame = &keyFrames_[index];
+    unsigned nextIndex = index + 1;
+    if (nextIndex >= keyFrames_.size())
+    {
+        if (!looped)
+        {
+            if (channelMask_ & CHANNEL_POSITION)
+                position = keyFrame->position_;
+            if (channelMask_ & CHANNEL_ROTATION)
+                rotation = keyFrame->rotation_;
+            if (channelMask_ & CHANNEL_SCALE)
+                scale = keyFrame->scale_;
+            return true;
+        }
+        nextIndex = 0;
+    }
+
+    const AnimationKeyFrame* nextKeyFrame = &keyFrames_[nextIndex];
+    float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
+    if (timeInterval < 0.0f)
+        timeInterval += length;
+    const float t = timeInterval > 0.0f ? (time - keyFrame->time_) / timeInterval : 1.0f;
+
+    if (channelMask_ & CHANNEL_POSITION)
+        position = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
+    if (channelMask_ & CHANNEL_ROTATION)
+        rotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
+    if (channelMask_ & CHANNEL_SCALE)
+        scale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
+    return true;
+}
+
 Animation::Animation(Context* context) :
     ResourceWithMetadata(context),
     length_(0.f)
@@ -130,11 +481,13 @@ bool Animation::BeginLoad(Deserializer& source)
     unsigned memoryUse = sizeof(Animation);
 
     // Check ID
-    if (source.ReadFileID() != "UANI")
+    const ea::string fileID = source.ReadFileID();
+    if (fileID != "UANI" && fileID != "UANC")
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid animation file");
         return false;
     }
+    const bool hasCompressedTracks = fileID == "UANC";
 
     // Read name and length
     animationName_ = source.ReadString();
@@ -151,6 +504,41 @@ bool Animation::BeginLoad(Deserializer& source)
         AnimationTrack* newTrack = CreateTrack(source.ReadString());
         newTrack->channelMask_ = AnimationChannelFlags(source.ReadUByte());
 
+        if (hasCompressedTracks && source.ReadBool())
+        {
+            CompressedAnimationKeyFrames& compressed = newTrack->compressedKeyFrames_;
+            compressed.numKeyFrames_ = source.ReadUInt();
+            compressed.stride_ = COMPRESSED_CHANNEL_SIZE * CountSetBits(newTrack->channelMask_.AsInteger());
+            if (source.ReadBool())
+            {
+                compressed.sampleRate_ = source.ReadFloat();
+                if (!(compressed.sampleRate_ > 0.0f))
+                {
+                    URHO3D_LOGERROR(source.GetName() + " has a compressed track with invalid sample rate");
+                    return false;
+                }
+            }
+            else
+            {
+                compressed.times_.resize(compressed.numKeyFrames_);
+                source.Read(compressed.times_.data(), compressed.numKeyFrames_ * sizeof(float));
+            }
+            if (newTrack->channelMask_ & CHANNEL_POSITION)
+            {
+                compressed.positionMin_ = source.ReadVector3();
+                compressed.positionRange_ = source.ReadVector3();
+            }
+            if (newTrack->channelMask_ & CHANNEL_SCALE)
+            {
+                compressed.scaleMin_ = source.ReadVector3();
+                compressed.scaleRange_ = source.ReadVector3();
+            }
+            compressed.data_.resize(compressed.numKeyFrames_ * compressed.stride_);
+            source.Read(compressed.data_.data(), compressed.data_.size() * sizeof(unsigned short));
+            memoryUse += compressed.times_.size() * sizeof(float) + compressed.data_.size() * sizeof(unsigned short);
+            continue;
+        }
+
         unsigned keyFrames = source.ReadUInt();
         newTrack->keyFrames_.resize(keyFrames);
         memoryUse += keyFrames * sizeof(AnimationKeyFrame);
@@ -229,8 +617,12 @@ bool Animation::BeginLoad(Deserializer& source)
 
 bool Animation::Save(Serializer& dest) const
 {
-    // Write ID, name and length
-    dest.WriteFileID("UANI");
+    // Write ID, name and length. Compressed tracks need the extended format
+    bool hasCompressedTracks = false;
+    for (auto i = tracks_.begin(); i != tracks_.end(); ++i)
+        hasCompressedTracks |= i->second.IsCompressed();
+
+    dest.WriteFileID(hasCompressedTracks ? "UANC" : "UANI");
     dest.WriteString(animationName_);
     dest.WriteFloat(length_);
 
@@ -241,6 +633,34 @@ bool Animation::Save(Serializer& dest) const
         const AnimationTrack& track = i->second;
         dest.WriteString(track.name_);
         dest.WriteUByte(track.channelMask_);
+
+        if (hasCompressedTracks)
+        {
+            dest.WriteBool(track.IsCompressed());
+            if (track.IsCompressed())
+            {
+                const CompressedAnimationKeyFrames& compressed = track.compressedKeyFrames_;
+                dest.WriteUInt(compressed.numKeyFrames_);
+                dest.WriteBool(compressed.times_.empty());
+                if (compressed.times_.empty())
+                    dest.WriteFloat(compressed.sampleRate_);
+                else
+                    dest.Write(compressed.times_.data(), compressed.times_.size() * sizeof(float));
+                if (track.channelMask_ & CHANNEL_POSITION)
+                {
+                    dest.WriteVector3(compressed.positionMin_);
+                    dest.WriteVector3(compressed.positionRange_);
+                }
+                if (track.channelMask_ & CHANNEL_SCALE)
+                {
+                    dest.WriteVector3(compressed.scaleMin_);
+                    dest.WriteVector3(compressed.scaleRange_);
+                }
+                dest.Write(compressed.data_.data(), compressed.data_.size() * sizeof(unsigned short));
+                continue;
+            }
+        }
+
         dest.WriteUInt(track.keyFrames_.size());
 
         // Write keyframes of the track
@@ -287,6 +707,28 @@ bool Animation::Save(Serializer& dest) const
     return true;
 }
 
+void Animation::Compress(const AnimationCompressionSettings& settings)
+{
+    for (auto i = tracks_.begin(); i != tracks_.end(); ++i)
+        i->second.Compress(settings, length_);
+    UpdateMemoryUse();
+}
+
+void Animation::Decompress()
+{
+    for (auto i = tracks_.begin(); i != tracks_.end(); ++i)
+        i->second.Decompress();
+    UpdateMemoryUse();
+}
+
+void Animation::UpdateMemoryUse()
+{
+    unsigned memoryUse = sizeof(Animation) + triggers_.size() * sizeof(AnimationTriggerPoint);
+    for (auto i = tracks_.begin(); i != tracks_.end(); ++i)
+        memoryUse += GetTrackMemoryUse(i->second);
+    SetMemoryUse(memoryUse);
+}
+
 void Animation::SetAnimationName(const ea::string& name)
 {
     animationName_ = name;
@@ -74,6 +74,44 @@ struct AnimationKeyFrame
     Vector3 scale_;
 };
 
+/// Settings of animation track compression.
+struct AnimationCompressionSettings
+{
+    /// Maximum position error of removed keyframes.
+    float positionError_{0.0005f};
+    /// Maximum rotation error of removed keyframes, in degrees.
+    float rotationError_{0.05f};
+    /// Maximum scale error of removed keyframes.
+    float scaleError_{0.0005f};
+    /// Keyframes per second when resampling uniformly. Zero keeps the source keyframe times and removes redundant keyframes instead.
+    float sampleRate_{};
+};
+
+/// Quantized keyframes of a compressed animation track. Positions and scales are quantized to 16 bits within the track range,
+/// rotations are stored as the three smallest components.
+/// @nobind
+struct CompressedAnimationKeyFrames
+{
+    /// Number of keyframes.
+    unsigned numKeyFrames_{};
+    /// Number of 16-bit values per keyframe.
+    unsigned stride_{};
+    /// Keyframe times. Empty if keyframes are uniformly sampled.
+    ea::vector<float> times_;
+    /// Keyframes per second if uniformly sampled.
+    float sampleRate_{};
+    /// Minimum position.
+    Vector3 positionMin_;
+    /// Position range.
+    Vector3 positionRange_;
+    /// Minimum scale.
+    Vector3 scaleMin_;
+    /// Scale range.
+    Vector3 scaleRange_;
+    /// Quantized position, rotation and scale of each keyframe, as present in the channel mask.
+    ea::vector<unsigned short> data_;
+};
+
 /// Skeletal animation track, stores keyframes of a single bone.
 /// @fakeref
 struct URHO3D_API AnimationTrack
@@ -103,6 +141,18 @@ struct URHO3D_API AnimationTrack
     /// Return keyframe index based on time and previous index. Return false if animation is empty.
     bool GetKeyFrameIndex(float time, unsigned& index) const;
 
+    /// Compress keyframes. Animation length is needed for uniform resampling. Uncompressed keyframes are removed.
+    void Compress(const AnimationCompressionSettings& settings, float length);
+    /// Decompress keyframes for editing.
+    void Decompress();
+    /// Return whether the keyframes are compressed.
+    bool IsCompressed() const { return compressedKeyFrames_.numKeyFrames_ != 0; }
+    /// Return whether the track has no keyframes.
+    bool IsEmpty() const { return keyFrames_.empty() && !IsCompressed(); }
+    /// Sample the track at time and interpolate between keyframes. Keyframe index is used as search start and updated.
+    /// Only channels in the channel mask are written. Return false if the track is empty.
+    bool Sample(float time, float length, bool looped, unsigned& index, Vector3& position, Quaternion& rotation, Vector3& scale) const;
+
     /// Bone or scene node name.
     ea::string name_;
     /// Name hash.
@@ -111,6 +161,8 @@ struct URHO3D_API AnimationTrack
     AnimationChannelFlags channelMask_{};
     /// Keyframes.
     ea::vector<AnimationKeyFrame> keyFrames_;
+    /// Compressed keyframes. Used instead of the keyframes if not empty.
+    CompressedAnimationKeyFrames compressedKeyFrames_;
 
     /// Instance equality operator.
     bool operator ==(const AnimationTrack& rhs) const
@@ -198,6 +250,10 @@ public:
     void SetNumTriggers(unsigned num);
     /// Clone the animation.
     SharedPtr<Animation> Clone(const ea::string& cloneName = EMPTY_STRING) const;
+    /// Compress all tracks. This is unsafe if the animation is currently used in playback.
+    void Compress(const AnimationCompressionSettings& settings);
+    /// Decompress all tracks. This is unsafe if the animation is currently used in playback.
+    void Decompress();
 
     /// Return animation name.
     /// @property
@@ -239,6 +295,9 @@ public:
     /// Set all animation tracks.
     void SetTracks(const ea::vector<AnimationTrack>& tracks);
 private:
+    /// Recalculate memory use after tracks have been compressed or decompressed.
+    void UpdateMemoryUse();
+
     /// Animation name.
     ea::string animationName_;
     /// Animation name hash.
@@ -36,6 +36,7 @@ namespace Urho3D
 AnimationStateTrack::AnimationStateTrack() :
     track_(nullptr),
     bone_(nullptr),
+    boneIndex_(M_MAX_UNSIGNED),
     weight_(1.0f),
     keyFrame_(0)
 {
@@ -150,6 +151,7 @@ void AnimationState::SetStartBone(Bone* startBone)
         if (trackBone && trackBone->node_)
         {
             stateTrack.bone_ = trackBone;
+            stateTrack.boneIndex_ = skeleton.GetBoneIndex(trackBone);
             stateTrack.node_ = trackBone->node_;
             stateTracks_.push_back(stateTrack);
         }
@@ -468,6 +470,29 @@ void AnimationState::ApplyToModel()
     }
 }
 
+void AnimationState::ApplyToPose(ea::vector<BonePose>& pose)
+{
+    if (!animation_ || !IsEnabled())
+        return;
+
+    for (auto i = stateTracks_.begin(); i != stateTracks_.end(); ++i)
+    {
+        AnimationStateTrack& stateTrack = *i;
+        float finalWeight = weight_ * stateTrack.weight_;
+
+        // Do not apply if zero effective weight or the bone has animation disabled
+        if (Equals(finalWeight, 0.0f) || !stateTrack.bone_->animated_ || stateTrack.boneIndex_ >= pose.size())
+            continue;
+
+        if (stateTrack.track_->IsEmpty() || !stateTrack.node_)
+            continue;
+
+        BonePose& bonePose = pose[stateTrack.boneIndex_];
+        BlendTrack(stateTrack, finalWeight, bonePose.position_, bonePose.rotation_, bonePose.scale_,
+            bonePose.position_, bonePose.rotation_, bonePose.scale_);
+    }
+}
+
 void AnimationState::ApplyToNodes()
 {
     // When applying to a node hierarchy, can only use full weight (nothing to blend to)
@@ -480,76 +505,65 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
     const AnimationTrack* track = stateTrack.track_;
     Node* node = stateTrack.node_;
 
-    if (track->keyFrames_.empty() || !node)
+    if (track->IsEmpty() || !node)
         return;
 
-    unsigned& frame = stateTrack.keyFrame_;
-    track->GetKeyFrameIndex(time_, frame);
-
-    // Check if next frame to interpolate to is valid, or if wrapping is needed (looping animation only)
-    unsigned nextFrame = frame + 1;
-    bool interpolate = true;
-    if (nextFrame >= track->keyFrames_.size())
-    {
-        if (!looped_)
-        {
-            nextFrame = frame;
-            interpolate = false;
-        }
-        else
-            nextFrame = 0;
-    }
-
-    const AnimationKeyFrame* keyFrame = &track->keyFrames_[frame];
     const AnimationChannelFlags channelMask = track->channelMask_;
 
     Vector3 newPosition;
     Quaternion newRotation;
     Vector3 newScale;
+    BlendTrack(stateTrack, weight, node->GetPosition(), node->GetRotation(), node->GetScale(), newPosition, newRotation, newScale);
 
-    if (interpolate)
+    if (silent)
     {
-        const AnimationKeyFrame* nextKeyFrame = &track->keyFrames_[nextFrame];
-        float timeInterval = nextKeyFrame->time_ - keyFrame->time_;
-        if (timeInterval < 0.0f)
-            timeInterval += animation_->GetLength();
-        float t = timeInterval > 0.0f ? (time_ - keyFrame->time_) / timeInterval : 1.0f;
-
         if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_.Lerp(nextKeyFrame->position_, t);
+            node->SetPositionSilent(newPosition);
         if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_.Slerp(nextKeyFrame->rotation_, t);
+            node->SetRotationSilent(newRotation);
         if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_.Lerp(nextKeyFrame->scale_, t);
+            node->SetScaleSilent(newScale);
     }
     else
     {
         if (channelMask & CHANNEL_POSITION)
-            newPosition = keyFrame->position_;
+            node->SetPosition(newPosition);
         if (channelMask & CHANNEL_ROTATION)
-            newRotation = keyFrame->rotation_;
+            node->SetRotation(newRotation);
         if (channelMask & CHANNEL_SCALE)
-            newScale = keyFrame->scale_;
+            node->SetScale(newScale);
     }
+}
+
+void AnimationState::BlendTrack(AnimationStateTrack& stateTrack, float weight, const Vector3& position,
+    const Quaternion& rotation, const Vector3& scale, Vector3& newPosition, Quaternion& newRotation, Vector3& newScale)
+{
+    const AnimationTrack* track = stateTrack.track_;
+    const AnimationChannelFlags channelMask = track->channelMask_;
+
+    // Output may alias the current transform, so sample into temporaries first
+    Vector3 sampledPosition;
+    Quaternion sampledRotation;
+    Vector3 sampledScale;
+    track->Sample(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, sampledPosition, sampledRotation, sampledScale);
 
     if (blendingMode_ == ABM_ADDITIVE) // not ABM_LERP
     {
         if (channelMask & CHANNEL_POSITION)
         {
-            Vector3 delta = newPosition - stateTrack.bone_->initialPosition_;
-            newPosition = node->GetPosition() + delta * weight;
+            Vector3 delta = sampledPosition - stateTrack.bone_->initialPosition_;
+            newPosition = position + delta * weight;
         }
         if (channelMask & CHANNEL_ROTATION)
         {
-            Quaternion delta = newRotation * stateTrack.bone_->initialRotation_.Inverse();
-            newRotation = (delta * node->GetRotation()).Normalized();
-            if (!Equals(weight, 1.0f))
-                newRotation = node->GetRotation().Slerp(newRotation, weight);
+            Quaternion delta = sampledRotation * stateTrack.bone_->initialRotation_.Inverse();
+            Quaternion blendedRotation = (delta * rotation).Normalized();
+            newRotation = Equals(weight, 1.0f) ? blendedRotation : rotation.Slerp(blendedRotation, weight);
         }
         if (channelMask & CHANNEL_SCALE)
         {
-            Vector3 delta = newScale - stateTrack.bone_->initialScale_;
-            newScale = node->GetScale() + delta * weight;
+            Vector3 delta = sampledScale - stateTrack.bone_->initialScale_;
+            newScale = scale + delta * weight;
         }
     }
     else
@@ -557,31 +571,21 @@ void AnimationState::ApplyTrack(AnimationStateTrack& stateTrack, float weight, b
         if (!Equals(weight, 1.0f)) // not full weight
         {
             if (channelMask & CHANNEL_POSITION)
-                newPosition = node->GetPosition().Lerp(newPosition, weight);
+                newPosition = position.Lerp(sampledPosition, weight);
             if (channelMask & CHANNEL_ROTATION)
-                newRotation = node->GetRotation().Slerp(newRotation, weight);
+                newRotation = rotation.Slerp(sampledRotation, weight);
             if (channelMask & CHANNEL_SCALE)
-                newScale = node->GetScale().Lerp(newScale, weight);
+                newScale = scale.Lerp(sampledScale, weight);
+        }
+        else
+        {
+            if (channelMask & CHANNEL_POSITION)
+                newPosition = sampledPosition;
+            if (channelMask & CHANNEL_ROTATION)
+                newRotation = sampledRotation;
+            if (channelMask & CHANNEL_SCALE)
+                newScale = sampledScale;
         }
-    }
-
-    if (silent)
-    {
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPositionSilent(newPosition);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotationSilent(newRotation);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScaleSilent(newScale);
-    }
-    else
-    {
-        if (channelMask & CHANNEL_POSITION)
-            node->SetPosition(newPosition);
-        if (channelMask & CHANNEL_ROTATION)
-            node->SetRotation(newRotation);
-        if (channelMask & CHANNEL_SCALE)
-            node->SetScale(newScale);
     }
 }
 
@@ -40,6 +40,7 @@ class Serializer;
 class Skeleton;
 struct AnimationTrack;
 struct Bone;
+struct BonePose;
 
 /// %Animation blending mode.
 enum AnimationBlendMode
@@ -74,6 +75,8 @@ struct URHO3D_API AnimationStateTrack
     const AnimationTrack* track_;
     /// Bone pointer.
     Bone* bone_;
+    /// Bone index in the skeleton.
+    unsigned boneIndex_;
     /// Scene node pointer.
     WeakPtr<Node> node_;
     /// Blending weight.
@@ -179,6 +182,10 @@ public:
 
     /// Apply the animation at the current time position.
     void Apply();
+    /// Blend the animation at the current time position into the bone pose of the model. Does not access the scene nodes
+    /// and is safe to call from worker threads for different models.
+    /// @nobind
+    void ApplyToPose(ea::vector<BonePose>& pose);
 
 private:
     /// Apply animation to a skeleton. Transform changes are applied silently, so the model needs to dirty its root model afterward.
@@ -187,6 +194,9 @@ private:
     void ApplyToNodes();
     /// Apply track.
     void ApplyTrack(AnimationStateTrack& stateTrack, float weight, bool silent);
+    /// Sample track and blend it with the current transform.
+    void BlendTrack(AnimationStateTrack& stateTrack, float weight, const Vector3& position, const Quaternion& rotation,
+        const Vector3& scale, Vector3& newPosition, Quaternion& newRotation, Vector3& newScale);
 
     /// Animated model (model mode).
     WeakPtr<AnimatedModel> model_;
@@ -53,34 +53,108 @@ inline bool CompareBatchesState(const Batch* lhs, const Batch* rhs)
         return lhs->distance_ < rhs->distance_;
 }
 
-inline bool CompareBatchesFrontToBack(const Batch* lhs, const Batch* rhs)
+inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ < rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    return lhs.distance_ < rhs.distance_;
 }
 
-inline bool CompareBatchesBackToFront(const Batch* lhs, const Batch* rhs)
+/// Number of keys below which a stable insertion sort is used instead of the radix sort.
+static const unsigned RADIX_SORT_THRESHOLD = 32;
+
+inline bool CompareSortKeys(const BatchSortKey& lhs, const BatchSortKey& rhs)
 {
-    if (lhs->renderOrder_ != rhs->renderOrder_)
-        return lhs->renderOrder_ < rhs->renderOrder_;
-    else if (lhs->distance_ != rhs->distance_)
-        return lhs->distance_ > rhs->distance_;
-    else
-        return lhs->sortKey_ < rhs->sortKey_;
+    return lhs.key_ < rhs.key_;
 }
 
-inline bool CompareInstancesFrontToBack(const InstanceData& lhs, const InstanceData& rhs)
+/// Return float bits that sort in the same order as the float values when compared as unsigned integers.
+inline unsigned FloatToSortableBits(float value)
 {
-    return lhs.distance_ < rhs.distance_;
+    const unsigned bits = FloatToRawIntBits(value);
+    return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
 }
 
-inline bool CompareBatchGroupOrder(const BatchGroup* lhs, const BatchGroup* rhs)
+/// Return number of bits needed to store values up to the given count.
+inline unsigned GetNumSortBits(unsigned count)
 {
-    return lhs->renderOrder_ < rhs->renderOrder_;
+    unsigned bits = 0;
+    while (count)
+    {
+        ++bits;
+        count >>= 1u;
+    }
+    return bits;
+}
+
+/// Sort keys by the lowest numBytes bytes with a stable LSD radix sort. Bytes that are equal in all keys are skipped.
+void RadixSortKeys(ea::vector<BatchSortKey>& keys, ea::vector<BatchSortKey>& temp, unsigned numBytes = 8)
+{
+    const unsigned count = keys.size();
+    if (count <= RADIX_SORT_THRESHOLD)
+    {
+        ea::insertion_sort(keys.begin(), keys.end(), CompareSortKeys);
+        return;
+    }
+
+    // Build the histograms of all bytes in a single pass
+    unsigned histograms[8][256] = {};
+    for (const BatchSortKey& sortKey : keys)
+    {
+        for (unsigned i = 0; i < numBytes; ++i)
+            ++histograms[i][(sortKey.key_ >> (i * 8u)) & 0xffu];
+    }
+
+    temp.resize(count);
+    BatchSortKey* src = keys.data();
+    BatchSortKey* dest = temp.data();
+
+    for (unsigned i = 0; i < numBytes; ++i)
+    {
+        const unsigned shift = i * 8u;
+        unsigned* histogram = histograms[i];
+        if (histogram[(src[0].key_ >> shift) & 0xffu] == count)
+            continue;
+
+        unsigned offset = 0;
+        for (unsigned j = 0; j < 256; ++j)
+        {
+            const unsigned bucketSize = histogram[j];
+            histogram[j] = offset;
+            offset += bucketSize;
+        }
+
+        for (unsigned j = 0; j < count; ++j)
+            dest[histogram[(src[j].key_ >> shift) & 0xffu]++] = src[j];
+
+        ea::swap(src, dest);
+    }
+
+    if (src != keys.data())
+        keys.swap(temp);
+}
+
+/// Reorder values to match sorted keys by following the permutation cycles. Consumes the key indices.
+template <class T> void ApplySortOrder(ea::vector<T>& values, ea::vector<BatchSortKey>& keys)
+{
+    for (unsigned i = 0; i < keys.size(); ++i)
+    {
+        if (keys[i].index_ == i)
+            continue;
+
+        T value = values[i];
+        unsigned j = i;
+        for (;;)
+        {
+            const unsigned k = keys[j].index_;
+            keys[j].index_ = j;
+            if (k == i)
+            {
+                values[j] = value;
+                break;
+            }
+            values[j] = values[k];
+            j = k;
+        }
+    }
 }
 
 void CalculateShadowMatrix(Matrix4& dest, LightBatchQueue* queue, unsigned split, Renderer* renderer)
@@ -762,87 +836,150 @@ unsigned BatchGroupKey::ToHash() const
                       (size_t)material_ / sizeof(Material) + (size_t)geometry_ / sizeof(Geometry)) + renderOrder_;
 }
 
+unsigned long long BatchGroupKey::ToSortKey() const
+{
+    // Colliding keys of different groups may interleave after sorting, which only splits a group, never merges two
+    const void* pointers[] = { zone_, lightQueue_, pass_, material_, geometry_ };
+    unsigned long long key = renderOrder_;
+    for (const void* pointer : pointers)
+        key = (key ^ (unsigned long long)(size_t)pointer) * 0x9e3779b97f4a7c15ull;
+    return key;
+}
+
 void BatchQueue::Clear(int maxSortedInstances)
 {
     batches_.clear();
     sortedBatches_.clear();
     batchGroups_.clear();
+    instancedBatches_.clear();
+    instancedTechniques_.clear();
     maxSortedInstances_ = (unsigned)maxSortedInstances;
 }
 
+void BatchQueue::AddInstancedBatch(const Batch& batch, Technique* tech)
+{
+    instancedBatches_.push_back(batch);
+    instancedTechniques_.push_back(tech);
+}
+
+void BatchQueue::SortInstancedBatches()
+{
+    sortKeys_.resize(instancedBatches_.size());
+    for (unsigned i = 0; i < instancedBatches_.size(); ++i)
+    {
+        sortKeys_[i].key_ = BatchGroupKey(instancedBatches_[i]).ToSortKey();
+        sortKeys_[i].index_ = i;
+    }
+
+    RadixSortKeys(sortKeys_, sortKeysTemp_);
+}
+
 void BatchQueue::SortBackToFront()
 {
-    sortedBatches_.resize(batches_.size());
+    // Sort by render order, then by distance descending, with the shader part of the state key as tiebreaker
+    const unsigned numBatches = batches_.size();
+    sortKeys_.resize(numBatches);
+    for (unsigned i = 0; i < numBatches; ++i)
+    {
+        const Batch& batch = batches_[i];
+        sortKeys_[i].key_ = ((unsigned long long)batch.renderOrder_ << 56u) |
+            ((unsigned long long)~FloatToSortableBits(batch.distance_) << 24u) | (batch.sortKey_ >> 40u);
+        sortKeys_[i].index_ = i;
+    }
 
-    for (unsigned i = 0; i < batches_.size(); ++i)
-        sortedBatches_[i] = &batches_[i];
+    RadixSortKeys(sortKeys_, sortKeysTemp_);
 
-    ea::quick_sort(sortedBatches_.begin(), sortedBatches_.end(), CompareBatchesBackToFront);
+    sortedBatches_.resize(numBatches);
+    for (unsigned i = 0; i < numBatches; ++i)
+        sortedBatches_[i] = &batches_[sortKeys_[i].index_];
 
-    sortedBatchGroups_.resize(batchGroups_.size());
+    const unsigned numGroups = batchGroups_.size();
+    sortKeys_.resize(numGroups);
+    for (unsigned i = 0; i < numGroups; ++i)
+    {
+        sortKeys_[i].key_ = batchGroups_[i].renderOrder_;
+        sortKeys_[i].index_ = i;
+    }
 
-    unsigned index = 0;
-    for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
-        sortedBatchGroups_[index++] = &i->second;
+    RadixSortKeys(sortKeys_, sortKeysTemp_, 1);
 
-    ea::quick_sort(sortedBatchGroups_.begin(), sortedBatchGroups_.end(), CompareBatchGroupOrder);
+    sortedBatchGroups_.resize(numGroups);
+    for (unsigned i = 0; i < numGroups; ++i)
+        sortedBatchGroups_[i] = &batchGroups_[sortKeys_[i].index_];
 }
 
 void BatchQueue::SortFrontToBack()
 {
-    sortedBatches_.clear();
-
+    sortedBatches_.resize(batches_.size());
     for (unsigned i = 0; i < batches_.size(); ++i)
-        sortedBatches_.push_back(&batches_[i]);
+        sortedBatches_[i] = &batches_[i];
 
     SortFrontToBack2Pass(sortedBatches_);
 
     // Sort each group front to back
     for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
     {
-        if (i->second.instances_.size() <= maxSortedInstances_)
+        if (i->instances_.size() <= maxSortedInstances_)
         {
-            ea::quick_sort(i->second.instances_.begin(), i->second.instances_.end(), CompareInstancesFrontToBack);
-            if (i->second.instances_.size())
-                i->second.distance_ = i->second.instances_[0].distance_;
+            ea::quick_sort(i->instances_.begin(), i->instances_.end(), CompareInstancesFrontToBack);
+            if (i->instances_.size())
+                i->distance_ = i->instances_[0].distance_;
         }
         else
         {
             float minDistance = M_INFINITY;
-            for (auto j = i->second.instances_.begin(); j !=
-                i->second.instances_.end(); ++j)
+            for (auto j = i->instances_.begin(); j != i->instances_.end(); ++j)
                 minDistance = Min(minDistance, j->distance_);
-            i->second.distance_ = minDistance;
+            i->distance_ = minDistance;
         }
     }
 
     sortedBatchGroups_.resize(batchGroups_.size());
-
-    unsigned index = 0;
-    for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
-        sortedBatchGroups_[index++] = &i->second;
-
+    for (unsigned i = 0; i < batchGroups_.size(); ++i)
+        sortedBatchGroups_[i] = &batchGroups_[i];
 
     SortFrontToBack2Pass(sortedBatchGroups_);
 }
 
 template <class T> void BatchQueue::SortFrontToBack2Pass(ea::vector<T>& batches)
 {
+    const unsigned numBatches = batches.size();
+    sortKeys_.resize(numBatches);
+
     // Mobile devices likely use a tiled deferred approach, with which front-to-back sorting is irrelevant. The 2-pass
-    // method is also time consuming, so just sort with state having priority
+    // method is also time consuming, so just sort with state having priority. Stable passes from the least significant
+    // key produce render order, state and distance order
 #ifdef GL_ES_VERSION_2_0
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
+    for (unsigned i = 0; i < numBatches; ++i)
+    {
+        sortKeys_[i].key_ = FloatToSortableBits(batches[i]->distance_);
+        sortKeys_[i].index_ = i;
+    }
+    RadixSortKeys(sortKeys_, sortKeysTemp_, 4);
+
+    for (BatchSortKey& sortKey : sortKeys_)
+        sortKey.key_ = batches[sortKey.index_]->sortKey_;
+    RadixSortKeys(sortKeys_, sortKeysTemp_);
+
+    for (BatchSortKey& sortKey : sortKeys_)
+        sortKey.key_ = batches[sortKey.index_]->renderOrder_;
+    RadixSortKeys(sortKeys_, sortKeysTemp_, 1);
 #else
     // For desktop, first sort by distance and remap shader/material/geometry IDs in the sort key
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesFrontToBack);
+    for (unsigned i = 0; i < numBatches; ++i)
+    {
+        sortKeys_[i].key_ = ((unsigned long long)batches[i]->renderOrder_ << 32u) | FloatToSortableBits(batches[i]->distance_);
+        sortKeys_[i].index_ = i;
+    }
+    RadixSortKeys(sortKeys_, sortKeysTemp_, 5);
 
     unsigned freeShaderID = 0;
     unsigned short freeMaterialID = 0;
     unsigned short freeGeometryID = 0;
 
-    for (auto i = batches.begin(); i != batches.end(); ++i)
+    for (const BatchSortKey& sortKey : sortKeys_)
     {
-        Batch* batch = *i;
+        Batch* batch = batches[sortKey.index_];
 
         auto shaderID = (unsigned)(batch->sortKey_ >> 32u);
         auto j = shaderRemapping_.find(shaderID);
@@ -881,15 +1018,38 @@ template <class T> void BatchQueue::SortFrontToBack2Pass(ea::vector<T>& batches)
     materialRemapping_.clear();
     geometryRemapping_.clear();
 
-    // Finally sort again with the rewritten ID's
-    ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
+    // Finally sort again with the rewritten IDs. They are dense, so render order, base flag and the IDs usually fit
+    // into one 64-bit key. The keys are already in distance order, which the stable sort preserves for equal states
+    const unsigned shaderBits = GetNumSortBits(freeShaderID);
+    const unsigned materialBits = GetNumSortBits(freeMaterialID);
+    const unsigned geometryBits = GetNumSortBits(freeGeometryID);
+    const bool packedKeys = shaderBits + materialBits + geometryBits <= 55;
+    if (packedKeys)
+    {
+        for (BatchSortKey& sortKey : sortKeys_)
+        {
+            const Batch* batch = batches[sortKey.index_];
+            const unsigned long long key = batch->sortKey_;
+            sortKey.key_ = ((unsigned long long)batch->renderOrder_ << 56u) | ((key >> 63u) << 55u) |
+                (((key >> 32u) & 0x7fffffffu) << (materialBits + geometryBits)) | (((key >> 16u) & 0xffffu) << geometryBits) |
+                (key & 0xffffu);
+        }
+        RadixSortKeys(sortKeys_, sortKeysTemp_);
+    }
+#endif
+
+    ApplySortOrder(batches, sortKeys_);
+
+#ifndef GL_ES_VERSION_2_0
+    if (!packedKeys)
+        ea::quick_sort(batches.begin(), batches.end(), CompareBatchesState);
 #endif
 }
 
 void BatchQueue::SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex)
 {
     for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
-        i->second.SetInstancingData(lockedData, stride, freeIndex);
+        i->SetInstancingData(lockedData, stride, freeIndex);
 }
 
 void BatchQueue::Draw(View* view, Camera* camera, bool markToStencil, bool usingLightOptimization, bool allowDepthWrite) const
@@ -939,11 +1099,10 @@ unsigned BatchQueue::GetNumInstances() const
 {
     unsigned total = 0;
 
-    for (auto i = batchGroups_.begin(); i !=
-        batchGroups_.end(); ++i)
+    for (auto i = batchGroups_.begin(); i != batchGroups_.end(); ++i)
     {
-        if (i->second.geometryType_ == GEOM_INSTANCED)
-            total += i->second.instances_.size();
+        if (i->geometryType_ == GEOM_INSTANCED)
+            total += i->instances_.size();
     }
 
     return total;
@@ -44,6 +44,7 @@ class Material;
 class Matrix3x4;
 class Pass;
 class ShaderVariation;
+class Technique;
 class Texture2D;
 class VertexBuffer;
 class View;
@@ -85,7 +86,7 @@ struct Batch
     {
     }
 
-    /// Calculate state sorting key, which consists of base pass flag, light, pass and geometry.
+    /// Calculate state sorting key, which consists of base pass flag, shaders, light, material and geometry. Render order and distance are packed in when the queue is sorted.
     void CalculateSortKey();
     /// Prepare for rendering.
     void Prepare(View* view, Camera* camera, bool setModelTransform, bool allowDepthWrite) const;
@@ -249,6 +250,17 @@ struct BatchGroupKey
 
     /// Return hash value.
     unsigned ToHash() const;
+    /// Return 64-bit key used to make batches of the same group adjacent when sorted.
+    unsigned long long ToSortKey() const;
+};
+
+/// Packed sorting key of a queued draw call. Only the keys are moved during sorting, not the draw calls.
+struct BatchSortKey
+{
+    /// Packed key.
+    unsigned long long key_;
+    /// Index of the draw call.
+    unsigned index_;
 };
 
 /// Queue that contains both instanced and non-instanced draw calls.
@@ -263,6 +275,10 @@ public:
     void SortFrontToBack();
     /// Sort batches front to back while also maintaining state sorting.
     template <class T> void SortFrontToBack2Pass(ea::vector<T>& batches);
+    /// Add an instanced draw call. It is merged into a batch group by FormBatchGroups().
+    void AddInstancedBatch(const Batch& batch, Technique* tech);
+    /// Sort pending instanced draw calls by group key so that draw calls of the same group are adjacent in the sort keys.
+    void SortInstancedBatches();
     /// Pre-set instance data of all groups. The vertex buffer must be big enough to hold all data.
     void SetInstancingData(void* lockedData, unsigned stride, unsigned& freeIndex);
     /// Draw.
@@ -271,10 +287,18 @@ public:
     unsigned GetNumInstances() const;
 
     /// Return whether the batch group is empty.
-    bool IsEmpty() const { return batches_.empty() && batchGroups_.empty(); }
+    bool IsEmpty() const { return batches_.empty() && batchGroups_.empty() && instancedBatches_.empty(); }
 
     /// Instanced draw calls.
-    ea::unordered_map<BatchGroupKey, BatchGroup> batchGroups_;
+    ea::vector<BatchGroup> batchGroups_;
+    /// Instanced draw calls not yet merged into batch groups.
+    ea::vector<Batch> instancedBatches_;
+    /// Techniques of the instanced draw calls not yet merged into batch groups.
+    ea::vector<Technique*> instancedTechniques_;
+    /// Sort keys of the last sort, reused between frames.
+    ea::vector<BatchSortKey> sortKeys_;
+    /// Radix sort scratch buffer, reused between frames.
+    ea::vector<BatchSortKey> sortKeysTemp_;
     /// Shader remapping table for 2-pass state and distance sort.
     ea::unordered_map<unsigned, unsigned> shaderRemapping_;
     /// Material remapping table for 2-pass state and distance sort.
@@ -812,7 +812,7 @@ void BillboardSet::CalculateFixedScreenSize(const FrameInfo& frame)
     {
         bufferDirty_ = true;
         forceUpdate_ = true;
-        worldBoundingBoxDirty_ = true;
+        MarkWorldBoundingBoxDirty();
     }
 }
 
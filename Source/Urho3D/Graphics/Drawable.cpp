@@ -97,7 +97,7 @@ Drawable::~Drawable()
 void Drawable::RegisterObject(Context* context)
 {
     URHO3D_ATTRIBUTE("Max Lights", int, maxLights_, 0, AM_DEFAULT);
-    URHO3D_ATTRIBUTE("View Mask", int, viewMask_, DEFAULT_VIEWMASK, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("View Mask", GetViewMask, SetViewMask, unsigned, DEFAULT_VIEWMASK, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Light Mask", int, lightMask_, DEFAULT_LIGHTMASK, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Shadow Mask", int, shadowMask_, DEFAULT_SHADOWMASK, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Zone Mask", GetZoneMask, SetZoneMask, unsigned, DEFAULT_ZONEMASK, AM_DEFAULT);
@@ -189,6 +189,8 @@ void Drawable::SetLodBias(float bias)
 void Drawable::SetViewMask(unsigned mask)
 {
     viewMask_ = mask;
+    if (octant_)
+        octant_->SetDrawableViewMask(octantIndex_, viewMask_);
     MarkNetworkUpdate();
 }
 
@@ -254,6 +256,8 @@ const BoundingBox& Drawable::GetWorldBoundingBox()
     {
         OnWorldBoundingBoxUpdate();
         worldBoundingBoxDirty_ = false;
+        if (octant_)
+            octant_->SetDrawableBoundingBox(octantIndex_, worldBoundingBox_);
     }
 
     return worldBoundingBox_;
@@ -370,9 +374,16 @@ void Drawable::OnSceneSet(Scene* scene)
         RemoveFromOctree();
 }
 
-void Drawable::OnMarkedDirty(Node* node)
+void Drawable::MarkWorldBoundingBoxDirty()
 {
     worldBoundingBoxDirty_ = true;
+    if (octant_)
+        octant_->MarkDrawableBoundingBoxDirty(octantIndex_);
+}
+
+void Drawable::OnMarkedDirty(Node* node)
+{
+    MarkWorldBoundingBoxDirty();
     if (!updateQueued_ && octant_)
         octant_->GetRoot()->QueueUpdate(this);
 
@@ -138,7 +138,7 @@ class URHO3D_API Drawable : public Component
 
     friend class Octant;
     friend class Octree;
-    friend void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex);
+    friend void UpdateDrawablesWork(const FrameInfo& frame, Drawable** start, Drawable** end);
 
 public:
     /// Construct.
@@ -154,6 +154,8 @@ public:
     virtual void ProcessRayQuery(const RayOctreeQuery& query, ea::vector<RayQueryResult>& results);
     /// Update before octree reinsertion. Is called from a worker thread.
     virtual void Update(const FrameInfo& frame) { }
+    /// Apply results of Update() that are not safe to apply from worker threads, such as scene node changes. Is called from the main thread after all drawables are updated, in update queue order.
+    virtual void FinishUpdate(const FrameInfo& frame) { }
     /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
     virtual void UpdateBatches(const FrameInfo& frame);
     /// Prepare geometry for rendering.
@@ -378,6 +380,8 @@ protected:
 
     /// Move into another octree octant.
     void SetOctant(Octant* octant) { octant_ = octant; }
+    /// Mark world-space bounding box as requiring recalculation.
+    void MarkWorldBoundingBoxDirty();
 
     /// World-space bounding box.
     BoundingBox worldBoundingBox_;
@@ -401,6 +405,8 @@ protected:
     bool zoneDirty_;
     /// Octree octant.
     Octant* octant_;
+    /// Index in octree octant.
+    unsigned octantIndex_{};
     /// Current zone.
     Zone* zone_;
     /// View mask.
@@ -29,6 +29,12 @@
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#if defined(URHO3D_SSE)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -45,12 +51,213 @@ enum ClipMask : unsigned
 };
 URHO3D_FLAGSET(ClipMask, ClipMaskFlags);
 
-void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
+namespace
+{
+
+#if defined(URHO3D_SSE)
+/// Return per-lane minimum of signed integers. SSE2 has no such instruction.
+inline __m128i MinInt4(__m128i a, __m128i b)
+{
+    const __m128i mask = _mm_cmplt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+#endif
+
+/// Write linearly interpolated depth to a span of pixels if it's closer.
+inline void DrawSpan(int* dest, int count, int invZ, int dInvZdX)
+{
+#if defined(URHO3D_SSE)
+    const __m128i step = _mm_set1_epi32(dInvZdX * 4);
+    __m128i z = _mm_setr_epi32(invZ, invZ + dInvZdX, invZ + dInvZdX * 2, invZ + dInvZdX * 3);
+    for (; count >= 4; count -= 4)
+    {
+        auto* ptr = reinterpret_cast<__m128i*>(dest);
+        _mm_storeu_si128(ptr, MinInt4(z, _mm_loadu_si128(ptr)));
+        z = _mm_add_epi32(z, step);
+        invZ += dInvZdX * 4;
+        dest += 4;
+    }
+#elif defined(__ARM_NEON)
+    const int32x4_t step = vdupq_n_s32(dInvZdX * 4);
+    const int lanes[4] = { invZ, invZ + dInvZdX, invZ + dInvZdX * 2, invZ + dInvZdX * 3 };
+    int32x4_t z = vld1q_s32(lanes);
+    for (; count >= 4; count -= 4)
+    {
+        vst1q_s32(dest, vminq_s32(z, vld1q_s32(dest)));
+        z = vaddq_s32(z, step);
+        invZ += dInvZdX * 4;
+        dest += 4;
+    }
+#endif
+
+    for (; count > 0; --count)
+    {
+        if (invZ < *dest)
+            *dest = invZ;
+        invZ += dInvZdX;
+        ++dest;
+    }
+}
+
+/// Build first depth hierarchy level row from two rows of pixel-level data. Second row may be null.
+/// Branch-free loop body is left for the compiler to vectorize, it does better than hand-written SSE2 with interleaved output.
+void BuildDepthHierarchyRow(const int* src, const int* src2, DepthValue* dest, int width)
+{
+    if (!src2)
+        src2 = src;
+
+    for (int x = 0; x < width; ++x)
+    {
+        const int* upper = src + x * 2;
+        const int* lower = src2 + x * 2;
+        dest[x].min_ = Min(Min(upper[0], upper[1]), Min(lower[0], lower[1]));
+        dest[x].max_ = Max(Max(upper[0], upper[1]), Max(lower[0], lower[1]));
+    }
+}
+
+/// Build depth hierarchy level row from two rows of previous level. Second row may be null.
+void BuildDepthHierarchyRow(const DepthValue* src, const DepthValue* src2, DepthValue* dest, int width)
 {
-    URHO3D_PROFILE("DrawOcclusionBatchWork");
-    auto* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
-    OcclusionBatch& batch = *reinterpret_cast<OcclusionBatch*>(item->start_);
-    buffer->DrawBatch(batch, threadIndex);
+    if (!src2)
+        src2 = src;
+
+    for (int x = 0; x < width; ++x)
+    {
+        const DepthValue* upper = src + x * 2;
+        const DepthValue* lower = src2 + x * 2;
+        dest[x].min_ = Min(Min(upper[0].min_, upper[1].min_), Min(lower[0].min_, lower[1].min_));
+        dest[x].max_ = Max(Max(upper[0].max_, upper[1].max_), Max(lower[0].max_, lower[1].max_));
+    }
+}
+
+}
+
+// Code based on Chris Hecker's Perspective Texture Mapping series in the Game Developer magazine
+// Also available online at http://chrishecker.com/Miscellaneous_Technical_Articles
+
+/// %Gradients of a software rasterized triangle.
+struct Gradients
+{
+    /// Construct from vertices.
+    explicit Gradients(const Vector3* vertices)
+    {
+        float invdX = 1.0f / (((vertices[1].x_ - vertices[2].x_) *
+                               (vertices[0].y_ - vertices[2].y_)) -
+                              ((vertices[0].x_ - vertices[2].x_) *
+                               (vertices[1].y_ - vertices[2].y_)));
+
+        float invdY = -invdX;
+
+        dInvZdX_ = invdX * (((vertices[1].z_ - vertices[2].z_) * (vertices[0].y_ - vertices[2].y_)) -
+                            ((vertices[0].z_ - vertices[2].z_) * (vertices[1].y_ - vertices[2].y_)));
+
+        dInvZdY_ = invdY * (((vertices[1].z_ - vertices[2].z_) * (vertices[0].x_ - vertices[2].x_)) -
+                            ((vertices[0].z_ - vertices[2].z_) * (vertices[1].x_ - vertices[2].x_)));
+
+        dInvZdXInt_ = (int)dInvZdX_;
+    }
+
+    /// Integer horizontal gradient.
+    int dInvZdXInt_;
+    /// Horizontal gradient.
+    float dInvZdX_;
+    /// Vertical gradient.
+    float dInvZdY_;
+};
+
+/// %Edge of a software rasterized triangle.
+struct Edge
+{
+    /// Construct undefined.
+    Edge() = default;
+    /// Construct from gradients and top & bottom vertices.
+    Edge(const Gradients& gradients, const Vector3& top, const Vector3& bottom, int topY)
+    {
+        float height = (bottom.y_ - top.y_);
+        float slope = (height != 0.0f) ? (bottom.x_ - top.x_) / height : 0.0f;
+        float yPreStep = (float)(topY + 1) - top.y_;
+        float xPreStep = slope * yPreStep;
+
+        x_ = RoundToInt((xPreStep + top.x_) * OCCLUSION_X_SCALE);
+        xStep_ = RoundToInt(slope * OCCLUSION_X_SCALE);
+        invZ_ = RoundToInt(top.z_ + xPreStep * gradients.dInvZdX_ + yPreStep * gradients.dInvZdY_);
+        invZStep_ = RoundToInt(slope * gradients.dInvZdX_ + gradients.dInvZdY_);
+    }
+
+    /// Step down by specified number of rows.
+    void Advance(int rows)
+    {
+        x_ += xStep_ * rows;
+        invZ_ += invZStep_ * rows;
+    }
+
+    /// X coordinate.
+    int x_;
+    /// X coordinate step.
+    int xStep_;
+    /// Inverse Z.
+    int invZ_;
+    /// Inverse Z step.
+    int invZStep_;
+};
+
+/// Clipped and projected occluder triangle set up for rasterization.
+struct OcclusionTriangle
+{
+    /// Edge from top to bottom vertex.
+    Edge topToBottom_;
+    /// Edge from top to middle vertex.
+    Edge topToMiddle_;
+    /// Edge from middle to bottom vertex.
+    Edge middleToBottom_;
+    /// Top row.
+    int topY_;
+    /// Middle row.
+    int middleY_;
+    /// Bottom row.
+    int bottomY_;
+    /// Integer horizontal inverse Z gradient.
+    int dInvZdX_;
+    /// Whether the middle vertex is on the right side.
+    bool middleIsRight_;
+};
+
+/// Per-thread triangle setup output.
+struct OcclusionThreadData
+{
+    /// Triangles set up by the thread.
+    ea::vector<OcclusionTriangle> triangles_;
+    /// Triangle indices per tile.
+    ea::vector<ea::vector<unsigned> > tiles_;
+    /// Number of triangles that passed clipping and culling.
+    unsigned numDrawnTriangles_{};
+};
+
+/// Draw rows [minY, maxY) of a triangle half between left and right edges, starting at row startY of the edges.
+static void DrawTriangleHalf(int* bufferData, int width, Edge left, Edge right, int startY, int minY, int maxY, int dInvZdX)
+{
+    left.Advance(minY - startY);
+    right.Advance(minY - startY);
+
+    int* row = bufferData + minY * width;
+    for (int y = minY; y < maxY; ++y)
+    {
+        int x = left.x_ >> 16u;
+        const int endX = Min(right.x_ >> 16u, width);
+        int invZ = left.invZ_;
+        if (x < 0)
+        {
+            invZ -= x * dInvZdX;
+            x = 0;
+        }
+
+        DrawSpan(row + x, endX - x, invZ, dInvZdX);
+
+        left.x_ += left.xStep_;
+        left.invZ_ += left.invZStep_;
+        right.x_ += right.xStep_;
+        row += width;
+    }
 }
 
 OcclusionBuffer::OcclusionBuffer(Context* context) :
@@ -85,18 +292,11 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
 
     width_ = width;
     height_ = height;
+    threaded_ = threaded;
 
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
-    buffers_.resize(numThreadBuffers);
-    for (unsigned i = 0; i < numThreadBuffers; ++i)
-    {
-        // Reserve extra memory in case 3D clipping is not exact
-        OcclusionBufferData& buffer = buffers_[i];
-        buffer.dataWithSafety_ = new int[width * (height + 2) + 2];
-        buffer.data_ = buffer.dataWithSafety_.get() + width + 1;
-        buffer.used_ = false;
-    }
+    // Reserve extra memory in case 3D clipping is not exact
+    buffer_.dataWithSafety_ = new int[width * (height + 2) + 2];
+    buffer_.data_ = buffer_.dataWithSafety_.get() + width + 1;
 
     mipBuffers_.clear();
 
@@ -113,7 +313,7 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     }
 
     URHO3D_LOGDEBUG("Set occlusion buffer size " + ea::to_string(width_) + "x" + ea::to_string(height_) + " with " +
-             ea::to_string(mipBuffers_.size()) + " mip levels and " + ea::to_string(numThreadBuffers) + " thread buffers");
+             ea::to_string(mipBuffers_.size()) + " mip levels" + (threaded_ ? ", threaded" : ""));
 
     CalculateViewport();
     return true;
@@ -159,12 +359,7 @@ void OcclusionBuffer::Reset()
 void OcclusionBuffer::Clear()
 {
     Reset();
-
-    // Only clear the main thread buffer. Rest are cleared on-demand when drawing the first batch
-    ClearBuffer(0);
-    for (unsigned i = 1; i < buffers_.size(); ++i)
-        buffers_[i].used_ = false;
-
+    ClearBuffer();
     depthHierarchyDirty_ = true;
 }
 
@@ -206,41 +401,65 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.size() == 1)
+    if (!buffer_.data_ || batches_.empty())
     {
-        // Not threaded
-        for (auto i = batches_.begin(); i != batches_.end(); ++i)
-            DrawBatch(*i, 0);
-
-        depthHierarchyDirty_ = true;
+        batches_.clear();
+        return;
     }
-    else if (buffers_.size() > 1)
+
+    // Threads are used only when called from the main thread or a worker thread
+    auto* queue = GetSubsystem<WorkQueue>();
+    const unsigned numThreads = threaded_ ? queue->GetNumThreads() : 0;
+    const bool useThreads = numThreads > 0 && WorkQueue::GetThreadIndex() <= numThreads;
+    const unsigned numTiles = static_cast<unsigned>((height_ + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT);
+
+    const unsigned numThreadData = useThreads ? numThreads + 1 : 1;
+    binTriangles_ = useThreads;
+    while (threadData_.size() < numThreadData)
+        threadData_.push_back(ea::make_unique<OcclusionThreadData>());
+    threadData_.resize(numThreadData);
+    for (const auto& data : threadData_)
     {
-        // Threaded
-        auto* queue = GetSubsystem<WorkQueue>();
+        data->triangles_.clear();
+        data->tiles_.resize(numTiles);
+        for (ea::vector<unsigned>& tile : data->tiles_)
+            tile.clear();
+        data->numDrawnTriangles_ = 0;
+    }
 
-        for (auto i = batches_.begin(); i != batches_.end(); ++i)
+    // When threaded, clip, project and bin triangles to tiles, then rasterize tiles independently of each other.
+    // Otherwise draw triangles right away
+    if (useThreads)
+    {
+        queue->ParallelFor(batches_.size(), 1, [this](unsigned begin, unsigned end, unsigned threadIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = DrawOcclusionBatchWork;
-            item->aux_ = this;
-            item->start_ = &(*i);
-            queue->AddWorkItem(item);
-        }
-
-        queue->Complete(M_MAX_UNSIGNED);
-
-        MergeBuffers();
-        depthHierarchyDirty_ = true;
+            URHO3D_PROFILE("DrawOcclusionBatches");
+            for (unsigned i = begin; i < end; ++i)
+                DrawBatch(batches_[i], threadIndex);
+        });
+        queue->ParallelFor(numTiles, 1, [this](unsigned begin, unsigned end, unsigned threadIndex)
+        {
+            URHO3D_PROFILE("DrawOcclusionTiles");
+            for (unsigned i = begin; i < end; ++i)
+                DrawTile(i);
+        });
+    }
+    else
+    {
+        for (const OcclusionBatch& batch : batches_)
+            DrawBatch(batch, 0);
     }
 
+    for (const auto& data : threadData_)
+        numTriangles_ += data->numDrawnTriangles_;
+
+    depthHierarchyDirty_ = true;
     batches_.clear();
 }
 
 void OcclusionBuffer::BuildDepthHierarchy()
 {
-    if (buffers_.empty() || !depthHierarchyDirty_)
+    if (!buffer_.data_ || !depthHierarchyDirty_)
         return;
 
     URHO3D_PROFILE("BuildDepthHierarchy");
@@ -252,38 +471,9 @@ void OcclusionBuffer::BuildDepthHierarchy()
     {
         for (int y = 0; y < height; ++y)
         {
-            int* src = buffers_[0].data_ + (y * 2) * width_;
-            DepthValue* dest = mipBuffers_[0].get() + y * width;
-            DepthValue* end = dest + width;
-
-            if (y * 2 + 1 < height_)
-            {
-                int* src2 = src + width_;
-                while (dest < end)
-                {
-                    int minUpper = Min(src[0], src[1]);
-                    int minLower = Min(src2[0], src2[1]);
-                    dest->min_ = Min(minUpper, minLower);
-                    int maxUpper = Max(src[0], src[1]);
-                    int maxLower = Max(src2[0], src2[1]);
-                    dest->max_ = Max(maxUpper, maxLower);
-
-                    src += 2;
-                    src2 += 2;
-                    ++dest;
-                }
-            }
-            else
-            {
-                while (dest < end)
-                {
-                    dest->min_ = Min(src[0], src[1]);
-                    dest->max_ = Max(src[0], src[1]);
-
-                    src += 2;
-                    ++dest;
-                }
-            }
+            const int* src = buffer_.data_ + (y * 2) * width_;
+            const int* src2 = y * 2 + 1 < height_ ? src + width_ : nullptr;
+            BuildDepthHierarchyRow(src, src2, mipBuffers_[0].get() + y * width, width);
         }
     }
 
@@ -297,38 +487,9 @@ void OcclusionBuffer::BuildDepthHierarchy()
 
         for (int y = 0; y < height; ++y)
         {
-            DepthValue* src = mipBuffers_[i - 1].get() + (y * 2) * prevWidth;
-            DepthValue* dest = mipBuffers_[i].get() + y * width;
-            DepthValue* end = dest + width;
-
-            if (y * 2 + 1 < prevHeight)
-            {
-                DepthValue* src2 = src + prevWidth;
-                while (dest < end)
-                {
-                    int minUpper = Min(src[0].min_, src[1].min_);
-                    int minLower = Min(src2[0].min_, src2[1].min_);
-                    dest->min_ = Min(minUpper, minLower);
-                    int maxUpper = Max(src[0].max_, src[1].max_);
-                    int maxLower = Max(src2[0].max_, src2[1].max_);
-                    dest->max_ = Max(maxUpper, maxLower);
-
-                    src += 2;
-                    src2 += 2;
-                    ++dest;
-                }
-            }
-            else
-            {
-                while (dest < end)
-                {
-                    dest->min_ = Min(src[0].min_, src[1].min_);
-                    dest->max_ = Max(src[0].max_, src[1].max_);
-
-                    src += 2;
-                    ++dest;
-                }
-            }
+            const DepthValue* src = mipBuffers_[i - 1].get() + (y * 2) * prevWidth;
+            const DepthValue* src2 = y * 2 + 1 < prevHeight ? src + prevWidth : nullptr;
+            BuildDepthHierarchyRow(src, src2, mipBuffers_[i].get() + y * width, width);
         }
     }
 
@@ -342,19 +503,51 @@ void OcclusionBuffer::ResetUseTimer()
 
 bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
 {
-    if (buffers_.empty())
+    if (!buffer_.data_)
         return true;
 
-    // Transform corners to projection space
+    return IsBoxVisible(worldSpaceBox);
+}
+
+void OcclusionBuffer::IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* results) const
+{
+    if (!buffer_.data_)
+    {
+        for (unsigned i = 0; i < count; ++i)
+            results[i] = true;
+        return;
+    }
+
+    for (unsigned i = 0; i < count; ++i)
+        results[i] = IsBoxVisible(worldSpaceBoxes[i]);
+}
+
+unsigned OcclusionBuffer::GetUseTimer()
+{
+    return useTimer_.GetMSec(false);
+}
+
+bool OcclusionBuffer::IsBoxVisible(const BoundingBox& worldSpaceBox) const
+{
+    // Transform corners to projection space. Each corner is a sum of per-axis terms, so only 6 terms need to be transformed
+    const Vector4 minXTerm = Vector4(viewProj_.m00_, viewProj_.m10_, viewProj_.m20_, viewProj_.m30_) * worldSpaceBox.min_.x_;
+    const Vector4 maxXTerm = Vector4(viewProj_.m00_, viewProj_.m10_, viewProj_.m20_, viewProj_.m30_) * worldSpaceBox.max_.x_;
+    const Vector4 minYTerm = Vector4(viewProj_.m01_, viewProj_.m11_, viewProj_.m21_, viewProj_.m31_) * worldSpaceBox.min_.y_;
+    const Vector4 maxYTerm = Vector4(viewProj_.m01_, viewProj_.m11_, viewProj_.m21_, viewProj_.m31_) * worldSpaceBox.max_.y_;
+    const Vector4 minZTerm = Vector4(viewProj_.m02_, viewProj_.m12_, viewProj_.m22_, viewProj_.m32_) * worldSpaceBox.min_.z_
+        + Vector4(viewProj_.m03_, viewProj_.m13_, viewProj_.m23_, viewProj_.m33_);
+    const Vector4 maxZTerm = Vector4(viewProj_.m02_, viewProj_.m12_, viewProj_.m22_, viewProj_.m32_) * worldSpaceBox.max_.z_
+        + Vector4(viewProj_.m03_, viewProj_.m13_, viewProj_.m23_, viewProj_.m33_);
+
     Vector4 vertices[8];
-    vertices[0] = ModelTransform(viewProj_, worldSpaceBox.min_);
-    vertices[1] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.min_.y_, worldSpaceBox.min_.z_));
-    vertices[2] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.max_.y_, worldSpaceBox.min_.z_));
-    vertices[3] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.max_.y_, worldSpaceBox.min_.z_));
-    vertices[4] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.min_.y_, worldSpaceBox.max_.z_));
-    vertices[5] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.min_.y_, worldSpaceBox.max_.z_));
-    vertices[6] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.max_.y_, worldSpaceBox.max_.z_));
-    vertices[7] = ModelTransform(viewProj_, worldSpaceBox.max_);
+    vertices[0] = minXTerm + minYTerm + minZTerm;
+    vertices[1] = maxXTerm + minYTerm + minZTerm;
+    vertices[2] = minXTerm + maxYTerm + minZTerm;
+    vertices[3] = maxXTerm + maxYTerm + minZTerm;
+    vertices[4] = minXTerm + minYTerm + maxZTerm;
+    vertices[5] = maxXTerm + minYTerm + maxZTerm;
+    vertices[6] = minXTerm + maxYTerm + maxZTerm;
+    vertices[7] = maxXTerm + maxYTerm + maxZTerm;
 
     // Apply a far clip relative bias
     for (auto& vertice : vertices)
@@ -444,8 +637,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     }
 
     // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
+    int* row = buffer_.data_ + rect.top_ * width_;
+    int* endRow = buffer_.data_ + rect.bottom_ * width_;
     while (row <= endRow)
     {
         int* src = row + rect.left_;
@@ -462,21 +655,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     return false;
 }
 
-unsigned OcclusionBuffer::GetUseTimer()
-{
-    return useTimer_.GetMSec(false);
-}
-
-
 void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
-    {
-        ClearBuffer(threadIndex);
-        buffers_[threadIndex].used_ = true;
-    }
-
     Matrix4 modelViewProj = viewProj_ * batch.model_;
 
     // Theoretical max. amount of vertices if each of the 6 clipping planes doubles the triangle count
@@ -593,6 +773,18 @@ void OcclusionBuffer::CalculateViewport()
     projOffsetScaleY_ = projection_.m11_ * scaleY_;
 }
 
+void OcclusionBuffer::DrawTile(unsigned tileIndex)
+{
+    const int minY = static_cast<int>(tileIndex) * OCCLUSION_TILE_HEIGHT;
+    const int maxY = Min(minY + OCCLUSION_TILE_HEIGHT, height_);
+
+    for (const auto& data : threadData_)
+    {
+        for (unsigned triangleIndex : data->tiles_[tileIndex])
+            DrawTriangle2D(data->triangles_[triangleIndex], minY, maxY);
+    }
+}
+
 void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
 {
     ClipMaskFlags clipMask{};
@@ -640,7 +832,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            BinTriangle2D(projected, clockwise, threadIndex);
             drawOk = true;
         }
     }
@@ -678,7 +870,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    BinTriangle2D(projected, clockwise, threadIndex);
                     drawOk = true;
                 }
             }
@@ -686,7 +878,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
     }
 
     if (drawOk)
-        ++numTriangles_;
+        ++threadData_[threadIndex]->numDrawnTriangles_;
 }
 
 void OcclusionBuffer::ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles)
@@ -759,67 +951,7 @@ void OcclusionBuffer::ClipVertices(const Vector4& plane, Vector4* vertices, bool
     }
 }
 
-// Code based on Chris Hecker's Perspective Texture Mapping series in the Game Developer magazine
-// Also available online at http://chrishecker.com/Miscellaneous_Technical_Articles
-
-/// %Gradients of a software rasterized triangle.
-struct Gradients
-{
-    /// Construct from vertices.
-    explicit Gradients(const Vector3* vertices)
-    {
-        float invdX = 1.0f / (((vertices[1].x_ - vertices[2].x_) *
-                               (vertices[0].y_ - vertices[2].y_)) -
-                              ((vertices[0].x_ - vertices[2].x_) *
-                               (vertices[1].y_ - vertices[2].y_)));
-
-        float invdY = -invdX;
-
-        dInvZdX_ = invdX * (((vertices[1].z_ - vertices[2].z_) * (vertices[0].y_ - vertices[2].y_)) -
-                            ((vertices[0].z_ - vertices[2].z_) * (vertices[1].y_ - vertices[2].y_)));
-
-        dInvZdY_ = invdY * (((vertices[1].z_ - vertices[2].z_) * (vertices[0].x_ - vertices[2].x_)) -
-                            ((vertices[0].z_ - vertices[2].z_) * (vertices[1].x_ - vertices[2].x_)));
-
-        dInvZdXInt_ = (int)dInvZdX_;
-    }
-
-    /// Integer horizontal gradient.
-    int dInvZdXInt_;
-    /// Horizontal gradient.
-    float dInvZdX_;
-    /// Vertical gradient.
-    float dInvZdY_;
-};
-
-/// %Edge of a software rasterized triangle.
-struct Edge
-{
-    /// Construct from gradients and top & bottom vertices.
-    Edge(const Gradients& gradients, const Vector3& top, const Vector3& bottom, int topY)
-    {
-        float height = (bottom.y_ - top.y_);
-        float slope = (height != 0.0f) ? (bottom.x_ - top.x_) / height : 0.0f;
-        float yPreStep = (float)(topY + 1) - top.y_;
-        float xPreStep = slope * yPreStep;
-
-        x_ = RoundToInt((xPreStep + top.x_) * OCCLUSION_X_SCALE);
-        xStep_ = RoundToInt(slope * OCCLUSION_X_SCALE);
-        invZ_ = RoundToInt(top.z_ + xPreStep * gradients.dInvZdX_ + yPreStep * gradients.dInvZdY_);
-        invZStep_ = RoundToInt(slope * gradients.dInvZdX_ + gradients.dInvZdY_);
-    }
-
-    /// X coordinate.
-    int x_;
-    /// X coordinate step.
-    int xStep_;
-    /// Inverse Z.
-    int invZ_;
-    /// Inverse Z step.
-    int invZStep_;
-};
-
-void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+void OcclusionBuffer::BinTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
 {
     int top, middle, bottom;
     bool middleIsRight;
@@ -881,163 +1013,80 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     auto topY = (int)vertices[top].y_;
     auto middleY = (int)vertices[middle].y_;
     auto bottomY = (int)vertices[bottom].y_;
+    const int minY = Max(topY, 0);
+    const int maxY = Min(bottomY, height_);
 
-    // Check for degenerate triangle
-    if (topY == bottomY)
+    // Check for degenerate or offscreen triangle
+    if (topY == bottomY || minY >= maxY)
         return;
 
     // Reverse middleIsRight test if triangle is counterclockwise
     if (!clockwise)
         middleIsRight = !middleIsRight;
 
-    const bool topDegenerate = topY == middleY;
-    const bool bottomDegenerate = middleY == bottomY;
-
     Gradients gradients(vertices);
-    Edge topToBottom(gradients, vertices[top], vertices[bottom], topY);
-
-    int* bufferData = buffers_[threadIndex].data_;
-
-    if (middleIsRight)
+    const OcclusionTriangle triangle{
+        Edge(gradients, vertices[top], vertices[bottom], topY),
+        Edge(gradients, vertices[top], vertices[middle], topY),
+        Edge(gradients, vertices[middle], vertices[bottom], middleY),
+        topY, middleY, bottomY, gradients.dInvZdXInt_, middleIsRight
+    };
+
+    // Single thread owns the whole buffer and can draw right away
+    if (!binTriangles_)
     {
-        // Top half
-        if (!topDegenerate)
-        {
-            Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
-            int* row = bufferData + topY * width_;
-            int* endRow = bufferData + middleY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (topToMiddle.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToBottom.x_ += topToBottom.xStep_;
-                topToBottom.invZ_ += topToBottom.invZStep_;
-                topToMiddle.x_ += topToMiddle.xStep_;
-                row += width_;
-            }
-        }
-
-        // Bottom half
-        if (!bottomDegenerate)
-        {
-            Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
-            int* row = bufferData + middleY * width_;
-            int* endRow = bufferData + bottomY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (middleToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToBottom.x_ += topToBottom.xStep_;
-                topToBottom.invZ_ += topToBottom.invZStep_;
-                middleToBottom.x_ += middleToBottom.xStep_;
-                row += width_;
-            }
-        }
+        DrawTriangle2D(triangle, minY, maxY);
+        return;
     }
-    else
-    {
-        // Top half
-        if (!topDegenerate)
-        {
-            Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
-            int* row = bufferData + topY * width_;
-            int* endRow = bufferData + middleY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToMiddle.invZ_;
-                int* dest = row + (topToMiddle.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
 
-                topToMiddle.x_ += topToMiddle.xStep_;
-                topToMiddle.invZ_ += topToMiddle.invZStep_;
-                topToBottom.x_ += topToBottom.xStep_;
-                row += width_;
-            }
-        }
+    OcclusionThreadData& data = *threadData_[threadIndex];
+    const auto triangleIndex = static_cast<unsigned>(data.triangles_.size());
+    data.triangles_.push_back(triangle);
 
-        // Bottom half
-        if (!bottomDegenerate)
-        {
-            Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
-            int* row = bufferData + middleY * width_;
-            int* endRow = bufferData + bottomY * width_;
-            while (row < endRow)
-            {
-                int invZ = middleToBottom.invZ_;
-                int* dest = row + (middleToBottom.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                middleToBottom.x_ += middleToBottom.xStep_;
-                middleToBottom.invZ_ += middleToBottom.invZStep_;
-                topToBottom.x_ += topToBottom.xStep_;
-                row += width_;
-            }
-        }
-    }
+    const int firstTile = minY / OCCLUSION_TILE_HEIGHT;
+    const int lastTile = (maxY - 1) / OCCLUSION_TILE_HEIGHT;
+    for (int tile = firstTile; tile <= lastTile; ++tile)
+        data.tiles_[tile].push_back(triangleIndex);
 }
 
-void OcclusionBuffer::MergeBuffers()
+void OcclusionBuffer::DrawTriangle2D(const OcclusionTriangle& triangle, int minY, int maxY)
 {
-    URHO3D_PROFILE("MergeBuffers");
-
-    for (unsigned i = 1; i < buffers_.size(); ++i)
+    const int topY = triangle.topY_;
+    const int middleY = triangle.middleY_;
+    const int dInvZdX = triangle.dInvZdX_;
+
+    // Top half
+    const int topMinY = Max(topY, minY);
+    const int topMaxY = Min(middleY, maxY);
+    if (topMinY < topMaxY)
     {
-        if (!buffers_[i].used_)
-            continue;
-
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
+        if (triangle.middleIsRight_)
+            DrawTriangleHalf(buffer_.data_, width_, triangle.topToBottom_, triangle.topToMiddle_, topY, topMinY, topMaxY, dInvZdX);
+        else
+            DrawTriangleHalf(buffer_.data_, width_, triangle.topToMiddle_, triangle.topToBottom_, topY, topMinY, topMaxY, dInvZdX);
+    }
 
-        while (count--)
-        {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
-        }
+    // Bottom half
+    const int bottomMinY = Max(middleY, minY);
+    const int bottomMaxY = Min(triangle.bottomY_, maxY);
+    if (bottomMinY < bottomMaxY)
+    {
+        // Bring long edge to the middle row first, so that both edges start from the same row
+        Edge topToBottom = triangle.topToBottom_;
+        topToBottom.Advance(middleY - topY);
+        if (triangle.middleIsRight_)
+            DrawTriangleHalf(buffer_.data_, width_, topToBottom, triangle.middleToBottom_, middleY, bottomMinY, bottomMaxY, dInvZdX);
+        else
+            DrawTriangleHalf(buffer_.data_, width_, triangle.middleToBottom_, topToBottom, middleY, bottomMinY, bottomMaxY, dInvZdX);
     }
 }
 
-void OcclusionBuffer::ClearBuffer(unsigned threadIndex)
+void OcclusionBuffer::ClearBuffer()
 {
-    if (threadIndex >= buffers_.size())
+    if (!buffer_.data_)
         return;
 
-    int* dest = buffers_[threadIndex].data_;
+    int* dest = buffer_.data_;
     int count = width_ * height_;
     auto fillValue = (int)OCCLUSION_Z_SCALE;
 
@@ -25,6 +25,7 @@
 #pragma once
 
 #include <EASTL/shared_array.h>
+#include <EASTL/unique_ptr.h>
 
 #include "../Core/Object.h"
 #include "../Core/Timer.h"
@@ -41,6 +42,8 @@ class IntRect;
 class VertexBuffer;
 struct Edge;
 struct Gradients;
+struct OcclusionThreadData;
+struct OcclusionTriangle;
 
 /// Occlusion hierarchy depth value.
 struct DepthValue
@@ -51,15 +54,13 @@ struct DepthValue
     int max_;
 };
 
-/// Per-thread occlusion buffer data.
+/// Occlusion buffer data.
 struct OcclusionBufferData
 {
     /// Full buffer data with safety padding.
     ea::shared_array<int> dataWithSafety_;
     /// Buffer data.
-    int* data_;
-    /// Use flag.
-    bool used_;
+    int* data_{};
 };
 
 /// Stored occlusion render job.
@@ -82,6 +83,7 @@ struct OcclusionBatch
 };
 
 static const int OCCLUSION_MIN_SIZE = 8;
+static const int OCCLUSION_TILE_HEIGHT = 16;
 static const int OCCLUSION_DEFAULT_MAX_TRIANGLES = 5000;
 static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
@@ -102,7 +104,7 @@ public:
     /// Register object with the engine.
     static void RegisterObject(Context* context);
 
-    /// Set occlusion buffer size and whether to reserve multiple buffers for threading optimization.
+    /// Set occlusion buffer size and whether to use worker threads for rendering.
     bool SetSize(int width, int height, bool threaded);
     /// Set camera view to render from.
     void SetView(Camera* camera);
@@ -127,7 +129,7 @@ public:
     void ResetUseTimer();
 
     /// Return highest level depth values.
-    int* GetBuffer() const { return buffers_.size() ? buffers_[0].data_ : nullptr; }
+    int* GetBuffer() const { return buffer_.data_; }
 
     /// Return view transform matrix.
     const Matrix3x4& GetView() const { return view_; }
@@ -151,15 +153,19 @@ public:
     CullMode GetCullMode() const { return cullMode_; }
 
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.size() > 1; }
+    bool IsThreaded() const { return threaded_; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
+    /// Test multiple bounding boxes for visibility and write results to array. For best performance, build depth hierarchy first.
+    void IsVisible(const BoundingBox* worldSpaceBoxes, unsigned count, bool* results) const;
     /// Return time since last use in milliseconds.
     unsigned GetUseTimer();
 
-    /// Draw a batch. Called internally.
+    /// Clip, project and bin triangles of a batch. Called internally.
     void DrawBatch(const OcclusionBatch& batch, unsigned threadIndex);
+    /// Rasterize binned triangles overlapping a tile. Called internally.
+    void DrawTile(unsigned tileIndex);
 
 private:
     /// Apply modelview transform to vertex.
@@ -170,21 +176,25 @@ private:
     inline Vector4 ClipEdge(const Vector4& v0, const Vector4& v1, float d0, float d1) const;
     /// Return signed area of a triangle. If negative, is clockwise.
     inline float SignedArea(const Vector3& v0, const Vector3& v1, const Vector3& v2) const;
+    /// Test a bounding box for visibility.
+    bool IsBoxVisible(const BoundingBox& worldSpaceBox) const;
     /// Calculate viewport transform.
     void CalculateViewport();
-    /// Draw a triangle.
+    /// Clip and project a triangle.
     void DrawTriangle(Vector4* vertices, unsigned threadIndex);
     /// Clip vertices against a plane.
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
-    /// Draw a clipped triangle.
-    void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
-    /// Clear a thread work buffer.
-    void ClearBuffer(unsigned threadIndex);
-    /// Merge thread work buffers into the first buffer.
-    void MergeBuffers();
-
-    /// Highest-level buffer data per thread.
-    ea::vector<OcclusionBufferData> buffers_;
+    /// Set up a clipped triangle for rasterization and bin it to tiles.
+    void BinTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
+    /// Rasterize rows [minY, maxY) of a set up triangle.
+    void DrawTriangle2D(const OcclusionTriangle& triangle, int minY, int maxY);
+    /// Clear the buffer data.
+    void ClearBuffer();
+
+    /// Highest-level buffer data.
+    OcclusionBufferData buffer_;
+    /// Triangle setup output per thread.
+    ea::vector<ea::unique_ptr<OcclusionThreadData> > threadData_;
     /// Reduced size depth buffers.
     ea::vector<ea::shared_array<DepthValue> > mipBuffers_;
     /// Submitted render jobs.
@@ -203,6 +213,10 @@ private:
     bool depthHierarchyDirty_{true};
     /// Culling reverse flag.
     bool reverseCulling_{};
+    /// Use worker threads flag.
+    bool threaded_{};
+    /// Whether triangles are binned to tiles for threaded rasterization or drawn right away.
+    bool binTriangles_{};
     /// View transform matrix.
     Matrix3x4 view_;
     /// Projection matrix.
@@ -147,15 +147,16 @@ private:
 
 static const float DEFAULT_OCTREE_SIZE = 1000.0f;
 static const int DEFAULT_OCTREE_LEVELS = 8;
+/// Maximum number of octree levels encoded into octant key.
+static const unsigned MAX_OCTANT_KEY_LEVELS = 10;
+/// Minimum number of drawables processed by single batch of threaded update.
+static const unsigned MIN_DRAWABLES_PER_BATCH = 256;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
+void UpdateDrawablesWork(const FrameInfo& frame, Drawable** start, Drawable** end)
 {
     URHO3D_PROFILE("UpdateDrawablesWork");
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
 
     while (start != end)
     {
@@ -187,11 +188,11 @@ Octant::~Octant()
         // Remove the drawables (if any) from this octant to the root octant
         for (auto i = drawables_.begin(); i != drawables_.end(); ++i)
         {
-            (*i)->SetOctant(root_);
-            root_->drawables_.push_back(*i);
+            root_->AddDrawableInternal(*i);
             root_->QueueUpdate(*i);
         }
         drawables_.clear();
+        drawableBounds_ = OctantDrawableBounds();
         numDrawables_ = 0;
     }
 
@@ -252,9 +253,13 @@ void Octant::InsertDrawable(Drawable* drawable)
         if (oldOctant != this)
         {
             // Add first, then remove, because drawable count going to zero deletes the octree branch in question
+            const unsigned oldIndex = drawable->octantIndex_;
             AddDrawable(drawable);
             if (oldOctant)
-                oldOctant->RemoveDrawable(drawable, false);
+            {
+                oldOctant->RemoveDrawableInternal(oldIndex);
+                oldOctant->DecDrawableCount();
+            }
         }
     }
     else
@@ -344,11 +349,7 @@ void Octant::GetDrawablesInternal(OctreeQuery& query, bool inside) const
     }
 
     if (drawables_.size())
-    {
-        auto** start = const_cast<Drawable**>(&drawables_[0]);
-        Drawable** end = start + drawables_.size();
-        query.TestDrawables(start, end, inside);
-    }
+        query.TestOctantDrawables(*this, inside);
 
     for (auto child : children_)
     {
@@ -416,6 +417,9 @@ Octree::Octree(Context* context) :
     Octant(BoundingBox(-DEFAULT_OCTREE_SIZE, DEFAULT_OCTREE_SIZE), 0, nullptr, this),
     numLevels_(DEFAULT_OCTREE_LEVELS)
 {
+    // Until worker threads are known, only the list for threads not owned by WorkQueue exists
+    threadedDrawableUpdates_.resize(1);
+
     // If the engine is running headless, subscribe to RenderUpdate events for manually updating the octree
     // to allow raycasts and animation update
     if (!GetSubsystem<Graphics>())
@@ -439,6 +443,7 @@ void Octree::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE_EX("Bounding Box Min", Vector3, worldBoundingBox_.min_, UpdateOctreeSize, defaultBoundsMin, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Bounding Box Max", Vector3, worldBoundingBox_.max_, UpdateOctreeSize, defaultBoundsMax, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Number of Levels", int, numLevels_, UpdateOctreeSize, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Threaded Update", GetThreadedUpdate, SetThreadedUpdate, bool, false, AM_DEFAULT);
 }
 
 void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -481,42 +486,44 @@ void Octree::Update(const FrameInfo& frame)
         // (for example physics objects) should not perform non-threadsafe work when marked dirty
         Scene* scene = GetScene();
         auto* queue = GetSubsystem<WorkQueue>();
-        scene->BeginThreadedUpdate();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.size() / numWorkItems), 1);
+        // Each thread queues reinsertions into its own list, plus one shared list for foreign threads
+        const unsigned numThreads = queue->GetNumThreads() + 1; // Worker threads + main thread
+        if (threadedDrawableUpdates_.size() < numThreads + 1)
+            threadedDrawableUpdates_.resize(numThreads + 1);
 
-        auto start = drawableUpdates_.begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
-        {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
+        scene->BeginThreadedUpdate();
 
-            auto end = drawableUpdates_.end();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
+        const unsigned batchSize = Max(static_cast<unsigned>(drawableUpdates_.size()) / (numThreads * 4), 1u);
+        queue->ParallelFor(drawableUpdates_.size(), batchSize, [&](unsigned begin, unsigned end, unsigned)
+        {
+            UpdateDrawablesWork(frame, drawableUpdates_.data() + begin, drawableUpdates_.data() + end);
+        });
 
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
+        // Apply results from the main thread in queue order, so the outcome does not depend on thread scheduling.
+        // Nodes dirtied here queue their drawables the same way as during the threaded update
+        {
+            URHO3D_PROFILE("FinishDrawableUpdates");
 
-            start = end;
+            for (Drawable* drawable : drawableUpdates_)
+            {
+                if (drawable)
+                    drawable->FinishUpdate(frame);
+            }
         }
 
-        queue->Complete(M_MAX_UNSIGNED);
         scene->EndThreadedUpdate();
     }
 
     // If any drawables were inserted during threaded update, update them now from the main thread
-    if (!threadedDrawableUpdates_.empty())
+    for (ea::vector<Drawable*>& threadUpdates : threadedDrawableUpdates_)
     {
+        if (threadUpdates.empty())
+            continue;
+
         URHO3D_PROFILE("UpdateDrawablesQueuedDuringUpdate");
 
-        for (auto i = threadedDrawableUpdates_.begin(); i !=
-            threadedDrawableUpdates_.end(); ++i)
+        for (auto i = threadUpdates.begin(); i != threadUpdates.end(); ++i)
         {
             Drawable* drawable = *i;
             if (drawable)
@@ -526,7 +533,7 @@ void Octree::Update(const FrameInfo& frame)
             }
         }
 
-        threadedDrawableUpdates_.clear();
+        threadUpdates.clear();
     }
 
     // Notify drawable update being finished. Custom animation (eg. IK) can be done at this point
@@ -547,9 +554,64 @@ void Octree::Update(const FrameInfo& frame)
     {
         URHO3D_PROFILE("ReinsertToOctree");
 
-        for (auto i = drawableUpdates_.begin(); i != drawableUpdates_.end(); ++i)
+        if (threadedUpdate_ && GetSubsystem<WorkQueue>()->GetNumThreads() > 0)
+            ReinsertDrawablesThreaded();
+        else
+            ReinsertDrawables();
+    }
+
+    drawableUpdates_.clear();
+}
+
+void Octree::ReinsertDrawables()
+{
+    for (auto i = drawableUpdates_.begin(); i != drawableUpdates_.end(); ++i)
+    {
+        Drawable* drawable = *i;
+        drawable->updateQueued_ = false;
+        Octant* octant = drawable->GetOctant();
+        const BoundingBox& box = drawable->GetWorldBoundingBox();
+
+        // Skip if no octant or does not belong to this octree anymore
+        if (!octant || octant->GetRoot() != this)
+            continue;
+        // Skip if still fits the current octant
+        if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
+            continue;
+
+        ReinsertDrawable(drawable);
+    }
+}
+
+void Octree::ReinsertDrawablesThreaded()
+{
+    auto* queue = GetSubsystem<WorkQueue>();
+    const unsigned numThreads = queue->GetNumThreads() + 1; // Worker threads + main thread
+
+    // The extra list is used by the calling thread if it is not owned by WorkQueue
+    threadedReinsertions_.resize(numThreads + 1);
+    for (auto& reinsertions : threadedReinsertions_)
+        reinsertions.clear();
+
+    // Updating world bounding boxes may lazily update world transforms of nodes shared by several drawables,
+    // so update them in the calling thread first
+    {
+        URHO3D_PROFILE("UpdateDrawableBoxes");
+
+        for (Drawable* drawable : drawableUpdates_)
+            drawable->GetWorldBoundingBox();
+    }
+
+    // Test for fit and compute target octants in worker threads. Octree is not modified at this point
+    const unsigned batchSize = Max(static_cast<unsigned>(drawableUpdates_.size()) / (numThreads * 4), MIN_DRAWABLES_PER_BATCH);
+    queue->ParallelFor(drawableUpdates_.size(), batchSize, [this, numThreads](unsigned begin, unsigned end, unsigned threadIndex)
+    {
+        URHO3D_PROFILE("CheckDrawableFitWork");
+
+        auto& reinsertions = threadedReinsertions_[Min(threadIndex, numThreads)];
+        for (unsigned i = begin; i < end; ++i)
         {
-            Drawable* drawable = *i;
+            Drawable* drawable = drawableUpdates_[i];
             drawable->updateQueued_ = false;
             Octant* octant = drawable->GetOctant();
             const BoundingBox& box = drawable->GetWorldBoundingBox();
@@ -561,21 +623,66 @@ void Octree::Update(const FrameInfo& frame)
             if (drawable->IsOccludee() && octant->GetCullingBox().IsInside(box) == INSIDE && octant->CheckDrawableFit(box))
                 continue;
 
-            InsertDrawable(drawable);
+            reinsertions.emplace_back(GetOctantKey(box), drawable);
+        }
+    });
+
+    // Group reinsertions by target octant so that consecutive insertions walk the same branch
+    auto& reinsertions = threadedReinsertions_[0];
+    for (unsigned i = 1; i < threadedReinsertions_.size(); ++i)
+        reinsertions.insert(reinsertions.end(), threadedReinsertions_[i].begin(), threadedReinsertions_[i].end());
+
+    ea::sort(reinsertions.begin(), reinsertions.end(),
+        [](const ea::pair<unsigned, Drawable*>& lhs, const ea::pair<unsigned, Drawable*>& rhs) { return lhs.first < rhs.first; });
+
+    for (const auto& item : reinsertions)
+        ReinsertDrawable(item.second);
+}
+
+void Octree::ReinsertDrawable(Drawable* drawable)
+{
+    InsertDrawable(drawable);
 
 #ifdef _DEBUG
-            // Verify that the drawable will be culled correctly
-            octant = drawable->GetOctant();
-            if (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
-            {
-                URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
-                         " octant box " + octant->GetCullingBox().ToString());
-            }
+    // Verify that the drawable will be culled correctly
+    const BoundingBox& box = drawable->GetWorldBoundingBox();
+    Octant* octant = drawable->GetOctant();
+    if (octant != this && octant->GetCullingBox().IsInside(box) != INSIDE)
+    {
+        URHO3D_LOGERROR("Drawable is not fully inside its octant's culling bounds: drawable box " + box.ToString() +
+                 " octant box " + octant->GetCullingBox().ToString());
+    }
 #endif
-        }
+}
+
+unsigned Octree::GetOctantKey(const BoundingBox& box) const
+{
+    const Vector3 boxCenter = box.Center();
+    const Vector3 boxSize = box.Size();
+    const unsigned numLevels = Min(numLevels_, MAX_OCTANT_KEY_LEVELS);
+
+    // Descend like InsertDrawable does, but without creating octants. Child indices are stored from the most
+    // significant bits, so drawables from the same branch are adjacent when sorted
+    Vector3 center = center_;
+    Vector3 halfSize = halfSize_;
+    unsigned key = 0;
+    for (unsigned level = 0; level < numLevels; ++level)
+    {
+        if (boxSize.x_ >= halfSize.x_ || boxSize.y_ >= halfSize.y_ || boxSize.z_ >= halfSize.z_)
+            break;
+
+        const unsigned x = boxCenter.x_ < center.x_ ? 0 : 1;
+        const unsigned y = boxCenter.y_ < center.y_ ? 0 : 2;
+        const unsigned z = boxCenter.z_ < center.z_ ? 0 : 4;
+        key |= (x + y + z) << (3 * (MAX_OCTANT_KEY_LEVELS - level - 1));
+
+        halfSize *= 0.5f;
+        center.x_ += x ? halfSize.x_ : -halfSize.x_;
+        center.y_ += y ? halfSize.y_ : -halfSize.y_;
+        center.z_ += z ? halfSize.z_ : -halfSize.z_;
     }
 
-    drawableUpdates_.clear();
+    return key;
 }
 
 void Octree::AddManualDrawable(Drawable* drawable)
@@ -671,8 +778,15 @@ void Octree::QueueUpdate(Drawable* drawable)
     Scene* scene = GetScene();
     if (scene && scene->IsThreadedUpdate())
     {
-        MutexLock lock(octreeMutex_);
-        threadedDrawableUpdates_.push_back(drawable);
+        // Threads owned by WorkQueue append to their own lists without locking
+        const unsigned threadIndex = WorkQueue::GetThreadIndex();
+        if (threadIndex < threadedDrawableUpdates_.size() - 1)
+            threadedDrawableUpdates_[threadIndex].push_back(drawable);
+        else
+        {
+            MutexLock lock(octreeMutex_);
+            threadedDrawableUpdates_.back().push_back(drawable);
+        }
     }
     else
         drawableUpdates_.push_back(drawable);
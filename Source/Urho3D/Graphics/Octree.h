@@ -36,6 +36,102 @@ class Zone;
 static const int NUM_OCTANTS = 8;
 static const unsigned ROOT_INDEX = M_MAX_UNSIGNED;
 
+/// Structure-of-arrays copy of world bounding boxes, view masks and flags of octant drawables. Used for vectorized culling.
+/// Element order matches octant drawable order.
+/// @nobind
+struct URHO3D_API OctantDrawableBounds
+{
+    /// Append drawable data.
+    void Add(Drawable* drawable, const BoundingBox* box)
+    {
+        minX_.push_back(0.0f);
+        minY_.push_back(0.0f);
+        minZ_.push_back(0.0f);
+        maxX_.push_back(0.0f);
+        maxY_.push_back(0.0f);
+        maxZ_.push_back(0.0f);
+        viewMasks_.push_back(drawable->GetViewMask());
+        drawableFlags_.push_back(drawable->GetDrawableFlags());
+        dirty_.push_back(false);
+
+        const unsigned index = minX_.size() - 1;
+        if (box)
+            SetBoundingBox(index, *box);
+        else
+            MarkDirty(index);
+    }
+
+    /// Remove element by moving the last element in its place.
+    void Remove(unsigned index)
+    {
+        const unsigned last = minX_.size() - 1;
+        if (index != last)
+        {
+            minX_[index] = minX_[last];
+            minY_[index] = minY_[last];
+            minZ_[index] = minZ_[last];
+            maxX_[index] = maxX_[last];
+            maxY_[index] = maxY_[last];
+            maxZ_[index] = maxZ_[last];
+            viewMasks_[index] = viewMasks_[last];
+            drawableFlags_[index] = drawableFlags_[last];
+            dirty_[index] = dirty_[last];
+        }
+
+        minX_.pop_back();
+        minY_.pop_back();
+        minZ_.pop_back();
+        maxX_.pop_back();
+        maxY_.pop_back();
+        maxZ_.pop_back();
+        viewMasks_.pop_back();
+        drawableFlags_.pop_back();
+        dirty_.pop_back();
+    }
+
+    /// Set up-to-date world bounding box.
+    void SetBoundingBox(unsigned index, const BoundingBox& box)
+    {
+        minX_[index] = box.min_.x_;
+        minY_[index] = box.min_.y_;
+        minZ_[index] = box.min_.z_;
+        maxX_[index] = box.max_.x_;
+        maxY_[index] = box.max_.y_;
+        maxZ_[index] = box.max_.z_;
+        dirty_[index] = false;
+    }
+
+    /// Mark world bounding box as outdated. Outdated box never fails the vectorized test, so the drawable is tested again with up-to-date box.
+    void MarkDirty(unsigned index)
+    {
+        minX_[index] = minY_[index] = minZ_[index] = -M_LARGE_VALUE;
+        maxX_[index] = maxY_[index] = maxZ_[index] = M_LARGE_VALUE;
+        dirty_[index] = true;
+    }
+
+    /// Return number of elements.
+    unsigned Size() const { return minX_.size(); }
+
+    /// Minimum X coordinates.
+    ea::vector<float> minX_;
+    /// Minimum Y coordinates.
+    ea::vector<float> minY_;
+    /// Minimum Z coordinates.
+    ea::vector<float> minZ_;
+    /// Maximum X coordinates.
+    ea::vector<float> maxX_;
+    /// Maximum Y coordinates.
+    ea::vector<float> maxY_;
+    /// Maximum Z coordinates.
+    ea::vector<float> maxZ_;
+    /// View masks.
+    ea::vector<unsigned> viewMasks_;
+    /// Drawable flags.
+    ea::vector<unsigned char> drawableFlags_;
+    /// Outdated bounding box flags.
+    ea::vector<unsigned char> dirty_;
+};
+
 /// %Octree octant.
 /// @nobind
 class URHO3D_API Octant
@@ -58,24 +154,30 @@ public:
     /// Add a drawable object to this octant.
     void AddDrawable(Drawable* drawable)
     {
-        drawable->SetOctant(this);
-        drawables_.push_back(drawable);
+        AddDrawableInternal(drawable);
         IncDrawableCount();
     }
 
     /// Remove a drawable object from this octant.
     void RemoveDrawable(Drawable* drawable, bool resetOctant = true)
     {
-        auto it = drawables_.find(drawable);
-        if (it != drawables_.end())
+        const unsigned index = drawable->GetOctant() == this ? drawable->octantIndex_ : drawables_.index_of(drawable);
+        if (index < drawables_.size() && drawables_[index] == drawable)
         {
-            drawables_.erase(it);
+            RemoveDrawableInternal(index);
             if (resetOctant)
                 drawable->SetOctant(nullptr);
             DecDrawableCount();
         }
     }
 
+    /// Update world bounding box of the drawable at specified index.
+    void SetDrawableBoundingBox(unsigned index, const BoundingBox& box) { drawableBounds_.SetBoundingBox(index, box); }
+    /// Mark world bounding box of the drawable at specified index as outdated.
+    void MarkDrawableBoundingBoxDirty(unsigned index) { drawableBounds_.MarkDirty(index); }
+    /// Update view mask of the drawable at specified index.
+    void SetDrawableViewMask(unsigned index, unsigned viewMask) { drawableBounds_.viewMasks_[index] = viewMask; }
+
     /// Return world-space bounding box.
     /// @property
     const BoundingBox& GetWorldBoundingBox() const { return worldBoundingBox_; }
@@ -95,6 +197,12 @@ public:
     /// Return number of drawables.
     unsigned GetNumDrawables() const { return numDrawables_; }
 
+    /// Return drawables in this octant only.
+    const ea::vector<Drawable*>& GetDrawables() const { return drawables_; }
+
+    /// Return structure-of-arrays data of drawables in this octant only.
+    const OctantDrawableBounds& GetDrawableBounds() const { return drawableBounds_; }
+
     /// Return true if there are no drawable objects in this octant and child octants.
     bool IsEmpty() { return numDrawables_ == 0; }
 
@@ -106,6 +214,26 @@ public:
 protected:
     /// Initialize bounding box.
     void Initialize(const BoundingBox& box);
+    /// Add drawable to the list without updating drawable count.
+    void AddDrawableInternal(Drawable* drawable)
+    {
+        drawable->SetOctant(this);
+        drawable->octantIndex_ = drawables_.size();
+        drawables_.push_back(drawable);
+        drawableBounds_.Add(drawable, drawable->worldBoundingBoxDirty_ ? nullptr : &drawable->worldBoundingBox_);
+    }
+    /// Remove drawable from the list by index without updating drawable count. Last drawable is moved in its place.
+    void RemoveDrawableInternal(unsigned index)
+    {
+        Drawable* last = drawables_.back();
+        if (drawables_[index] != last)
+        {
+            drawables_[index] = last;
+            last->octantIndex_ = index;
+        }
+        drawables_.pop_back();
+        drawableBounds_.Remove(index);
+    }
     /// Return drawable objects by a query, called internally.
     void GetDrawablesInternal(OctreeQuery& query, bool inside) const;
     /// Return drawable objects by a ray query, called internally.
@@ -143,6 +271,8 @@ protected:
     BoundingBox cullingBox_;
     /// Drawable objects.
     ea::vector<Drawable*> drawables_;
+    /// Structure-of-arrays data of drawable objects.
+    OctantDrawableBounds drawableBounds_;
     /// Child octants.
     Octant* children_[NUM_OCTANTS]{};
     /// World bounding box center.
@@ -181,6 +311,9 @@ public:
     void SetSize(const BoundingBox& box, unsigned numLevels);
     /// Update and reinsert drawable objects.
     void Update(const FrameInfo& frame);
+    /// Set whether to check and sort drawables for reinsertion in worker threads.
+    /// @property
+    void SetThreadedUpdate(bool enable) { threadedUpdate_ = enable; }
     /// Add a drawable manually.
     void AddManualDrawable(Drawable* drawable);
     /// Remove a manually added drawable.
@@ -202,6 +335,9 @@ public:
     /// Return subdivision levels.
     /// @property
     unsigned GetNumLevels() const { return numLevels_; }
+    /// Return whether drawables are checked and sorted for reinsertion in worker threads.
+    /// @property
+    bool GetThreadedUpdate() const { return threadedUpdate_; }
 
     /// Mark drawable object as requiring an update and a reinsertion.
     void QueueUpdate(Drawable* drawable);
@@ -215,17 +351,29 @@ private:
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
     /// Update octree size.
     void UpdateOctreeSize() { SetSize(worldBoundingBox_, numLevels_); }
+    /// Reinsert drawables serially.
+    void ReinsertDrawables();
+    /// Find drawables that require reinsertion in worker threads, then reinsert them grouped by target octant.
+    void ReinsertDrawablesThreaded();
+    /// Insert drawable to the octant it fits.
+    void ReinsertDrawable(Drawable* drawable);
+    /// Return key of the deepest octant that may contain the box. Drawables with equal keys share the insertion path.
+    unsigned GetOctantKey(const BoundingBox& box) const;
 
     /// Drawable objects that require update.
     ea::vector<Drawable*> drawableUpdates_;
-    /// Drawable objects that were inserted during threaded update phase.
-    ea::vector<Drawable*> threadedDrawableUpdates_;
-    /// Mutex for octree reinsertions.
+    /// Drawable objects that were inserted during threaded update phase, per thread. Last list is shared by threads not owned by WorkQueue.
+    ea::vector<ea::vector<Drawable*> > threadedDrawableUpdates_;
+    /// Drawable objects to be reinserted with their octant keys, per thread.
+    ea::vector<ea::vector<ea::pair<unsigned, Drawable*> > > threadedReinsertions_;
+    /// Mutex for octree reinsertions from threads not owned by WorkQueue.
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
     mutable ea::vector<Drawable*> rayQueryDrawables_;
     /// Subdivision level.
     unsigned numLevels_;
+    /// Whether to check and sort drawables for reinsertion in worker threads.
+    bool threadedUpdate_{};
 };
 
 }
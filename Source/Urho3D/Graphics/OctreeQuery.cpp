@@ -22,6 +22,7 @@
 
 #include "../Precompiled.h"
 
+#include "../Graphics/Octree.h"
 #include "../Graphics/OctreeQuery.h"
 
 #include "../DebugNew.h"
@@ -29,6 +30,24 @@
 namespace Urho3D
 {
 
+namespace
+{
+
+/// Max number of drawables tested by single vectorized call.
+static const unsigned CULLING_CHUNK_SIZE = 256;
+
+}
+
+void OctreeQuery::TestOctantDrawables(const Octant& octant, bool inside)
+{
+    const ea::vector<Drawable*>& drawables = octant.GetDrawables();
+    if (drawables.empty())
+        return;
+
+    auto** start = const_cast<Drawable**>(drawables.data());
+    TestDrawables(start, start + drawables.size(), inside);
+}
+
 Intersection PointOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
     if (inside)
@@ -111,12 +130,61 @@ void FrustumOctreeQuery::TestDrawables(Drawable** start, Drawable** end, bool in
 
         if ((drawable->GetDrawableFlags() & drawableFlags_) && (drawable->GetViewMask() & viewMask_))
         {
-            if (inside || frustum_.IsInsideFast(drawable->GetWorldBoundingBox()))
+            if ((inside || frustum_.IsInsideFast(drawable->GetWorldBoundingBox())) && AcceptDrawable(drawable))
                 result_.push_back(drawable);
         }
     }
 }
 
+void FrustumOctreeQuery::TestOctantDrawables(const Octant& octant, bool inside)
+{
+    const ea::vector<Drawable*>& drawables = octant.GetDrawables();
+    const OctantDrawableBounds& bounds = octant.GetDrawableBounds();
+    const unsigned numDrawables = drawables.size();
+
+    // Drawables that pass the vectorized tests are handed to TestDrawables, so that subclasses overriding it still see
+    // every candidate. Drawables with outdated bounding boxes are tested again with the up-to-date box
+    Drawable* candidates[CULLING_CHUNK_SIZE];
+    Drawable* dirtyCandidates[CULLING_CHUNK_SIZE];
+    unsigned visibleIndices[CULLING_CHUNK_SIZE];
+    for (unsigned chunkStart = 0; chunkStart < numDrawables; chunkStart += CULLING_CHUNK_SIZE)
+    {
+        const unsigned chunkSize = Min(numDrawables - chunkStart, CULLING_CHUNK_SIZE);
+        unsigned numVisible = chunkSize;
+        if (inside)
+        {
+            for (unsigned j = 0; j < chunkSize; ++j)
+                visibleIndices[j] = j;
+        }
+        else
+        {
+            numVisible = frustum_.CullBoxesFast(
+                &bounds.minX_[chunkStart], &bounds.minY_[chunkStart], &bounds.minZ_[chunkStart],
+                &bounds.maxX_[chunkStart], &bounds.maxY_[chunkStart], &bounds.maxZ_[chunkStart],
+                chunkSize, visibleIndices);
+        }
+
+        unsigned numCandidates = 0;
+        unsigned numDirtyCandidates = 0;
+        for (unsigned j = 0; j < numVisible; ++j)
+        {
+            const unsigned i = chunkStart + visibleIndices[j];
+            if (!(bounds.drawableFlags_[i] & drawableFlags_) || !(bounds.viewMasks_[i] & viewMask_))
+                continue;
+
+            if (!inside && bounds.dirty_[i])
+                dirtyCandidates[numDirtyCandidates++] = drawables[i];
+            else
+                candidates[numCandidates++] = drawables[i];
+        }
+
+        if (numCandidates)
+            TestDrawables(candidates, candidates + numCandidates, true);
+        if (numDirtyCandidates)
+            TestDrawables(dirtyCandidates, dirtyCandidates + numDirtyCandidates, false);
+    }
+}
+
 
 Intersection AllContentOctreeQuery::TestOctant(const BoundingBox& box, bool inside)
 {
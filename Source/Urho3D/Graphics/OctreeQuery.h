@@ -36,6 +36,7 @@ namespace Urho3D
 
 class Drawable;
 class Node;
+class Octant;
 
 /// Base class for octree queries.
 class URHO3D_API OctreeQuery : private NonCopyable
@@ -56,6 +57,8 @@ public:
     virtual Intersection TestOctant(const BoundingBox& box, bool inside) = 0;
     /// Intersection test for drawables.
     virtual void TestDrawables(Drawable** start, Drawable** end, bool inside) = 0;
+    /// Intersection test for all drawables of an octant. By default calls TestDrawables.
+    virtual void TestOctantDrawables(const Octant& octant, bool inside);
 
     /// Result vector reference.
     ea::vector<Drawable*>& result_;
@@ -148,9 +151,15 @@ public:
     Intersection TestOctant(const BoundingBox& box, bool inside) override;
     /// Intersection test for drawables.
     void TestDrawables(Drawable** start, Drawable** end, bool inside) override;
+    /// Intersection test for all drawables of an octant. Uses vectorized test on octant bounding box data and passes the remaining drawables to TestDrawables, with inside set if the frustum test is already done.
+    void TestOctantDrawables(const Octant& octant, bool inside) override;
 
     /// Frustum.
     Frustum frustum_;
+
+protected:
+    /// Additional drawable filter applied after flags, view mask and frustum tests.
+    virtual bool AcceptDrawable(Drawable* drawable) const { return true; }
 };
 
 /// General octree query result. Used for Lua bindings only.
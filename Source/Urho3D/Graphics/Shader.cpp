@@ -175,15 +175,19 @@ bool Shader::ProcessSource(ea::string& code, Deserializer& source)
 {
     auto* cache = GetSubsystem<ResourceCache>();
 
-    // If the source if a non-packaged file, store the timestamp
+    // If the source if a non-packaged file, store the timestamp. The background loader passes file contents read into
+    // memory, in that case look up the file by name
     auto* file = dynamic_cast<File*>(&source);
-    if (file && !file->IsPackaged())
+    if (!file || !file->IsPackaged())
     {
         auto* fileSystem = GetSubsystem<FileSystem>();
-        ea::string fullName = cache->GetResourceFileName(file->GetName());
-        unsigned fileTimeStamp = fileSystem->GetLastModifiedTime(fullName);
-        if (fileTimeStamp > timeStamp_)
-            timeStamp_ = fileTimeStamp;
+        ea::string fullName = cache->GetResourceFileName(source.GetName());
+        if (!fullName.empty())
+        {
+            unsigned fileTimeStamp = fileSystem->GetLastModifiedTime(fullName);
+            if (fileTimeStamp > timeStamp_)
+                timeStamp_ = fileTimeStamp;
+        }
     }
 
     // Store resource dependencies for includes so that we know to reload if any of them changes
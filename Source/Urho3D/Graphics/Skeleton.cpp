@@ -144,6 +144,28 @@ void Skeleton::ResetSilent()
     }
 }
 
+void Skeleton::ResetPose(ea::vector<BonePose>& pose) const
+{
+    pose.resize(bones_.size());
+    for (unsigned i = 0; i < bones_.size(); ++i)
+    {
+        const Bone& bone = bones_[i];
+        pose[i].position_ = bone.initialPosition_;
+        pose[i].rotation_ = bone.initialRotation_;
+        pose[i].scale_ = bone.initialScale_;
+    }
+}
+
+void Skeleton::ApplyPoseSilent(const ea::vector<BonePose>& pose)
+{
+    const unsigned numBones = Min(bones_.size(), pose.size());
+    for (unsigned i = 0; i < numBones; ++i)
+    {
+        const Bone& bone = bones_[i];
+        if (bone.animated_ && bone.node_)
+            bone.node_->SetTransformSilent(pose[i].position_, pose[i].rotation_, pose[i].scale_);
+    }
+}
 
 Bone* Skeleton::GetRootBone()
 {
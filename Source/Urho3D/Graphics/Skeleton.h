@@ -95,6 +95,18 @@ struct Bone
     WeakPtr<Node> node_;
 };
 
+/// Local transform of a bone calculated by animation.
+/// @nobind
+struct BonePose
+{
+    /// Position.
+    Vector3 position_;
+    /// Rotation.
+    Quaternion rotation_;
+    /// Scale.
+    Vector3 scale_;
+};
+
 /// Hierarchical collection of bones.
 /// @fakeref
 class URHO3D_API Skeleton
@@ -151,6 +163,10 @@ public:
 
     /// Reset all animating bones to initial positions without marking the nodes dirty. Requires the node dirtying to be performed later.
     void ResetSilent();
+    /// Reset pose of all bones to initial transforms.
+    void ResetPose(ea::vector<BonePose>& pose) const;
+    /// Apply pose to all animating bones without marking the nodes dirty. Requires the node dirtying to be performed later.
+    void ApplyPoseSilent(const ea::vector<BonePose>& pose);
 
 private:
     /// Bones.
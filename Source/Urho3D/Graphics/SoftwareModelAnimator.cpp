@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/IndexBuffer.h"
@@ -31,6 +32,15 @@
 
 #include <EASTL/sort.h>
 
+#if defined(URHO3D_SSE)
+#include <emmintrin.h>
+#if defined(__FMA__)
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -39,13 +49,221 @@ namespace Urho3D
 namespace
 {
 
-Vector3 TransformNormal(const Matrix3x4& m, const Vector3& v)
+/// Number of vertices skinned or morphed by one task.
+static const unsigned ANIMATION_BATCH_SIZE = 1024;
+
+/// Process vertex range in batches using all threads if the work queue is available.
+template <class T> void ProcessVertexBatches(WorkQueue* workQueue, unsigned count, const T& function)
+{
+    if (workQueue)
+        workQueue->ParallelFor(count, ANIMATION_BATCH_SIZE, [&](unsigned begin, unsigned end, unsigned) { function(begin, end); });
+    else
+        function(0, count);
+}
+
+#if defined(URHO3D_SSE)
+/// Return a * b + c.
+inline __m128 MultiplyAdd(__m128 a, __m128 b, __m128 c)
+{
+#if defined(__FMA__)
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+/// Load 3 floats without reading past them. The 4th lane is zero.
+inline __m128 LoadVector3(const float* source)
+{
+    return _mm_movelh_ps(_mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(source)), _mm_load_ss(source + 2));
+}
+
+/// Store 3 lowest floats.
+inline void StoreVector3(float* dest, __m128 value)
+{
+    _mm_storel_pi(reinterpret_cast<__m64*>(dest), value);
+    _mm_store_ss(dest + 2, _mm_movehl_ps(value, value));
+}
+
+/// Skinning matrix stored as 4 columns, last lane of each column is unused.
+struct SkinningMatrix
+{
+    __m128 columns_[4];
+};
+
+/// Blend bone matrices by weights and transpose the result to columns.
+inline SkinningMatrix BlendBoneMatrices(const Matrix3x4* worldTransforms, const unsigned char* indices, const float* weights,
+    unsigned numBones)
 {
-    return {
-        m.m00_ * v.x_ + m.m01_ * v.y_ + m.m02_ * v.z_,
-        m.m10_ * v.x_ + m.m11_ * v.y_ + m.m12_ * v.z_,
-        m.m20_ * v.x_ + m.m21_ * v.y_ + m.m22_ * v.z_
-    };
+    const float* bone = &worldTransforms[indices[0]].m00_;
+    __m128 weight = _mm_set1_ps(weights[0]);
+    __m128 row0 = _mm_mul_ps(_mm_loadu_ps(bone), weight);
+    __m128 row1 = _mm_mul_ps(_mm_loadu_ps(bone + 4), weight);
+    __m128 row2 = _mm_mul_ps(_mm_loadu_ps(bone + 8), weight);
+    for (unsigned i = 1; i < numBones; ++i)
+    {
+        bone = &worldTransforms[indices[i]].m00_;
+        weight = _mm_set1_ps(weights[i]);
+        row0 = MultiplyAdd(_mm_loadu_ps(bone), weight, row0);
+        row1 = MultiplyAdd(_mm_loadu_ps(bone + 4), weight, row1);
+        row2 = MultiplyAdd(_mm_loadu_ps(bone + 8), weight, row2);
+    }
+
+    __m128 row3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    return { { row0, row1, row2, row3 } };
+}
+
+/// Transform position in place.
+inline void TransformPosition(const SkinningMatrix& matrix, float* position)
+{
+    __m128 result = MultiplyAdd(matrix.columns_[0], _mm_set1_ps(position[0]), matrix.columns_[3]);
+    result = MultiplyAdd(matrix.columns_[1], _mm_set1_ps(position[1]), result);
+    result = MultiplyAdd(matrix.columns_[2], _mm_set1_ps(position[2]), result);
+    StoreVector3(position, result);
+}
+
+/// Transform direction in place.
+inline void TransformDirection(const SkinningMatrix& matrix, float* direction)
+{
+    __m128 result = _mm_mul_ps(matrix.columns_[0], _mm_set1_ps(direction[0]));
+    result = MultiplyAdd(matrix.columns_[1], _mm_set1_ps(direction[1]), result);
+    result = MultiplyAdd(matrix.columns_[2], _mm_set1_ps(direction[2]), result);
+    StoreVector3(direction, result);
+}
+
+/// Add weighted delta to 3 floats.
+inline void MorphVector3(float* dest, const float* delta, float weight)
+{
+    StoreVector3(dest, MultiplyAdd(LoadVector3(delta), _mm_set1_ps(weight), LoadVector3(dest)));
+}
+#elif defined(__ARM_NEON)
+/// Skinning matrix stored as 4 columns, last lane of each column is unused.
+struct SkinningMatrix
+{
+    float32x4_t columns_[4];
+};
+
+/// Blend bone matrices by weights and transpose the result to columns.
+inline SkinningMatrix BlendBoneMatrices(const Matrix3x4* worldTransforms, const unsigned char* indices, const float* weights,
+    unsigned numBones)
+{
+    const float* bone = &worldTransforms[indices[0]].m00_;
+    float32x4_t row0 = vmulq_n_f32(vld1q_f32(bone), weights[0]);
+    float32x4_t row1 = vmulq_n_f32(vld1q_f32(bone + 4), weights[0]);
+    float32x4_t row2 = vmulq_n_f32(vld1q_f32(bone + 8), weights[0]);
+    for (unsigned i = 1; i < numBones; ++i)
+    {
+        bone = &worldTransforms[indices[i]].m00_;
+        row0 = vmlaq_n_f32(row0, vld1q_f32(bone), weights[i]);
+        row1 = vmlaq_n_f32(row1, vld1q_f32(bone + 4), weights[i]);
+        row2 = vmlaq_n_f32(row2, vld1q_f32(bone + 8), weights[i]);
+    }
+
+    const float32x4x2_t rows01 = vtrnq_f32(row0, row1);
+    const float32x4x2_t rows23 = vtrnq_f32(row2, vdupq_n_f32(0.0f));
+    return { {
+        vcombine_f32(vget_low_f32(rows01.val[0]), vget_low_f32(rows23.val[0])),
+        vcombine_f32(vget_low_f32(rows01.val[1]), vget_low_f32(rows23.val[1])),
+        vcombine_f32(vget_high_f32(rows01.val[0]), vget_high_f32(rows23.val[0])),
+        vcombine_f32(vget_high_f32(rows01.val[1]), vget_high_f32(rows23.val[1]))
+    } };
+}
+
+/// Store 3 lowest floats.
+inline void StoreVector3(float* dest, float32x4_t value)
+{
+    vst1_f32(dest, vget_low_f32(value));
+    vst1q_lane_f32(dest + 2, value, 2);
+}
+
+/// Transform position in place.
+inline void TransformPosition(const SkinningMatrix& matrix, float* position)
+{
+    float32x4_t result = vmlaq_n_f32(matrix.columns_[3], matrix.columns_[0], position[0]);
+    result = vmlaq_n_f32(result, matrix.columns_[1], position[1]);
+    result = vmlaq_n_f32(result, matrix.columns_[2], position[2]);
+    StoreVector3(position, result);
+}
+
+/// Transform direction in place.
+inline void TransformDirection(const SkinningMatrix& matrix, float* direction)
+{
+    float32x4_t result = vmulq_n_f32(matrix.columns_[0], direction[0]);
+    result = vmlaq_n_f32(result, matrix.columns_[1], direction[1]);
+    result = vmlaq_n_f32(result, matrix.columns_[2], direction[2]);
+    StoreVector3(direction, result);
+}
+
+/// Add weighted delta to 3 floats.
+inline void MorphVector3(float* dest, const float* delta, float weight)
+{
+    vst1_f32(dest, vmla_n_f32(vld1_f32(dest), vld1_f32(delta), weight));
+    dest[2] += delta[2] * weight;
+}
+#else
+/// Skinning matrix.
+using SkinningMatrix = Matrix3x4;
+
+/// Blend bone matrices by weights.
+inline SkinningMatrix BlendBoneMatrices(const Matrix3x4* worldTransforms, const unsigned char* indices, const float* weights,
+    unsigned numBones)
+{
+    Matrix3x4 matrix = worldTransforms[indices[0]] * weights[0];
+    for (unsigned i = 1; i < numBones; ++i)
+        matrix = matrix + worldTransforms[indices[i]] * weights[i];
+    return matrix;
+}
+
+/// Transform position in place.
+inline void TransformPosition(const SkinningMatrix& matrix, float* position)
+{
+    Vector3& value = *reinterpret_cast<Vector3*>(position);
+    value = matrix * value;
+}
+
+/// Transform direction in place.
+inline void TransformDirection(const SkinningMatrix& m, float* direction)
+{
+    const Vector3 v = *reinterpret_cast<Vector3*>(direction);
+    direction[0] = m.m00_ * v.x_ + m.m01_ * v.y_ + m.m02_ * v.z_;
+    direction[1] = m.m10_ * v.x_ + m.m11_ * v.y_ + m.m12_ * v.z_;
+    direction[2] = m.m20_ * v.x_ + m.m21_ * v.y_ + m.m22_ * v.z_;
+}
+
+/// Add weighted delta to 3 floats.
+inline void MorphVector3(float* dest, const float* delta, float weight)
+{
+    dest[0] += delta[0] * weight;
+    dest[1] += delta[1] * weight;
+    dest[2] += delta[2] * weight;
+}
+#endif
+
+/// Skin range of vertices in place.
+template <bool SkinNormals, bool SkinTangents>
+void SkinVertices(unsigned char* vertexData, unsigned vertexSize, unsigned normalOffset, unsigned tangentOffset,
+    const unsigned char* indicesData, const float* weightsData, unsigned numBones, const Matrix3x4* worldTransforms,
+    unsigned begin, unsigned end)
+{
+    vertexData += begin * vertexSize;
+    indicesData += begin * numBones;
+    weightsData += begin * numBones;
+
+    for (unsigned vertexIndex = begin; vertexIndex < end; ++vertexIndex)
+    {
+        const SkinningMatrix matrix = BlendBoneMatrices(worldTransforms, indicesData, weightsData, numBones);
+
+        TransformPosition(matrix, reinterpret_cast<float*>(vertexData));
+        if (SkinNormals)
+            TransformDirection(matrix, reinterpret_cast<float*>(vertexData + normalOffset));
+        if (SkinTangents)
+            TransformDirection(matrix, reinterpret_cast<float*>(vertexData + tangentOffset));
+
+        vertexData += vertexSize;
+        indicesData += numBones;
+        weightsData += numBones;
+    }
 }
 
 }
@@ -137,48 +355,17 @@ void SoftwareModelAnimator::ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer
     const unsigned tangentOffset = clonedBuffer->GetElementOffset(TYPE_VECTOR4, SEM_TANGENT);
 
     unsigned char* clonedBufferData = clonedBuffer->GetShadowData();
-
-    unsigned char* positionsData = clonedBufferData;
-    unsigned char* normalsData = SkinNormals ? clonedBufferData + normalOffset : nullptr;
-    unsigned char* tangentsData = SkinTangents ? clonedBufferData + tangentOffset : nullptr;
-
     const unsigned char* indicesData = animationData.blendIndices_.data();
     const float* weightsData = animationData.blendWeights_.data();
+    const Matrix3x4* worldTransformsData = worldTransforms.data();
+    const unsigned numBones = numBones_;
 
-    const unsigned numVertices = clonedBuffer->GetVertexCount();
-    Matrix3x4 matrix;
-    for (unsigned vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+    // Vertices are independent, so large buffers are split between threads
+    ProcessVertexBatches(GetSubsystem<WorkQueue>(), clonedBuffer->GetVertexCount(), [&](unsigned begin, unsigned end)
     {
-        matrix = worldTransforms[indicesData[0]] * weightsData[0];
-        for (unsigned boneIndex = 1; boneIndex < numBones_; ++boneIndex)
-            matrix = matrix + worldTransforms[indicesData[boneIndex]] * weightsData[boneIndex];
-
-        Vector3& position = *reinterpret_cast<Vector3*>(positionsData);
-        position = matrix * position;
-
-        if (SkinNormals)
-        {
-            Vector3& normal = *reinterpret_cast<Vector3*>(normalsData);
-            normal = TransformNormal(matrix, normal);
-        }
-
-        if (SkinTangents)
-        {
-            Vector3& tangent = *reinterpret_cast<Vector3*>(tangentsData);
-            tangent = TransformNormal(matrix, tangent);
-        }
-
-        // Advance
-        indicesData += numBones_;
-        weightsData += numBones_;
-
-        positionsData += clonedVertexSize;
-        if (SkinNormals)
-            normalsData += clonedVertexSize;
-        if (SkinTangents)
-            tangentsData += clonedVertexSize;
-    }
-
+        SkinVertices<SkinNormals, SkinTangents>(clonedBufferData, clonedVertexSize, normalOffset, tangentOffset,
+            indicesData, weightsData, numBones, worldTransformsData, begin, end);
+    });
 }
 
 void SoftwareModelAnimator::Commit()
@@ -437,47 +624,47 @@ void SoftwareModelAnimator::CopyMorphVertices(void* destVertexData, const void*
 void SoftwareModelAnimator::ApplyMorph(VertexBuffer* buffer, const VertexBufferMorph& morph, float weight)
 {
     const VertexMaskFlags elementMask = morph.elementMask_ & buffer->GetElementMask();
-    unsigned vertexCount = morph.vertexCount_;
-    unsigned normalOffset = buffer->GetElementOffset(SEM_NORMAL);
-    unsigned tangentOffset = buffer->GetElementOffset(SEM_TANGENT);
-    unsigned vertexSize = buffer->GetVertexSize();
-
-    unsigned char* srcData = morph.morphData_.get();
+    const unsigned normalOffset = buffer->GetElementOffset(SEM_NORMAL);
+    const unsigned tangentOffset = buffer->GetElementOffset(SEM_TANGENT);
+    const unsigned vertexSize = buffer->GetVertexSize();
+
+    // Each morphed vertex is stored as index followed by 3 floats per element
+    const bool morphPosition = !!(elementMask & MASK_POSITION);
+    const bool morphNormal = !!(elementMask & MASK_NORMAL);
+    const bool morphTangent = !!(elementMask & MASK_TANGENT);
+    const unsigned morphNormalOffset = sizeof(unsigned) + (morph.elementMask_ & MASK_POSITION ? 3 * sizeof(float) : 0);
+    const unsigned morphTangentOffset = morphNormalOffset + (morph.elementMask_ & MASK_NORMAL ? 3 * sizeof(float) : 0);
+    const unsigned morphVertexSize = morphTangentOffset + (morph.elementMask_ & MASK_TANGENT ? 3 * sizeof(float) : 0);
+
+    const unsigned char* morphData = morph.morphData_.get();
     unsigned char* destData = buffer->GetShadowData();
 
-    while (vertexCount--)
+    // Vertices are unique within a morph, so large morphs are split between threads
+    ProcessVertexBatches(GetSubsystem<WorkQueue>(), morph.vertexCount_, [&](unsigned begin, unsigned end)
     {
-        const unsigned vertexIndex = *reinterpret_cast<const unsigned*>(srcData);
-        srcData += sizeof(unsigned);
-
-        if (elementMask & MASK_POSITION)
-        {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize);
-            auto src = reinterpret_cast<const float*>(srcData);
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
-        }
-        if (elementMask & MASK_NORMAL)
+        const unsigned char* srcData = morphData + begin * morphVertexSize;
+        for (unsigned i = begin; i < end; ++i)
         {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize + normalOffset);
-            auto src = reinterpret_cast<const float*>(srcData);
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
-        }
-        if (elementMask & MASK_TANGENT)
-        {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize + tangentOffset);
-            auto src = reinterpret_cast<const float*>(srcData);
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
+            unsigned vertexIndex;
+            memcpy(&vertexIndex, srcData, sizeof(unsigned));
+            unsigned char* dest = destData + vertexIndex * vertexSize;
+
+            if (morphPosition)
+                MorphVector3(reinterpret_cast<float*>(dest), reinterpret_cast<const float*>(srcData + sizeof(unsigned)), weight);
+            if (morphNormal)
+            {
+                MorphVector3(reinterpret_cast<float*>(dest + normalOffset),
+                    reinterpret_cast<const float*>(srcData + morphNormalOffset), weight);
+            }
+            if (morphTangent)
+            {
+                MorphVector3(reinterpret_cast<float*>(dest + tangentOffset),
+                    reinterpret_cast<const float*>(srcData + morphTangentOffset), weight);
+            }
+
+            srcData += morphVertexSize;
         }
-    }
+    });
 }
 
 }
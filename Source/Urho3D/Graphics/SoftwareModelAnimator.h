@@ -66,9 +66,9 @@ public:
 
     /// Reset morph and/or skeletal animation. Safe to call from worker thread.
     void ResetAnimation();
-    /// Apply morphs. Safe to call from worker thread.
+    /// Apply morphs. Large morphs are split between worker threads. Safe to call from worker thread.
     void ApplyMorphs(ea::span<const ModelMorph> morphs);
-    /// Apply skinning.
+    /// Apply skinning. Large vertex buffers are split between worker threads.
     void ApplySkinning(ea::span<const Matrix3x4> worldTransforms);
     /// Commit data to GPU.
     void Commit();
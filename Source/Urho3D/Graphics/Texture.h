@@ -75,6 +75,8 @@ public:
     /// Set mip levels to skip on a quality setting when loading. Ensures higher quality levels do not skip more.
     /// @property
     void SetMipsToSkip(MaterialQuality quality, int toSkip);
+    /// Set additional mip levels to skip when loading, as decided by texture streaming. Takes effect on next SetData(Image*).
+    void SetStreamingMipsToSkip(unsigned toSkip) { streamingMipsToSkip_ = toSkip; }
 
     /// Return API-specific texture format.
     /// @property
@@ -148,6 +150,8 @@ public:
     /// Return mip levels to skip on a quality setting when loading.
     /// @property
     int GetMipsToSkip(MaterialQuality quality) const;
+    /// Return additional mip levels skipped by texture streaming.
+    unsigned GetStreamingMipsToSkip() const { return streamingMipsToSkip_; }
     /// Return mip level width, or 0 if level does not exist.
     /// @property
     int GetLevelWidth(unsigned level) const;
@@ -230,6 +234,8 @@ protected:
     void CheckTextureBudget(StringHash type);
     /// Create the GPU texture. Implemented in subclasses.
     virtual bool Create() { return true; }
+    /// Return mip levels to skip when loading from an image, including the texture streaming offset.
+    unsigned GetTotalMipsToSkip(MaterialQuality quality) const { return (unsigned)GetMipsToSkip(quality) + streamingMipsToSkip_; }
 
     /// OpenGL target.
     unsigned target_{};
@@ -265,6 +271,8 @@ protected:
     unsigned anisotropy_{};
     /// Mip levels to skip when loading per texture quality setting.
     unsigned mipsToSkip_[MAX_TEXTURE_QUALITY_LEVELS]{2, 1, 0};
+    /// Additional mip levels to skip as decided by texture streaming.
+    unsigned streamingMipsToSkip_{};
     /// Border color.
     Color borderColor_;
     /// Multisampling level.
@@ -29,6 +29,7 @@
 #include "../Graphics/GraphicsImpl.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
@@ -79,15 +80,19 @@ bool Texture2D::BeginLoad(Deserializer& source)
         return false;
     }
 
-    // Precalculate mip levels if async loading
-    if (GetAsyncLoadState() == ASYNC_LOADING)
-        loadImage_->PrecalculateLevels();
-
     // Load the optional parameters file
     auto* cache = GetSubsystem<ResourceCache>();
     ea::string xmlName = ReplaceExtension(GetName(), ".xml");
     loadParameters_ = cache->GetTempResource<XMLFile>(xmlName, false);
 
+    // Generate mip levels of sRGB textures in linear space
+    if (loadParameters_ && loadParameters_->GetRoot().GetChild("srgb").GetBool("enable"))
+        loadImage_->SetSRGB(true);
+
+    // Precalculate mip levels if async loading
+    if (GetAsyncLoadState() == ASYNC_LOADING)
+        loadImage_->PrecalculateLevels();
+
     return true;
 }
 
@@ -101,6 +106,18 @@ bool Texture2D::EndLoad()
     CheckTextureBudget(GetTypeStatic());
 
     SetParameters(loadParameters_);
+
+    // Upload only the low mips of a streamed texture, the rest are streamed in when needed
+    auto* streaming = GetSubsystem<TextureStreaming>();
+    if (streaming && streaming->IsEnabled() && usage_ == TEXTURE_STATIC && requestedLevels_ == 0)
+        SetStreamingMipsToSkip(streaming->AddTexture(this, loadImage_));
+    else
+    {
+        if (streaming)
+            streaming->RemoveTexture(this);
+        SetStreamingMipsToSkip(0);
+    }
+
     bool success = SetData(loadImage_);
 
     loadImage_.Reset();
@@ -0,0 +1,390 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include <EASTL/sort.h>
+
+#include <atomic>
+
+#include "../Core/Context.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreaming.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Resource/Image.h"
+#include "../Resource/ResourceCache.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Image reload shared between the main thread and a worker thread.
+struct TextureStreamingLoad : public RefCounted
+{
+    /// Image being loaded.
+    SharedPtr<Image> image_;
+    /// Most detailed level to upload.
+    unsigned level_{};
+    /// Success flag. Valid once done.
+    bool success_{};
+    /// Done flag.
+    std::atomic<bool> done_{};
+};
+
+TextureStreaming::TextureStreaming(Context* context) :
+    Object(context)
+{
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(TextureStreaming, HandleEndFrame));
+}
+
+TextureStreaming::~TextureStreaming() = default;
+
+unsigned TextureStreaming::AddTexture(Texture2D* texture, const Image* image)
+{
+    if (!texture || !image)
+        return 0;
+
+    auto* renderer = GetSubsystem<Renderer>();
+    const MaterialQuality quality = renderer ? renderer->GetTextureQuality() : QUALITY_HIGH;
+    unsigned mipsToSkip = (unsigned)texture->GetMipsToSkip(quality);
+
+    int width = 0;
+    int height = 0;
+    unsigned numLevels = 0;
+    unsigned long long topLevelSize = 0;
+    if (image->IsCompressed())
+    {
+        const unsigned numCompressedLevels = image->GetNumCompressedLevels();
+        if (numCompressedLevels <= 1)
+            return 0;
+
+        mipsToSkip = Min(mipsToSkip, numCompressedLevels - 1);
+        const CompressedLevel level = image->GetCompressedLevel(mipsToSkip);
+        width = level.width_;
+        height = level.height_;
+        numLevels = numCompressedLevels - mipsToSkip;
+        topLevelSize = level.dataSize_;
+    }
+    else
+    {
+        width = Max(image->GetWidth() >> mipsToSkip, 1);
+        height = Max(image->GetHeight() >> mipsToSkip, 1);
+        numLevels = LogBaseTwo((unsigned)Max(width, height)) + 1;
+        topLevelSize = (unsigned long long)width * height * image->GetComponents();
+    }
+
+    return AddTexture(texture, texture->GetName(), width, height, numLevels, topLevelSize);
+}
+
+unsigned TextureStreaming::AddTexture(Texture2D* texture, const ea::string& imageName, int width, int height,
+    unsigned numLevels, unsigned long long topLevelSize)
+{
+    if (!texture || numLevels <= 1)
+        return 0;
+
+    TextureStreamingEntry& entry = entries_[texture];
+    entry = TextureStreamingEntry();
+    entry.texture_ = texture;
+    entry.imageName_ = imageName;
+    entry.width_ = width;
+    entry.height_ = height;
+    entry.numLevels_ = numLevels;
+    entry.topLevelSize_ = topLevelSize;
+
+    // Start from the least detailed level that is still at least the minimum resident size
+    unsigned level = 0;
+    while (level + 1 < numLevels && (Max(width, height) >> level) > minResidentSize_)
+        ++level;
+
+    entry.minResidentLevel_ = level;
+    entry.residentLevel_ = level;
+    entry.targetLevel_ = level;
+    texture->SetStreamingMipsToSkip(level);
+    return level;
+}
+
+void TextureStreaming::RemoveTexture(Texture2D* texture)
+{
+    entries_.erase(texture);
+}
+
+void TextureStreaming::RequestScreenSize(Texture2D* texture, float pixels)
+{
+    auto i = entries_.find(texture);
+    if (i == entries_.end())
+        return;
+
+    // Choose the least detailed level that still has at least one texel per pixel
+    const TextureStreamingEntry& entry = i->second;
+    const float maxSize = (float)Max(entry.width_, entry.height_);
+    unsigned level = 0;
+    if (pixels > 0.0f && pixels < maxSize)
+        level = LogBaseTwo((unsigned)(maxSize / pixels));
+    else if (pixels <= 0.0f)
+        level = entry.minResidentLevel_;
+
+    RequestLevel(texture, level);
+}
+
+void TextureStreaming::RequestLevel(Texture2D* texture, unsigned level)
+{
+    auto i = entries_.find(texture);
+    if (i != entries_.end())
+        i->second.requestedLevel_ = Min(i->second.requestedLevel_, level);
+}
+
+void TextureStreaming::Update(unsigned frameNumber)
+{
+    if (entries_.empty())
+        return;
+
+    URHO3D_PROFILE("UpdateTextureStreaming");
+
+    // Forget textures that have been destroyed
+    for (auto i = entries_.begin(); i != entries_.end();)
+    {
+        if (i->second.texture_.Expired())
+            i = entries_.erase(i);
+        else
+            ++i;
+    }
+
+    UpdateTargets(frameNumber);
+    ApplyTargets();
+}
+
+unsigned TextureStreaming::GetNumPendingLoads() const
+{
+    unsigned count = 0;
+    for (const auto& i : entries_)
+    {
+        if (i.second.pendingLoad_)
+            ++count;
+    }
+    return count;
+}
+
+unsigned long long TextureStreaming::GetResidentMemory() const
+{
+    unsigned long long total = 0;
+    for (const auto& i : entries_)
+        total += GetLevelMemory(i.second, i.second.residentLevel_);
+    return total;
+}
+
+unsigned long long TextureStreaming::GetTargetMemory() const
+{
+    unsigned long long total = 0;
+    for (const auto& i : entries_)
+        total += GetLevelMemory(i.second, i.second.targetLevel_);
+    return total;
+}
+
+unsigned TextureStreaming::GetResidentLevel(Texture2D* texture) const
+{
+    const TextureStreamingEntry* entry = GetEntry(texture);
+    return entry ? entry->residentLevel_ : M_MAX_UNSIGNED;
+}
+
+unsigned TextureStreaming::GetTargetLevel(Texture2D* texture) const
+{
+    const TextureStreamingEntry* entry = GetEntry(texture);
+    return entry ? entry->targetLevel_ : M_MAX_UNSIGNED;
+}
+
+const TextureStreamingEntry* TextureStreaming::GetEntry(Texture2D* texture) const
+{
+    auto i = entries_.find(texture);
+    return i != entries_.end() ? &i->second : nullptr;
+}
+
+unsigned long long TextureStreaming::GetLevelMemory(const TextureStreamingEntry& entry, unsigned level)
+{
+    unsigned long long total = 0;
+    for (unsigned i = level; i < entry.numLevels_; ++i)
+        total += Max(entry.topLevelSize_ >> (2 * i), 1ULL);
+    return total;
+}
+
+void TextureStreaming::UpdateTargets(unsigned frameNumber)
+{
+    unsigned long long totalMemory = 0;
+    ea::vector<TextureStreamingEntry*> candidates;
+
+    for (auto& i : entries_)
+    {
+        TextureStreamingEntry& entry = i.second;
+
+        // Requested textures move to the requested level, others keep their target until evicted
+        if (entry.requestedLevel_ != M_MAX_UNSIGNED)
+        {
+            entry.targetLevel_ = Min(entry.requestedLevel_, entry.minResidentLevel_);
+            entry.lastRequestFrame_ = frameNumber;
+            entry.requestedLevel_ = M_MAX_UNSIGNED;
+        }
+
+        totalMemory += GetLevelMemory(entry, entry.targetLevel_);
+        if (entry.targetLevel_ < entry.minResidentLevel_)
+            candidates.push_back(&entry);
+    }
+
+    if (!budget_ || totalMemory <= budget_)
+        return;
+
+    // Evict textures that have not been requested for the longest time first. Among equally recent ones, drop the
+    // largest by one level at a time so that visible textures degrade evenly
+    ea::sort(candidates.begin(), candidates.end(), [](const TextureStreamingEntry* lhs, const TextureStreamingEntry* rhs)
+    {
+        if (lhs->lastRequestFrame_ != rhs->lastRequestFrame_)
+            return lhs->lastRequestFrame_ < rhs->lastRequestFrame_;
+        return GetLevelMemory(*lhs, lhs->targetLevel_) > GetLevelMemory(*rhs, rhs->targetLevel_);
+    });
+
+    unsigned begin = 0;
+    while (begin < candidates.size() && totalMemory > budget_)
+    {
+        const unsigned frame = candidates[begin]->lastRequestFrame_;
+        unsigned end = begin;
+        while (end < candidates.size() && candidates[end]->lastRequestFrame_ == frame)
+            ++end;
+
+        bool demoted = true;
+        while (demoted && totalMemory > budget_)
+        {
+            demoted = false;
+            for (unsigned i = begin; i < end && totalMemory > budget_; ++i)
+            {
+                TextureStreamingEntry& entry = *candidates[i];
+                if (entry.targetLevel_ >= entry.minResidentLevel_)
+                    continue;
+
+                totalMemory -= GetLevelMemory(entry, entry.targetLevel_) - GetLevelMemory(entry, entry.targetLevel_ + 1);
+                ++entry.targetLevel_;
+                demoted = true;
+            }
+        }
+
+        begin = end;
+    }
+}
+
+void TextureStreaming::ApplyTargets()
+{
+    auto* graphics = GetSubsystem<Graphics>();
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    const bool canReload = graphics && !graphics->IsDeviceLost() && cache && workQueue;
+
+    unsigned numUpdates = 0;
+    ea::vector<Texture2D*> failedTextures;
+
+    // Apply evictions before loads so that memory is released first
+    for (unsigned pass = 0; pass < 2; ++pass)
+    {
+        for (auto& i : entries_)
+        {
+            TextureStreamingEntry& entry = i.second;
+
+            if (entry.pendingLoad_)
+            {
+                if (pass == 0 && entry.pendingLoad_->done_.load(std::memory_order_acquire))
+                {
+                    if (!entry.pendingLoad_->success_)
+                        failedTextures.push_back(i.first);
+                    else
+                        FinishLoad(entry);
+                    entry.pendingLoad_.Reset();
+                }
+                continue;
+            }
+
+            const bool evict = entry.targetLevel_ > entry.residentLevel_;
+            if (entry.targetLevel_ == entry.residentLevel_ || evict != (pass == 0) || numUpdates >= maxUpdatesPerFrame_)
+                continue;
+
+            ++numUpdates;
+
+            // Without a GPU texture the residency change is bookkeeping only
+            if (!canReload || entry.imageName_.empty())
+            {
+                i.first->SetStreamingMipsToSkip(entry.targetLevel_);
+                entry.residentLevel_ = entry.targetLevel_;
+                continue;
+            }
+
+            SharedPtr<File> file = cache->GetFile(entry.imageName_, false);
+            if (!file)
+            {
+                failedTextures.push_back(i.first);
+                continue;
+            }
+
+            SharedPtr<TextureStreamingLoad> load(new TextureStreamingLoad());
+            load->image_ = context_->CreateObject<Image>();
+            load->image_->SetSRGB(i.first->GetSRGB());
+            load->level_ = entry.targetLevel_;
+            entry.pendingLoad_ = load;
+
+            workQueue->AddWorkItem([load, file]()
+            {
+                load->success_ = load->image_->Load(*file);
+                if (load->success_ && !load->image_->IsCompressed())
+                    load->image_->PrecalculateLevels();
+                load->done_.store(true, std::memory_order_release);
+            });
+        }
+    }
+
+    for (Texture2D* texture : failedTextures)
+    {
+        URHO3D_LOGWARNING("Failed to stream texture " + texture->GetName() + ", streaming disabled for it");
+        entries_.erase(texture);
+    }
+}
+
+void TextureStreaming::FinishLoad(TextureStreamingEntry& entry)
+{
+    Texture2D* texture = entry.texture_;
+    TextureStreamingLoad* load = entry.pendingLoad_;
+
+    texture->SetStreamingMipsToSkip(load->level_);
+    if (texture->SetData(load->image_))
+        entry.residentLevel_ = load->level_;
+    else
+        texture->SetStreamingMipsToSkip(entry.residentLevel_);
+}
+
+void TextureStreaming::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    auto* time = GetSubsystem<Time>();
+    Update(time ? time->GetFrameNumber() : 0);
+}
+
+}
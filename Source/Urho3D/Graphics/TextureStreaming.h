@@ -0,0 +1,148 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <EASTL/unordered_map.h>
+
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+class Image;
+class Texture2D;
+struct TextureStreamingLoad;
+
+/// Streaming state of a single texture.
+struct TextureStreamingEntry
+{
+    /// Texture.
+    WeakPtr<Texture2D> texture_;
+    /// Image resource name used to reload the texture with a different mip range.
+    ea::string imageName_;
+    /// Width of the most detailed streamable level.
+    int width_{};
+    /// Height of the most detailed streamable level.
+    int height_{};
+    /// Number of streamable mip levels.
+    unsigned numLevels_{};
+    /// Memory use of the most detailed level in bytes.
+    unsigned long long topLevelSize_{};
+    /// Least detailed level, which is always kept resident.
+    unsigned minResidentLevel_{};
+    /// Currently resident most detailed level.
+    unsigned residentLevel_{};
+    /// Level the texture is being moved to.
+    unsigned targetLevel_{};
+    /// Most detailed level requested since last update.
+    unsigned requestedLevel_{M_MAX_UNSIGNED};
+    /// Frame number of the last request.
+    unsigned lastRequestFrame_{};
+    /// Image reload in progress.
+    SharedPtr<TextureStreamingLoad> pendingLoad_;
+};
+
+/// %Texture mip streaming subsystem. Textures are loaded with their low mips first, and more detailed mips are streamed in
+/// according to the on-screen size requested by views, under a global texture memory budget.
+class URHO3D_API TextureStreaming : public Object
+{
+    URHO3D_OBJECT(TextureStreaming, Object);
+
+public:
+    /// Construct.
+    explicit TextureStreaming(Context* context);
+    /// Destruct.
+    ~TextureStreaming() override;
+
+    /// Enable or disable streaming for subsequently loaded textures.
+    void SetEnabled(bool enable) { enabled_ = enable; }
+    /// Set texture memory budget in bytes. Zero means unlimited.
+    void SetBudget(unsigned long long budget) { budget_ = budget; }
+    /// Set largest dimension of the low detail mip that is loaded first and always kept resident.
+    void SetMinResidentSize(int size) { minResidentSize_ = Max(size, 1); }
+    /// Set maximum number of texture reloads started per frame.
+    void SetMaxUpdatesPerFrame(unsigned count) { maxUpdatesPerFrame_ = Max(count, 1U); }
+
+    /// Register a texture that is being loaded from an image. Return mip levels to skip on the initial upload.
+    unsigned AddTexture(Texture2D* texture, const Image* image);
+    /// Register a texture with explicit dimensions. Return the initially resident level.
+    unsigned AddTexture(Texture2D* texture, const ea::string& imageName, int width, int height, unsigned numLevels,
+        unsigned long long topLevelSize);
+    /// Unregister a texture.
+    void RemoveTexture(Texture2D* texture);
+    /// Request a texture to be displayed at given size in pixels. Called by views for visible materials.
+    void RequestScreenSize(Texture2D* texture, float pixels);
+    /// Request a texture mip level to be resident.
+    void RequestLevel(Texture2D* texture, unsigned level);
+    /// Update residency targets and apply texture reloads. Called automatically at the end of each frame.
+    void Update(unsigned frameNumber);
+
+    /// Return whether streaming is enabled.
+    bool IsEnabled() const { return enabled_; }
+    /// Return texture memory budget in bytes.
+    unsigned long long GetBudget() const { return budget_; }
+    /// Return largest dimension of the low detail mip.
+    int GetMinResidentSize() const { return minResidentSize_; }
+    /// Return maximum number of texture reloads started per frame.
+    unsigned GetMaxUpdatesPerFrame() const { return maxUpdatesPerFrame_; }
+    /// Return number of streamed textures.
+    unsigned GetNumTextures() const { return entries_.size(); }
+    /// Return number of texture reloads in progress.
+    unsigned GetNumPendingLoads() const;
+    /// Return memory use of resident mips of all streamed textures.
+    unsigned long long GetResidentMemory() const;
+    /// Return memory use the current residency targets would need.
+    unsigned long long GetTargetMemory() const;
+    /// Return resident level of a texture, or M_MAX_UNSIGNED if not streamed.
+    unsigned GetResidentLevel(Texture2D* texture) const;
+    /// Return target level of a texture, or M_MAX_UNSIGNED if not streamed.
+    unsigned GetTargetLevel(Texture2D* texture) const;
+    /// Return streaming state of a texture, or null if not streamed.
+    const TextureStreamingEntry* GetEntry(Texture2D* texture) const;
+
+    /// Return memory use of a texture when given level is the most detailed resident one.
+    static unsigned long long GetLevelMemory(const TextureStreamingEntry& entry, unsigned level);
+
+private:
+    /// Choose target levels from requests and fit them into the budget.
+    void UpdateTargets(unsigned frameNumber);
+    /// Start or finish moving textures to their target levels.
+    void ApplyTargets();
+    /// Upload a finished reload to the texture.
+    void FinishLoad(TextureStreamingEntry& entry);
+    /// Handle end of frame.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+
+    /// Streamed textures.
+    ea::unordered_map<Texture2D*, TextureStreamingEntry> entries_;
+    /// Enabled flag.
+    bool enabled_{};
+    /// Texture memory budget.
+    unsigned long long budget_{};
+    /// Largest dimension of the low detail mip.
+    int minResidentSize_{64};
+    /// Maximum number of texture reloads started per frame.
+    unsigned maxUpdatesPerFrame_{4};
+};
+
+}
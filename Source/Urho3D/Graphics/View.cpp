@@ -46,6 +46,7 @@
 #include "../Graphics/Texture2DArray.h"
 #include "../Graphics/Texture3D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../IO/FileSystem.h"
@@ -87,21 +88,9 @@ public:
     {
     }
 
-    /// Intersection test for drawables.
-    void TestDrawables(Drawable** start, Drawable** end, bool inside) override
-    {
-        while (start != end)
-        {
-            Drawable* drawable = *start++;
-
-            if (drawable->GetCastShadows() && (drawable->GetDrawableFlags() & drawableFlags_) &&
-                (drawable->GetViewMask() & viewMask_))
-            {
-                if (inside || frustum_.IsInsideFast(drawable->GetWorldBoundingBox()))
-                    result_.push_back(drawable);
-            }
-        }
-    }
+protected:
+    /// Accept only shadowcasters.
+    bool AcceptDrawable(Drawable* drawable) const override { return drawable->GetCastShadows(); }
 };
 
 /// %Frustum octree query for zones and occluders.
@@ -115,21 +104,12 @@ public:
     {
     }
 
-    /// Intersection test for drawables.
-    void TestDrawables(Drawable** start, Drawable** end, bool inside) override
+protected:
+    /// Accept only zones and occluders.
+    bool AcceptDrawable(Drawable* drawable) const override
     {
-        while (start != end)
-        {
-            Drawable* drawable = *start++;
-            unsigned char flags = drawable->GetDrawableFlags();
-
-            if ((flags == DRAWABLE_ZONE || (flags == DRAWABLE_GEOMETRY && drawable->IsOccluder())) &&
-                (drawable->GetViewMask() & viewMask_))
-            {
-                if (inside || frustum_.IsInsideFast(drawable->GetWorldBoundingBox()))
-                    result_.push_back(drawable);
-            }
-        }
+        const unsigned char flags = drawable->GetDrawableFlags();
+        return flags == DRAWABLE_ZONE || (flags == DRAWABLE_GEOMETRY && drawable->IsOccluder());
     }
 };
 
@@ -145,7 +125,7 @@ public:
     {
     }
 
-    /// Intersection test for an octant.
+    /// Intersection test for an octant. Note: drawable occlusion is performed later in worker threads.
     Intersection TestOctant(const BoundingBox& box, bool inside) override
     {
         if (inside)
@@ -159,31 +139,13 @@ public:
         }
     }
 
-    /// Intersection test for drawables. Note: drawable occlusion is performed later in worker threads.
-    void TestDrawables(Drawable** start, Drawable** end, bool inside) override
-    {
-        while (start != end)
-        {
-            Drawable* drawable = *start++;
-
-            if ((drawable->GetDrawableFlags() & drawableFlags_) && (drawable->GetViewMask() & viewMask_))
-            {
-                if (inside || frustum_.IsInsideFast(drawable->GetWorldBoundingBox()))
-                    result_.push_back(drawable);
-            }
-        }
-    }
-
     /// Occlusion buffer.
     OcclusionBuffer* buffer_;
 };
 
-void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
+void CheckVisibilityWork(View* view, Drawable** start, Drawable** end, unsigned threadIndex)
 {
     URHO3D_PROFILE("CheckVisibilityWork");
-    auto* view = reinterpret_cast<View*>(item->aux_);
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
     OcclusionBuffer* buffer = view->occlusionBuffer_;
     const Matrix3x4& viewMatrix = view->cullCamera_->GetView();
     Vector3 viewZ = Vector3(viewMatrix.m20_, viewMatrix.m21_, viewMatrix.m22_);
@@ -192,12 +154,43 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     bool cameraZoneOverride = view->cameraZoneOverride_;
     PerThreadSceneResult& result = view->sceneResults_[threadIndex];
 
+    // Occlusion is tested in batches
+    static const unsigned occlusionBatchSize = 64;
+    BoundingBox occludeeBoxes[occlusionBatchSize];
+    bool occludeeVisible[occlusionBatchSize];
+    bool visible[occlusionBatchSize];
+
     while (start != end)
     {
-        Drawable* drawable = *start++;
+        const unsigned count = Min(static_cast<unsigned>(end - start), occlusionBatchSize);
+        Drawable** batchStart = start;
+        start += count;
+
+        unsigned numOccludees = 0;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            Drawable* drawable = batchStart[i];
+            visible[i] = !buffer || !drawable->IsOccludee();
+            if (!visible[i])
+                occludeeBoxes[numOccludees++] = drawable->GetWorldBoundingBox();
+        }
 
-        if (!buffer || !drawable->IsOccludee() || buffer->IsVisible(drawable->GetWorldBoundingBox()))
+        if (numOccludees)
         {
+            buffer->IsVisible(occludeeBoxes, numOccludees, occludeeVisible);
+            for (unsigned i = 0, j = 0; i < count; ++i)
+            {
+                if (!visible[i])
+                    visible[i] = occludeeVisible[j++];
+            }
+        }
+
+        for (unsigned i = 0; i < count; ++i)
+        {
+            if (!visible[i])
+                continue;
+
+            Drawable* drawable = batchStart[i];
             drawable->UpdateBatches(view->frame_);
             // If draw distance non-zero, update and check it
             float maxDistance = drawable->GetDrawDistance();
@@ -248,21 +241,9 @@ void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex)
     }
 }
 
-void ProcessLightWork(const WorkItem* item, unsigned threadIndex)
-{
-    URHO3D_PROFILE("ProcessLightWork");
-    auto* view = reinterpret_cast<View*>(item->aux_);
-    auto* query = reinterpret_cast<LightQueryResult*>(item->start_);
-
-    view->ProcessLight(*query, threadIndex);
-}
-
-void UpdateDrawableGeometriesWork(const WorkItem* item, unsigned threadIndex)
+void UpdateDrawableGeometriesWork(const FrameInfo& frame, Drawable** start, Drawable** end)
 {
     URHO3D_PROFILE("UpdateDrawableGeometriesWork");
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
 
     while (start != end)
     {
@@ -920,30 +901,13 @@ void View::GetDrawables()
             result.maxZ_ = 0.0f;
         }
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = tempDrawables.size() / numWorkItems;
-
-        auto start = tempDrawables.begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
+        // Use several batches per thread so that threads finishing early can steal the remaining work
+        const unsigned numThreads = queue->GetNumThreads() + 1; // Worker threads + main thread
+        const unsigned batchSize = Max(static_cast<unsigned>(tempDrawables.size()) / (numThreads * 4), 64u);
+        queue->ParallelFor(tempDrawables.size(), batchSize, [&](unsigned begin, unsigned end, unsigned threadIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = CheckVisibilityWork;
-            item->aux_ = this;
-
-            auto end = tempDrawables.end();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
-
-        queue->Complete(M_MAX_UNSIGNED);
+            CheckVisibilityWork(this, tempDrawables.data() + begin, tempDrawables.data() + end, threadIndex);
+        });
     }
 
     // Combine lights, geometries & scene Z range from the threads
@@ -998,6 +962,7 @@ void View::GetBatches()
     ProcessLights();
     GetLightBatches();
     GetBaseBatches();
+    FormBatchGroups();
 }
 
 void View::ProcessLights()
@@ -1009,21 +974,15 @@ void View::ProcessLights()
     lightQueryResults_.resize(lights_.size());
 
     for (unsigned i = 0; i < lightQueryResults_.size(); ++i)
-    {
-        SharedPtr<WorkItem> item = queue->GetFreeItem();
-        item->priority_ = M_MAX_UNSIGNED;
-        item->workFunction_ = ProcessLightWork;
-        item->aux_ = this;
-
-        LightQueryResult& query = lightQueryResults_[i];
-        query.light_ = lights_[i];
+        lightQueryResults_[i].light_ = lights_[i];
 
-        item->start_ = &query;
-        queue->AddWorkItem(item);
-    }
-
-    // Ensure all lights have been processed before proceeding
-    queue->Complete(M_MAX_UNSIGNED);
+    // Returns when all lights have been processed
+    queue->ParallelFor(lightQueryResults_.size(), 1, [this](unsigned begin, unsigned end, unsigned threadIndex)
+    {
+        URHO3D_PROFILE("ProcessLightWork");
+        for (unsigned i = begin; i < end; ++i)
+            ProcessLight(lightQueryResults_[i], threadIndex);
+    });
 }
 
 void View::GetLightBatches()
@@ -1222,9 +1181,16 @@ void View::GetBaseBatches()
 {
     URHO3D_PROFILE("GetBaseBatches");
 
+    auto* streaming = GetSubsystem<TextureStreaming>();
+    if (streaming && !streaming->GetNumTextures())
+        streaming = nullptr;
+
     for (auto i = geometries_.begin(); i != geometries_.end(); ++i)
     {
         Drawable* drawable = *i;
+        if (streaming)
+            RequestStreamedTextures(streaming, drawable);
+
         UpdateGeometryType type = drawable->GetUpdateGeometryType();
         if (type == UPDATE_MAIN_THREAD)
             nonThreadedGeometries_.push_back(drawable);
@@ -1375,26 +1341,16 @@ void View::UpdateGeometries()
                 }
             }
 
-            int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-            int drawablesPerItem = threadedGeometries_.size() / numWorkItems;
-
-            auto start = threadedGeometries_.begin();
-            for (int i = 0; i < numWorkItems; ++i)
+            // Split geometry update into batches in a worker thread while the main thread processes non-threaded geometries
+            const unsigned numThreads = queue->GetNumThreads() + 1; // Worker threads + main thread
+            const unsigned batchSize = Max(static_cast<unsigned>(threadedGeometries_.size()) / (numThreads * 4), 16u);
+            queue->AddWorkItem([this, queue, batchSize]()
             {
-                auto end = threadedGeometries_.end();
-                if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                    end = start + drawablesPerItem;
-
-                SharedPtr<WorkItem> item = queue->GetFreeItem();
-                item->priority_ = M_MAX_UNSIGNED;
-                item->workFunction_ = UpdateDrawableGeometriesWork;
-                item->aux_ = const_cast<FrameInfo*>(&frame_);
-                item->start_ = &(*start);
-                item->end_ = &(*end);
-                queue->AddWorkItem(item);
-
-                start = end;
-            }
+                queue->ParallelFor(threadedGeometries_.size(), batchSize, [this](unsigned begin, unsigned end, unsigned)
+                {
+                    UpdateDrawableGeometriesWork(frame_, threadedGeometries_.data() + begin, threadedGeometries_.data() + end);
+                });
+            }, M_MAX_UNSIGNED);
         }
 
         // While the work queue is processed, update non-threaded geometries
@@ -2916,6 +2872,29 @@ void View::CheckMaterialForAuxView(Material* material)
     material->MarkForAuxView(frame_.frameNumber_);
 }
 
+void View::RequestStreamedTextures(TextureStreaming* streaming, Drawable* drawable)
+{
+    // Estimate the on-screen size of the drawable in pixels from its largest world extent
+    const Vector3 size = drawable->GetWorldBoundingBox().Size();
+    const float extent = Max(Max(size.x_, size.y_), size.z_);
+    float viewExtent = 2.0f * cullCamera_->GetHalfViewSize();
+    if (!cullCamera_->IsOrthographic())
+        viewExtent *= Max(drawable->GetDistance(), cullCamera_->GetNearClip());
+    const float pixels = viewExtent > 0.0f ? extent / viewExtent * (float)viewSize_.y_ : 0.0f;
+
+    for (const SourceBatch& batch : drawable->GetBatches())
+    {
+        if (!batch.material_)
+            continue;
+
+        for (const auto& texture : batch.material_->GetTextures())
+        {
+            if (texture.second && texture.second->GetType() == Texture2D::GetTypeStatic())
+                streaming->RequestScreenSize(static_cast<Texture2D*>(texture.second.Get()), pixels);
+        }
+    }
+}
+
 void View::SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command)
 {
     ea::string vsDefines = command.vertexShaderDefines_.trimmed();
@@ -2941,32 +2920,9 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     if (allowInstancing && batch.geometryType_ == GEOM_STATIC && batch.geometry_->GetIndexBuffer())
         batch.geometryType_ = GEOM_INSTANCED;
 
+    // Instanced batches are merged into groups once all batches have been queued
     if (batch.geometryType_ == GEOM_INSTANCED)
-    {
-        BatchGroupKey key(batch);
-
-        auto i = queue.batchGroups_.find(key);
-        if (i == queue.batchGroups_.end())
-        {
-            // Create a new group based on the batch
-            // In case the group remains below the instancing limit, do not enable instancing shaders yet
-            BatchGroup newGroup(batch);
-            newGroup.geometryType_ = GEOM_STATIC;
-            renderer_->SetBatchShaders(newGroup, tech, allowShadows, queue);
-            newGroup.CalculateSortKey();
-            i = queue.batchGroups_.insert(ea::make_pair(key, newGroup)).first;
-        }
-
-        int oldSize = i->second.instances_.size();
-        i->second.AddTransforms(batch);
-        // Convert to using instancing shaders when the instancing limit is reached
-        if (oldSize < minInstances_ && (int) i->second.instances_.size() >= minInstances_)
-        {
-            i->second.geometryType_ = GEOM_INSTANCED;
-            renderer_->SetBatchShaders(i->second, tech, allowShadows, queue);
-            i->second.CalculateSortKey();
-        }
-    }
+        queue.AddInstancedBatch(batch, tech);
     else
     {
         renderer_->SetBatchShaders(batch, tech, allowShadows, queue);
@@ -2989,6 +2945,53 @@ void View::AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, boo
     }
 }
 
+void View::FormBatchGroups()
+{
+    URHO3D_PROFILE("FormBatchGroups");
+
+    for (auto i = batchQueues_.begin(); i != batchQueues_.end(); ++i)
+        FormBatchGroups(i->second);
+
+    for (auto i = lightQueues_.begin(); i != lightQueues_.end(); ++i)
+    {
+        for (unsigned j = 0; j < i->shadowSplits_.size(); ++j)
+            FormBatchGroups(i->shadowSplits_[j].shadowBatches_);
+        FormBatchGroups(i->litBaseBatches_);
+        FormBatchGroups(i->litBatches_);
+    }
+}
+
+void View::FormBatchGroups(BatchQueue& queue)
+{
+    if (queue.instancedBatches_.empty())
+        return;
+
+    // Sorting by group key makes the batches of each group adjacent, so groups are formed in a single linear pass
+    queue.SortInstancedBatches();
+
+    const ea::vector<BatchSortKey>& sortKeys = queue.sortKeys_;
+    for (unsigned i = 0; i < sortKeys.size();)
+    {
+        const unsigned firstIndex = sortKeys[i].index_;
+        const BatchGroupKey key(queue.instancedBatches_[firstIndex]);
+
+        BatchGroup& group = queue.batchGroups_.emplace_back(queue.instancedBatches_[firstIndex]);
+        for (; i < sortKeys.size(); ++i)
+        {
+            const Batch& batch = queue.instancedBatches_[sortKeys[i].index_];
+            if (BatchGroupKey(batch) != key)
+                break;
+            group.AddTransforms(batch);
+        }
+
+        // In case the group remains below the instancing limit, do not use instancing shaders. Instancing is never
+        // requested for queues that disallow shadows, so shadows are always allowed here
+        group.geometryType_ = (int)group.instances_.size() >= minInstances_ ? GEOM_INSTANCED : GEOM_STATIC;
+        renderer_->SetBatchShaders(group, queue.instancedTechniques_[firstIndex], true, queue);
+        group.CalculateSortKey();
+    }
+}
+
 void View::PrepareInstancingBuffer()
 {
     // Prepare instancing buffer from the source view
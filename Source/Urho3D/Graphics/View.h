@@ -47,6 +47,7 @@ class RenderSurface;
 class Technique;
 class Texture;
 class Texture2D;
+class TextureStreaming;
 class Viewport;
 class Zone;
 struct RenderPathCommand;
@@ -110,8 +111,7 @@ static const unsigned MAX_VIEWPORT_TEXTURES = 2;
 /// Internal structure for 3D rendering work. Created for each backbuffer and texture viewport, but not for shadow cameras.
 class URHO3D_API View : public Object
 {
-    friend void CheckVisibilityWork(const WorkItem* item, unsigned threadIndex);
-    friend void ProcessLightWork(const WorkItem* item, unsigned threadIndex);
+    friend void CheckVisibilityWork(View* view, Drawable** start, Drawable** end, unsigned threadIndex);
 
     URHO3D_OBJECT(View, Object);
 
@@ -268,10 +268,16 @@ private:
     Technique* GetTechnique(Drawable* drawable, Material* material);
     /// Check if material should render an auxiliary view (if it has a camera attached).
     void CheckMaterialForAuxView(Material* material);
+    /// Request streamed textures of a visible drawable's materials at its projected on-screen size.
+    void RequestStreamedTextures(TextureStreaming* streaming, Drawable* drawable);
     /// Set shader defines for a batch queue if used.
     void SetQueueShaderDefines(BatchQueue& queue, const RenderPathCommand& command);
     /// Choose shaders for a batch and add it to queue.
     void AddBatchToQueue(BatchQueue& queue, Batch& batch, Technique* tech, bool allowInstancing = true, bool allowShadows = true);
+    /// Merge queued instanced batches into batch groups in all batch queues.
+    void FormBatchGroups();
+    /// Merge queued instanced batches into batch groups and assign their shaders.
+    void FormBatchGroups(BatchQueue& queue);
     /// Prepare instancing buffer by filling it with all instance transforms.
     void PrepareInstancingBuffer();
     /// Set up a light volume rendering batch.
@@ -0,0 +1,131 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/BitStream.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Number of bits used to store the bit length of a zigzag encoded value.
+const unsigned ZIGZAG_LENGTH_BITS = 5;
+
+/// Return number of significant bits in a value.
+unsigned GetBitLength(unsigned value)
+{
+    unsigned length = 0;
+    while (value)
+    {
+        ++length;
+        value >>= 1u;
+    }
+    return length;
+}
+
+/// Map signed values to unsigned so that values close to zero stay small.
+unsigned EncodeZigZag(int value)
+{
+    return (static_cast<unsigned>(value) << 1u) ^ static_cast<unsigned>(value >> 31);
+}
+
+/// Map zigzag encoded values back to signed.
+int DecodeZigZag(unsigned value)
+{
+    return static_cast<int>(value >> 1u) ^ -static_cast<int>(value & 1u);
+}
+
+}
+
+void BitWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    while (numBits)
+    {
+        const unsigned bitOffset = numBits_ & 7u;
+        if (!bitOffset)
+            buffer_.push_back(0);
+
+        const unsigned count = ea::min(8u - bitOffset, numBits);
+        buffer_.back() |= static_cast<unsigned char>((value & ((1u << count) - 1u)) << bitOffset);
+        value >>= count;
+        numBits -= count;
+        numBits_ += count;
+    }
+}
+
+void BitWriter::WriteZigZag(int value)
+{
+    const unsigned encoded = EncodeZigZag(ea::clamp(value, -MAX_ZIGZAG_VALUE, MAX_ZIGZAG_VALUE));
+    const unsigned length = GetBitLength(encoded);
+    WriteBits(length, ZIGZAG_LENGTH_BITS);
+    WriteBits(encoded, length);
+}
+
+void BitWriter::Clear()
+{
+    buffer_.clear();
+    numBits_ = 0;
+}
+
+unsigned BitWriter::GetZigZagSize(int value)
+{
+    return ZIGZAG_LENGTH_BITS + GetBitLength(EncodeZigZag(ea::clamp(value, -MAX_ZIGZAG_VALUE, MAX_ZIGZAG_VALUE)));
+}
+
+BitReader::BitReader(const void* data, unsigned size) :
+    data_(static_cast<const unsigned char*>(data)),
+    size_(size)
+{
+}
+
+unsigned BitReader::ReadBits(unsigned numBits)
+{
+    unsigned value = 0;
+    unsigned shift = 0;
+    while (numBits)
+    {
+        const unsigned bitOffset = position_ & 7u;
+        const unsigned count = ea::min(8u - bitOffset, numBits);
+        if (!IsEof())
+        {
+            const unsigned bits = (data_[position_ >> 3u] >> bitOffset) & ((1u << count) - 1u);
+            value |= bits << shift;
+        }
+        shift += count;
+        numBits -= count;
+        position_ += count;
+    }
+    return value;
+}
+
+int BitReader::ReadZigZag()
+{
+    const unsigned length = ReadBits(ZIGZAG_LENGTH_BITS);
+    return DecodeZigZag(ReadBits(length));
+}
+
+}
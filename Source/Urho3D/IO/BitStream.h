@@ -0,0 +1,94 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Urho3D.h>
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Dynamically sized buffer that can be written to as a bit-packed stream. Bits are stored starting from the lowest bit of each byte.
+/// @nobind
+class URHO3D_API BitWriter
+{
+public:
+    /// Largest magnitude of a value that can be written with WriteZigZag.
+    static constexpr int MAX_ZIGZAG_VALUE = (1 << 30) - 1;
+
+    /// Write the lowest bits of a value, up to 32 bits.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write a bool as a single bit.
+    void WriteBool(bool value) { WriteBits(value ? 1u : 0u, 1); }
+    /// Write a signed value in range [-MAX_ZIGZAG_VALUE, MAX_ZIGZAG_VALUE] as its zigzag encoded bit length followed by the bits. Values close to zero take the fewest bits.
+    void WriteZigZag(int value);
+    /// Reset to zero size.
+    void Clear();
+
+    /// Return number of bits WriteZigZag uses for a value.
+    static unsigned GetZigZagSize(int value);
+
+    /// Return data.
+    const unsigned char* GetData() const { return buffer_.data(); }
+
+    /// Return size in bytes, including the partially written last byte.
+    unsigned GetSize() const { return buffer_.size(); }
+
+    /// Return number of bits written.
+    unsigned GetNumBits() const { return numBits_; }
+
+private:
+    /// Written bytes.
+    ea::vector<unsigned char> buffer_;
+    /// Number of bits written.
+    unsigned numBits_{};
+};
+
+/// Memory area that can be read from as a bit-packed stream written by BitWriter.
+/// @nobind
+class URHO3D_API BitReader
+{
+public:
+    /// Construct with a pointer and size.
+    BitReader(const void* data, unsigned size);
+
+    /// Read bits into the lowest bits of the returned value, up to 32 bits. Bits past the end read as zero.
+    unsigned ReadBits(unsigned numBits);
+    /// Read a bool from a single bit.
+    bool ReadBool() { return ReadBits(1) != 0; }
+    /// Read a signed value written by BitWriter::WriteZigZag.
+    int ReadZigZag();
+    /// Return whether the end of the data has been reached.
+    bool IsEof() const { return position_ >= size_ * 8u; }
+
+private:
+    /// Data.
+    const unsigned char* data_;
+    /// Size in bytes.
+    unsigned size_;
+    /// Read position in bits.
+    unsigned position_{};
+};
+
+}
@@ -136,6 +136,42 @@ bool File::Open(PackageFile* package, const ea::string& fileName)
     if (!entry)
         return false;
 
+    Close();
+
+    if (package->IsCompressed() && package->GetVersion() >= PackageFile::BLOCK_TABLE_VERSION)
+    {
+        if (!OpenBlockCompressed(package, *entry))
+        {
+            URHO3D_LOGERROR("Could not open package file " + fileName);
+            Close();
+            return false;
+        }
+
+        name_ = fileName;
+        return true;
+    }
+
+    // Read uncompressed entries directly from the memory mapping without opening a file handle
+    ea::span<const unsigned char> mappedData = package->GetEntryData(fileName);
+    if (mappedData.data())
+    {
+        name_ = fileName;
+        mode_ = FILE_READ;
+        package_ = package;
+        mappedData_ = mappedData.data();
+        checksum_ = entry->checksum_;
+        size_ = entry->size_;
+        position_ = 0;
+        compressed_ = false;
+        return true;
+    }
+
+    if (entry->offset_ > M_MAX_UNSIGNED)
+    {
+        URHO3D_LOGERROR("Package file entry " + fileName + " is beyond 4 GB and can only be read from a memory mapped package");
+        return false;
+    }
+
     bool success = OpenInternal(package->GetName(), FILE_READ, true);
     if (!success)
     {
@@ -144,7 +180,7 @@ bool File::Open(PackageFile* package, const ea::string& fileName)
     }
 
     name_ = fileName;
-    offset_ = entry->offset_;
+    offset_ = static_cast<unsigned>(entry->offset_);
     checksum_ = entry->checksum_;
     size_ = entry->size_;
     compressed_ = package->IsCompressed();
@@ -173,6 +209,23 @@ unsigned File::Read(void* dest, unsigned size)
     if (!size)
         return 0;
 
+    if (mappedData_)
+    {
+        memcpy(dest, mappedData_ + position_, size);
+        position_ += size;
+        return size;
+    }
+
+    if (blockSize_)
+    {
+        if (!ReadBlockCompressed(dest, size))
+        {
+            URHO3D_LOGERROR("Error while reading from file " + GetName());
+            return 0;
+        }
+        return size;
+    }
+
 #ifdef __ANDROID__
     if (assetHandle_ && !compressed_)
     {
@@ -281,6 +334,13 @@ unsigned File::Seek(unsigned position)
     if (mode_ == FILE_READ && position > size_)
         position = size_;
 
+    // Memory mapped and block compressed files support random access
+    if (mappedData_ || blockSize_)
+    {
+        position_ = position;
+        return position_;
+    }
+
     if (compressed_)
     {
         // Start over from the beginning
@@ -353,7 +413,7 @@ unsigned File::Write(const void* data, unsigned size)
 
 unsigned File::GetChecksum()
 {
-    if (offset_ || checksum_)
+    if (offset_ || package_ || checksum_)
         return checksum_;
 #ifdef __ANDROID__
     if ((!handle_ && !assetHandle_) || mode_ == FILE_WRITE)
@@ -393,6 +453,21 @@ void File::Close()
     readBuffer_.reset();
     inputBuffer_.reset();
 
+    blockSize_ = 0;
+    blockEnds_.clear();
+    blockData_ = nullptr;
+    mappedEntryData_ = nullptr;
+
+    if (package_)
+    {
+        mappedData_ = nullptr;
+        package_ = nullptr;
+        position_ = 0;
+        size_ = 0;
+        offset_ = 0;
+        checksum_ = 0;
+    }
+
     if (handle_)
     {
         fclose((FILE*)handle_);
@@ -413,9 +488,9 @@ void File::Flush()
 bool File::IsOpen() const
 {
 #ifdef __ANDROID__
-    return handle_ != 0 || assetHandle_ != 0;
+    return handle_ != 0 || assetHandle_ != 0 || package_ != nullptr;
 #else
-    return handle_ != nullptr;
+    return handle_ != nullptr || package_ != nullptr;
 #endif
 }
 
@@ -546,6 +621,120 @@ void File::SeekInternal(unsigned newPosition)
         fseek((FILE*)handle_, newPosition, SEEK_SET);
 }
 
+bool File::OpenBlockCompressed(PackageFile* package, const PackageEntry& entry)
+{
+    if (package->IsMemoryMapped())
+    {
+        // Keep the package alive while blocks are decompressed from the mapping
+        package_ = package;
+        mappedEntryData_ = package->GetMappedData() + entry.offset_;
+        name_ = package->GetName();
+        mode_ = FILE_READ;
+    }
+    else
+    {
+        if (entry.offset_ > M_MAX_UNSIGNED || !OpenInternal(package->GetName(), FILE_READ, true))
+            return false;
+        offset_ = static_cast<unsigned>(entry.offset_);
+    }
+
+    checksum_ = entry.checksum_;
+    size_ = entry.size_;
+    position_ = 0;
+    compressed_ = true;
+
+    // Entry starts with the block size, the number of blocks and the block table
+    unsigned header[2];
+    if (!ReadPackageData(header, 0, sizeof header) || !header[0] || header[1] != (size_ + header[0] - 1) / header[0])
+        return false;
+
+    blockEnds_.resize(header[1]);
+    if (!ReadPackageData(blockEnds_.data(), sizeof header, blockEnds_.size() * sizeof(unsigned)))
+        return false;
+
+    blockSize_ = header[0];
+    blockDataOffset_ = sizeof header + blockEnds_.size() * sizeof(unsigned);
+    currentBlock_ = M_MAX_UNSIGNED;
+    readBuffer_ = new unsigned char[blockSize_];
+    inputBuffer_ = new unsigned char[LZ4_compressBound(blockSize_)];
+    return true;
+}
+
+bool File::ReadBlockCompressed(void* dest, unsigned size)
+{
+    auto* destPtr = static_cast<unsigned char*>(dest);
+    while (size)
+    {
+        const unsigned blockIndex = position_ / blockSize_;
+        if (blockIndex != currentBlock_ && !LoadBlock(blockIndex))
+            return false;
+
+        const unsigned blockStart = blockIndex * blockSize_;
+        const unsigned copySize = Min(Min(blockSize_, size_ - blockStart) - (position_ - blockStart), size);
+        memcpy(destPtr, blockData_ + position_ - blockStart, copySize);
+        destPtr += copySize;
+        size -= copySize;
+        position_ += copySize;
+    }
+    return true;
+}
+
+bool File::ReadPackageData(void* dest, unsigned offset, unsigned size)
+{
+    if (mappedEntryData_)
+    {
+        if (mappedEntryData_ + offset + size > package_->GetMappedData() + package_->GetMappedSize())
+            return false;
+        memcpy(dest, mappedEntryData_ + offset, size);
+        return true;
+    }
+
+    SeekInternal(offset_ + offset);
+    return ReadInternal(dest, size);
+}
+
+bool File::LoadBlock(unsigned index)
+{
+    const unsigned begin = index ? blockEnds_[index - 1] & ~PackageFile::STORED_BLOCK_FLAG : 0;
+    const unsigned end = blockEnds_[index] & ~PackageFile::STORED_BLOCK_FLAG;
+    const bool stored = (blockEnds_[index] & PackageFile::STORED_BLOCK_FLAG) != 0;
+    const unsigned packedSize = end - begin;
+    const unsigned unpackedSize = Min(blockSize_, size_ - index * blockSize_);
+    if (end < begin || packedSize > static_cast<unsigned>(LZ4_compressBound(blockSize_)) || (stored && packedSize != unpackedSize))
+        return false;
+
+    currentBlock_ = M_MAX_UNSIGNED;
+
+    // Stored blocks in the memory mapping are used in place
+    const unsigned char* packedData = nullptr;
+    if (mappedEntryData_)
+    {
+        packedData = mappedEntryData_ + blockDataOffset_ + begin;
+        if (packedData + packedSize > package_->GetMappedData() + package_->GetMappedSize())
+            return false;
+    }
+    else
+    {
+        if (!ReadPackageData(inputBuffer_.get(), blockDataOffset_ + begin, packedSize))
+            return false;
+        packedData = inputBuffer_.get();
+    }
+
+    if (stored)
+        blockData_ = packedData;
+    else
+    {
+        const int result = LZ4_decompress_safe(reinterpret_cast<const char*>(packedData),
+            reinterpret_cast<char*>(readBuffer_.get()), static_cast<int>(packedSize), static_cast<int>(unpackedSize));
+        if (result != static_cast<int>(unpackedSize))
+            return false;
+        blockData_ = readBuffer_.get();
+    }
+
+    currentBlock_ = index;
+    return true;
+}
+
 void File::ReadBinary(ea::vector<unsigned char>& buffer)
 {
     buffer.clear();
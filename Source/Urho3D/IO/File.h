@@ -59,6 +59,7 @@ enum FileMode
 };
 
 class PackageFile;
+struct PackageEntry;
 
 /// %File opened either through the filesystem or from within a package file.
 class URHO3D_API File : public Object, public AbstractFile
@@ -110,7 +111,14 @@ public:
 
     /// Return whether the file originates from a package.
     /// @property
-    bool IsPackaged() const { return offset_ != 0; }
+    bool IsPackaged() const { return offset_ != 0 || package_ != nullptr; }
+
+    /// Return whether the file is read directly from a memory mapped package.
+    bool IsMemoryMapped() const { return mappedData_ != nullptr; }
+
+    /// Return file contents in the memory mapped package without copying, or null if not memory mapped. Valid while the file is open.
+    /// @nobind
+    const unsigned char* GetMappedData() const { return mappedData_; }
 
     /// Reads a binary file to buffer.
     void ReadBinary(ea::vector<unsigned char>& buffer);
@@ -135,6 +143,14 @@ private:
     bool ReadInternal(void* dest, unsigned size);
     /// Seek in file internally using either C standard IO functions or SDL RWops for Android asset files.
     void SeekInternal(unsigned newPosition);
+    /// Open a package entry with a block table. Return true if successful.
+    bool OpenBlockCompressed(PackageFile* package, const PackageEntry& entry);
+    /// Read bytes of a block compressed package entry. Return true if successful.
+    bool ReadBlockCompressed(void* dest, unsigned size);
+    /// Read raw bytes of a package entry at given offset from the entry start. Return true if successful.
+    bool ReadPackageData(void* dest, unsigned offset, unsigned size);
+    /// Make the block containing the current position available in the block data. Return true if successful.
+    bool LoadBlock(unsigned index);
 
     /// Absolute file name.
     ea::string absoluteFileName_;
@@ -156,6 +172,22 @@ private:
     unsigned readBufferSize_;
     /// Start position within a package file, 0 for regular files.
     unsigned offset_;
+    /// Package file of a memory mapped file, keeps the mapping alive.
+    SharedPtr<PackageFile> package_;
+    /// File contents in the memory mapped package.
+    const unsigned char* mappedData_{};
+    /// Entry data of a block compressed file in the memory mapped package.
+    const unsigned char* mappedEntryData_{};
+    /// Uncompressed block size of a block compressed package entry, 0 for other files.
+    unsigned blockSize_{};
+    /// Offset of the first block from the entry start.
+    unsigned blockDataOffset_{};
+    /// End offsets of the compressed blocks relative to the first block, with the stored block flag.
+    ea::vector<unsigned> blockEnds_;
+    /// Index of the block in the block data.
+    unsigned currentBlock_{};
+    /// Uncompressed data of the current block. Points either to the read buffer or to the memory mapping.
+    const unsigned char* blockData_{};
     /// Content checksum.
     unsigned checksum_;
     /// Compression flag.
@@ -31,7 +31,8 @@
 #include <windows.h>
 #elif __linux__
 #include <sys/inotify.h>
-#include <sys/ioctl.h>
+#include <poll.h>
+#include <cerrno>
 extern "C"
 {
 // Need read/close for inotify
@@ -46,14 +47,37 @@ extern "C"
 
 namespace Urho3D
 {
-#ifndef __APPLE__
+#ifdef _WIN32
 static const unsigned BUFFERSIZE = 4096;
+#elif defined(__linux__)
+/// Size of the inotify read buffer. Large enough to drain thousands of events per read.
+static const unsigned BUFFERSIZE = 64 * 1024;
+/// Time in milliseconds to wait for inotify events before checking whether the thread should exit.
+static const int POLL_TIMEOUT_MS = 100;
+/// Events watched for each directory.
+static const unsigned WATCH_FLAGS = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO;
 #endif
 
+/// Merge the kind of a new change into the kind of the pending change of the same file.
+static FileChangeKind MergeFileChangeKinds(FileChangeKind pending, FileChangeKind change)
+{
+    // File created and then written is still new
+    if (pending == FILECHANGE_ADDED && change == FILECHANGE_MODIFIED)
+        return FILECHANGE_ADDED;
+    // File renamed and then written keeps the rename, so the old name is not lost
+    if (pending == FILECHANGE_RENAMED && change == FILECHANGE_MODIFIED)
+        return FILECHANGE_RENAMED;
+    // File replaced by deleting and creating it again, as many editors and tools do
+    if (pending == FILECHANGE_REMOVED && change == FILECHANGE_ADDED)
+        return FILECHANGE_MODIFIED;
+    return change;
+}
+
 FileWatcher::FileWatcher(Context* context) :
     Object(context),
     fileSystem_(GetSubsystem<FileSystem>()),
     delay_(1.0f),
+    maxDelay_(5.0f),
     watchSubDirs_(false)
 {
 #ifdef URHO3D_FILEWATCHER
@@ -116,49 +140,22 @@ bool FileWatcher::StartWatching(const ea::string& pathName, bool watchSubDirs)
         return false;
     }
 #elif defined(__linux__)
-    int flags = IN_CREATE | IN_DELETE | IN_MODIFY | IN_ATTRIB | IN_MOVED_FROM | IN_MOVED_TO;
-    int handle = inotify_add_watch(watchHandle_, pathName.c_str(), (unsigned)flags);
+    path_ = AddTrailingSlash(pathName);
+    watchSubDirs_ = watchSubDirs;
 
-    if (handle < 0)
+    // Store the root path as empty string, sub-directories are stored relative to it
+    AddWatches(EMPTY_STRING, false);
+    if (dirHandle_.empty())
     {
         URHO3D_LOGERROR("Failed to start watching path " + pathName);
+        path_.clear();
         return false;
     }
-    else
-    {
-        // Store the root path here when reconstructed with inotify later
-        dirHandle_[handle] = "";
-        path_ = AddTrailingSlash(pathName);
-        watchSubDirs_ = watchSubDirs;
 
-        if (watchSubDirs_)
-        {
-            ea::vector<ea::string> subDirs;
-            fileSystem_->ScanDir(subDirs, pathName, "*", SCAN_DIRS, true);
-
-            for (unsigned i = 0; i < subDirs.size(); ++i)
-            {
-                ea::string subDirFullPath = AddTrailingSlash(path_ + subDirs[i]);
+    Run();
 
-                // Don't watch ./ or ../ sub-directories
-                if (!subDirFullPath.ends_with("./"))
-                {
-                    handle = inotify_add_watch(watchHandle_, subDirFullPath.c_str(), (unsigned)flags);
-                    if (handle < 0)
-                        URHO3D_LOGERROR("Failed to start watching subdirectory path " + subDirFullPath);
-                    else
-                    {
-                        // Store sub-directory to reconstruct later from inotify
-                        dirHandle_[handle] = AddTrailingSlash(subDirs[i]);
-                    }
-                }
-            }
-        }
-        Run();
-
-        URHO3D_LOGDEBUG("Started watching path " + pathName);
-        return true;
-    }
+    URHO3D_LOGDEBUG("Started watching path " + pathName);
+    return true;
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
     if (!supported_)
     {
@@ -216,6 +213,8 @@ void FileWatcher::StopWatching()
 #ifdef _WIN32
         CloseHandle((HANDLE)dirHandle_);
 #elif defined(__linux__)
+        // The thread modifies the watches when directories are created, so stop it first
+        Stop();
         for (auto i = dirHandle_.begin(); i != dirHandle_.end(); ++i)
             inotify_rm_watch(watchHandle_, i->first);
         dirHandle_.clear();
@@ -223,7 +222,7 @@ void FileWatcher::StopWatching()
         CloseFileWatcher(watcher_);
 #endif
 
-#ifndef __APPLE__
+#ifdef _WIN32
         Stop();
 #endif
 
@@ -237,6 +236,11 @@ void FileWatcher::SetDelay(float interval)
     delay_ = Max(interval, 0.0f);
 }
 
+void FileWatcher::SetMaxDelay(float interval)
+{
+    maxDelay_ = Max(interval, 0.0f);
+}
+
 void FileWatcher::ThreadFunction()
 {
 #ifdef URHO3D_FILEWATCHER
@@ -296,57 +300,90 @@ void FileWatcher::ThreadFunction()
         }
     }
 #elif defined(__linux__)
-    unsigned char buffer[BUFFERSIZE];
+    alignas(inotify_event) unsigned char buffer[BUFFERSIZE];
 
     while (shouldRun_)
     {
-        unsigned available = 0;
-        ioctl(watchHandle_, FIONREAD, &available);
-
-        if (available == 0)
-        {
-            Time::Sleep(100);
+        pollfd pollHandle{ watchHandle_, POLLIN, 0 };
+        if (poll(&pollHandle, 1, POLL_TIMEOUT_MS) <= 0)
             continue;
-        }
-
-        int i = 0;
-        auto length = (int)read(watchHandle_, buffer, Min(available, sizeof(buffer)));
 
+        const auto length = (int)read(watchHandle_, buffer, sizeof(buffer));
         if (length < 0)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
             return;
+        }
 
+        // Renames are reported as pairs of events with the same cookie, normally within one read
         ea::unordered_map<unsigned, FileChange> renames;
+        int i = 0;
         while (i < length)
         {
             auto* event = (inotify_event*)&buffer[i];
+            i += sizeof(inotify_event) + event->len;
 
-            if (event->len > 0)
+            if (event->mask & IN_Q_OVERFLOW)
             {
-                ea::string fileName = dirHandle_[event->wd] + event->name;
-
-                if (event->mask == IN_CREATE)
-                    AddChange({FILECHANGE_ADDED, fileName, EMPTY_STRING});
-                else if (event->mask & IN_DELETE)
-                    AddChange({FILECHANGE_REMOVED, fileName, EMPTY_STRING});
-                else if (event->mask & IN_MODIFY || event->mask & IN_ATTRIB)
-                    AddChange({FILECHANGE_MODIFIED, fileName, EMPTY_STRING});
-                else if (event->mask & IN_MOVE)
-                {
-                    auto& entry = renames[event->cookie];
-                    if (event->mask & IN_MOVED_FROM)
-                        entry.oldFileName_ = fileName;
-                    else if (event->mask & IN_MOVED_TO)
-                        entry.fileName_ = fileName;
+                URHO3D_LOGWARNING("File watcher event queue overflow, some changes in " + path_ + " were lost");
+                continue;
+            }
 
-                    if (!entry.oldFileName_.empty() && !entry.fileName_.empty())
-                    {
-                        entry.kind_ = FILECHANGE_RENAMED;
-                        AddChange(entry);
-                    }
+            if (event->mask & IN_IGNORED)
+            {
+                // Watched directory was deleted or moved away
+                dirHandle_.erase(event->wd);
+                continue;
+            }
+
+            auto dirIter = dirHandle_.find(event->wd);
+            if (event->len == 0 || dirIter == dirHandle_.end())
+                continue;
+
+            ea::string fileName = dirIter->second + event->name;
+
+            if (event->mask & IN_ISDIR)
+            {
+                // Start watching new sub-directories. Files may be created in them before the watch is added,
+                // so report existing files too
+                if (watchSubDirs_ && (event->mask & (IN_CREATE | IN_MOVED_TO)))
+                    AddWatches(AddTrailingSlash(fileName), true);
+                else if (event->mask & IN_MOVED_FROM)
+                    RemoveWatches(AddTrailingSlash(fileName));
+                continue;
+            }
+
+            if (event->mask & IN_CREATE)
+                AddChange({FILECHANGE_ADDED, fileName, EMPTY_STRING});
+            else if (event->mask & IN_DELETE)
+                AddChange({FILECHANGE_REMOVED, fileName, EMPTY_STRING});
+            else if (event->mask & IN_MODIFY || event->mask & IN_ATTRIB)
+                AddChange({FILECHANGE_MODIFIED, fileName, EMPTY_STRING});
+            else if (event->mask & IN_MOVE)
+            {
+                auto& entry = renames[event->cookie];
+                if (event->mask & IN_MOVED_FROM)
+                    entry.oldFileName_ = ea::move(fileName);
+                else if (event->mask & IN_MOVED_TO)
+                    entry.fileName_ = ea::move(fileName);
+
+                if (!entry.oldFileName_.empty() && !entry.fileName_.empty())
+                {
+                    entry.kind_ = FILECHANGE_RENAMED;
+                    AddChange(entry);
+                    renames.erase(event->cookie);
                 }
             }
+        }
 
-            i += sizeof(inotify_event) + event->len;
+        // Files moved into or out of the watched directory have no pair
+        for (const auto& [cookie, entry] : renames)
+        {
+            if (!entry.fileName_.empty())
+                AddChange({FILECHANGE_ADDED, entry.fileName_, EMPTY_STRING});
+            else
+                AddChange({FILECHANGE_REMOVED, entry.oldFileName_, EMPTY_STRING});
         }
     }
 #elif defined(__APPLE__) && !defined(IOS) && !defined(TVOS)
@@ -393,12 +430,31 @@ void FileWatcher::AddChange(const FileChange& change)
 {
     MutexLock lock(changesMutex_);
 
+    lastChangeTimer_.Reset();
+    if (changes_.empty())
+        oldestChangeTimer_.Reset();
+
     auto it = changes_.find(change.fileName_);
     if (it == changes_.end())
         changes_[change.fileName_].change_ = change;
     else
+    {
+        FileChange& pendingChange = it->second.change_;
+
+        // File created and deleted again before the change was reported: nothing to report
+        if (pendingChange.kind_ == FILECHANGE_ADDED && change.kind_ == FILECHANGE_REMOVED)
+        {
+            changes_.erase(it);
+            return;
+        }
+
+        pendingChange.kind_ = MergeFileChangeKinds(pendingChange.kind_, change.kind_);
+        if (pendingChange.kind_ == FILECHANGE_RENAMED && change.kind_ == FILECHANGE_RENAMED)
+            pendingChange.oldFileName_ = change.oldFileName_;
+
         // Reset the timer associated with the filename. Will be notified once timer exceeds the delay
         it->second.timer_.Reset();
+    }
 }
 
 bool FileWatcher::GetNextChange(FileChange& dest)
@@ -425,4 +481,81 @@ bool FileWatcher::GetNextChange(FileChange& dest)
     }
 }
 
+bool FileWatcher::GetNextBatch(ea::vector<FileChange>& dest)
+{
+    MutexLock lock(changesMutex_);
+
+    dest.clear();
+    if (changes_.empty())
+        return false;
+
+    // Wait until the changes settle down, but do not hold them back forever when files are changed continuously
+    const auto delayMsec = (unsigned)(delay_ * 1000.0f);
+    const auto maxDelayMsec = (unsigned)(maxDelay_ * 1000.0f);
+    if (lastChangeTimer_.GetMSec(false) < delayMsec && oldestChangeTimer_.GetMSec(false) < maxDelayMsec)
+        return false;
+
+    dest.reserve(changes_.size());
+    for (auto& [fileName, timedChange] : changes_)
+        dest.push_back(ea::move(timedChange.change_));
+    changes_.clear();
+    return true;
+}
+
+unsigned FileWatcher::GetNumPendingChanges() const
+{
+    MutexLock lock(changesMutex_);
+    return changes_.size();
+}
+
+#if defined(URHO3D_FILEWATCHER) && defined(__linux__)
+void FileWatcher::AddWatches(const ea::string& subDir, bool reportExistingFiles)
+{
+    const ea::string fullPath = path_ + subDir;
+    const int handle = inotify_add_watch(watchHandle_, fullPath.c_str(), WATCH_FLAGS);
+    if (handle < 0)
+    {
+        URHO3D_LOGERROR("Failed to start watching path " + fullPath);
+        return;
+    }
+
+    // Store sub-directory to reconstruct later from inotify
+    dirHandle_[handle] = subDir;
+
+    if (reportExistingFiles)
+    {
+        ea::vector<ea::string> files;
+        fileSystem_->ScanDir(files, fullPath, "*", SCAN_FILES, false);
+        for (const ea::string& file : files)
+            AddChange({FILECHANGE_ADDED, subDir + file, EMPTY_STRING});
+    }
+
+    if (!watchSubDirs_)
+        return;
+
+    ea::vector<ea::string> subDirs;
+    fileSystem_->ScanDir(subDirs, fullPath, "*", SCAN_DIRS, false);
+    for (const ea::string& dir : subDirs)
+    {
+        // Don't watch ./ or ../ sub-directories
+        if (dir != "." && dir != "..")
+            AddWatches(AddTrailingSlash(subDir + dir), reportExistingFiles);
+    }
+}
+
+void FileWatcher::RemoveWatches(const ea::string& subDir)
+{
+    for (auto i = dirHandle_.begin(); i != dirHandle_.end();)
+    {
+        if (i->second.starts_with(subDir))
+        {
+            inotify_rm_watch(watchHandle_, i->first);
+            i = dirHandle_.erase(i);
+        }
+        else
+            ++i;
+    }
+}
+#endif
+
 }
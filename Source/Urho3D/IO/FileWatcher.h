@@ -76,16 +76,24 @@ public:
     void StopWatching();
     /// Set the delay in seconds before file changes are notified. This (hopefully) avoids notifying when a file save is still in progress. Default 1 second.
     void SetDelay(float interval);
-    /// Add a file change into the changes queue.
+    /// Set the maximum time in seconds that changes are held back by GetNextBatch() while files keep changing. Default 5 seconds.
+    void SetMaxDelay(float interval);
+    /// Add a file change into the changes queue. Repeated changes of the same file are merged.
     void AddChange(const FileChange& change);
     /// Return a file change (true if was found, false if not).
     bool GetNextChange(FileChange& dest);
+    /// Return all pending changes once no file has changed for the delay, or the oldest change has waited for the maximum delay. Return true if any changes were returned.
+    bool GetNextBatch(ea::vector<FileChange>& dest);
 
     /// Return the path being watched, or empty if not watching.
     const ea::string& GetPath() const { return path_; }
 
     /// Return the delay in seconds for notifying file changes.
     float GetDelay() const { return delay_; }
+    /// Return the maximum time in seconds that changes are held back by GetNextBatch().
+    float GetMaxDelay() const { return maxDelay_; }
+    /// Return number of pending changes.
+    unsigned GetNumPendingChanges() const;
 
 private:
     struct TimedFileChange
@@ -103,9 +111,15 @@ private:
     /// Pending changes. These will be returned and removed from the list when their timer has exceeded the delay.
     ea::unordered_map<ea::string, TimedFileChange> changes_;
     /// Mutex for the change buffer.
-    Mutex changesMutex_;
+    mutable Mutex changesMutex_;
+    /// Time since the last change was added.
+    Timer lastChangeTimer_;
+    /// Time since the oldest pending change was added.
+    Timer oldestChangeTimer_;
     /// Delay in seconds for notifying changes.
     float delay_;
+    /// Maximum delay in seconds for notifying change batches.
+    float maxDelay_;
     /// Watch subdirectories flag.
     bool watchSubDirs_;
 
@@ -116,6 +130,11 @@ private:
 
 #elif __linux__
 
+    /// Add watches for the directory relative to the watched path and its sub-directories. Optionally report already existing files as added.
+    void AddWatches(const ea::string& subDir, bool reportExistingFiles);
+    /// Remove watches for the directory relative to the watched path and its sub-directories.
+    void RemoveWatches(const ea::string& subDir);
+
     /// HashMap for the directory and sub-directories (needed for inotify's int handles).
     ea::unordered_map<int, ea::string> dirHandle_;
     /// Linux inotify needs a handle.
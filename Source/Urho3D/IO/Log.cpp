@@ -38,8 +38,14 @@
 #include <spdlog/sinks/dist_sink.h>
 #include <spdlog/sinks/base_sink.h>
 #include <spdlog/details/null_mutex.h>
+#include <spdlog/details/os.h>
 
+#include <EASTL/sort.h>
+
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <thread>
 #include <cstdio>
 
 #ifdef __ANDROID__
@@ -57,7 +63,22 @@ extern "C" void SDL_IOS_LogMessage(const char* message);
 namespace Urho3D
 {
 
+/// Number of messages each thread may queue before its buffer is full. Must be a power of two.
+static const unsigned LOG_RING_SIZE = 1024;
+/// Maximum number of written messages waiting for event delivery.
+static const unsigned MAX_PENDING_LOG_EVENTS = 16384;
+/// Time in milliseconds the flush thread sleeps when there are no queued messages.
+static const unsigned LOG_FLUSH_INTERVAL_MS = 5;
+
+static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "Log ring size must be a power of two.");
+
 static Log* logInstance = nullptr;
+/// Current log implementation. Cleared before shutdown, which then waits for writers that have already loaded it.
+static std::atomic<LogImpl*> logImplInstance{};
+/// Number of threads currently enqueueing a message.
+static std::atomic<unsigned> numActiveLogWriters{};
+/// Generation of the current Log instance, used to invalidate per-thread buffers of destroyed instances.
+static std::atomic<unsigned> logGeneration{};
 
 #if defined(IOS) || defined(TVOS)
 template<typename Mutex>
@@ -144,36 +165,76 @@ Logger::Logger(void* logger)
 {
 }
 
-void Logger::Write(LogLevel level, const ea::string& message) const
+/// Log message queued by a producer thread.
+struct QueuedLogMessage
 {
-    if (logger_ == nullptr)
-        return;
+    /// Logger that received the message.
+    spdlog::logger* logger_{};
+    /// Time when the message was written.
+    spdlog::log_clock::time_point time_{};
+    /// ID of the thread that wrote the message.
+    size_t threadId_{};
+    /// Global sequence number used to restore the order between threads.
+    unsigned long long sequence_{};
+    /// Message level.
+    LogLevel level_{};
+    /// Message text. Capacity is kept when the slot is reused.
+    ea::string message_;
+};
 
-    auto* logger = reinterpret_cast<spdlog::logger*>(logger_);
+/// Fixed size single producer, single consumer queue of messages written by one thread.
+class LogMessageRing
+{
+public:
+    /// Construct.
+    LogMessageRing() : messages_(LOG_RING_SIZE) {}
 
-    switch (level)
+    /// Queue message. Called only by the owner thread. Return false if the buffer is full.
+    bool Push(spdlog::logger* logger, LogLevel level, const ea::string& message, unsigned long long sequence)
     {
-    case LOG_TRACE:
-        logger->trace(message.c_str());
-        break;
-    case LOG_DEBUG:
-        logger->debug(message.c_str());
-        break;
-    case LOG_INFO:
-        logger->info(message.c_str());
-        break;
-    case LOG_WARNING:
-        logger->warn(message.c_str());
-        break;
-    case LOG_ERROR:
-        logger->error(message.c_str());
-        break;
-    case LOG_NONE:
-    case MAX_LOGLEVELS:
-        logger->warn("(Unknown log level used!) %s", message.c_str());
-        break;
+        const unsigned head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= LOG_RING_SIZE)
+            return false;
+
+        QueuedLogMessage& queued = messages_[head & (LOG_RING_SIZE - 1)];
+        queued.logger_ = logger;
+        queued.time_ = spdlog::log_clock::now();
+        queued.threadId_ = spdlog::details::os::thread_id();
+        queued.sequence_ = sequence;
+        queued.level_ = level;
+        queued.message_ = message;
+
+        head_.store(head + 1, std::memory_order_release);
+        return true;
     }
-}
+
+    /// Return whether there are no queued messages.
+    bool IsEmpty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_relaxed); }
+
+    /// Message slots.
+    ea::vector<QueuedLogMessage> messages_;
+    /// Index of the next message to be written by the producer.
+    std::atomic<unsigned> head_{};
+    /// Index of the next message to be read by the consumer.
+    std::atomic<unsigned> tail_{};
+    /// Number of messages dropped since the last drain.
+    std::atomic<unsigned> numDropped_{};
+};
+
+/// Background thread that periodically writes queued log messages to the sinks.
+class LogFlushThread : public Thread
+{
+public:
+    /// Construct.
+    explicit LogFlushThread(LogImpl* impl) : Thread("LogFlush"), impl_(impl) {}
+
+    /// Write queued messages until stopped.
+    void ThreadFunction() override;
+
+private:
+    /// Log implementation.
+    LogImpl* impl_{};
+};
 
 class LogImpl : public Object
 {
@@ -195,6 +256,125 @@ public:
 #endif
         sinkProxy_->add_sink(platformSink_);
         sinkProxy_->add_sink(std::make_shared<MessageForwarderSink_mt>());
+
+        generation_ = ++logGeneration;
+        logImplInstance = this;
+        flushThread_ = ea::make_unique<LogFlushThread>(this);
+        flushThread_->Run();
+    }
+
+    ~LogImpl() override
+    {
+        Shutdown();
+    }
+
+    /// Stop the flush thread and write remaining messages.
+    void Shutdown()
+    {
+        // Detach from new writers and wait until the ones already enqueueing are done
+        LogImpl* expected = this;
+        logImplInstance.compare_exchange_strong(expected, nullptr);
+        while (numActiveLogWriters.load() != 0)
+            std::this_thread::yield();
+
+        if (flushThread_)
+        {
+            flushThread_->Stop();
+            flushThread_.reset();
+        }
+        WriteQueuedMessages();
+    }
+
+    /// Queue message from the calling thread.
+    void Enqueue(spdlog::logger* logger, LogLevel level, const ea::string& message)
+    {
+        LogMessageRing* ring = GetThreadRing();
+        const unsigned long long sequence = nextSequence_.fetch_add(1, std::memory_order_relaxed);
+        if (!ring->Push(logger, level, message, sequence))
+        {
+            if (level < blockingLevel_.load(std::memory_order_relaxed))
+            {
+                ring->numDropped_.fetch_add(1, std::memory_order_relaxed);
+                numDropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // Make room by writing out everything that is queued so far
+            WriteQueuedMessages();
+            ring->Push(logger, level, message, sequence);
+        }
+
+        if (level >= flushLevel_.load(std::memory_order_relaxed))
+            WriteQueuedMessages();
+    }
+
+    /// Write queued messages of all threads to the sinks in the order they were written. Return number of written messages.
+    unsigned WriteQueuedMessages()
+    {
+        MutexLock drainLock(drainMutex_);
+
+        {
+            MutexLock lock(ringsMutex_);
+            // Forget buffers of exited threads once they are empty
+            for (auto iter = rings_.begin(); iter != rings_.end();)
+            {
+                if (iter->use_count() == 1 && (*iter)->IsEmpty())
+                    iter = rings_.erase(iter);
+                else
+                    ++iter;
+            }
+            drainRings_.assign(rings_.begin(), rings_.end());
+        }
+
+        drainHeads_.resize(drainRings_.size());
+        drainMessages_.clear();
+        unsigned numDropped = 0;
+        for (unsigned i = 0; i < drainRings_.size(); ++i)
+        {
+            LogMessageRing& ring = *drainRings_[i];
+            const unsigned head = ring.head_.load(std::memory_order_acquire);
+            for (unsigned index = ring.tail_.load(std::memory_order_relaxed); index != head; ++index)
+                drainMessages_.push_back(&ring.messages_[index & (LOG_RING_SIZE - 1)]);
+            drainHeads_[i] = head;
+            numDropped += ring.numDropped_.exchange(0, std::memory_order_relaxed);
+        }
+
+        if (numDropped > 0)
+        {
+            const ea::string message = Format("Dropped {} log messages because of full buffer", numDropped);
+            if (auto logger = spdlog::get("main"))
+                WriteMessage(logger.get(), LOG_WARNING, spdlog::log_clock::now(), spdlog::details::os::thread_id(), message);
+        }
+
+        ea::sort(drainMessages_.begin(), drainMessages_.end(),
+            [](const QueuedLogMessage* lhs, const QueuedLogMessage* rhs) { return lhs->sequence_ < rhs->sequence_; });
+
+        for (const QueuedLogMessage* queued : drainMessages_)
+            WriteMessage(queued->logger_, queued->level_, queued->time_, queued->threadId_, queued->message_);
+
+        for (unsigned i = 0; i < drainRings_.size(); ++i)
+            drainRings_[i]->tail_.store(drainHeads_[i], std::memory_order_release);
+        drainRings_.clear();
+
+        const auto numWritten = static_cast<unsigned>(drainMessages_.size());
+        if (numWritten > 0 || numDropped > 0)
+            sinkProxy_->flush();
+        return numWritten;
+    }
+
+    /// Write message directly to the sinks of the logger.
+    static void WriteMessage(spdlog::logger* logger, LogLevel level, spdlog::log_clock::time_point time, size_t threadId,
+        const ea::string& message)
+    {
+        spdlog::details::log_msg msg(spdlog::string_view_t(logger->name()), ConvertLogLevel(level),
+            spdlog::string_view_t(message.data(), message.size()));
+        msg.time = time;
+        msg.thread_id = threadId;
+        for (const auto& sink : logger->sinks())
+        {
+            if (sink->should_log(msg.level))
+                sink->log(msg);
+        }
     }
 
 #ifdef __ANDROID__
@@ -215,8 +395,105 @@ public:
 #endif
     /// Sink that forwards messages to all other sinks.
     std::shared_ptr<spdlog::sinks::dist_sink_mt> sinkProxy_;
+    /// Lowest level of messages written before returning to the caller.
+    std::atomic<LogLevel> flushLevel_{LOG_ERROR};
+    /// Lowest level of messages that wait for space in a full buffer.
+    std::atomic<LogLevel> blockingLevel_{LOG_WARNING};
+    /// Total number of dropped messages.
+    std::atomic<unsigned> numDropped_{};
+
+private:
+    /// Per-thread buffer and the generation of the Log instance it is registered with.
+    struct ThreadRing
+    {
+        unsigned generation_{};
+        std::shared_ptr<LogMessageRing> ring_;
+    };
+
+    /// Return buffer of the calling thread, registering a new one if needed.
+    LogMessageRing* GetThreadRing()
+    {
+        static thread_local ThreadRing threadRing;
+        if (threadRing.generation_ != generation_ || !threadRing.ring_)
+        {
+            threadRing.ring_ = std::make_shared<LogMessageRing>();
+            threadRing.generation_ = generation_;
+
+            MutexLock lock(ringsMutex_);
+            rings_.push_back(threadRing.ring_);
+        }
+        return threadRing.ring_.get();
+    }
+
+    /// Generation of this instance.
+    unsigned generation_{};
+    /// Sequence number of the next message.
+    std::atomic<unsigned long long> nextSequence_{};
+    /// Buffers of all threads that wrote messages.
+    ea::vector<std::shared_ptr<LogMessageRing>> rings_;
+    /// Mutex for buffer registration.
+    Mutex ringsMutex_;
+    /// Mutex that serializes writing of queued messages.
+    Mutex drainMutex_;
+    /// Buffers being drained.
+    ea::vector<std::shared_ptr<LogMessageRing>> drainRings_;
+    /// Positions up to which buffers are drained.
+    ea::vector<unsigned> drainHeads_;
+    /// Messages being drained.
+    ea::vector<const QueuedLogMessage*> drainMessages_;
+    /// Background flush thread.
+    ea::unique_ptr<LogFlushThread> flushThread_;
 };
 
+void LogFlushThread::ThreadFunction()
+{
+    while (shouldRun_)
+    {
+        if (impl_->WriteQueuedMessages() == 0)
+            Time::Sleep(LOG_FLUSH_INTERVAL_MS);
+    }
+}
+
+bool Logger::IsEnabled(LogLevel level) const
+{
+    if (logger_ == nullptr)
+        return false;
+    if (level < LOG_TRACE || level >= LOG_NONE)
+        return true;
+    return reinterpret_cast<spdlog::logger*>(logger_)->should_log(ConvertLogLevel(level));
+}
+
+void Logger::Write(LogLevel level, const ea::string& message) const
+{
+    if (logger_ == nullptr)
+        return;
+
+    auto* logger = reinterpret_cast<spdlog::logger*>(logger_);
+
+    if (level < LOG_TRACE || level >= LOG_NONE)
+    {
+        Write(LOG_WARNING, "(Unknown log level used!) " + message);
+        return;
+    }
+
+    const spdlog::level::level_enum spdLevel = ConvertLogLevel(level);
+    if (!logger->should_log(spdLevel))
+        return;
+
+    // Register as active writer before loading the instance so that shutdown waits for this call
+    numActiveLogWriters.fetch_add(1);
+    if (LogImpl* impl = logImplInstance.load())
+    {
+        impl->Enqueue(logger, level, message);
+        numActiveLogWriters.fetch_sub(1);
+        return;
+    }
+    numActiveLogWriters.fetch_sub(1);
+
+    // Write directly if the logging subsystem is already gone
+    logger->log(spdLevel, spdlog::string_view_t(message.data(), message.size()));
+}
+
 Log::Log(Context* context) :
     Object(context),
     impl_(new LogImpl(context)),
@@ -229,6 +506,7 @@ Log::Log(Context* context) :
 
 Log::~Log()
 {
+    impl_->Shutdown();
     logInstance = nullptr;
 }
 
@@ -292,6 +570,38 @@ void Log::SetLogFormat(const ea::string& format)
 #endif
 }
 
+void Log::SetFlushLevel(LogLevel level)
+{
+    impl_->flushLevel_.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Log::GetFlushLevel() const
+{
+    return impl_->flushLevel_.load(std::memory_order_relaxed);
+}
+
+void Log::SetBlockingLevel(LogLevel level)
+{
+    impl_->blockingLevel_.store(level, std::memory_order_relaxed);
+}
+
+LogLevel Log::GetBlockingLevel() const
+{
+    return impl_->blockingLevel_.load(std::memory_order_relaxed);
+}
+
+unsigned Log::GetNumDroppedMessages() const
+{
+    return impl_->numDropped_.load(std::memory_order_relaxed);
+}
+
+void Log::Flush()
+{
+    impl_->WriteQueuedMessages();
+    if (Thread::IsMainThread())
+        PumpThreadMessages();
+}
+
 Logger Log::GetLogger(const ea::string& name)
 {
     // Loggers may be used only after initializing Log subsystem, therefore do not use logging from static initializers.
@@ -330,33 +640,14 @@ void Log::SendMessageEvent(LogLevel level, time_t timestamp, const ea::string& l
     TracyMessageC(message.c_str(), message.size(), LOG_LEVEL_COLORS[level].ToUIntArgb());
 #endif
 
-    // If not in the main thread, store message for later processing
-    if (!Thread::IsMainThread())
+    // Store message for delivery at the end of frame
+    MutexLock lock(logMutex_);
+    if (threadMessages_.size() >= MAX_PENDING_LOG_EVENTS)
     {
-        if (logInstance)
-        {
-            MutexLock lock(logMutex_);
-            threadMessages_.push_back(StoredLogMessage(level, timestamp, logger, message));
-        }
-
+        ++numDroppedEvents_;
         return;
     }
-
-    if (inWrite_)
-        return;
-
-    inWrite_ = true;
-
-    using namespace LogMessage;
-
-    VariantMap& eventData = logInstance->GetEventDataMap();
-    eventData[P_LEVEL] = level;
-    eventData[P_TIME] = (unsigned)timestamp;
-    eventData[P_LOGGER] = logger;
-    eventData[P_MESSAGE] = message;
-    SendEvent(E_LOGMESSAGE, eventData);
-
-    inWrite_ = false;
+    threadMessages_.emplace_back(level, timestamp, logger, message);
 }
 
 void Log::PumpThreadMessages()
@@ -373,15 +664,49 @@ void Log::PumpThreadMessages()
         return;
     }
 
-    MutexLock lock(logMutex_);
+    // Messages logged by event handlers are delivered on the next pump
+    if (inWrite_)
+        return;
+
+    unsigned numDroppedEvents = 0;
+    {
+        MutexLock lock(logMutex_);
+        ea::swap(threadMessages_, deliveredMessages_);
+        ea::swap(numDroppedEvents_, numDroppedEvents);
+    }
+
+    if (deliveredMessages_.empty())
+        return;
+
+    URHO3D_PROFILE("PumpLogMessages");
 
-    // Process messages accumulated from other threads (if any)
-    while (!threadMessages_.empty())
+    // Skip building event data if nobody listens
+    if (context_->GetEventReceivers(E_LOGMESSAGE) || context_->GetEventReceivers(this, E_LOGMESSAGE))
     {
-        const StoredLogMessage& stored = threadMessages_.front();
-        SendMessageEvent(stored.level_, stored.timestamp_, stored.logger_, stored.message_);
-        threadMessages_.pop_front();
+        inWrite_ = true;
+
+        using namespace LogMessage;
+
+        if (numDroppedEvents > 0)
+        {
+            deliveredMessages_.emplace_back(LOG_WARNING, deliveredMessages_.back().timestamp_, "main",
+                Format("Dropped {} log message events because of full queue", numDroppedEvents));
+        }
+
+        VariantMap& eventData = GetEventDataMap();
+        for (const StoredLogMessage& stored : deliveredMessages_)
+        {
+            eventData[P_LEVEL] = stored.level_;
+            eventData[P_TIME] = (unsigned)stored.timestamp_;
+            eventData[P_LOGGER] = stored.logger_;
+            eventData[P_MESSAGE] = stored.message_;
+            SendEvent(E_LOGMESSAGE, eventData);
+        }
+
+        inWrite_ = false;
     }
+
+    deliveredMessages_.clear();
 }
 
 }
@@ -22,7 +22,7 @@
 
 #pragma once
 
-#include <EASTL/list.h>
+#include <EASTL/vector.h>
 
 #include "../Core/Macros.h"
 #include "../Core/Mutex.h"
@@ -78,7 +78,7 @@ static const char* logLevelNames[] =
 
 class File;
 
-/// Stored log message from another thread.
+/// Stored log message waiting for event delivery.
 struct StoredLogMessage
 {
     /// Construct undefined.
@@ -123,7 +123,12 @@ public:
     template<typename... Args> void Info(const char* format, Args... args) const    { Write(LOG_INFO, format, args...); }
     template<typename... Args> void Warning(const char* format, Args... args) const { Write(LOG_WARNING, format, args...); }
     template<typename... Args> void Error(const char* format, Args... args) const   { Write(LOG_ERROR, format, args...); }
-    template<typename... Args> void Write(LogLevel level, const char* format, Args... args) const { Write(level, Format(format, args...)); }
+    template<typename... Args> void Write(LogLevel level, const char* format, Args... args) const
+    {
+        // Skip formatting of messages that would be filtered out anyway
+        if (IsEnabled(level))
+            Write(level, Format(format, args...));
+    }
 
     template<typename... Args> void Trace(const ea::string& message) const   { Write(LOG_TRACE, message.c_str()); }
     template<typename... Args> void Debug(const ea::string& message) const   { Write(LOG_DEBUG, message.c_str()); }
@@ -132,6 +137,8 @@ public:
     template<typename... Args> void Error(const ea::string& message) const   { Write(LOG_ERROR, message.c_str()); }
 
     void Write(LogLevel level, const ea::string& message) const;
+    /// Return whether messages of given level are written.
+    bool IsEnabled(LogLevel level) const;
 
 protected:
     /// Instance of spdlog logger.
@@ -178,7 +185,25 @@ public:
     /// Returns default logger.
     static Logger GetLogger();
 
-    ///
+    /// Set lowest level of messages that are written out before returning to the caller. Lower levels are written by the background thread.
+    /// @property
+    void SetFlushLevel(LogLevel level);
+    /// Return lowest level of messages that are written out before returning to the caller.
+    /// @property
+    LogLevel GetFlushLevel() const;
+    /// Set lowest level of messages that wait for space when the calling thread's buffer is full. Lower levels are dropped.
+    /// @property
+    void SetBlockingLevel(LogLevel level);
+    /// Return lowest level of messages that wait for space when the calling thread's buffer is full.
+    /// @property
+    LogLevel GetBlockingLevel() const;
+    /// Return total number of messages dropped because of full buffers.
+    /// @property
+    unsigned GetNumDroppedMessages() const;
+
+    /// Write all queued messages to the sinks. When called from the main thread, also send pending log message events.
+    void Flush();
+    /// Send log message events for all messages written since the last call. Main thread only.
     void PumpThreadMessages();
 
 private:
@@ -191,8 +216,12 @@ private:
     ea::string formatPattern_{};
     /// Mutex for threaded operation.
     Mutex logMutex_{};
-    /// Log messages from other threads.
-    ea::list<StoredLogMessage> threadMessages_{};
+    /// Written log messages waiting for event delivery.
+    ea::vector<StoredLogMessage> threadMessages_{};
+    /// Log messages being delivered as events.
+    ea::vector<StoredLogMessage> deliveredMessages_{};
+    /// Number of messages that were not delivered as events because the pending queue was full.
+    unsigned numDroppedEvents_{};
     /// Logging level.
 #ifdef _DEBUG
     LogLevel level_ = LOG_DEBUG;
@@ -24,12 +24,49 @@
 
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/PackageFile.h"
 #include "../IO/FileSystem.h"
 
+#include <EASTL/sort.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace Urho3D
 {
 
+namespace
+{
+
+inline bool CompareIndexEntries(const PackageIndexEntry& lhs, const PackageIndexEntry& rhs)
+{
+    return lhs.nameHash_ < rhs.nameHash_;
+}
+
+/// Return whether all names of the file index start and end within the name table.
+bool CheckIndexNames(const PackageIndexEntry* index, unsigned numFiles, const char* names, unsigned namesSize)
+{
+    // The last name is terminated at the end of the table, therefore every name that starts inside it is terminated too
+    if (numFiles && (!namesSize || names[namesSize - 1] != '\0'))
+        return false;
+
+    for (unsigned i = 0; i < numFiles; ++i)
+    {
+        if (index[i].nameOffset_ >= namesSize)
+            return false;
+    }
+    return true;
+}
+
+}
+
 PackageFile::PackageFile(Context* context) :
     Object(context),
     totalSize_(0),
@@ -49,120 +86,262 @@ PackageFile::PackageFile(Context* context, const ea::string& fileName, unsigned
     Open(fileName, startOffset);
 }
 
-PackageFile::~PackageFile() = default;
+PackageFile::~PackageFile()
+{
+    UnmapFile();
+}
 
 bool PackageFile::Open(const ea::string& fileName, unsigned startOffset)
 {
-    SharedPtr<File> file(new File(context_, fileName));
-    if (!file->IsOpen())
-        return false;
+    Reset();
+
+    // Mapping is optional, fall back to file reads if it is not available. File can not open packages larger than
+    // 4 GB, so read the header through the mapping when there is one
+    MapFile(fileName);
+
+    SharedPtr<File> file;
+    ea::unique_ptr<MemoryBuffer> mappedFile;
+    Deserializer* source = nullptr;
+    if (mappedData_)
+    {
+        const unsigned long long viewSize = Min(mappedSize_, static_cast<unsigned long long>(M_MAX_UNSIGNED));
+        mappedFile = ea::make_unique<MemoryBuffer>(static_cast<const unsigned char*>(mappedData_), static_cast<unsigned>(viewSize));
+        source = mappedFile.get();
+    }
+    else
+    {
+        file = new File(context_, fileName);
+        if (!file->IsOpen())
+            return false;
+        source = file;
+    }
 
     // Check ID, then read the directory
-    file->Seek(startOffset);
-    ea::string id = file->ReadFileID();
+    source->Seek(startOffset);
+    ea::string id = source->ReadFileID();
     if (id != "UPAK" && id != "ULZ4" && id != "RPAK" && id != "RLZ4")
     {
         // If start offset has not been explicitly specified, also try to read package size from the end of file
         // to know how much we must rewind to find the package start
         if (!startOffset)
         {
-            unsigned fileSize = file->GetSize();
-            file->Seek((unsigned)(fileSize - sizeof(unsigned)));
-            unsigned newStartOffset = fileSize - file->ReadUInt();
+            unsigned fileSize = source->GetSize();
+            source->Seek((unsigned)(fileSize - sizeof(unsigned)));
+            unsigned newStartOffset = fileSize - source->ReadUInt();
             if (newStartOffset < fileSize)
             {
                 startOffset = newStartOffset;
-                file->Seek(startOffset);
-                id = file->ReadFileID();
+                source->Seek(startOffset);
+                id = source->ReadFileID();
             }
         }
 
         if (id != "UPAK" && id != "ULZ4" && id != "RPAK" && id != "RLZ4")
         {
             URHO3D_LOGERROR(fileName + " is not a valid package file");
+            Reset();
             return false;
         }
     }
 
     fileName_ = fileName;
     nameHash_ = fileName_;
-    totalSize_ = file->GetSize();
+    totalSize_ = source->GetSize();
     compressed_ = id == "ULZ4" || id == "RLZ4";
-    unsigned numFiles = file->ReadUInt();
-    checksum_ = file->ReadUInt();
+    numFiles_ = source->ReadUInt();
+    checksum_ = source->ReadUInt();
 
+    unsigned version = 0;
+    long long fileListOffset = 0;
     if (id == "RPAK" || id == "RLZ4")
     {
         // New PAK file format includes two extra PAK header fields:
-        // * Version. At this time this field is unused and is always 0. It will be used in the future if PAK format needs to be extended.
+        // * Version. Version 0 writes the file list as is, version 1 writes the sorted file index, version 2 adds block tables
+        //   to compressed entries.
         // * File list offset. New format writes file list in the end of the file. This allows PAK creation without knowing entire file list
         //   beforehand.
-        unsigned version = file->ReadUInt();                        // Reserved for future use.
-        assert(version == 0);
-        int64_t fileListOffset = file->ReadInt64();                 // New format has file list at the end of the file.
-        file->Seek(fileListOffset);                                 // TODO: Serializer/Deserializer do not support files bigger than 4 GB
+        version = source->ReadUInt();
+        fileListOffset = source->ReadInt64() + startOffset;
+        if (version > BLOCK_TABLE_VERSION)
+        {
+            URHO3D_LOGERROR(fileName + " has unsupported package version " + ea::to_string(version));
+            Reset();
+            return false;
+        }
     }
 
-    for (unsigned i = 0; i < numFiles; ++i)
+    version_ = version;
+
+    // The file list is read through a seek within the first 4 GB unless the sorted index is read from the mapping
+    if ((!mappedData_ || version < INDEXED_VERSION) && fileListOffset > M_MAX_UNSIGNED)
     {
-        ea::string entryName = file->ReadString();
-        PackageEntry newEntry{};
-        newEntry.offset_ = file->ReadUInt() + startOffset;
-        totalDataSize_ += (newEntry.size_ = file->ReadUInt());
-        newEntry.checksum_ = file->ReadUInt();
-        if (!compressed_ && newEntry.offset_ + newEntry.size_ > totalSize_)
+        URHO3D_LOGERROR("File index of package file " + fileName + " is beyond 4 GB and can only be read from a memory mapped package");
+        Reset();
+        return false;
+    }
+
+    if (version >= INDEXED_VERSION)
+    {
+        if (mappedData_ && fileListOffset + numFiles_ * sizeof(PackageIndexEntry) + sizeof(unsigned) > mappedSize_)
         {
-            URHO3D_LOGERROR("File entry " + entryName + " outside package file");
+            URHO3D_LOGERROR("File index outside package file " + fileName);
+            Reset();
             return false;
         }
+
+        // Use the index directly from the memory mapping if possible. Offsets of a package appended to another file need rebasing
+        const unsigned char* indexData = mappedData_ ? mappedData_ + fileListOffset : nullptr;
+        const bool isAligned = reinterpret_cast<uintptr_t>(indexData) % alignof(PackageIndexEntry) == 0;
+        if (indexData && isAligned && !startOffset)
+        {
+            index_ = reinterpret_cast<const PackageIndexEntry*>(indexData);
+            const unsigned char* nameData = indexData + numFiles_ * sizeof(PackageIndexEntry);
+            const unsigned namesSize = *reinterpret_cast<const unsigned*>(nameData);
+            if (nameData + sizeof(unsigned) + namesSize > mappedData_ + mappedSize_)
+            {
+                URHO3D_LOGERROR("File index outside package file " + fileName);
+                Reset();
+                return false;
+            }
+            names_ = reinterpret_cast<const char*>(nameData + sizeof(unsigned));
+            if (!CheckIndexNames(index_, numFiles_, names_, namesSize))
+            {
+                URHO3D_LOGERROR("File names outside file index in package file " + fileName);
+                Reset();
+                return false;
+            }
+        }
         else
-            entries_[entryName] = newEntry;
+        {
+            // Copy the index to rebase or align it, reading through the mapping if possible
+            ea::unique_ptr<MemoryBuffer> mappedIndex;
+            Deserializer* indexSource = source;
+            if (indexData)
+            {
+                const unsigned long long indexSize = Min(mappedSize_ - fileListOffset, static_cast<unsigned long long>(M_MAX_UNSIGNED));
+                mappedIndex = ea::make_unique<MemoryBuffer>(indexData, static_cast<unsigned>(indexSize));
+                indexSource = mappedIndex.get();
+            }
+            else
+                indexSource->Seek(static_cast<unsigned>(fileListOffset));
+
+            indexStorage_.resize(numFiles_);
+            indexSource->Read(indexStorage_.data(), numFiles_ * sizeof(PackageIndexEntry));
+            nameStorage_.resize(indexSource->ReadUInt());
+            indexSource->Read(nameStorage_.data(), nameStorage_.size());
+            for (PackageIndexEntry& indexEntry : indexStorage_)
+                indexEntry.entry_.offset_ += startOffset;
+
+            index_ = indexStorage_.data();
+            names_ = nameStorage_.data();
+            if (!CheckIndexNames(index_, numFiles_, names_, nameStorage_.size()))
+            {
+                URHO3D_LOGERROR("File names outside file index in package file " + fileName);
+                Reset();
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Old formats store unsorted file list, build the index from it
+    if (id == "RPAK" || id == "RLZ4")
+        source->Seek(static_cast<unsigned>(fileListOffset));
+
+    indexStorage_.resize(numFiles_);
+    for (unsigned i = 0; i < numFiles_; ++i)
+    {
+        ea::string entryName = source->ReadString();
+        PackageIndexEntry& indexEntry = indexStorage_[i];
+        indexEntry.entry_.offset_ = source->ReadUInt() + startOffset;
+        indexEntry.entry_.size_ = source->ReadUInt();
+        indexEntry.entry_.checksum_ = source->ReadUInt();
+        indexEntry.nameHash_ = StringHash(entryName).Value();
+        indexEntry.nameOffset_ = nameStorage_.size();
+        nameStorage_.insert(nameStorage_.end(), entryName.c_str(), entryName.c_str() + entryName.length() + 1);
+
+        if (!compressed_ && indexEntry.entry_.offset_ + indexEntry.entry_.size_ > totalSize_)
+        {
+            URHO3D_LOGERROR("File entry " + entryName + " outside package file");
+            Reset();
+            return false;
+        }
     }
+    ea::stable_sort(indexStorage_.begin(), indexStorage_.end(), CompareIndexEntries);
 
+    index_ = indexStorage_.data();
+    names_ = nameStorage_.data();
     return true;
 }
 
 bool PackageFile::Exists(const ea::string& fileName) const
 {
-    bool found = entries_.find(fileName) != entries_.end();
+    return GetEntry(fileName) != nullptr;
+}
+
+const PackageEntry* PackageFile::GetEntry(const ea::string& fileName) const
+{
+    const PackageIndexEntry* indexEntry = FindIndexEntry(fileName);
+    if (indexEntry)
+        return &indexEntry->entry_;
 
 #ifdef _WIN32
     // On Windows perform a fallback case-insensitive search
-    if (!found)
+    for (unsigned i = 0; i < numFiles_; ++i)
     {
-        for (auto i = entries_.begin(); i != entries_.end(); ++i)
-        {
-            if (!i->first.comparei(fileName))
-            {
-                found = true;
-                break;
-            }
-        }
+        if (!fileName.comparei(GetIndexEntryName(index_[i])))
+            return &index_[i].entry_;
     }
 #endif
 
-    return found;
+    return nullptr;
 }
 
-const PackageEntry* PackageFile::GetEntry(const ea::string& fileName) const
+ea::span<const unsigned char> PackageFile::GetEntryData(const ea::string& fileName) const
 {
-    auto i = entries_.find(fileName);
-    if (i != entries_.end())
-        return &i->second;
+    if (!mappedData_ || compressed_)
+        return {};
 
-#ifdef _WIN32
-    // On Windows perform a fallback case-insensitive search
-    else
+    const PackageEntry* entry = GetEntry(fileName);
+    if (!entry || entry->offset_ + entry->size_ > mappedSize_)
+        return {};
+
+    return { mappedData_ + entry->offset_, entry->size_ };
+}
+
+const ea::unordered_map<ea::string, PackageEntry>& PackageFile::GetEntries() const
+{
+    MutexLock lock(entriesMutex_);
+    if (!entriesCreated_)
     {
-        for (auto j = entries_.begin(); j != entries_.end(); ++j)
-        {
-            if (!j->first.comparei(fileName))
-                return &j->second;
-        }
+        for (unsigned i = 0; i < numFiles_; ++i)
+            entries_[GetIndexEntryName(index_[i])] = index_[i].entry_;
+        entriesCreated_ = true;
     }
-#endif
+    return entries_;
+}
 
-    return nullptr;
+unsigned PackageFile::GetTotalDataSize() const
+{
+    MutexLock lock(entriesMutex_);
+    if (!totalDataSizeValid_)
+    {
+        totalDataSize_ = 0;
+        for (unsigned i = 0; i < numFiles_; ++i)
+            totalDataSize_ += index_[i].entry_.size_;
+        totalDataSizeValid_ = true;
+    }
+    return totalDataSize_;
+}
+
+const ea::vector<ea::string> PackageFile::GetEntryNames() const
+{
+    ea::vector<ea::string> names;
+    names.reserve(numFiles_);
+    for (unsigned i = 0; i < numFiles_; ++i)
+        names.emplace_back(GetIndexEntryName(index_[i]));
+    return names;
 }
 
 void PackageFile::Scan(ea::vector<ea::string>& result, const ea::string& pathName, const ea::string& filter, bool recursive) const
@@ -183,10 +362,9 @@ void PackageFile::Scan(ea::vector<ea::string>& result, const ea::string& pathNam
     caseSensitive = false;
 #endif
 
-    const StringVector& entryNames = GetEntryNames();
-    for (auto i = entryNames.begin(); i != entryNames.end(); ++i)
+    for (unsigned i = 0; i < numFiles_; ++i)
     {
-        ea::string entryName = GetSanitizedPath(*i);
+        ea::string entryName = GetSanitizedPath(GetIndexEntryName(index_[i]));
         if ((filterExtension.empty() || entryName.ends_with(filterExtension, caseSensitive)) &&
             entryName.starts_with(sanitizedPath, caseSensitive))
         {
@@ -201,4 +379,120 @@ void PackageFile::Scan(ea::vector<ea::string>& result, const ea::string& pathNam
     }
 }
 
+bool PackageFile::WriteIndex(Serializer& dest, const ea::vector<ea::pair<ea::string, PackageEntry> >& entries)
+{
+    ea::vector<PackageIndexEntry> index(entries.size());
+    ea::vector<char> names;
+    for (unsigned i = 0; i < entries.size(); ++i)
+    {
+        const ea::string& name = entries[i].first;
+        index[i].entry_ = entries[i].second;
+        index[i].nameHash_ = StringHash(name).Value();
+        index[i].nameOffset_ = names.size();
+        names.insert(names.end(), name.c_str(), name.c_str() + name.length() + 1);
+    }
+    ea::stable_sort(index.begin(), index.end(), CompareIndexEntries);
+
+    bool success = dest.Write(index.data(), index.size() * sizeof(PackageIndexEntry)) == index.size() * sizeof(PackageIndexEntry);
+    success &= dest.WriteUInt(names.size());
+    success &= dest.Write(names.data(), names.size()) == names.size();
+    return success;
+}
+
+const PackageIndexEntry* PackageFile::FindIndexEntry(const ea::string& fileName) const
+{
+    PackageIndexEntry key{};
+    key.nameHash_ = StringHash(fileName).Value();
+
+    // Names with colliding hashes are adjacent
+    const PackageIndexEntry* end = index_ + numFiles_;
+    for (auto i = ea::lower_bound(index_, end, key, CompareIndexEntries); i != end && i->nameHash_ == key.nameHash_; ++i)
+    {
+        if (fileName == GetIndexEntryName(*i))
+            return i;
+    }
+    return nullptr;
+}
+
+void PackageFile::MapFile(const ea::string& fileName)
+{
+#ifdef __ANDROID__
+    // Assets inside the APK can not be mapped
+    if (URHO3D_IS_ASSET(fileName))
+        return;
+#endif
+
+#if defined(_WIN32)
+    HANDLE fileHandle = CreateFileW(GetWideNativePath(fileName).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return;
+
+    LARGE_INTEGER fileSize;
+    if (GetFileSizeEx(fileHandle, &fileSize) && fileSize.QuadPart > 0)
+    {
+        mappingHandle_ = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mappingHandle_)
+        {
+            mappedData_ = static_cast<unsigned char*>(MapViewOfFile(mappingHandle_, FILE_MAP_READ, 0, 0, 0));
+            if (mappedData_)
+                mappedSize_ = static_cast<unsigned long long>(fileSize.QuadPart);
+            else
+            {
+                CloseHandle(mappingHandle_);
+                mappingHandle_ = nullptr;
+            }
+        }
+    }
+    CloseHandle(fileHandle);
+#elif !defined(__EMSCRIPTEN__)
+    const int fd = open(GetNativePath(fileName).c_str(), O_RDONLY);
+    if (fd < 0)
+        return;
+
+    struct stat fileStat{};
+    if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+    {
+        void* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            mappedData_ = static_cast<unsigned char*>(data);
+            mappedSize_ = static_cast<unsigned long long>(fileStat.st_size);
+        }
+    }
+    close(fd);
+#endif
+}
+
+void PackageFile::UnmapFile()
+{
+    if (!mappedData_)
+        return;
+
+#if defined(_WIN32)
+    UnmapViewOfFile(mappedData_);
+    CloseHandle(mappingHandle_);
+    mappingHandle_ = nullptr;
+#elif !defined(__EMSCRIPTEN__)
+    munmap(mappedData_, static_cast<size_t>(mappedSize_));
+#endif
+
+    mappedData_ = nullptr;
+    mappedSize_ = 0;
+}
+
+void PackageFile::Reset()
+{
+    UnmapFile();
+    index_ = nullptr;
+    names_ = nullptr;
+    numFiles_ = 0;
+    version_ = 0;
+    indexStorage_.clear();
+    nameStorage_.clear();
+    entries_.clear();
+    entriesCreated_ = false;
+    totalDataSizeValid_ = false;
+}
+
 }
@@ -22,28 +22,55 @@
 
 #pragma once
 
+#include "../Core/Mutex.h"
 #include "../Core/Object.h"
 
+#include <EASTL/span.h>
+
 namespace Urho3D
 {
 
+class Serializer;
+
 /// %File entry within the package file.
 struct PackageEntry
 {
     /// Offset from the beginning.
-    unsigned offset_;
+    unsigned long long offset_;
     /// File size.
     unsigned size_;
     /// File checksum.
     unsigned checksum_;
 };
 
+/// Record of the sorted package file index. Indexed packages store the records on disk in this layout, so they are used
+/// directly from the memory mapping.
+/// @nobind
+struct PackageIndexEntry
+{
+    /// File entry.
+    PackageEntry entry_;
+    /// File name hash.
+    unsigned nameHash_;
+    /// Offset of the null-terminated file name in the name table.
+    unsigned nameOffset_;
+};
+
+static_assert(sizeof(PackageIndexEntry) == 24, "Unexpected size of PackageIndexEntry");
+
 /// Stores files of a directory tree sequentially for convenient access.
 class URHO3D_API PackageFile : public Object
 {
     URHO3D_OBJECT(PackageFile, Object);
 
 public:
+    /// Package format version with the sorted file index.
+    static const unsigned INDEXED_VERSION = 1;
+    /// Package format version with block tables in compressed entries, allowing random access within the entry.
+    static const unsigned BLOCK_TABLE_VERSION = 2;
+    /// Flag in the block table marking a block stored without compression.
+    static const unsigned STORED_BLOCK_FLAG = 0x80000000;
+
     /// Construct.
     explicit PackageFile(Context* context);
     /// Construct and open.
@@ -57,9 +84,13 @@ public:
     bool Exists(const ea::string& fileName) const;
     /// Return the file entry corresponding to the name, or null if not found. This will be case-insensitive on Windows and case-sensitive on other platforms.
     const PackageEntry* GetEntry(const ea::string& fileName) const;
+    /// Return data of an uncompressed file entry in the memory mapping without copying. Return empty span if not found,
+    /// or if the package is compressed or not memory mapped.
+    /// @nobind
+    ea::span<const unsigned char> GetEntryData(const ea::string& fileName) const;
 
-    /// Return all file entries.
-    const ea::unordered_map<ea::string, PackageEntry>& GetEntries() const { return entries_; }
+    /// Return all file entries. The map is created on the first call, prefer GetEntry() for lookups.
+    const ea::unordered_map<ea::string, PackageEntry>& GetEntries() const;
 
     /// Return the package file name.
     /// @property
@@ -70,7 +101,7 @@ public:
 
     /// Return number of files.
     /// @property
-    unsigned GetNumFiles() const { return entries_.size(); }
+    unsigned GetNumFiles() const { return numFiles_; }
 
     /// Return total size of the package file.
     /// @property
@@ -78,7 +109,7 @@ public:
 
     /// Return total data size from all the file entries in the package file.
     /// @property
-    unsigned GetTotalDataSize() const { return totalDataSize_; }
+    unsigned GetTotalDataSize() const;
 
     /// Return checksum of the package file contents.
     /// @property
@@ -88,39 +119,85 @@ public:
     /// @property
     bool IsCompressed() const { return compressed_; }
 
+    /// Return package format version.
+    unsigned GetVersion() const { return version_; }
+
+    /// Return whether the package is memory mapped.
+    bool IsMemoryMapped() const { return mappedData_ != nullptr; }
+
+    /// Return memory mapped package data, or null if not mapped.
+    /// @nobind
+    const unsigned char* GetMappedData() const { return mappedData_; }
+
+    /// Return size of the memory mapping.
+    unsigned long long GetMappedSize() const { return mappedSize_; }
+
     /// Return list of file names in the package.
-    const ea::vector<ea::string> GetEntryNames() const { return entries_.keys(); }
-
-    /// Return a file name in the package at the specified index
-    const ea::string& GetEntryName(unsigned index) const
-    {
-        unsigned nn = 0;
-        for (auto j = entries_.begin(); j != entries_.end(); ++j)
-        {
-            if (nn == index) return j->first;
-            nn++;
-        }
-        return EMPTY_STRING;
-    }
+    const ea::vector<ea::string> GetEntryNames() const;
+
+    /// Return a file name in the package at the specified index.
+    ea::string GetEntryName(unsigned index) const { return index < numFiles_ ? ea::string(GetIndexEntryName(index_[index])) : EMPTY_STRING; }
 
     /// Scan package for specified files.
     void Scan(ea::vector<ea::string>& result, const ea::string& pathName, const ea::string& filter, bool recursive) const;
 
+    /// Write sorted file index at the current position of the destination. The position should be aligned to 8 bytes
+    /// for the index to be usable from the memory mapping.
+    /// @nobind
+    static bool WriteIndex(Serializer& dest, const ea::vector<ea::pair<ea::string, PackageEntry> >& entries);
+
 private:
-    /// File entries.
-    ea::unordered_map<ea::string, PackageEntry> entries_;
+    /// Memory map the package file.
+    void MapFile(const ea::string& fileName);
+    /// Release the memory mapping.
+    void UnmapFile();
+    /// Release file entries and the memory mapping.
+    void Reset();
+    /// Return name of an index record.
+    const char* GetIndexEntryName(const PackageIndexEntry& entry) const { return names_ + entry.nameOffset_; }
+    /// Find index record by file name. Return null if not found.
+    const PackageIndexEntry* FindIndexEntry(const ea::string& fileName) const;
+
+    /// Sorted file index. Points either to the memory mapping or to the index storage.
+    const PackageIndexEntry* index_{};
+    /// File name table. Points either to the memory mapping or to the name storage.
+    const char* names_{};
+    /// Index records if the index is not used from the memory mapping.
+    ea::vector<PackageIndexEntry> indexStorage_;
+    /// File name table if the index is not used from the memory mapping.
+    ea::vector<char> nameStorage_;
+    /// File entries by name, created on demand.
+    mutable ea::unordered_map<ea::string, PackageEntry> entries_;
+    /// Whether the entries map is created.
+    mutable bool entriesCreated_{};
+    /// Mutex for creating the entries map.
+    mutable Mutex entriesMutex_;
+    /// Memory mapped package data.
+    unsigned char* mappedData_{};
+    /// Size of the memory mapping.
+    unsigned long long mappedSize_{};
+#ifdef _WIN32
+    /// File mapping object handle.
+    void* mappingHandle_{};
+#endif
     /// File name.
     ea::string fileName_;
     /// Package file name hash.
     StringHash nameHash_;
+    /// Number of files.
+    unsigned numFiles_{};
     /// Package file total size.
     unsigned totalSize_;
-    /// Total data size in the package using each entry's actual size if it is a compressed package file.
-    unsigned totalDataSize_;
+    /// Total data size in the package using each entry's actual size if it is a compressed package file. Calculated on demand.
+    mutable unsigned totalDataSize_;
+    /// Whether the total data size is calculated.
+    mutable bool totalDataSizeValid_{};
     /// Package file checksum.
     unsigned checksum_;
     /// Compressed flag.
     bool compressed_;
+    /// Package format version.
+    unsigned version_{};
 };
 
 }
@@ -24,6 +24,14 @@
 
 #include "../Math/Frustum.h"
 
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(URHO3D_SSE)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -243,4 +251,153 @@ void Frustum::UpdatePlanes()
 
 }
 
+unsigned Frustum::CullBoxesFast(const float* minX, const float* minY, const float* minZ,
+    const float* maxX, const float* maxY, const float* maxZ, unsigned count, unsigned* visibleIndices) const
+{
+    unsigned numVisible = 0;
+    unsigned i = 0;
+
+#if defined(__AVX__)
+    const __m256 half = _mm256_set1_ps(0.5f);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 x0 = _mm256_loadu_ps(minX + i);
+        const __m256 y0 = _mm256_loadu_ps(minY + i);
+        const __m256 z0 = _mm256_loadu_ps(minZ + i);
+        const __m256 x1 = _mm256_loadu_ps(maxX + i);
+        const __m256 y1 = _mm256_loadu_ps(maxY + i);
+        const __m256 z1 = _mm256_loadu_ps(maxZ + i);
+        const __m256 cx = _mm256_mul_ps(_mm256_add_ps(x0, x1), half);
+        const __m256 cy = _mm256_mul_ps(_mm256_add_ps(y0, y1), half);
+        const __m256 cz = _mm256_mul_ps(_mm256_add_ps(z0, z1), half);
+        const __m256 ex = _mm256_mul_ps(_mm256_sub_ps(x1, x0), half);
+        const __m256 ey = _mm256_mul_ps(_mm256_sub_ps(y1, y0), half);
+        const __m256 ez = _mm256_mul_ps(_mm256_sub_ps(z1, z0), half);
+
+        __m256 outside = _mm256_setzero_ps();
+        for (const Plane& plane : planes_)
+        {
+            const __m256 dist = _mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(cx, _mm256_set1_ps(plane.normal_.x_)),
+                _mm256_mul_ps(cy, _mm256_set1_ps(plane.normal_.y_))),
+                _mm256_add_ps(_mm256_mul_ps(cz, _mm256_set1_ps(plane.normal_.z_)), _mm256_set1_ps(plane.d_)));
+            const __m256 absDist = _mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(ex, _mm256_set1_ps(plane.absNormal_.x_)),
+                _mm256_mul_ps(ey, _mm256_set1_ps(plane.absNormal_.y_))),
+                _mm256_mul_ps(ez, _mm256_set1_ps(plane.absNormal_.z_)));
+            outside = _mm256_or_ps(outside, _mm256_cmp_ps(dist, _mm256_xor_ps(absDist, signMask), _CMP_LT_OQ));
+        }
+
+        unsigned visibleMask = ~static_cast<unsigned>(_mm256_movemask_ps(outside)) & 0xffu;
+        for (unsigned lane = 0; visibleMask; ++lane, visibleMask >>= 1)
+        {
+            if (visibleMask & 1u)
+                visibleIndices[numVisible++] = i + lane;
+        }
+    }
+#elif defined(URHO3D_SSE)
+    const __m128 half = _mm_set1_ps(0.5f);
+    const __m128 signMask = _mm_set1_ps(-0.0f);
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 x0 = _mm_loadu_ps(minX + i);
+        const __m128 y0 = _mm_loadu_ps(minY + i);
+        const __m128 z0 = _mm_loadu_ps(minZ + i);
+        const __m128 x1 = _mm_loadu_ps(maxX + i);
+        const __m128 y1 = _mm_loadu_ps(maxY + i);
+        const __m128 z1 = _mm_loadu_ps(maxZ + i);
+        const __m128 cx = _mm_mul_ps(_mm_add_ps(x0, x1), half);
+        const __m128 cy = _mm_mul_ps(_mm_add_ps(y0, y1), half);
+        const __m128 cz = _mm_mul_ps(_mm_add_ps(z0, z1), half);
+        const __m128 ex = _mm_mul_ps(_mm_sub_ps(x1, x0), half);
+        const __m128 ey = _mm_mul_ps(_mm_sub_ps(y1, y0), half);
+        const __m128 ez = _mm_mul_ps(_mm_sub_ps(z1, z0), half);
+
+        __m128 outside = _mm_setzero_ps();
+        for (const Plane& plane : planes_)
+        {
+            const __m128 dist = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(cx, _mm_set1_ps(plane.normal_.x_)),
+                _mm_mul_ps(cy, _mm_set1_ps(plane.normal_.y_))),
+                _mm_add_ps(_mm_mul_ps(cz, _mm_set1_ps(plane.normal_.z_)), _mm_set1_ps(plane.d_)));
+            const __m128 absDist = _mm_add_ps(_mm_add_ps(
+                _mm_mul_ps(ex, _mm_set1_ps(plane.absNormal_.x_)),
+                _mm_mul_ps(ey, _mm_set1_ps(plane.absNormal_.y_))),
+                _mm_mul_ps(ez, _mm_set1_ps(plane.absNormal_.z_)));
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(dist, _mm_xor_ps(absDist, signMask)));
+        }
+
+        unsigned visibleMask = ~static_cast<unsigned>(_mm_movemask_ps(outside)) & 0xfu;
+        for (unsigned lane = 0; visibleMask; ++lane, visibleMask >>= 1)
+        {
+            if (visibleMask & 1u)
+                visibleIndices[numVisible++] = i + lane;
+        }
+    }
+#elif defined(__ARM_NEON)
+    const float32x4_t half = vdupq_n_f32(0.5f);
+    for (; i + 4 <= count; i += 4)
+    {
+        const float32x4_t x0 = vld1q_f32(minX + i);
+        const float32x4_t y0 = vld1q_f32(minY + i);
+        const float32x4_t z0 = vld1q_f32(minZ + i);
+        const float32x4_t x1 = vld1q_f32(maxX + i);
+        const float32x4_t y1 = vld1q_f32(maxY + i);
+        const float32x4_t z1 = vld1q_f32(maxZ + i);
+        const float32x4_t cx = vmulq_f32(vaddq_f32(x0, x1), half);
+        const float32x4_t cy = vmulq_f32(vaddq_f32(y0, y1), half);
+        const float32x4_t cz = vmulq_f32(vaddq_f32(z0, z1), half);
+        const float32x4_t ex = vmulq_f32(vsubq_f32(x1, x0), half);
+        const float32x4_t ey = vmulq_f32(vsubq_f32(y1, y0), half);
+        const float32x4_t ez = vmulq_f32(vsubq_f32(z1, z0), half);
+
+        uint32x4_t outside = vdupq_n_u32(0);
+        for (const Plane& plane : planes_)
+        {
+            float32x4_t dist = vdupq_n_f32(plane.d_);
+            dist = vmlaq_n_f32(dist, cx, plane.normal_.x_);
+            dist = vmlaq_n_f32(dist, cy, plane.normal_.y_);
+            dist = vmlaq_n_f32(dist, cz, plane.normal_.z_);
+            float32x4_t absDist = vmulq_n_f32(ex, plane.absNormal_.x_);
+            absDist = vmlaq_n_f32(absDist, ey, plane.absNormal_.y_);
+            absDist = vmlaq_n_f32(absDist, ez, plane.absNormal_.z_);
+            outside = vorrq_u32(outside, vcltq_f32(dist, vnegq_f32(absDist)));
+        }
+
+        uint32_t lanes[4];
+        vst1q_u32(lanes, outside);
+        for (unsigned lane = 0; lane < 4; ++lane)
+        {
+            if (!lanes[lane])
+                visibleIndices[numVisible++] = i + lane;
+        }
+    }
+#endif
+
+    // Scalar fallback and tail
+    for (; i < count; ++i)
+    {
+        const Vector3 center((minX[i] + maxX[i]) * 0.5f, (minY[i] + maxY[i]) * 0.5f, (minZ[i] + maxZ[i]) * 0.5f);
+        const Vector3 edge((maxX[i] - minX[i]) * 0.5f, (maxY[i] - minY[i]) * 0.5f, (maxZ[i] - minZ[i]) * 0.5f);
+
+        bool outside = false;
+        for (const Plane& plane : planes_)
+        {
+            const float dist = plane.normal_.DotProduct(center) + plane.d_;
+            const float absDist = plane.absNormal_.DotProduct(edge);
+            if (dist < -absDist)
+            {
+                outside = true;
+                break;
+            }
+        }
+
+        if (!outside)
+            visibleIndices[numVisible++] = i;
+    }
+
+    return numVisible;
+}
+
 }
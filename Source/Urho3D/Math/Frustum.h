@@ -158,6 +158,12 @@ public:
         return INSIDE;
     }
 
+    /// Test an array of bounding boxes stored as separate min/max coordinate streams, using SIMD when available.
+    /// Writes indices of boxes that are (partially) inside to visibleIndices and returns their count. Same result as IsInsideFast per box.
+    /// @nobind
+    unsigned CullBoxesFast(const float* minX, const float* minY, const float* minZ,
+        const float* maxX, const float* maxY, const float* maxZ, unsigned count, unsigned* visibleIndices) const;
+
     /// Return distance of a point to the frustum, or 0 if inside.
     float Distance(const Vector3& point) const
     {
@@ -58,6 +58,26 @@ namespace Urho3D
 
 static const int STATS_INTERVAL_MSEC = 2000;
 
+/// Return world position of the node without caching world transforms, as connections are updated in parallel.
+static Vector3 GetUncachedWorldPosition(const Node* node)
+{
+    if (!node->IsDirty())
+        return node->GetWorldPosition();
+
+    const Node* scene = node->GetScene();
+    Matrix3x4 transform = node->GetTransform();
+    const Node* parent = node->GetParent();
+    while (parent && parent != scene && parent->IsDirty())
+    {
+        transform = parent->GetTransform() * transform;
+        parent = parent->GetParent();
+    }
+
+    if (parent && parent != scene)
+        transform = parent->GetWorldTransform() * transform;
+    return transform.Translation();
+}
+
 PackageDownload::PackageDownload() :
     totalFragments_(0),
     checksum_(0),
@@ -104,6 +124,16 @@ void Connection::Initialize(bool isClient, const SLNet::AddressOrGUID& address,
     SetAddressOrGUID(address);
 }
 
+void Connection::InitializeTransport(bool isClient, const SLNet::AddressOrGUID& address, NetworkTransport* transport)
+{
+    assert(peer_ == nullptr && !transport_);
+    transport_ = transport;
+    isClient_ = isClient;
+    sceneState_.connection_ = this;
+    port_ = address.systemAddress.GetPort();
+    SetAddressOrGUID(address);
+}
+
 void Connection::RegisterObject(Context* context)
 {
     context->RegisterFactory<Connection>();
@@ -149,8 +179,8 @@ void Connection::SendMessage(int msgID, bool reliable, bool inOrder, const unsig
         buffer.WriteUInt((unsigned int)MSG_PACKED_MESSAGE);
     }
 
-    buffer.WriteUInt((unsigned int) msgID);
-    buffer.WriteUInt(numBytes);
+    buffer.WriteVLE((unsigned int) msgID);
+    buffer.WriteVLE(numBytes);
     buffer.Write(data, numBytes);
 }
 
@@ -208,6 +238,8 @@ void Connection::SetScene(Scene* newScene)
     if (isClient_)
     {
         sceneState_.Clear();
+        relevantNodes_.clear();
+        interestActive_ = false;
 
         // When scene is assigned on the server, instruct the client to load it. This may require downloading packages
         const ea::vector<SharedPtr<PackageFile> >& packages = scene_->GetRequiredPackageFiles();
@@ -268,7 +300,10 @@ void Connection::SetLogStatistics(bool enable)
 
 void Connection::Disconnect(int waitMSec)
 {
-    peer_->CloseConnection(*address_, true);
+    if (transport_)
+        transport_->Close();
+    else
+        peer_->CloseConnection(*address_, true);
 }
 
 void Connection::SendServerUpdate()
@@ -282,15 +317,54 @@ void Connection::SendServerUpdate()
     nodesToProcess_.insert(sceneID);
     ProcessNode(sceneID);
 
+    // With an interest grid, only consider dirtied nodes of the hierarchies near the observer position
+    auto* interestGrid = scene_->GetComponent<NetworkInterestGrid>();
+    if (interestGrid && interestGrid->IsEnabledEffective())
+    {
+        UpdateInterest(interestGrid);
+
+        irrelevantNodes_.clear();
+        for (unsigned nodeID : sceneState_.dirtyNodes_)
+        {
+            // Nodes not found anymore are processed to send their removal
+            Node* node = scene_->GetNode(nodeID);
+            if (!node || IsNodeRelevant(node))
+                nodesToProcess_.insert(nodeID);
+            else
+                irrelevantNodes_.push_back(nodeID);
+        }
+
+        // Nodes that moved to an irrelevant hierarchy are removed from the client, new ones are sent once relevant
+        for (unsigned nodeID : irrelevantNodes_)
+        {
+            Node* node = scene_->GetNode(nodeID);
+            if (sceneState_.nodeStates_.contains(nodeID))
+                RemoveFromInterest(node);
+            else
+                sceneState_.dirtyNodes_.erase(nodeID);
+        }
+    }
+    else
+    {
+        // Send the nodes that were filtered out while the interest grid was in use
+        if (interestActive_)
+        {
+            interestActive_ = false;
+            relevantNodes_.clear();
+            MarkHierarchyDirty(scene_);
+        }
+
+        nodesToProcess_.insert(sceneState_.dirtyNodes_.begin(), sceneState_.dirtyNodes_.end());
+    }
+
     // Then go through all dirtied nodes
-    nodesToProcess_.insert(sceneState_.dirtyNodes_.begin(), sceneState_.dirtyNodes_.end());
     nodesToProcess_.erase(sceneID); // Do not process the root node twice
 
-    while (nodesToProcess_.size())
-    {
-        unsigned nodeID = *nodesToProcess_.begin();
+    // Iterate over a copy, as finding the first remaining element of a hash set after erasures scans all buckets.
+    // Nodes already processed as dependencies are skipped by ProcessNode
+    nodeProcessOrder_.assign(nodesToProcess_.begin(), nodesToProcess_.end());
+    for (unsigned nodeID : nodeProcessOrder_)
         ProcessNode(nodeID);
-    }
 }
 
 void Connection::SendClientUpdate()
@@ -406,7 +480,14 @@ void Connection::SendBuffer(PacketType type)
     if (type == PT_RELIABLE_UNORDERED)
         reliability = PacketReliability::RELIABLE;
 
-    if (peer_) {
+    totalBytesOut_ += buffer.GetSize();
+
+    if (transport_)
+    {
+        transport_->SendPacket(buffer.GetData(), buffer.GetSize(), type);
+        tempPacketCounter_.y_++;
+    }
+    else if (peer_) {
         peer_->Send((const char *) buffer.GetData(), (int) buffer.GetSize(), HIGH_PRIORITY, reliability, (char) 0,
                     *address_, false);
         tempPacketCounter_.y_++;
@@ -473,8 +554,8 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& buffer)
     }
 
     while (!buffer.IsEof()) {
-        msgID = buffer.ReadUInt();
-        unsigned int packetSize = buffer.ReadUInt();
+        msgID = buffer.ReadVLE();
+        unsigned int packetSize = buffer.ReadVLE();
         MemoryBuffer msg(buffer.GetData() + buffer.GetPosition(), packetSize);
         buffer.Seek(buffer.GetPosition() + packetSize);
 
@@ -629,7 +710,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
             }
 
             // Read initial attributes, then snap the motion smoothing immediately to the end
-            node->ReadDeltaUpdate(msg);
+            node->ReadDeltaUpdate(msg, true);
             auto* transform = node->GetComponent<SmoothedTransform>();
             if (transform)
                 transform->Update(1.0f, 0.0f);
@@ -669,7 +750,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
                 }
 
                 // Read initial attributes and apply
-                component->ReadDeltaUpdate(msg);
+                component->ReadDeltaUpdate(msg, true);
                 component->ApplyAttributes();
             }
         }
@@ -753,7 +834,7 @@ void Connection::ProcessSceneUpdate(int msgID, MemoryBuffer& msg)
                 }
 
                 // Read initial attributes and apply
-                component->ReadDeltaUpdate(msg);
+                component->ReadDeltaUpdate(msg, true);
                 component->ApplyAttributes();
             }
             else
@@ -1082,11 +1163,15 @@ Scene* Connection::GetScene() const
 
 bool Connection::IsConnected() const
 {
+    if (transport_)
+        return transport_->IsOpen();
     return peer_ && peer_->IsActive();
 }
 
 float Connection::GetRoundTripTime() const
 {
+    if (transport_)
+        return transport_->GetRoundTripTime();
     if (peer_)
     {
         SLNet::RakNetStatistics stats{};
@@ -1275,6 +1360,7 @@ void Connection::ProcessNewNode(Node* node)
 
     // Write node's attributes
     node->WriteInitialDeltaUpdate(msg_, timeStamp_);
+    node->UpdateLatestDataBaseline(nodeState, true);
 
     // Write node's user variables
     const VariantMap& vars = node->GetVars();
@@ -1304,6 +1390,7 @@ void Connection::ProcessNewNode(Node* node)
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
         component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+        component->UpdateLatestDataBaseline(componentState, true);
     }
 
     SendMessage(MSG_CREATENODE, true, true, msg_);
@@ -1312,6 +1399,119 @@ void Connection::ProcessNewNode(Node* node)
     sceneState_.dirtyNodes_.erase(node->GetID());
 }
 
+void Connection::UpdateInterest(NetworkInterestGrid* grid)
+{
+    interestActive_ = true;
+
+    // Nodes become relevant within the interest radius and stay relevant until they move past the margin
+    const float radius = grid->GetInterestRadius();
+    interestQuery_.clear();
+    grid->Query(interestQuery_, position_, radius + grid->GetInterestMargin());
+
+    newRelevantNodes_.clear();
+    for (const NetworkInterestGrid::QueryResult& result : interestQuery_)
+    {
+        if (result.distanceSquared_ <= radius * radius || relevantNodes_.contains(result.nodeID_))
+            newRelevantNodes_.insert(result.nodeID_);
+    }
+
+    // Remove leaving nodes from the client, except for the nodes owned by it. Removed nodes are handled as usual
+    for (unsigned nodeID : relevantNodes_)
+    {
+        if (newRelevantNodes_.contains(nodeID))
+            continue;
+
+        Node* node = scene_->GetNode(nodeID);
+        if (node && node->GetOwner() == this)
+            newRelevantNodes_.insert(nodeID);
+        else if (node)
+            RemoveFromInterest(node);
+    }
+
+    // Send entering nodes along with their children
+    for (unsigned nodeID : newRelevantNodes_)
+    {
+        if (!relevantNodes_.contains(nodeID))
+        {
+            if (Node* node = scene_->GetNode(nodeID))
+                MarkHierarchyDirty(node);
+        }
+    }
+
+    ea::swap(relevantNodes_, newRelevantNodes_);
+
+    // Nodes moved under another parent may have joined a relevant hierarchy
+    for (unsigned nodeID : grid->GetAddedNodes())
+    {
+        Node* node = scene_->GetNode(nodeID);
+        if (node && !sceneState_.nodeStates_.contains(nodeID) && IsNodeRelevant(node))
+            MarkHierarchyDirty(node);
+    }
+}
+
+bool Connection::IsNodeRelevant(Node* node) const
+{
+    Node* root = node;
+    while (root->GetParent() && root->GetParent() != scene_)
+        root = root->GetParent();
+
+    // The scene and the children of local nodes are not tracked by the grid and are always relevant
+    if (root == scene_ || !root->IsReplicated())
+        return true;
+
+    return relevantNodes_.contains(root->GetID()) || root->GetOwner() == this;
+}
+
+void Connection::MarkHierarchyDirty(Node* node)
+{
+    if (node->IsReplicated())
+        sceneState_.dirtyNodes_.insert(node->GetID());
+
+    node->GetChildren(interestChildren_, true);
+    for (Node* child : interestChildren_)
+    {
+        if (child->IsReplicated())
+            sceneState_.dirtyNodes_.insert(child->GetID());
+    }
+}
+
+void Connection::RemoveFromInterest(Node* node)
+{
+    // Removing the node on the client also removes its children
+    if (sceneState_.nodeStates_.contains(node->GetID()))
+    {
+        msg_.Clear();
+        msg_.WriteNetID(node->GetID());
+        SendMessage(MSG_REMOVENODE, true, true, msg_);
+    }
+
+    ForgetNode(node);
+    node->GetChildren(interestChildren_, true);
+    for (Node* child : interestChildren_)
+        ForgetNode(child);
+}
+
+void Connection::ForgetNode(Node* node)
+{
+    const unsigned nodeID = node->GetID();
+    sceneState_.dirtyNodes_.erase(nodeID);
+    nodesToProcess_.erase(nodeID);
+
+    auto i = sceneState_.nodeStates_.find(nodeID);
+    if (i == sceneState_.nodeStates_.end())
+        return;
+
+    // Stop tracking, so that the node is sent again from scratch when it becomes relevant
+    NodeReplicationState& nodeState = i->second;
+    for (auto j = nodeState.componentStates_.begin(); j != nodeState.componentStates_.end(); ++j)
+    {
+        if (Component* component = j->second.component_)
+            component->RemoveReplicationState(&j->second);
+    }
+    node->RemoveReplicationState(&nodeState);
+    sceneState_.nodeStates_.erase(i);
+}
+
 void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState)
 {
     // Process depended upon nodes first, if they are dirty
@@ -1328,7 +1528,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     auto* priority = node->GetComponent<NetworkPriority>();
     if (priority && (!priority->GetAlwaysUpdateOwner() || node->GetOwner() != this))
     {
-        float distance = (node->GetWorldPosition() - position_).Length();
+        float distance = (GetUncachedWorldPosition(node) - position_).Length();
         if (!priority->CheckUpdate(distance, nodeState.priorityAcc_))
             return;
     }
@@ -1338,7 +1538,9 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     {
         const ea::vector<AttributeInfo>* attributes = node->GetNetworkAttributes();
         unsigned numAttributes = attributes->size();
+        const DirtyBits dirtyAttributes = nodeState.dirtyAttributes_;
         bool hasLatestData = false;
+        bool updateBaseline = false;
 
         for (unsigned i = 0; i < numAttributes; ++i)
         {
@@ -1349,14 +1551,19 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             }
         }
 
-        // Send latestdata message if necessary
+        // Send latestdata message if necessary. If the baseline is outdated, send the latest data reliably instead
         if (hasLatestData)
         {
             msg_.Clear();
             msg_.WriteNetID(node->GetID());
-            node->WriteLatestDataUpdate(msg_, timeStamp_);
-
-            SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
+            if (node->WriteLatestDataUpdate(msg_, latestDataBits_, timeStamp_, nodeState))
+                SendMessage(MSG_NODELATESTDATA, true, false, msg_, node->GetID());
+            else
+            {
+                nodeState.dirtyAttributes_ = dirtyAttributes;
+                node->GetLatestDataBaselineAttributes(nodeState.dirtyAttributes_);
+                updateBaseline = true;
+            }
         }
 
         // Send deltaupdate if remaining dirty bits, or vars have changed
@@ -1365,6 +1572,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             msg_.Clear();
             msg_.WriteNetID(node->GetID());
             node->WriteDeltaUpdate(msg_, nodeState.dirtyAttributes_, timeStamp_);
+            if (updateBaseline)
+                node->UpdateLatestDataBaseline(nodeState, false);
 
             // Write changed variables
             msg_.WriteVLE(nodeState.dirtyVars_.size());
@@ -1416,7 +1625,9 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             {
                 const ea::vector<AttributeInfo>* attributes = component->GetNetworkAttributes();
                 unsigned numAttributes = attributes->size();
+                const DirtyBits dirtyAttributes = componentState.dirtyAttributes_;
                 bool hasLatestData = false;
+                bool updateBaseline = false;
 
                 for (unsigned i = 0; i < numAttributes; ++i)
                 {
@@ -1427,14 +1638,19 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                     }
                 }
 
-                // Send latestdata message if necessary
+                // Send latestdata message if necessary. If the baseline is outdated, send the latest data reliably instead
                 if (hasLatestData)
                 {
                     msg_.Clear();
                     msg_.WriteNetID(component->GetID());
-                    component->WriteLatestDataUpdate(msg_, timeStamp_);
-
-                    SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
+                    if (component->WriteLatestDataUpdate(msg_, latestDataBits_, timeStamp_, componentState))
+                        SendMessage(MSG_COMPONENTLATESTDATA, true, false, msg_, component->GetID());
+                    else
+                    {
+                        componentState.dirtyAttributes_ = dirtyAttributes;
+                        component->GetLatestDataBaselineAttributes(componentState.dirtyAttributes_);
+                        updateBaseline = true;
+                    }
                 }
 
                 // Send deltaupdate if remaining dirty bits
@@ -1443,6 +1659,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                     msg_.Clear();
                     msg_.WriteNetID(component->GetID());
                     component->WriteDeltaUpdate(msg_, componentState.dirtyAttributes_, timeStamp_);
+                    if (updateBaseline)
+                        component->UpdateLatestDataBaseline(componentState, false);
 
                     SendMessage(MSG_COMPONENTDELTAUPDATE, true, true, msg_);
 
@@ -1479,6 +1697,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 msg_.WriteStringHash(component->GetType());
                 msg_.WriteNetID(component->GetID());
                 component->WriteInitialDeltaUpdate(msg_, timeStamp_);
+                component->UpdateLatestDataBaseline(componentState, true);
 
                 SendMessage(MSG_CREATECOMPONENT, true, true, msg_);
             }
@@ -29,7 +29,9 @@
 #include "../Core/Object.h"
 #include "../Core/Timer.h"
 #include "../Input/Controls.h"
+#include "../IO/BitStream.h"
 #include "../IO/VectorBuffer.h"
+#include "../Network/NetworkInterestGrid.h"
 #include "../Scene/ReplicationState.h"
 
 namespace SLNet
@@ -115,6 +117,20 @@ enum PacketType {
     PT_RELIABLE_ORDERED
 };
 
+/// Packet transport of a connection. Connections without a transport send through their SLikeNet peer.
+class URHO3D_API NetworkTransport : public RefCounted
+{
+public:
+    /// Send a packet. The data begins with the SLikeNet message ID, followed by the Urho3D message ID.
+    virtual void SendPacket(const unsigned char* data, unsigned size, PacketType type) = 0;
+    /// Close the connection.
+    virtual void Close() = 0;
+    /// Return whether the connection is open.
+    virtual bool IsOpen() const = 0;
+    /// Return round trip time in milliseconds.
+    virtual float GetRoundTripTime() const = 0;
+};
+
 /// %Connection to a remote network host.
 class URHO3D_API Connection : public Object
 {
@@ -127,6 +143,8 @@ public:
     ~Connection() override;
     /// Initialize object state. Should be called immediately after constructor.
     void Initialize(bool isClient, const SLNet::AddressOrGUID& address, SLNet::RakPeerInterface* peer);
+    /// Initialize object state with a custom packet transport. Should be called immediately after constructor.
+    void InitializeTransport(bool isClient, const SLNet::AddressOrGUID& address, NetworkTransport* transport);
 
     /// Register object with the engine.
     static void RegisterObject(Context* context);
@@ -161,7 +179,7 @@ public:
     void SetLogStatistics(bool enable);
     /// Disconnect. If wait time is non-zero, will block while waiting for disconnect to finish.
     void Disconnect(int waitMSec = 0);
-    /// Send scene update messages. Called by Network.
+    /// Send scene update messages. Called by Network, concurrently for all client connections.
     void SendServerUpdate();
     /// Send latest controls from the client. Called by Network.
     void SendClientUpdate();
@@ -256,6 +274,10 @@ public:
     /// @property
     int GetPacketsOutPerSec() const;
 
+    /// Return total size of the message packets sent, excluding transport overhead.
+    /// @property
+    unsigned long long GetTotalBytesOut() const { return totalBytesOut_; }
+
     /// Return an address:port string.
     ea::string ToString() const;
     /// Return number of package downloads remaining.
@@ -307,6 +329,16 @@ private:
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Update the root-level nodes relevant to the client from the interest grid. Sends entering nodes and removes leaving ones.
+    void UpdateInterest(NetworkInterestGrid* grid);
+    /// Return whether the node belongs to a hierarchy relevant to the client.
+    bool IsNodeRelevant(Node* node) const;
+    /// Mark a node and its replicated children dirty.
+    void MarkHierarchyDirty(Node* node);
+    /// Remove a node and its children from the client while they remain in the scene on the server.
+    void RemoveFromInterest(Node* node);
+    /// Forget the replication state of a single node.
+    void ForgetNode(Node* node);
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Process unknown message. All unknown messages are forwarded as an events
@@ -338,8 +370,22 @@ private:
     ea::unordered_map<unsigned, ea::vector<unsigned char> > componentLatestData_;
     /// Node ID's to process during a replication update.
     ea::hash_set<unsigned> nodesToProcess_;
+    /// Order of processing nodes during a replication update.
+    ea::vector<unsigned> nodeProcessOrder_;
+    /// Root-level nodes within the interest area of the client.
+    ea::hash_set<unsigned> relevantNodes_;
+    /// Root-level nodes within the interest area being collected during a replication update.
+    ea::hash_set<unsigned> newRelevantNodes_;
+    /// Reusable interest grid query results.
+    ea::vector<NetworkInterestGrid::QueryResult> interestQuery_;
+    /// Reusable child node list for interest changes.
+    ea::vector<Node*> interestChildren_;
+    /// Dirty nodes outside of the interest area during a replication update.
+    ea::vector<unsigned> irrelevantNodes_;
     /// Reusable message buffer.
     VectorBuffer msg_;
+    /// Reusable bit-packed latest data buffer.
+    BitWriter latestDataBits_;
     /// Queued remote events.
     ea::vector<RemoteEvent> remoteEvents_;
     /// Scene file to load once all packages (if any) have been downloaded.
@@ -362,14 +408,20 @@ private:
     bool sceneLoaded_;
     /// Show statistics flag.
     bool logStatistics_;
+    /// Whether nodes were last filtered by an interest grid.
+    bool interestActive_{};
     /// Address of this connection.
     SLNet::AddressOrGUID* address_;
     /// Raknet peer object.
     SLNet::RakPeerInterface* peer_;
+    /// Custom packet transport used instead of the peer.
+    SharedPtr<NetworkTransport> transport_;
     /// Temporary variable to hold packet count in the next second, x - packets in, y - packets out.
     IntVector2 tempPacketCounter_;
     /// Packet count in the last second, x - packets in, y - packets out.
     IntVector2 packetCounter_;
+    /// Total size of the message packets sent.
+    unsigned long long totalBytesOut_{};
     /// Packet count timer which resets every 1s.
     Timer packetCounterTimer_;
     /// Last heard timer, resets when new packet is incoming.
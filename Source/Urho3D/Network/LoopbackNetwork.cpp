@@ -0,0 +1,312 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Network/LoopbackNetwork.h"
+#include "../Network/Network.h"
+#include "../Network/Protocol.h"
+
+#include <EASTL/heap.h>
+
+#include <slikenet/MessageIdentifiers.h>
+#include <slikenet/types.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Shortest delay before a lost reliable packet is sent again, in milliseconds.
+static const float MIN_RESEND_DELAY = 10.0f;
+/// Maximum number of times a reliable packet is lost before it is delivered anyway.
+static const unsigned MAX_RESENDS = 10;
+
+/// Transport of one direction of a simulated client connection.
+class LoopbackTransport : public NetworkTransport
+{
+public:
+    /// Construct.
+    explicit LoopbackTransport(LoopbackNetwork* network) : network_(network) {}
+
+    /// Queue a packet for the loopback network. Server updates are sent from worker threads, so the packets are handed over to the network later on the main thread.
+    void SendPacket(const unsigned char* data, unsigned size, PacketType type) override
+    {
+        if (!network_ || !target_)
+            return;
+
+        QueuedPacket packet;
+        packet.offset_ = queuedData_.size();
+        packet.size_ = size;
+        packet.type_ = type;
+        queuedPackets_.push_back(packet);
+        queuedData_.insert(queuedData_.end(), data, data + size);
+    }
+
+    /// Hand the queued packets over to the loopback network. Called on the main thread.
+    void FlushPackets()
+    {
+        if (network_ && target_)
+        {
+            for (const QueuedPacket& packet : queuedPackets_)
+                network_->SendPacket(this, queuedData_.data() + packet.offset_, packet.size_, packet.type_);
+        }
+
+        queuedPackets_.clear();
+        queuedData_.clear();
+    }
+
+    /// Return number of queued packets.
+    unsigned GetNumQueuedPackets() const { return queuedPackets_.size(); }
+
+    /// Disconnect the simulated client.
+    void Close() override
+    {
+        if (network_ && target_)
+            network_->Disconnect(target_);
+    }
+
+    /// Return whether the connection is open.
+    bool IsOpen() const override { return network_ && target_; }
+
+    /// Return round trip time in milliseconds.
+    float GetRoundTripTime() const override { return network_ ? 2.0f * network_->GetLatency() : 0.0f; }
+
+    /// Set receiving connection. Null closes the transport.
+    void SetTarget(Connection* target) { target_ = target; }
+
+    /// Return receiving connection.
+    Connection* GetTarget() const { return target_; }
+
+    /// Delivery time of the last reliable ordered packet in milliseconds.
+    double lastOrderedDelivery_{};
+
+private:
+    /// Packet waiting to be handed over to the loopback network.
+    struct QueuedPacket
+    {
+        /// Offset of the packet data.
+        unsigned offset_{};
+        /// Packet size.
+        unsigned size_{};
+        /// Packet type.
+        PacketType type_{};
+    };
+
+    /// Loopback network.
+    WeakPtr<LoopbackNetwork> network_;
+    /// Receiving connection.
+    WeakPtr<Connection> target_;
+    /// Queued packets.
+    ea::vector<QueuedPacket> queuedPackets_;
+    /// Data of the queued packets.
+    ea::vector<unsigned char> queuedData_;
+};
+
+/// Return address identifying a simulated client on the server.
+static SLNet::AddressOrGUID GetClientAddress(unsigned long long id)
+{
+    return SLNet::AddressOrGUID(SLNet::RakNetGUID(id));
+}
+
+LoopbackNetwork::LoopbackNetwork(Context* context) :
+    Object(context),
+    network_(GetSubsystem<Network>()),
+    random_(0u)
+{
+}
+
+LoopbackNetwork::~LoopbackNetwork()
+{
+    DisconnectAll();
+}
+
+Connection* LoopbackNetwork::Connect(Scene* scene, const VariantMap& identity)
+{
+    if (!network_)
+    {
+        URHO3D_LOGERROR("Network subsystem is required for loopback connections");
+        return nullptr;
+    }
+
+    Client client;
+    client.id_ = nextClientID_++;
+    client.toServer_ = MakeShared<LoopbackTransport>(this);
+    client.toClient_ = MakeShared<LoopbackTransport>(this);
+
+    const SLNet::AddressOrGUID address = GetClientAddress(client.id_);
+    client.clientConnection_ = context_->CreateObject<Connection>();
+    client.clientConnection_->InitializeTransport(false, address, client.toServer_);
+    client.clientConnection_->SetScene(scene);
+    client.clientConnection_->SetIdentity(identity);
+    client.toClient_->SetTarget(client.clientConnection_);
+    clients_.push_back(client);
+
+    // The server side connection is created as for clients connected through SLikeNet
+    network_->NewConnectionEstablished(address, client.toClient_);
+    client.toServer_->SetTarget(network_->GetConnection(address));
+
+    // Send the identity, as the client does once connected
+    VectorBuffer msg;
+    msg.WriteVariantMap(identity);
+    client.clientConnection_->SendMessage(MSG_IDENTITY, true, true, msg);
+
+    return client.clientConnection_;
+}
+
+void LoopbackNetwork::Disconnect(Connection* connection)
+{
+    for (unsigned i = 0; i < clients_.size(); ++i)
+    {
+        if (clients_[i].clientConnection_ == connection || clients_[i].toServer_->GetTarget() == connection)
+        {
+            RemoveClient(i);
+            return;
+        }
+    }
+}
+
+void LoopbackNetwork::DisconnectAll()
+{
+    while (!clients_.empty())
+        RemoveClient(clients_.size() - 1);
+}
+
+void LoopbackNetwork::Update(float timeStep)
+{
+    URHO3D_PROFILE("UpdateLoopbackNetwork");
+
+    // Packets sent since the last update, including the server updates, leave at the current time
+    FlushPackets();
+
+    time_ += timeStep * 1000.0;
+
+    while (!packets_.empty() && packets_.front().deliveryTime_ <= time_)
+    {
+        ea::pop_heap(packets_.begin(), packets_.end());
+        Packet packet = ea::move(packets_.back());
+        packets_.pop_back();
+
+        // Packets to disconnected clients are dropped
+        if (Connection* target = packet.target_)
+            DeliverPacket(target, packet.data_);
+
+        packet.data_.clear();
+        freeBuffers_.push_back(ea::move(packet.data_));
+    }
+
+    // Send the client updates, as Network::PostUpdate does for the connection to the server
+    for (unsigned i = 0; i < clients_.size(); ++i)
+    {
+        Connection* connection = clients_[i].clientConnection_;
+        connection->SendClientUpdate();
+        connection->SendRemoteEvents();
+        connection->SendAllBuffers();
+    }
+    FlushPackets();
+}
+
+unsigned LoopbackNetwork::GetNumPendingPackets() const
+{
+    unsigned numPackets = packets_.size();
+    for (const Client& client : clients_)
+        numPackets += client.toServer_->GetNumQueuedPackets() + client.toClient_->GetNumQueuedPackets();
+    return numPackets;
+}
+
+Connection* LoopbackNetwork::GetServerConnection(unsigned index) const
+{
+    return index < clients_.size() ? clients_[index].toServer_->GetTarget() : nullptr;
+}
+
+void LoopbackNetwork::SendPacket(LoopbackTransport* transport, const unsigned char* data, unsigned size, PacketType type)
+{
+    double deliveryTime = time_ + latency_;
+
+    // Lost reliable packets are sent again after a round trip, possibly getting lost again
+    const bool reliable = type == PT_RELIABLE_ORDERED || type == PT_RELIABLE_UNORDERED;
+    for (unsigned i = 0; i < MAX_RESENDS && random_.GetBool(packetLoss_); ++i)
+    {
+        if (!reliable)
+            return;
+        deliveryTime += Max(2.0f * latency_, MIN_RESEND_DELAY);
+    }
+
+    // Reliable ordered packets wait for the earlier ones
+    if (type == PT_RELIABLE_ORDERED)
+    {
+        deliveryTime = Max(deliveryTime, transport->lastOrderedDelivery_);
+        transport->lastOrderedDelivery_ = deliveryTime;
+    }
+
+    Packet packet;
+    packet.deliveryTime_ = deliveryTime;
+    packet.sequence_ = nextSequence_++;
+    packet.target_ = transport->GetTarget();
+    if (!freeBuffers_.empty())
+    {
+        packet.data_ = ea::move(freeBuffers_.back());
+        freeBuffers_.pop_back();
+    }
+    packet.data_.assign(data, data + size);
+
+    packets_.push_back(ea::move(packet));
+    ea::push_heap(packets_.begin(), packets_.end());
+}
+
+void LoopbackNetwork::FlushPackets()
+{
+    for (const Client& client : clients_)
+    {
+        client.toServer_->FlushPackets();
+        client.toClient_->FlushPackets();
+    }
+}
+
+void LoopbackNetwork::DeliverPacket(Connection* connection, const ea::vector<unsigned char>& data)
+{
+    // Urho3D messages begin with the SLikeNet user packet ID and the message ID, as in Network::HandleIncomingPacket
+    if (data.size() <= 1 + sizeof(unsigned) || data[0] < ID_USER_PACKET_ENUM)
+        return;
+
+    MemoryBuffer buffer(data.data() + 1, data.size() - 1);
+    const unsigned msgID = buffer.ReadUInt();
+    connection->ProcessMessage(msgID, buffer);
+}
+
+void LoopbackNetwork::RemoveClient(unsigned index)
+{
+    const Client client = clients_[index];
+    clients_.erase(clients_.begin() + index);
+
+    client.toServer_->SetTarget(nullptr);
+    client.toClient_->SetTarget(nullptr);
+    if (network_)
+        network_->ClientDisconnected(GetClientAddress(client.id_));
+}
+
+}
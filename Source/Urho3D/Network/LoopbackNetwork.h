@@ -0,0 +1,154 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Math/RandomEngine.h"
+#include "../Network/Connection.h"
+
+namespace Urho3D
+{
+
+class LoopbackTransport;
+class Network;
+class Scene;
+
+/// In-process network of simulated clients connected to the local server through memory, without sockets. Packets are delivered with deterministic latency and packet loss as Update advances the simulated time. The server side connections are regular client connections of the %Network subsystem.
+class URHO3D_API LoopbackNetwork : public Object
+{
+    URHO3D_OBJECT(LoopbackNetwork, Object);
+
+public:
+    /// Construct.
+    explicit LoopbackNetwork(Context* context);
+    /// Destruct. Disconnect all clients.
+    ~LoopbackNetwork() override;
+
+    /// Connect a simulated client to the local server. The client receives the replicated server scene into the given scene. Return the client side connection.
+    Connection* Connect(Scene* scene, const VariantMap& identity = Variant::emptyVariantMap);
+    /// Disconnect a simulated client. Either the client or the server side connection may be given.
+    void Disconnect(Connection* connection);
+    /// Disconnect all simulated clients.
+    void DisconnectAll();
+    /// Advance the simulated time, deliver the packets that have arrived and send the client updates. Server updates are sent by Network::PostUpdate.
+    void Update(float timeStep);
+
+    /// Set one-way latency in milliseconds.
+    /// @property
+    void SetLatency(float latencyMs) { latency_ = Max(latencyMs, 0.0f); }
+    /// Set packet loss probability. Lost reliable packets are sent again after a round trip, lost unreliable packets are dropped.
+    /// @property
+    void SetPacketLoss(float probability) { packetLoss_ = Clamp(probability, 0.0f, 1.0f); }
+    /// Restart the packet loss sequence with a seed.
+    void SetRandomSeed(unsigned seed) { random_ = RandomEngine(seed); }
+
+    /// Return one-way latency in milliseconds.
+    /// @property
+    float GetLatency() const { return latency_; }
+
+    /// Return packet loss probability.
+    /// @property
+    float GetPacketLoss() const { return packetLoss_; }
+
+    /// Return simulated time in milliseconds.
+    /// @property
+    double GetTime() const { return time_; }
+
+    /// Return number of connected clients.
+    /// @property
+    unsigned GetNumClients() const { return clients_.size(); }
+
+    /// Return client side connection by index.
+    Connection* GetClientConnection(unsigned index) const { return index < clients_.size() ? clients_[index].clientConnection_ : nullptr; }
+    /// Return server side connection of a client by index.
+    Connection* GetServerConnection(unsigned index) const;
+    /// Return number of packets waiting for delivery.
+    /// @property
+    unsigned GetNumPendingPackets() const;
+
+    /// Send a packet over a transport. Called by the transports on the main thread.
+    void SendPacket(LoopbackTransport* transport, const unsigned char* data, unsigned size, PacketType type);
+
+private:
+    /// Simulated client.
+    struct Client
+    {
+        /// Identifier used as the client GUID on the server.
+        unsigned long long id_{};
+        /// Client side connection.
+        SharedPtr<Connection> clientConnection_;
+        /// Transport from the client to the server.
+        SharedPtr<LoopbackTransport> toServer_;
+        /// Transport from the server to the client.
+        SharedPtr<LoopbackTransport> toClient_;
+    };
+
+    /// Packet in flight.
+    struct Packet
+    {
+        /// Delivery time in milliseconds.
+        double deliveryTime_{};
+        /// Send order, to deliver simultaneous packets in order.
+        unsigned long long sequence_{};
+        /// Receiving connection.
+        WeakPtr<Connection> target_;
+        /// Packet data.
+        ea::vector<unsigned char> data_;
+
+        /// Compare for the delivery heap, which keeps the earliest packet first.
+        bool operator <(const Packet& rhs) const
+        {
+            return deliveryTime_ != rhs.deliveryTime_ ? deliveryTime_ > rhs.deliveryTime_ : sequence_ > rhs.sequence_;
+        }
+    };
+
+    /// Hand the packets queued by the transports over to the delivery heap.
+    void FlushPackets();
+    /// Deliver a packet to the receiving connection.
+    void DeliverPacket(Connection* connection, const ea::vector<unsigned char>& data);
+    /// Remove a client by index.
+    void RemoveClient(unsigned index);
+
+    /// Network subsystem.
+    WeakPtr<Network> network_;
+    /// Connected clients.
+    ea::vector<Client> clients_;
+    /// Packets in flight as a heap ordered by delivery time.
+    ea::vector<Packet> packets_;
+    /// Data buffers of delivered packets for reuse.
+    ea::vector<ea::vector<unsigned char> > freeBuffers_;
+    /// Random number generator for packet loss.
+    RandomEngine random_;
+    /// Simulated time in milliseconds.
+    double time_{};
+    /// One-way latency in milliseconds.
+    float latency_{};
+    /// Packet loss probability.
+    float packetLoss_{};
+    /// Next packet sequence number.
+    unsigned long long nextSequence_{};
+    /// Next client identifier.
+    unsigned long long nextClientID_{1};
+};
+
+}
@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
@@ -34,6 +35,7 @@
 #include "../Network/HttpRequest.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
+#include "../Network/NetworkInterestGrid.h"
 #include "../Network/NetworkPriority.h"
 #include "../Network/Protocol.h"
 #include "../Scene/Scene.h"
@@ -311,6 +313,18 @@ void Network::NewConnectionEstablished(const SLNet::AddressOrGUID& connection)
     SharedPtr<Connection> newConnection(context_->CreateObject<Connection>());
     newConnection->Initialize(true, connection, rakPeer_);
     newConnection->ConfigureNetworkSimulator(simulatedLatency_, simulatedPacketLoss_);
+    AddClientConnection(connection, newConnection);
+}
+
+void Network::NewConnectionEstablished(const SLNet::AddressOrGUID& connection, NetworkTransport* transport)
+{
+    SharedPtr<Connection> newConnection(context_->CreateObject<Connection>());
+    newConnection->InitializeTransport(true, connection, transport);
+    AddClientConnection(connection, newConnection);
+}
+
+void Network::AddClientConnection(const SLNet::AddressOrGUID& connection, Connection* newConnection)
+{
     clientConnections_[GetEndpointHash(connection)] = newConnection;
     URHO3D_LOGINFO("Client " + newConnection->ToString() + " connected");
 
@@ -922,7 +936,8 @@ void Network::PostUpdate(float timeStep)
         SendEvent(E_NETWORKUPDATE);
         updateAcc_ = fmodf(updateAcc_, updateInterval_);
 
-        if (IsServerRunning())
+        // Connections with a custom transport are updated without a running server
+        if (IsServerRunning() || !clientConnections_.empty())
         {
             // Collect and prepare all networked scenes
             {
@@ -937,19 +952,35 @@ void Network::PostUpdate(float timeStep)
                 }
 
                 for (auto i = networkScenes_.begin(); i != networkScenes_.end(); ++i)
+                {
+                    // Interest grid reads the nodes marked for network update, so update it first
+                    if (auto* interestGrid = (*i)->GetComponent<NetworkInterestGrid>())
+                        interestGrid->Update();
                     (*i)->PrepareNetworkUpdate();
+                }
             }
 
             {
                 URHO3D_PROFILE("SendServerUpdate");
 
-                // Then send server updates for each client connection
+                // Then build server updates for each client connection in parallel. Attribute values are serialized
+                // once by the first connection that needs them and copied by the rest
+                updateConnections_.clear();
                 for (auto i = clientConnections_.begin(); i != clientConnections_.end(); ++i)
+                    updateConnections_.push_back(i->second);
+
+                GetSubsystem<WorkQueue>()->ParallelFor(updateConnections_.size(), 1,
+                    [this](unsigned begin, unsigned end, unsigned threadIndex)
+                {
+                    for (unsigned i = begin; i < end; ++i)
+                        updateConnections_[i]->SendServerUpdate();
+                });
+
+                for (Connection* connection : updateConnections_)
                 {
-                    i->second->SendServerUpdate();
-                    i->second->SendRemoteEvents();
-                    i->second->SendPackages();
-                    i->second->SendAllBuffers();
+                    connection->SendRemoteEvents();
+                    connection->SendPackages();
+                    connection->SendAllBuffers();
                 }
             }
         }
@@ -1035,6 +1066,7 @@ unsigned long Network::GetEndpointHash(const SLNet::AddressOrGUID& endpoint)
 void RegisterNetworkLibrary(Context* context)
 {
     NetworkPriority::RegisterObject(context);
+    NetworkInterestGrid::RegisterObject(context);
     Connection::RegisterObject(context);
 }
 
@@ -50,6 +50,8 @@ public:
     void HandleMessage(const SLNet::AddressOrGUID& source, int packetID, int msgID, const char* data, size_t numBytes);
     /// Handle a new client connection.
     void NewConnectionEstablished(const SLNet::AddressOrGUID& connection);
+    /// Handle a new client connection using a custom packet transport. Server updates are sent to it even if the server is not running.
+    void NewConnectionEstablished(const SLNet::AddressOrGUID& connection, NetworkTransport* transport);
     /// Handle a client disconnection.
     void ClientDisconnected(const SLNet::AddressOrGUID& connection);
 
@@ -154,6 +156,8 @@ private:
     void OnServerConnected(const SLNet::AddressOrGUID& address);
     /// Handle server disconnection.
     void OnServerDisconnected(const SLNet::AddressOrGUID& address);
+    /// Register a new client connection and send the connected event.
+    void AddClientConnection(const SLNet::AddressOrGUID& connection, Connection* newConnection);
     /// Reconfigure network simulator parameters on all existing connections.
     void ConfigureNetworkSimulator();
     /// All incoming packages are handled here.
@@ -175,6 +179,8 @@ private:
     ea::hash_set<StringHash> blacklistedRemoteEvents_;
     /// Networked scenes.
     ea::hash_set<Scene*> networkScenes_;
+    /// Client connections receiving the current server update.
+    ea::vector<Connection*> updateConnections_;
     /// Update FPS.
     int updateFps_;
     /// Simulated latency (send delay) in milliseconds.
@@ -0,0 +1,261 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Network/NetworkInterestGrid.h"
+#include "../Scene/ReplicationState.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* NETWORK_CATEGORY;
+
+static const float DEFAULT_CELL_SIZE = 32.0f;
+static const float DEFAULT_INTEREST_RADIUS = 128.0f;
+static const float DEFAULT_INTEREST_MARGIN = 16.0f;
+static const float MIN_CELL_SIZE = 0.1f;
+
+NetworkInterestGrid::NetworkInterestGrid(Context* context) :
+    Component(context),
+    cellSize_(DEFAULT_CELL_SIZE),
+    interestRadius_(DEFAULT_INTEREST_RADIUS),
+    interestMargin_(DEFAULT_INTEREST_MARGIN)
+{
+}
+
+NetworkInterestGrid::~NetworkInterestGrid() = default;
+
+void NetworkInterestGrid::RegisterObject(Context* context)
+{
+    context->RegisterFactory<NetworkInterestGrid>(NETWORK_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Cell Size", GetCellSize, SetCellSize, float, DEFAULT_CELL_SIZE, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Interest Radius", GetInterestRadius, SetInterestRadius, float, DEFAULT_INTEREST_RADIUS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Interest Margin", GetInterestMargin, SetInterestMargin, float, DEFAULT_INTEREST_MARGIN, AM_DEFAULT);
+}
+
+void NetworkInterestGrid::SetCellSize(float size)
+{
+    size = Max(size, MIN_CELL_SIZE);
+    if (size != cellSize_)
+    {
+        cellSize_ = size;
+        Rebuild();
+    }
+}
+
+void NetworkInterestGrid::SetInterestRadius(float radius)
+{
+    interestRadius_ = Max(radius, 0.0f);
+}
+
+void NetworkInterestGrid::SetInterestMargin(float margin)
+{
+    interestMargin_ = Max(margin, 0.0f);
+}
+
+void NetworkInterestGrid::Update()
+{
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+    URHO3D_PROFILE("UpdateNetworkInterestGrid");
+
+    // Root-level nodes move with their position, nodes moved under another parent are no longer tracked
+    for (unsigned nodeID : scene->GetNetworkUpdateNodes())
+    {
+        Node* node = scene->GetNode(nodeID);
+        if (!node)
+            continue;
+
+        if (node->GetParent() == scene && node->IsReplicated())
+            TrackNode(node);
+        else
+            UntrackNode(nodeID);
+    }
+
+    ea::swap(addedNodes_, pendingAddedNodes_);
+    pendingAddedNodes_.clear();
+}
+
+void NetworkInterestGrid::Query(ea::vector<QueryResult>& result, const Vector3& position, float radius) const
+{
+    const Vector2 center{ position.x_, position.z_ };
+    const float radiusSquared = radius * radius;
+    const int minX = FloorToInt((center.x_ - radius) / cellSize_);
+    const int maxX = FloorToInt((center.x_ + radius) / cellSize_);
+    const int minZ = FloorToInt((center.y_ - radius) / cellSize_);
+    const int maxZ = FloorToInt((center.y_ + radius) / cellSize_);
+
+    for (int x = minX; x <= maxX; ++x)
+    {
+        for (int z = minZ; z <= maxZ; ++z)
+        {
+            const unsigned long long key = (static_cast<unsigned long long>(static_cast<unsigned>(x)) << 32u) | static_cast<unsigned>(z);
+            auto cell = cells_.find(key);
+            if (cell == cells_.end())
+                continue;
+
+            for (const CellNode& cellNode : cell->second)
+            {
+                const float distanceSquared = (cellNode.position_ - center).LengthSquared();
+                if (distanceSquared <= radiusSquared)
+                    result.push_back({ cellNode.nodeID_, distanceSquared });
+            }
+        }
+    }
+}
+
+void NetworkInterestGrid::OnSceneSet(Scene* scene)
+{
+    UnsubscribeFromAllEvents();
+
+    if (scene)
+    {
+        SubscribeToEvent(scene, E_NODEADDED, URHO3D_HANDLER(NetworkInterestGrid, HandleNodeAdded));
+        SubscribeToEvent(scene, E_NODEREMOVED, URHO3D_HANDLER(NetworkInterestGrid, HandleNodeRemoved));
+    }
+
+    Rebuild();
+}
+
+unsigned long long NetworkInterestGrid::GetCellKey(const Vector2& position) const
+{
+    const auto x = static_cast<unsigned>(FloorToInt(position.x_ / cellSize_));
+    const auto z = static_cast<unsigned>(FloorToInt(position.y_ / cellSize_));
+    return (static_cast<unsigned long long>(x) << 32u) | z;
+}
+
+void NetworkInterestGrid::TrackNode(Node* node)
+{
+    const Vector3& nodePosition = node->GetPosition();
+    const Vector2 position{ nodePosition.x_, nodePosition.z_ };
+
+    auto iter = nodes_.find(node->GetID());
+    if (iter == nodes_.end())
+    {
+        AddToCell(node->GetID(), position);
+        return;
+    }
+
+    const unsigned long long cell = GetCellKey(position);
+    if (iter->second.cell_ == cell)
+        cells_[cell][iter->second.index_].position_ = position;
+    else
+    {
+        RemoveFromCell(iter->second);
+        AddToCell(node->GetID(), position);
+    }
+}
+
+void NetworkInterestGrid::UntrackNode(unsigned nodeID)
+{
+    auto iter = nodes_.find(nodeID);
+    if (iter != nodes_.end())
+    {
+        RemoveFromCell(iter->second);
+        nodes_.erase(iter);
+    }
+}
+
+void NetworkInterestGrid::AddToCell(unsigned nodeID, const Vector2& position)
+{
+    const unsigned long long cellKey = GetCellKey(position);
+    ea::vector<CellNode>& cell = cells_[cellKey];
+    nodes_[nodeID] = { cellKey, static_cast<unsigned>(cell.size()) };
+    cell.push_back({ nodeID, position });
+}
+
+void NetworkInterestGrid::RemoveFromCell(const NodeLocation& location)
+{
+    auto cellIter = cells_.find(location.cell_);
+    ea::vector<CellNode>& cell = cellIter->second;
+
+    // Move the last node of the cell into the vacated slot
+    const unsigned lastIndex = cell.size() - 1;
+    if (location.index_ != lastIndex)
+    {
+        cell[location.index_] = cell[lastIndex];
+        nodes_[cell[location.index_].nodeID_].index_ = location.index_;
+    }
+
+    cell.pop_back();
+    if (cell.empty())
+        cells_.erase(cellIter);
+}
+
+void NetworkInterestGrid::Rebuild()
+{
+    nodes_.clear();
+    cells_.clear();
+
+    Scene* scene = GetScene();
+    if (!scene)
+        return;
+
+    for (Node* node : scene->GetChildren())
+    {
+        if (node->IsReplicated())
+            TrackNode(node);
+    }
+}
+
+void NetworkInterestGrid::HandleNodeAdded(StringHash eventType, VariantMap& eventData)
+{
+    using namespace NodeAdded;
+
+    auto* parent = static_cast<Node*>(eventData[P_PARENT].GetPtr());
+    auto* node = static_cast<Node*>(eventData[P_NODE].GetPtr());
+    if (parent == GetScene())
+    {
+        if (node->IsReplicated())
+            TrackNode(node);
+    }
+    else if (node->IsReplicated())
+    {
+        // Added nodes are only consumed by connections, do not collect them while nothing replicates the scene
+        NetworkState* sceneState = GetScene()->GetNetworkState();
+        if (sceneState && !sceneState->replicationStates_.empty())
+            pendingAddedNodes_.push_back(node->GetID());
+    }
+}
+
+void NetworkInterestGrid::HandleNodeRemoved(StringHash eventType, VariantMap& eventData)
+{
+    using namespace NodeRemoved;
+
+    auto* parent = static_cast<Node*>(eventData[P_PARENT].GetPtr());
+    auto* node = static_cast<Node*>(eventData[P_NODE].GetPtr());
+    if (parent == GetScene())
+        UntrackNode(node->GetID());
+}
+
+}
@@ -0,0 +1,143 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Scene/Component.h"
+
+#include <EASTL/unordered_map.h>
+
+namespace Urho3D
+{
+
+/// %Network interest management grid. When present in a scene, clients only receive the replicated root-level nodes near their observer position, along with all children of those nodes.
+class URHO3D_API NetworkInterestGrid : public Component
+{
+    URHO3D_OBJECT(NetworkInterestGrid, Component);
+
+public:
+    /// Root-level node found by an interest query.
+    struct QueryResult
+    {
+        /// Node ID.
+        unsigned nodeID_{};
+        /// Squared distance from the query position on the horizontal plane.
+        float distanceSquared_{};
+    };
+
+    /// Construct.
+    explicit NetworkInterestGrid(Context* context);
+    /// Destruct.
+    ~NetworkInterestGrid() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Set grid cell size. Default 32.
+    /// @property
+    void SetCellSize(float size);
+    /// Set distance from the observer position within which nodes are sent to the client. Default 128.
+    /// @property
+    void SetInterestRadius(float radius);
+    /// Set additional distance a node must move away before it is removed from the client. Default 16.
+    /// @property
+    void SetInterestMargin(float margin);
+
+    /// Return grid cell size.
+    /// @property
+    float GetCellSize() const { return cellSize_; }
+
+    /// Return distance from the observer position within which nodes are sent to the client.
+    /// @property
+    float GetInterestRadius() const { return interestRadius_; }
+
+    /// Return additional distance a node must move away before it is removed from the client.
+    /// @property
+    float GetInterestMargin() const { return interestMargin_; }
+
+    /// Return number of tracked root-level nodes.
+    /// @property
+    unsigned GetNumNodes() const { return nodes_.size(); }
+
+    /// Update positions of the nodes marked for network update. Called by Network before the scene network update.
+    void Update();
+    /// Return tracked root-level nodes within distance from the position. Distances are measured on the XZ plane.
+    void Query(ea::vector<QueryResult>& result, const Vector3& position, float radius) const;
+    /// Return non-root nodes added or reparented before the last update. Connections use these to find nodes that joined a relevant hierarchy.
+    const ea::vector<unsigned>& GetAddedNodes() const { return addedNodes_; }
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
+private:
+    /// Node stored in a grid cell.
+    struct CellNode
+    {
+        /// Node ID.
+        unsigned nodeID_;
+        /// Node position on the XZ plane.
+        Vector2 position_;
+    };
+
+    /// Location of a tracked node in the grid.
+    struct NodeLocation
+    {
+        /// Cell key.
+        unsigned long long cell_;
+        /// Index in the cell.
+        unsigned index_;
+    };
+
+    /// Return key of the cell containing a position.
+    unsigned long long GetCellKey(const Vector2& position) const;
+    /// Add or move a root-level node.
+    void TrackNode(Node* node);
+    /// Remove a node.
+    void UntrackNode(unsigned nodeID);
+    /// Add a node to a cell.
+    void AddToCell(unsigned nodeID, const Vector2& position);
+    /// Remove a node from its cell.
+    void RemoveFromCell(const NodeLocation& location);
+    /// Rebuild the grid from all root-level nodes of the scene.
+    void Rebuild();
+    /// Handle node added to the scene.
+    void HandleNodeAdded(StringHash eventType, VariantMap& eventData);
+    /// Handle node removed from the scene.
+    void HandleNodeRemoved(StringHash eventType, VariantMap& eventData);
+
+    /// Tracked nodes by ID.
+    ea::unordered_map<unsigned, NodeLocation> nodes_;
+    /// Nodes by cell key.
+    ea::unordered_map<unsigned long long, ea::vector<CellNode> > cells_;
+    /// Non-root nodes added since the last update while the scene is replicated.
+    ea::vector<unsigned> pendingAddedNodes_;
+    /// Non-root nodes added before the last update.
+    ea::vector<unsigned> addedNodes_;
+    /// Grid cell size.
+    float cellSize_;
+    /// Interest radius.
+    float interestRadius_;
+    /// Interest margin.
+    float interestMargin_;
+};
+
+}
@@ -27,6 +27,7 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
@@ -42,13 +43,17 @@
 #include "../Scene/SceneEvents.h"
 
 #include <Bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
 #include <Bullet/BulletCollision/CollisionShapes/btBoxShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
+#include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <Bullet/LinearMath/btThreads.h>
 
 
 extern ContactAddedCallback gContactAddedCallback;
@@ -147,6 +152,75 @@ struct PhysicsQueryCallback : public btCollisionWorld::ContactResultCallback
     unsigned collisionMask_;
 };
 
+#if BT_THREADSAFE
+/// Bullet task scheduler that runs parallel loops on the WorkQueue threads, so physics does not compete with a second thread pool.
+class WorkQueueTaskScheduler : public btITaskScheduler
+{
+public:
+    /// Construct.
+    explicit WorkQueueTaskScheduler(WorkQueue* workQueue) :
+        btITaskScheduler("WorkQueue"),
+        workQueue_(workQueue),
+        numThreads_(Min(workQueue->GetNumThreads() + 1, BT_MAX_THREAD_COUNT))
+    {
+    }
+
+    /// Return maximum number of threads.
+    int getMaxNumThreads() const override { return numThreads_; }
+    /// Return number of threads including the main thread.
+    int getNumThreads() const override { return numThreads_; }
+    /// Set number of threads. Ignored because the thread count is owned by the WorkQueue.
+    void setNumThreads(int numThreads) override {}
+
+    /// Process range in parallel.
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+    {
+        if (iEnd <= iBegin)
+            return;
+
+        workQueue_->ParallelFor(iEnd - iBegin, grainSize, [&](unsigned begin, unsigned end, unsigned)
+        {
+            body.forLoop(iBegin + begin, iBegin + end);
+        });
+    }
+
+    /// Process range in parallel and return the sum of the batch results.
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+    {
+        if (iEnd <= iBegin)
+            return 0.0f;
+
+        btScalar sum = 0.0f;
+        SpinLockMutex sumMutex;
+        workQueue_->ParallelFor(iEnd - iBegin, grainSize, [&](unsigned begin, unsigned end, unsigned)
+        {
+            const btScalar batchSum = body.sumLoop(iBegin + begin, iBegin + end);
+            MutexLock<SpinLockMutex> lock(sumMutex);
+            sum += batchSum;
+        });
+        return sum;
+    }
+
+private:
+    /// Work queue.
+    WorkQueue* workQueue_{};
+    /// Number of threads taking part in parallel loops.
+    int numThreads_{};
+};
+#endif
+
+/// Multithreaded collision dispatcher with new manifold lists for all Bullet thread indices. Bullet numbers threads in the order they first call into it, so raycasts and other queries from threads outside the WorkQueue may push the worker indices past the WorkQueue thread count.
+class WorkQueueCollisionDispatcher : public btCollisionDispatcherMt
+{
+public:
+    /// Construct.
+    explicit WorkQueueCollisionDispatcher(btCollisionConfiguration* config) :
+        btCollisionDispatcherMt(config)
+    {
+        m_batchManifoldsPtr.resize(BT_MAX_THREAD_COUNT);
+    }
+};
+
 PhysicsWorld::PhysicsWorld(Context* context) :
     Component(context),
     fps_(DEFAULT_FPS),
@@ -159,12 +233,42 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     else
         collisionConfiguration_ = new btDefaultCollisionConfiguration();
 
-    collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
+    if (PhysicsWorld::config.multiThreaded_)
+    {
+#if BT_THREADSAFE
+        if (auto* workQueue = GetSubsystem<WorkQueue>())
+        {
+            // The scheduler must be active before the multithreaded dispatcher and solver pool are created
+            taskScheduler_ = ea::make_unique<WorkQueueTaskScheduler>(workQueue);
+            btSetTaskScheduler(taskScheduler_.get());
+        }
+        else
+            URHO3D_LOGWARNING("No WorkQueue subsystem, using single-threaded physics world");
+#else
+        URHO3D_LOGWARNING("Multithreaded physics requires URHO3D_THREADING, using single-threaded physics world");
+#endif
+    }
+
+    if (taskScheduler_)
+        collisionDispatcher_ = ea::make_unique<WorkQueueCollisionDispatcher>(collisionConfiguration_);
+    else
+        collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
     btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
 
     broadphase_ = ea::make_unique<btDbvtBroadphase>();
-    solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
-    world_ = ea::make_unique<btDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+    if (taskScheduler_)
+    {
+        // Islands are solved in parallel by the solver pool, large islands are split by the multithreaded solver
+        solver_ = ea::make_unique<btConstraintSolverPoolMt>(taskScheduler_->getNumThreads());
+        solverMt_ = ea::make_unique<btSequentialImpulseConstraintSolverMt>();
+        world_ = ea::make_unique<btDiscreteDynamicsWorldMt>(collisionDispatcher_.get(), broadphase_.get(),
+            static_cast<btConstraintSolverPoolMt*>(solver_.get()), solverMt_.get(), collisionConfiguration_);
+    }
+    else
+    {
+        solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
+        world_ = ea::make_unique<btDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+    }
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -191,10 +295,15 @@ PhysicsWorld::~PhysicsWorld()
     }
 
     world_.reset();
+    solverMt_.reset();
     solver_.reset();
     broadphase_.reset();
     collisionDispatcher_.reset();
 
+    if (taskScheduler_ && btGetTaskScheduler() == taskScheduler_.get())
+        btSetTaskScheduler(nullptr);
+    taskScheduler_.reset();
+
     // Delete configuration only if it was the default created by PhysicsWorld
     if (!PhysicsWorld::config.collisionConfig_)
         delete collisionConfiguration_;
@@ -271,6 +380,7 @@ void PhysicsWorld::Update(float timeStep)
         maxSubSteps = Min(maxSubSteps, maxSubSteps_);
 
     delayedWorldTransforms_.clear();
+    ActivateTaskScheduler();
     simulating_ = true;
 
     if (interpolation_)
@@ -310,6 +420,7 @@ void PhysicsWorld::Update(float timeStep)
 
 void PhysicsWorld::UpdateCollisions()
 {
+    ActivateTaskScheduler();
     world_->performDiscreteCollisionDetection();
 }
 
@@ -1075,6 +1186,13 @@ void PhysicsWorld::SendCollisionEvents()
     previousCollisions_ = currentCollisions_;
 }
 
+void PhysicsWorld::ActivateTaskScheduler()
+{
+    // Bullet has a single global scheduler, several multithreaded worlds take turns
+    if (taskScheduler_ && btGetTaskScheduler() != taskScheduler_.get())
+        btSetTaskScheduler(taskScheduler_.get());
+}
+
 void RegisterPhysicsLibrary(Context* context)
 {
     CollisionShape::RegisterObject(context);
@@ -39,6 +39,7 @@ class btConstraintSolver;
 class btDiscreteDynamicsWorld;
 class btDispatcher;
 class btDynamicsWorld;
+class btITaskScheduler;
 class btPersistentManifold;
 
 namespace Urho3D
@@ -111,12 +112,15 @@ struct ManifoldPair
 struct PhysicsWorldConfig
 {
     PhysicsWorldConfig() :
-        collisionConfig_(nullptr)
+        collisionConfig_(nullptr),
+        multiThreaded_(false)
     {
     }
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Use Bullet's multithreaded dynamics world running on the WorkQueue threads. Requires URHO3D_THREADING.
+    bool multiThreaded_;
 };
 
 static const int DEFAULT_FPS = 60;
@@ -255,6 +259,9 @@ public:
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
 
+    /// Return whether the simulation runs in the multithreaded dynamics world.
+    bool IsMultiThreaded() const { return taskScheduler_ != nullptr; }
+
     /// Add a rigid body to keep track of. Called by RigidBody.
     void AddRigidBody(RigidBody* body);
     /// Remove a rigid body. Called by RigidBody.
@@ -316,6 +323,8 @@ private:
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Make this world's task scheduler the one used by Bullet. No-op when single-threaded.
+    void ActivateTaskScheduler();
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -323,8 +332,12 @@ private:
     ea::unique_ptr<btDispatcher> collisionDispatcher_;
     /// Bullet collision broadphase.
     ea::unique_ptr<btBroadphaseInterface> broadphase_;
-    /// Bullet constraint solver.
+    /// Bullet constraint solver. Solver pool when multithreaded.
     ea::unique_ptr<btConstraintSolver> solver_;
+    /// Bullet multithreaded constraint solver for large islands.
+    ea::unique_ptr<btConstraintSolver> solverMt_;
+    /// Bullet task scheduler running on the WorkQueue threads. Null when single-threaded.
+    ea::unique_ptr<btITaskScheduler> taskScheduler_;
     /// Bullet physics world.
     ea::unique_ptr<btDiscreteDynamicsWorld> world_;
     /// Extra weak pointer to scene to allow for cleanup in case the world is destroyed before other components.
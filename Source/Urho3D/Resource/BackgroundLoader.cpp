@@ -25,8 +25,10 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/ProcessUtils.h"
 #include "../Core/Profiler.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../Resource/BackgroundLoader.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
@@ -36,13 +38,60 @@
 namespace Urho3D
 {
 
+/// Maximum number of decode threads.
+static const unsigned MAX_DECODE_THREADS = 4;
+/// Maximum number of prefetched items per decode thread, limits memory held by prefetched file contents.
+static const unsigned MAX_PREFETCHED_PER_THREAD = 4;
+/// Files larger than this are not prefetched into memory and are read by BeginLoad() directly.
+static const unsigned MAX_PREFETCH_SIZE = 64 * 1024 * 1024;
+
+/// Decode thread of the background loader.
+class BackgroundLoadWorker : public Thread
+{
+public:
+    /// Construct.
+    explicit BackgroundLoadWorker(BackgroundLoader* owner) :
+        Thread("ResourceDecode"),
+        owner_(owner)
+    {
+    }
+
+    /// Decode loop.
+    void ThreadFunction() override
+    {
+        while (shouldRun_)
+        {
+            if (!owner_->DecodeNextResource())
+                owner_->WaitForDecodeWork();
+        }
+    }
+
+private:
+    /// Background loader.
+    BackgroundLoader* owner_;
+};
+
 BackgroundLoader::BackgroundLoader(ResourceCache* owner) :
+    Thread("ResourceLoad"),
     owner_(owner)
 {
+    const unsigned numDecodeThreads = Min(Max(GetNumPhysicalCPUs(), 2u) - 1, MAX_DECODE_THREADS);
+    for (unsigned i = 0; i < numDecodeThreads; ++i)
+        decodeThreads_.emplace_back(new BackgroundLoadWorker(this));
 }
 
 BackgroundLoader::~BackgroundLoader()
 {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        shutDown_ = true;
+        wakeCondition_.notify_all();
+    }
+
+    for (auto& worker : decodeThreads_)
+        worker->Stop();
+    Stop();
+
     MutexLock lock(backgroundLoadMutex_);
 
     backgroundLoadQueue_.clear();
@@ -50,62 +99,151 @@ BackgroundLoader::~BackgroundLoader()
 
 void BackgroundLoader::ThreadFunction()
 {
+    const unsigned maxPrefetched = decodeThreads_.size() * MAX_PREFETCHED_PER_THREAD;
     while (shouldRun_)
     {
-        backgroundLoadMutex_.Acquire();
+        if (!PrefetchNextResource())
+            WaitForWork([&]() { return numUnprefetched_.load() > 0 && numPrefetched_.load() < maxPrefetched; });
+    }
+}
 
-        // Search for a queued resource that has not been loaded yet
-        auto i = backgroundLoadQueue_.begin();
-        while (i != backgroundLoadQueue_.end())
-        {
-            if (i->second.resource_->GetAsyncLoadState() == ASYNC_QUEUED)
-                break;
-            else
-                ++i;
-        }
+void BackgroundLoader::WaitForDecodeWork()
+{
+    WaitForWork([this]() { return numPrefetched_.load() > 0; });
+}
+
+template <class T> void BackgroundLoader::WaitForWork(T predicate)
+{
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    wakeCondition_.wait(lock, [&]() { return shutDown_ || predicate(); });
+}
+
+void BackgroundLoader::WakeThreads()
+{
+    std::lock_guard<std::mutex> lock(wakeMutex_);
+    wakeCondition_.notify_all();
+}
+
+template <class T> BackgroundLoadItem* BackgroundLoader::FindQueuedItem(T predicate)
+{
+    BackgroundLoadItem* result = nullptr;
+    for (auto& [key, item] : backgroundLoadQueue_)
+    {
+        if (item.resource_->GetAsyncLoadState() != ASYNC_QUEUED || !predicate(item))
+            continue;
+
+        // Resources that other queued resources depend on unblock the most work
+        if (!item.dependents_.empty())
+            return &item;
+        if (!result)
+            result = &item;
+    }
+    return result;
+}
+
+bool BackgroundLoader::PrefetchNextResource()
+{
+    backgroundLoadMutex_.Acquire();
+
+    // Do not run too far ahead of the decode threads
+    BackgroundLoadItem* item = nullptr;
+    if (numPrefetched_ < decodeThreads_.size() * MAX_PREFETCHED_PER_THREAD)
+        item = FindQueuedItem([](const BackgroundLoadItem& item) { return !item.prefetched_; });
+
+    // We can be sure that the item is not removed from the queue as long as it is in the "queued" or "loading" state,
+    // and only this thread processes items which are not prefetched
+    backgroundLoadMutex_.Release();
+    if (!item)
+        return false;
 
-        if (i == backgroundLoadQueue_.end())
+    URHO3D_PROFILE("PrefetchResource");
+
+    SharedPtr<File> file = owner_->GetFile(item->resource_->GetName(), item->sendEventOnFailure_);
+    ea::vector<unsigned char> data;
+    if (file && !file->IsMemoryMapped() && file->GetSize() <= MAX_PREFETCH_SIZE)
+    {
+        data.resize(file->GetSize());
+        if (file->Read(data.data(), data.size()) != data.size())
         {
-            // No resources to load found
-            backgroundLoadMutex_.Release();
-            Time::Sleep(5);
+            URHO3D_LOGERROR("Could not read resource file " + file->GetName());
+            file = nullptr;
         }
-        else
-        {
-            BackgroundLoadItem& item = i->second;
-            Resource* resource = item.resource_;
-            // We can be sure that the item is not removed from the queue as long as it is in the
-            // "queued" or "loading" state
-            backgroundLoadMutex_.Release();
-
-            bool success = false;
-            SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
-            if (file)
-            {
-                resource->SetAsyncLoadState(ASYNC_LOADING);
-                success = resource->BeginLoad(*file);
-            }
+    }
 
-            // Process dependencies now
-            // Need to lock the queue again when manipulating other entries
-            ea::pair<StringHash, StringHash> key = ea::make_pair(resource->GetType(), resource->GetNameHash());
-            backgroundLoadMutex_.Acquire();
-            if (item.dependents_.size())
-            {
-                for (auto i = item.dependents_.begin(); i != item.dependents_.end(); ++i)
-                {
-                    auto j = backgroundLoadQueue_.find(*i);
-                    if (j != backgroundLoadQueue_.end())
-                        j->second.dependencies_.erase(key);
-                }
+    MutexLock lock(backgroundLoadMutex_);
+    --numUnprefetched_;
+    if (!file)
+    {
+        CompleteItem(*item, false);
+        return true;
+    }
 
-                item.dependents_.clear();
-            }
+    item->file_ = file;
+    item->data_ = ea::move(data);
+    item->prefetched_ = true;
+    ++numPrefetched_;
+    WakeThreads();
+    return true;
+}
+
+bool BackgroundLoader::DecodeNextResource()
+{
+    backgroundLoadMutex_.Acquire();
+
+    BackgroundLoadItem* item = FindQueuedItem([](const BackgroundLoadItem& item) { return item.prefetched_; });
+    if (item)
+    {
+        // Claim the item for this thread
+        item->resource_->SetAsyncLoadState(ASYNC_LOADING);
+        --numPrefetched_;
+    }
+    backgroundLoadMutex_.Release();
+    if (!item)
+        return false;
+
+    // The prefetch thread may continue if it was waiting for the decode threads
+    WakeThreads();
 
-            resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
-            backgroundLoadMutex_.Release();
+    Resource* resource = item->resource_;
+    bool success = false;
+    if (!item->data_.empty())
+    {
+        MemoryBuffer buffer(item->data_);
+        buffer.SetName(item->file_->GetName());
+        success = resource->BeginLoad(buffer);
+    }
+    else
+        success = resource->BeginLoad(*item->file_);
+
+    // Release the file contents as soon as possible, EndLoad() does not use them
+    ea::vector<unsigned char> data = ea::move(item->data_);
+    SharedPtr<File> file = ea::move(item->file_);
+
+    // Need to lock the queue again when manipulating other entries
+    MutexLock lock(backgroundLoadMutex_);
+    CompleteItem(*item, success);
+    return true;
+}
+
+void BackgroundLoader::CompleteItem(BackgroundLoadItem& item, bool success)
+{
+    // Process dependencies now
+    Resource* resource = item.resource_;
+    ea::pair<StringHash, StringHash> key = ea::make_pair(resource->GetType(), resource->GetNameHash());
+    if (item.dependents_.size())
+    {
+        for (auto i = item.dependents_.begin(); i != item.dependents_.end(); ++i)
+        {
+            auto j = backgroundLoadQueue_.find(*i);
+            if (j != backgroundLoadQueue_.end())
+                j->second.dependencies_.erase(key);
         }
+
+        item.dependents_.clear();
     }
+
+    resource->SetAsyncLoadState(success ? ASYNC_SUCCESS : ASYNC_FAIL);
+    WakeThreads();
 }
 
 bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bool sendEventOnFailure, Resource* caller)
@@ -145,6 +283,7 @@ bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bo
 
     item.resource_->SetName(name);
     item.resource_->SetAsyncLoadState(ASYNC_QUEUED);
+    ++numUnprefetched_;
 
     // If this is a resource calling for the background load of more resources, mark the dependency as necessary
     if (caller)
@@ -163,9 +302,14 @@ bool BackgroundLoader::QueueResource(StringHash type, const ea::string& name, bo
                        " requested for a background loaded resource but was not in the background load queue");
     }
 
-    // Start the background loader thread now
+    // Start the background loader threads now
     if (!IsStarted())
+    {
         Run();
+        for (auto& worker : decodeThreads_)
+            worker->Run();
+    }
+    WakeThreads();
 
     return true;
 }
@@ -187,18 +331,18 @@ void BackgroundLoader::WaitForResource(StringHash type, StringHash nameHash)
             HiresTimer waitTimer;
             bool didWait = false;
 
-            for (;;)
+            // Completing an item wakes up the waiting threads
+            WaitForWork([&]()
             {
                 unsigned numDeps = i->second.dependencies_.size();
                 AsyncLoadState state = resource->GetAsyncLoadState();
                 if (numDeps > 0 || state == ASYNC_QUEUED || state == ASYNC_LOADING)
                 {
                     didWait = true;
-                    Time::Sleep(1);
+                    return false;
                 }
-                else
-                    break;
-            }
+                return true;
+            });
 
             if (didWait)
                 URHO3D_LOGDEBUG("Waited " + ea::to_string(waitTimer.GetUSec(false) / 1000) + " ms for background loaded resource " +
@@ -25,14 +25,23 @@
 #include <EASTL/hash_set.h>
 #include <EASTL/unordered_map.h>
 
+#include <EASTL/unique_ptr.h>
+#include <EASTL/vector.h>
+
 #include "../Core/Mutex.h"
 #include "../Container/Ptr.h"
 #include "../Core/Thread.h"
+#include "../IO/File.h"
 #include "../Math/StringHash.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
 namespace Urho3D
 {
 
+class BackgroundLoadWorker;
 class Resource;
 class ResourceCache;
 
@@ -47,9 +56,16 @@ struct URHO3D_API BackgroundLoadItem
     ea::hash_set<ea::pair<StringHash, StringHash> > dependents_;
     /// Whether to send failure event.
     bool sendEventOnFailure_;
+    /// Resource file opened by the I/O stage.
+    SharedPtr<File> file_;
+    /// Prefetched file contents. Empty if the file is read directly, e.g. from a memory mapped package.
+    ea::vector<unsigned char> data_;
+    /// Whether the I/O stage is finished with the item.
+    bool prefetched_{};
 };
 
-/// Background loader of resources. Owned by the ResourceCache.
+/// Background loader of resources. Owned by the ResourceCache. Loading is staged: the loader thread prefetches file
+/// contents, and a pool of decode threads runs Resource::BeginLoad() on prefetched items in parallel.
 /// @nobind
 class URHO3D_API BackgroundLoader : public RefCounted, public Thread
 {
@@ -60,7 +76,7 @@ public:
     /// Destruct. Forcibly clear the load queue.
     ~BackgroundLoader() override;
 
-    /// Resource background loading loop.
+    /// Resource file prefetch loop.
     void ThreadFunction() override;
 
     /// Queue loading of a resource. The name must be sanitated to ensure consistent format. Return true if queued (not a duplicate and resource was a known type).
@@ -72,10 +88,27 @@ public:
 
     /// Return amount of resources in the load queue.
     unsigned GetNumQueuedResources() const;
+    /// Return number of decode threads.
+    unsigned GetNumDecodeThreads() const { return decodeThreads_.size(); }
+
+    /// Run BeginLoad() for one prefetched resource. Return false if no resource was ready. Called from the decode threads.
+    bool DecodeNextResource();
+    /// Sleep until there is a prefetched resource to decode or the loader shuts down. Called from the decode threads.
+    void WaitForDecodeWork();
 
 private:
+    /// Open and read the file of one queued resource. Return false if no resource was ready.
+    bool PrefetchNextResource();
+    /// Return the best queued item matching the predicate: resources other queued resources depend on come first. Must be called with the queue locked.
+    template <class T> BackgroundLoadItem* FindQueuedItem(T predicate);
+    /// Mark the BeginLoad() stage complete and release the dependents. Must be called with the queue locked.
+    void CompleteItem(BackgroundLoadItem& item, bool success);
     /// Finish one background loaded resource.
     void FinishBackgroundLoading(BackgroundLoadItem& item);
+    /// Sleep until the predicate is true or the loader shuts down.
+    template <class T> void WaitForWork(T predicate);
+    /// Wake up all threads waiting for the queue to change.
+    void WakeThreads();
 
     /// Resource cache.
     ResourceCache* owner_;
@@ -83,6 +116,18 @@ private:
     mutable Mutex backgroundLoadMutex_;
     /// Resources that are queued for background loading.
     ea::unordered_map<ea::pair<StringHash, StringHash>, BackgroundLoadItem> backgroundLoadQueue_;
+    /// Number of queued items waiting for the prefetch thread.
+    std::atomic<unsigned> numUnprefetched_{};
+    /// Number of prefetched items waiting for the decode threads.
+    std::atomic<unsigned> numPrefetched_{};
+    /// Mutex for sleeping until the queue changes.
+    std::mutex wakeMutex_;
+    /// Condition to wake up the loader threads and threads waiting for a resource when the queue changes.
+    std::condition_variable wakeCondition_;
+    /// Shutdown flag for the loader threads.
+    bool shutDown_{};
+    /// Decode threads.
+    ea::vector<ea::unique_ptr<BackgroundLoadWorker> > decodeThreads_;
 };
 
 }
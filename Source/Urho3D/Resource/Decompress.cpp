@@ -25,6 +25,7 @@
 #include "../Resource/Decompress.h"
 
 #include <cstdint>
+#include <cstring>
 
 // ETC2 decompress
 typedef unsigned char uint8;
@@ -86,7 +87,7 @@ static int Unpack565(unsigned char const* packed, unsigned char* colour)
     return value;
 }
 
-static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isDxt1)
+static void DecompressColourDXT(unsigned char* rgba, unsigned stride, void const* block, bool isDxt1)
 {
     // get the block bytes
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
@@ -118,29 +119,17 @@ static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isD
     codes[8 + 3] = 255;
     codes[12 + 3] = (unsigned char)((isDxt1 && a <= b) ? 0 : 255);
 
-    // unpack the indices
-    unsigned char indices[16];
-    for (int i = 0; i < 4; ++i)
+    // store out the colours a row at a time, each row of indices is one byte
+    for (int y = 0; y < 4; ++y)
     {
-        unsigned char* ind = indices + 4 * i;
-        unsigned char packed = bytes[4 + i];
-
-        ind[0] = (unsigned char)(packed & 0x3);
-        ind[1] = (unsigned char)((packed >> 2) & 0x3);
-        ind[2] = (unsigned char)((packed >> 4) & 0x3);
-        ind[3] = (unsigned char)((packed >> 6) & 0x3);
-    }
-
-    // store out the colours
-    for (int i = 0; i < 16; ++i)
-    {
-        auto offset = (unsigned char)(4 * indices[i]);
-        for (int j = 0; j < 4; ++j)
-            rgba[4 * i + j] = codes[offset + j];
+        unsigned char* row = rgba + y * stride;
+        unsigned packed = bytes[4 + y];
+        for (int x = 0; x < 4; ++x, packed >>= 2)
+            memcpy(row + 4 * x, codes + 4 * (packed & 0x3), 4);
     }
 }
 
-static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
+static void DecompressAlphaDXT3(unsigned char* rgba, unsigned stride, void const* block)
 {
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
 
@@ -155,12 +144,13 @@ static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
         auto hi = (unsigned char)(quant & 0xf0);
 
         // convert back up to bytes
-        rgba[8 * i + 3] = lo | (lo << 4);
-        rgba[8 * i + 7] = hi | (hi >> 4);
+        unsigned char* pixel = rgba + (i >> 1) * stride + (i & 1) * 8;
+        pixel[3] = lo | (lo << 4);
+        pixel[7] = hi | (hi >> 4);
     }
 }
 
-static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
+static void DecompressAlphaDXT5(unsigned char* rgba, unsigned stride, void const* block)
 {
     // get the two alpha values
     auto const* bytes = reinterpret_cast< unsigned char const* >( block );
@@ -186,34 +176,16 @@ static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
             codes[1 + i] = (unsigned char)(((7 - i) * alpha0 + i * alpha1) / 7);
     }
 
-    // decode the indices
-    unsigned char indices[16];
-    unsigned char const* src = bytes + 2;
-    unsigned char* dest = indices;
-    for (int i = 0; i < 2; ++i)
-    {
-        // grab 3 bytes
-        int value = 0;
-        for (int j = 0; j < 3; ++j)
-        {
-            int byte = *src++;
-            value |= (byte << 8 * j);
-        }
-
-        // unpack 8 3-bit values from it
-        for (int j = 0; j < 8; ++j)
-        {
-            int index = (value >> 3 * j) & 0x7;
-            *dest++ = (unsigned char)index;
-        }
-    }
+    // decode the 3-bit indices from 48 bits and write out the indexed codebook values
+    unsigned long long indices = 0;
+    for (int i = 0; i < 6; ++i)
+        indices |= (unsigned long long)bytes[2 + i] << (8 * i);
 
-    // write out the indexed codebook values
-    for (int i = 0; i < 16; ++i)
-        rgba[4 * i + 3] = codes[indices[i]];
+    for (int i = 0; i < 16; ++i, indices >>= 3)
+        rgba[(i >> 2) * stride + 4 * (i & 3) + 3] = codes[indices & 0x7];
 }
 
-static void DecompressDXT(unsigned char* rgba, const void* block, CompressedFormat format)
+static void DecompressDXT(unsigned char* rgba, unsigned stride, const void* block, CompressedFormat format)
 {
     // get the block locations
     void const* colourBlock = block;
@@ -222,13 +194,13 @@ static void DecompressDXT(unsigned char* rgba, const void* block, CompressedForm
         colourBlock = reinterpret_cast< unsigned char const* >( block ) + 8;
 
     // decompress colour
-    DecompressColourDXT(rgba, colourBlock, format == CF_DXT1);
+    DecompressColourDXT(rgba, stride, colourBlock, format == CF_DXT1);
 
     // decompress alpha separately if necessary
     if (format == CF_DXT3)
-        DecompressAlphaDXT3(rgba, alphaBock);
+        DecompressAlphaDXT3(rgba, stride, alphaBock);
     else if (format == CF_DXT5)
-        DecompressAlphaDXT5(rgba, alphaBock);
+        DecompressAlphaDXT5(rgba, stride, alphaBock);
 }
 
 void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format)
@@ -245,9 +217,17 @@ void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int
         {
             for (int x = 0; x < width; x += 4)
             {
+                // decompress blocks that are fully inside the image directly to the destination
+                if (x + 4 <= width && y + 4 <= height)
+                {
+                    DecompressDXT(rgba + sz + 4 * (width * y + x), 4 * width, sourceBlock, format);
+                    sourceBlock += bytesPerBlock;
+                    continue;
+                }
+
                 // decompress the block
                 unsigned char targetRgba[4 * 16];
-                DecompressDXT(targetRgba, sourceBlock, format);
+                DecompressDXT(targetRgba, 4 * 4, sourceBlock, format);
 
                 // write the decompressed pixels to the correct image locations
                 unsigned char const* sourcePixel = targetRgba;
@@ -24,10 +24,12 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Resource/Decompress.h"
+#include "../Resource/ImageProcessing.h"
 
 #include <SDL/SDL_surface.h>
 #include <STB/stb_image.h>
@@ -76,6 +78,11 @@ static const unsigned DDS_DIMENSION_TEXTURE3D = 4;
 
 static const unsigned DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
 
+/// Minimum number of pixels converted by one parallel batch.
+static const unsigned CONVERT_PIXELS_PER_BATCH = 256 * 1024;
+/// Minimum number of compressed blocks decompressed by one parallel batch.
+static const unsigned DECOMPRESS_BLOCKS_PER_BATCH = 4096;
+
 static const unsigned DDS_DXGI_FORMAT_R8G8B8A8_UNORM = 28;
 static const unsigned DDS_DXGI_FORMAT_R8G8B8A8_UNORM_SRGB = 26;
 static const unsigned DDS_DXGI_FORMAT_BC1_UNORM = 71;
@@ -214,7 +221,7 @@ struct DDSurfaceDesc2
     unsigned dwTextureStage_;
 };
 
-bool CompressedLevel::Decompress(unsigned char* dest) const
+bool CompressedLevel::Decompress(unsigned char* dest, WorkQueue* workQueue) const
 {
     if (!data_)
         return false;
@@ -224,17 +231,34 @@ bool CompressedLevel::Decompress(unsigned char* dest) const
     case CF_DXT1:
     case CF_DXT3:
     case CF_DXT5:
-        DecompressImageDXT(dest, data_, width_, height_, depth_, format_);
-        return true;
-
     // ETC2 format is compatible with ETC1, so we just use the same function.
     case CF_ETC1:
     case CF_ETC2_RGB:
-        DecompressImageETC(dest, data_, width_, height_, false);
-        return true;
     case CF_ETC2_RGBA:
-        DecompressImageETC(dest, data_, width_, height_, true);
+    {
+        // Rows of 4x4 blocks are independent and can be decompressed in parallel bands
+        const unsigned blockSize = (format_ == CF_DXT1 || format_ == CF_ETC1 || format_ == CF_ETC2_RGB) ? 8 : 16;
+        const unsigned blockRowSize = ((width_ + 3) / 4) * blockSize;
+        const auto numBlockRows = (unsigned)((height_ + 3) / 4);
+        const auto decompressRows = [=](unsigned begin, unsigned end, unsigned)
+        {
+            unsigned char* bandDest = dest + begin * 4 * width_ * 4;
+            const unsigned char* bandData = data_ + begin * blockRowSize;
+            const int bandHeight = Min((int)end * 4, height_) - (int)begin * 4;
+            if (format_ == CF_DXT1 || format_ == CF_DXT3 || format_ == CF_DXT5)
+                DecompressImageDXT(bandDest, bandData, width_, bandHeight, 1, format_);
+            else
+                DecompressImageETC(bandDest, bandData, width_, bandHeight, format_ == CF_ETC2_RGBA);
+        };
+
+        if (depth_ > 1)
+            DecompressImageDXT(dest, data_, width_, height_, depth_, format_);
+        else if (workQueue)
+            workQueue->ParallelFor(numBlockRows, Max(DECOMPRESS_BLOCKS_PER_BATCH / Max(blockRowSize / blockSize, 1U), 1U), decompressRows);
+        else
+            decompressRows(0, numBlockRows, 0);
         return true;
+    }
 
     case CF_PVRTC_RGB_2BPP:
     case CF_PVRTC_RGBA_2BPP:
@@ -1187,36 +1211,8 @@ bool Image::Resize(int width, int height)
     if (!data_ || width <= 0 || height <= 0)
         return false;
 
-    /// \todo Reducing image size does not sample all needed pixels
     ea::shared_array<unsigned char> newData(new unsigned char[width * height * components_]);
-    for (int y = 0; y < height; ++y)
-    {
-        for (int x = 0; x < width; ++x)
-        {
-            // Calculate float coordinates between 0 - 1 for resampling
-            float xF = (width_ > 1) ? (float)x / (float)(width - 1) : 0.0f;
-            float yF = (height_ > 1) ? (float)y / (float)(height - 1) : 0.0f;
-            unsigned uintColor = GetPixelBilinear(xF, yF).ToUInt();
-            unsigned char* dest = newData.get() + (y * width + x) * components_;
-            auto* src = (unsigned char*)&uintColor;
-
-            switch (components_)
-            {
-            case 4:
-                dest[3] = src[3];
-                // Fall through
-            case 3:
-                dest[2] = src[2];
-                // Fall through
-            case 2:
-                dest[1] = src[1];
-                // Fall through
-            default:
-                dest[0] = src[0];
-                break;
-            }
-        }
-    }
+    ResampleImage2D(newData.get(), width, height, data_.get(), width_, height_, components_, sRGB_, GetSubsystem<WorkQueue>());
 
     width_ = width;
     height_ = height;
@@ -1636,6 +1632,7 @@ SharedPtr<Image> Image::GetNextLevel() const
         mipImage->SetSize(widthOut, heightOut, depthOut, components_);
     else
         mipImage->SetSize(widthOut, heightOut, components_);
+    mipImage->sRGB_ = sRGB_;
 
     const unsigned char* pixelDataIn = data_.get();
     unsigned char* pixelDataOut = mipImage->data_.get();
@@ -1688,86 +1685,7 @@ SharedPtr<Image> Image::GetNextLevel() const
     }
     // 2D case
     else if (depth_ == 1)
-    {
-        switch (components_)
-        {
-        case 1:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_];
-                unsigned char* out = &pixelDataOut[y * widthOut];
-
-                for (int x = 0; x < widthOut; ++x)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 1] +
-                                              inLower[x * 2] + inLower[x * 2 + 1]) >> 2);
-                }
-            }
-            break;
-
-        case 2:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 2];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 2];
-                unsigned char* out = &pixelDataOut[y * widthOut * 2];
-
-                for (int x = 0; x < widthOut * 2; x += 2)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 2] +
-                                              inLower[x * 2] + inLower[x * 2 + 2]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 3] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 3]) >> 2);
-                }
-            }
-            break;
-
-        case 3:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 3];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 3];
-                unsigned char* out = &pixelDataOut[y * widthOut * 3];
-
-                for (int x = 0; x < widthOut * 3; x += 3)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 3] +
-                                              inLower[x * 2] + inLower[x * 2 + 3]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 4] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 5]) >> 2);
-                }
-            }
-            break;
-
-        case 4:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 4];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 4];
-                unsigned char* out = &pixelDataOut[y * widthOut * 4];
-
-                for (int x = 0; x < widthOut * 4; x += 4)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
-                                              inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 5]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 6] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 6]) >> 2);
-                    out[x + 3] = (unsigned char)(((unsigned)inUpper[x * 2 + 3] + inUpper[x * 2 + 7] +
-                                                  inLower[x * 2 + 3] + inLower[x * 2 + 7]) >> 2);
-                }
-            }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
-        }
-    }
+        DownsampleImage2D(pixelDataOut, pixelDataIn, width_, height_, components_, sRGB_, GetSubsystem<WorkQueue>());
     // 3D case
     else
     {
@@ -1931,47 +1849,59 @@ SharedPtr<Image> Image::ConvertToRGBA() const
     SharedPtr<Image> ret(context_->CreateObject<Image>());
     ret->SetSize(width_, height_, depth_, 4);
 
-    const unsigned char* src = data_.get();
-    unsigned char* dest = ret->GetData();
-
-    switch (components_)
+    const unsigned char* srcData = data_.get();
+    unsigned char* destData = ret->GetData();
+    const unsigned components = components_;
+    const auto convertPixels = [=](unsigned begin, unsigned end, unsigned)
     {
-    case 1:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
-        {
-            unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = 255;
-        }
-        break;
+        const unsigned char* src = srcData + begin * components;
+        unsigned char* dest = destData + begin * 4;
 
-    case 2:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
+        switch (components)
         {
-            unsigned char pixel = *src++;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = pixel;
-            *dest++ = *src++;
-        }
-        break;
+        case 1:
+            for (unsigned i = begin; i < end; ++i)
+            {
+                unsigned char pixel = *src++;
+                *dest++ = pixel;
+                *dest++ = pixel;
+                *dest++ = pixel;
+                *dest++ = 255;
+            }
+            break;
 
-    case 3:
-        for (unsigned i = 0; i < static_cast<unsigned>(width_ * height_ * depth_); ++i)
-        {
-            *dest++ = *src++;
-            *dest++ = *src++;
-            *dest++ = *src++;
-            *dest++ = 255;
+        case 2:
+            for (unsigned i = begin; i < end; ++i)
+            {
+                unsigned char pixel = *src++;
+                *dest++ = pixel;
+                *dest++ = pixel;
+                *dest++ = pixel;
+                *dest++ = *src++;
+            }
+            break;
+
+        case 3:
+            for (unsigned i = begin; i < end; ++i)
+            {
+                *dest++ = *src++;
+                *dest++ = *src++;
+                *dest++ = *src++;
+                *dest++ = 255;
+            }
+            break;
+
+        default:
+            assert(false);  // Should never reach nere
+            break;
         }
-        break;
+    };
 
-    default:
-        assert(false);  // Should never reach nere
-        break;
-    }
+    const auto numPixels = static_cast<unsigned>(width_ * height_ * depth_);
+    if (auto* workQueue = GetSubsystem<WorkQueue>())
+        workQueue->ParallelFor(numPixels, CONVERT_PIXELS_PER_BATCH, convertPixels);
+    else
+        convertPixels(0, numPixels, 0);
 
     return ret;
 }
@@ -2120,7 +2050,7 @@ SharedPtr<Image> Image::GetDecompressedImage() const
 
     auto decompressedImage = MakeShared<Image>(context_);
     decompressedImage->SetSize(compressedLevel.width_, compressedLevel.height_, 4);
-    compressedLevel.Decompress(decompressedImage->GetData());
+    compressedLevel.Decompress(decompressedImage->GetData(), GetSubsystem<WorkQueue>());
 
     return decompressedImage;
 }
@@ -2351,6 +2281,16 @@ void Image::GetLevels(ea::vector<const Image*>& levels) const
 
 unsigned char* Image::GetImageData(Deserializer& source, int& width, int& height, unsigned& components)
 {
+    // Decode straight from a memory mapped package without copying the file
+    auto* file = dynamic_cast<File*>(&source);
+    if (file && file->IsMemoryMapped())
+    {
+        const unsigned position = file->GetPosition();
+        const unsigned size = file->GetSize() - position;
+        file->Seek(file->GetSize());
+        return stbi_load_from_memory(file->GetMappedData() + position, size, &width, &height, (int*)&components, 0);
+    }
+
     unsigned dataSize = source.GetSize();
 
     ea::shared_array<unsigned char> buffer(new unsigned char[dataSize]);
@@ -33,6 +33,8 @@ struct SDL_Surface;
 namespace Urho3D
 {
 
+class WorkQueue;
+
 static const int COLOR_LUT_SIZE = 16;
 
 /// Supported compressed image formats.
@@ -56,7 +58,8 @@ enum CompressedFormat
 struct URHO3D_API CompressedLevel
 {
     /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. Return true if successful.
-    bool Decompress(unsigned char* dest) const;
+    /// Block-based formats are decompressed in parallel if a work queue is given.
+    bool Decompress(unsigned char* dest, WorkQueue* workQueue = nullptr) const;
 
     /// Compressed image data.
     unsigned char* data_{};
@@ -104,6 +107,8 @@ public:
     bool SetSize(int width, int height, int depth, unsigned components);
     /// Set new image data.
     void SetData(const unsigned char* pixelData);
+    /// Set whether the pixel data is sRGB. Mip levels and resized images of sRGB data are filtered in linear space.
+    void SetSRGB(bool enable) { sRGB_ = enable; }
     /// Set a 2D pixel.
     void SetPixel(int x, int y, const Color& color);
     /// Set a 3D pixel.
@@ -142,7 +147,7 @@ public:
     /// Whether this texture has been detected as a volume, only relevant for DDS.
     /// @property
     bool IsArray() const { return array_; }
-    /// Whether this texture is in sRGB, only relevant for DDS.
+    /// Whether the pixel data is sRGB. Detected from DDS, otherwise set by the user.
     /// @property
     bool IsSRGB() const { return sRGB_; }
 
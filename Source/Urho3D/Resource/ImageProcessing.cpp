@@ -0,0 +1,368 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/WorkQueue.h"
+#include "../Math/MathDefs.h"
+#include "../Resource/ImageProcessing.h"
+
+#include <EASTL/vector.h>
+
+#include <cmath>
+#include <cstring>
+
+#if defined(URHO3D_SSE)
+#include <emmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Number of entries in the linear to sRGB conversion table.
+static const unsigned LINEAR_TO_SRGB_TABLE_SIZE = 8192;
+/// Minimum number of pixels processed by one parallel batch.
+static const unsigned MIN_PIXELS_PER_BATCH = 64 * 1024;
+
+/// Return table converting 8-bit sRGB values to linear values in range 0-255.
+static const float* GetSRGBToLinearTable()
+{
+    static const ea::vector<float> table = []
+    {
+        ea::vector<float> result(256);
+        for (unsigned i = 0; i < 256; ++i)
+        {
+            const float value = i / 255.0f;
+            result[i] = 255.0f * (value <= 0.04045f ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f));
+        }
+        return result;
+    }();
+    return table.data();
+}
+
+/// Return table converting linear values in range 0-1 to 8-bit sRGB values.
+static const unsigned char* GetLinearToSRGBTable()
+{
+    static const ea::vector<unsigned char> table = []
+    {
+        ea::vector<unsigned char> result(LINEAR_TO_SRGB_TABLE_SIZE);
+        for (unsigned i = 0; i < LINEAR_TO_SRGB_TABLE_SIZE; ++i)
+        {
+            const float value = (float)i / (LINEAR_TO_SRGB_TABLE_SIZE - 1);
+            const float srgb = value <= 0.0031308f ? value * 12.92f : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+            result[i] = (unsigned char)Clamp((int)(srgb * 255.0f + 0.5f), 0, 255);
+        }
+        return result;
+    }();
+    return table.data();
+}
+
+/// Return table converting 8-bit values to themselves as floats.
+static const float* GetIdentityTable()
+{
+    static const ea::vector<float> table = []
+    {
+        ea::vector<float> result(256);
+        for (unsigned i = 0; i < 256; ++i)
+            result[i] = (float)i;
+        return result;
+    }();
+    return table.data();
+}
+
+/// Return whether a component holds alpha, which is never sRGB encoded.
+static bool IsAlphaComponent(unsigned component, unsigned components)
+{
+    return (components == 2 && component == 1) || (components == 4 && component == 3);
+}
+
+/// Convert a linear value in range 0-255 to 8-bit sRGB.
+static unsigned char LinearToSRGB(const unsigned char* table, float value)
+{
+    const int index = (int)(value * ((LINEAR_TO_SRGB_TABLE_SIZE - 1) / 255.0f) + 0.5f);
+    return table[Clamp(index, 0, (int)LINEAR_TO_SRGB_TABLE_SIZE - 1)];
+}
+
+/// Run a function over rows, in parallel if a work queue is given.
+template <class T> static void ForEachRow(WorkQueue* workQueue, int numRows, int rowPixels, const T& function)
+{
+    const unsigned batchSize = Max(MIN_PIXELS_PER_BATCH / Max(rowPixels, 1), 1U);
+    if (workQueue)
+        workQueue->ParallelFor(numRows, batchSize, [&](unsigned begin, unsigned end, unsigned) { function(begin, end); });
+    else
+        function(0, numRows);
+}
+
+/// Downsample one row of 8-bit components without color space conversion.
+static void DownsampleRowLinear(unsigned char* out, const unsigned char* upper, const unsigned char* lower, int widthOut,
+    unsigned components)
+{
+    int x = 0;
+
+#if defined(URHO3D_SSE)
+    const __m128i zero = _mm_setzero_si128();
+    // Sum vertical neighbours as 16-bit values, then horizontal neighbours. Results match the scalar path exactly
+    switch (components)
+    {
+    case 1:
+    {
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; x + 16 <= widthOut; x += 16)
+        {
+            __m128i result[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(upper + x * 2 + i * 16));
+                const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + x * 2 + i * 16));
+                const __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(l, zero));
+                const __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(l, zero));
+                result[i] = _mm_packs_epi32(_mm_madd_epi16(sumLo, ones), _mm_madd_epi16(sumHi, ones));
+                result[i] = _mm_srli_epi16(result[i], 2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), _mm_packus_epi16(result[0], result[1]));
+        }
+        break;
+    }
+
+    case 2:
+        for (; x + 8 <= widthOut; x += 8)
+        {
+            __m128i result[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(upper + x * 4 + i * 16));
+                const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + x * 4 + i * 16));
+                const __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(l, zero));
+                const __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(l, zero));
+                const __m128i pairsLo = _mm_add_epi16(_mm_shuffle_epi32(sumLo, _MM_SHUFFLE(2, 0, 2, 0)),
+                    _mm_shuffle_epi32(sumLo, _MM_SHUFFLE(3, 1, 3, 1)));
+                const __m128i pairsHi = _mm_add_epi16(_mm_shuffle_epi32(sumHi, _MM_SHUFFLE(2, 0, 2, 0)),
+                    _mm_shuffle_epi32(sumHi, _MM_SHUFFLE(3, 1, 3, 1)));
+                result[i] = _mm_srli_epi16(_mm_unpacklo_epi64(pairsLo, pairsHi), 2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 2), _mm_packus_epi16(result[0], result[1]));
+        }
+        break;
+
+    case 4:
+        for (; x + 4 <= widthOut; x += 4)
+        {
+            __m128i result[2];
+            for (int i = 0; i < 2; ++i)
+            {
+                const __m128i u = _mm_loadu_si128(reinterpret_cast<const __m128i*>(upper + x * 8 + i * 16));
+                const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lower + x * 8 + i * 16));
+                const __m128i sumLo = _mm_add_epi16(_mm_unpacklo_epi8(u, zero), _mm_unpacklo_epi8(l, zero));
+                const __m128i sumHi = _mm_add_epi16(_mm_unpackhi_epi8(u, zero), _mm_unpackhi_epi8(l, zero));
+                result[i] = _mm_add_epi16(_mm_unpacklo_epi64(sumLo, sumHi), _mm_unpackhi_epi64(sumLo, sumHi));
+                result[i] = _mm_srli_epi16(result[i], 2);
+            }
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x * 4), _mm_packus_epi16(result[0], result[1]));
+        }
+        break;
+
+    default:
+        break;
+    }
+#endif
+
+    for (unsigned i = x * components; i < widthOut * components; ++i)
+    {
+        const unsigned j = (i / components) * components * 2 + i % components;
+        out[i] = (unsigned char)(((unsigned)upper[j] + upper[j + components] + lower[j] + lower[j + components]) >> 2);
+    }
+}
+
+/// Downsample one row of 8-bit components, averaging sRGB color components in linear space.
+static void DownsampleRowSRGB(unsigned char* out, const unsigned char* upper, const unsigned char* lower, int widthOut,
+    unsigned components)
+{
+    const float* toLinear = GetSRGBToLinearTable();
+    const unsigned char* toSRGB = GetLinearToSRGBTable();
+
+    for (int x = 0; x < widthOut; ++x)
+    {
+        const unsigned j = x * components * 2;
+        for (unsigned c = 0; c < components; ++c)
+        {
+            const unsigned k = j + c;
+            if (IsAlphaComponent(c, components))
+            {
+                out[x * components + c] = (unsigned char)(((unsigned)upper[k] + upper[k + components] + lower[k] +
+                    lower[k + components]) >> 2);
+            }
+            else
+            {
+                const float sum = toLinear[upper[k]] + toLinear[upper[k + components]] + toLinear[lower[k]] +
+                    toLinear[lower[k + components]];
+                out[x * components + c] = LinearToSRGB(toSRGB, sum * 0.25f);
+            }
+        }
+    }
+}
+
+void DownsampleImage2D(unsigned char* dest, const unsigned char* src, int srcWidth, int srcHeight, unsigned components,
+    bool sRGB, WorkQueue* workQueue)
+{
+    const int widthOut = srcWidth / 2;
+    const int heightOut = srcHeight / 2;
+    const unsigned srcStride = srcWidth * components;
+    const unsigned destStride = widthOut * components;
+
+    ForEachRow(workQueue, heightOut, srcWidth * 2, [=](unsigned begin, unsigned end)
+    {
+        for (unsigned y = begin; y < end; ++y)
+        {
+            const unsigned char* upper = src + (y * 2) * srcStride;
+            const unsigned char* lower = upper + srcStride;
+            unsigned char* out = dest + y * destStride;
+            if (sRGB)
+                DownsampleRowSRGB(out, upper, lower, widthOut, components);
+            else
+                DownsampleRowLinear(out, upper, lower, widthOut, components);
+        }
+    });
+}
+
+/// Source pixel indices and weights contributing to each destination pixel along one axis.
+struct ResampleFilter
+{
+    /// Number of taps per destination pixel.
+    unsigned taps_{};
+    /// Source pixel indices, taps_ per destination pixel.
+    ea::vector<int> indices_;
+    /// Weights, taps_ per destination pixel.
+    ea::vector<float> weights_;
+
+    /// Build filter for resampling from source to destination size.
+    void Define(int srcSize, int destSize)
+    {
+        if (destSize < srcSize)
+        {
+            // Average all source pixels the destination pixel covers, weighted by coverage
+            const double scale = (double)srcSize / destSize;
+            taps_ = (unsigned)ceil(scale) + 1;
+            indices_.resize(destSize * taps_);
+            weights_.resize(destSize * taps_);
+            for (int i = 0; i < destSize; ++i)
+            {
+                const double begin = i * scale;
+                const double end = begin + scale;
+                const int first = (int)begin;
+                for (unsigned t = 0; t < taps_; ++t)
+                {
+                    const int pos = first + (int)t;
+                    const double coverage = Min(end, pos + 1.0) - Max(begin, (double)pos);
+                    indices_[i * taps_ + t] = Min(pos, srcSize - 1);
+                    weights_[i * taps_ + t] = pos < srcSize && coverage > 0.0 ? (float)(coverage / scale) : 0.0f;
+                }
+            }
+        }
+        else
+        {
+            // Interpolate between the two nearest source pixel centers
+            const double scale = (double)srcSize / destSize;
+            taps_ = 2;
+            indices_.resize(destSize * taps_);
+            weights_.resize(destSize * taps_);
+            for (int i = 0; i < destSize; ++i)
+            {
+                const double pos = Clamp((i + 0.5) * scale - 0.5, 0.0, (double)(srcSize - 1));
+                const int first = (int)pos;
+                const float fraction = (float)(pos - first);
+                indices_[i * 2] = first;
+                indices_[i * 2 + 1] = Min(first + 1, srcSize - 1);
+                weights_[i * 2] = 1.0f - fraction;
+                weights_[i * 2 + 1] = fraction;
+            }
+        }
+    }
+};
+
+void ResampleImage2D(unsigned char* dest, int destWidth, int destHeight, const unsigned char* src, int srcWidth,
+    int srcHeight, unsigned components, bool sRGB, WorkQueue* workQueue)
+{
+    ResampleFilter horizontal;
+    ResampleFilter vertical;
+    horizontal.Define(srcWidth, destWidth);
+    vertical.Define(srcHeight, destHeight);
+
+    // Per-component conversion to linear values in range 0-255
+    const float* toLinear[4];
+    for (unsigned c = 0; c < components; ++c)
+        toLinear[c] = sRGB && !IsAlphaComponent(c, components) ? GetSRGBToLinearTable() : GetIdentityTable();
+    const unsigned char* toSRGB = GetLinearToSRGBTable();
+
+    const unsigned srcStride = srcWidth * components;
+    ForEachRow(workQueue, destHeight, srcWidth * (int)vertical.taps_, [&](unsigned begin, unsigned end)
+    {
+        ea::vector<float> row(srcStride);
+        for (unsigned y = begin; y < end; ++y)
+        {
+            // Filter vertically into a full width row, then horizontally into the destination
+            ea::fill(row.begin(), row.end(), 0.0f);
+            for (unsigned t = 0; t < vertical.taps_; ++t)
+            {
+                const float weight = vertical.weights_[y * vertical.taps_ + t];
+                if (weight == 0.0f)
+                    continue;
+
+                const unsigned char* srcRow = src + vertical.indices_[y * vertical.taps_ + t] * srcStride;
+                if (!sRGB)
+                {
+                    for (unsigned i = 0; i < srcStride; ++i)
+                        row[i] += weight * srcRow[i];
+                }
+                else
+                {
+                    for (unsigned i = 0; i < srcStride; i += components)
+                    {
+                        for (unsigned c = 0; c < components; ++c)
+                            row[i + c] += weight * toLinear[c][srcRow[i + c]];
+                    }
+                }
+            }
+
+            unsigned char* out = dest + y * destWidth * components;
+            for (int x = 0; x < destWidth; ++x)
+            {
+                const int* indices = &horizontal.indices_[x * horizontal.taps_];
+                const float* weights = &horizontal.weights_[x * horizontal.taps_];
+                for (unsigned c = 0; c < components; ++c)
+                {
+                    float sum = 0.0f;
+                    for (unsigned t = 0; t < horizontal.taps_; ++t)
+                        sum += weights[t] * row[indices[t] * components + c];
+
+                    if (sRGB && !IsAlphaComponent(c, components))
+                        out[x * components + c] = LinearToSRGB(toSRGB, sum);
+                    else
+                        out[x * components + c] = (unsigned char)Clamp((int)(sum + 0.5f), 0, 255);
+                }
+            }
+        }
+    });
+}
+
+}
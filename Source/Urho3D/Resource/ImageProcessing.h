@@ -0,0 +1,41 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include <Urho3D/Urho3D.h>
+
+namespace Urho3D
+{
+
+class WorkQueue;
+
+/// Downsample a 2D image to half size in both dimensions with a 2x2 box filter. Source must be at least 2x2 pixels.
+/// Color components of sRGB images are averaged in linear space. Rows are processed in parallel if a work queue is given.
+URHO3D_API void DownsampleImage2D(unsigned char* dest, const unsigned char* src, int srcWidth, int srcHeight,
+    unsigned components, bool sRGB, WorkQueue* workQueue = nullptr);
+/// Resample a 2D image to arbitrary size. Reducing averages all covered source pixels, enlarging uses bilinear filtering.
+/// Color components of sRGB images are filtered in linear space. Rows are processed in parallel if a work queue is given.
+URHO3D_API void ResampleImage2D(unsigned char* dest, int destWidth, int destHeight, const unsigned char* src,
+    int srcWidth, int srcHeight, unsigned components, bool sRGB, WorkQueue* workQueue = nullptr);
+
+}
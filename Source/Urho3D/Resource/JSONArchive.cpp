@@ -608,4 +608,333 @@ URHO3D_JSON_IN_IMPL(ea::string, GetString, IsString);
 
 #undef URHO3D_JSON_IN_IMPL
 
+JSONStreamInputArchiveBlock::JSONStreamInputArchiveBlock(const char* name, ArchiveBlockType type, const JSONTape& tape,
+    unsigned valueIndex)
+    : name_(name ? name : "")
+    , type_(type)
+    , tape_(&tape)
+    , valueIndex_(valueIndex)
+    , nextEntryIndex_(valueIndex + 1)
+{
+}
+
+bool JSONStreamInputArchiveBlock::ReadCurrentKey(ArchiveBase& archive, ea::string& key)
+{
+    if (type_ != ArchiveBlockType::Map)
+    {
+        archive.SetErrorFormatted(ArchiveBase::fatalUnexpectedKeySerialization);
+        assert(0);
+        return false;
+    }
+
+    if (keyRead_)
+    {
+        archive.SetErrorFormatted(ArchiveBase::fatalDuplicateKeySerialization);
+        assert(0);
+        return false;
+    }
+
+    if (numReadElements_ >= GetSizeHint())
+    {
+        archive.SetErrorFormatted(ArchiveBase::errorElementNotFound_elementName, ArchiveBase::keyElementName_);
+        return false;
+    }
+
+    key = tape_->GetEntry(nextEntryIndex_).GetString();
+    keyRead_ = true;
+    return true;
+}
+
+unsigned JSONStreamInputArchiveBlock::ReadElement(ArchiveBase& archive, const char* elementName,
+    const ArchiveBlockType* elementBlockType)
+{
+    // Find appropriate value
+    unsigned elementIndex = M_MAX_UNSIGNED;
+    if (IsArchiveBlockJSONArray(type_))
+    {
+        if (numReadElements_ >= GetSizeHint())
+        {
+            archive.SetErrorFormatted(ArchiveBase::errorElementNotFound_elementName, elementName);
+            return M_MAX_UNSIGNED;
+        }
+
+        // Read current element from the array
+        elementIndex = nextEntryIndex_;
+    }
+    else if (IsArchiveBlockJSONObject(type_))
+    {
+        if (type_ == ArchiveBlockType::Unordered)
+        {
+            if (!elementName)
+            {
+                archive.SetErrorFormatted(ArchiveBase::fatalMissingElementName);
+                assert(0);
+                return M_MAX_UNSIGNED;
+            }
+
+            // Not an error in Unordered block if not found
+            elementIndex = tape_->FindMember(valueIndex_, elementName);
+            if (elementIndex == M_MAX_UNSIGNED)
+                return M_MAX_UNSIGNED;
+        }
+        else if (type_ == ArchiveBlockType::Map)
+        {
+            if (!keyRead_)
+            {
+                archive.SetErrorFormatted(ArchiveBase::fatalMissingKeySerialization);
+                assert(0);
+                return M_MAX_UNSIGNED;
+            }
+
+            if (numReadElements_ >= GetSizeHint())
+            {
+                archive.SetErrorFormatted(ArchiveBase::errorElementNotFound_elementName, elementName);
+                return M_MAX_UNSIGNED;
+            }
+
+            // Read current element from the map, the value follows the key
+            elementIndex = nextEntryIndex_ + 1;
+        }
+        else
+        {
+            assert(0);
+            return M_MAX_UNSIGNED;
+        }
+    }
+    else
+    {
+        assert(0);
+        return M_MAX_UNSIGNED;
+    }
+
+    // Check if reading block
+    if (elementBlockType)
+    {
+        if (!IsArchiveBlockTypeMatching(tape_->GetEntry(elementIndex), *elementBlockType))
+        {
+            archive.SetErrorFormatted(ArchiveBase::errorUnexpectedBlockType_blockName, name_);
+            return M_MAX_UNSIGNED;
+        }
+    }
+
+    // Move to next
+    keyRead_ = false;
+    if (type_ == ArchiveBlockType::Array || type_ == ArchiveBlockType::Sequential || type_ == ArchiveBlockType::Map)
+    {
+        nextEntryIndex_ = tape_->GetEntry(elementIndex).next_;
+        ++numReadElements_;
+    }
+
+    return elementIndex;
+}
+
+bool JSONStreamInputArchive::BeginBlock(const char* name, unsigned& sizeHint, bool safe, ArchiveBlockType type)
+{
+    if (!CheckEOF(name, name))
+        return false;
+
+    // Open root block
+    if (stack_.empty())
+    {
+        if (tape_.IsEmpty() || !IsArchiveBlockTypeMatching(tape_.GetEntry(0), type))
+        {
+            SetErrorFormatted(ArchiveBase::errorUnexpectedBlockType_blockName, name);
+            return false;
+        }
+
+        Block frame{ name, type, tape_, 0 };
+        sizeHint = frame.GetSizeHint();
+        stack_.push_back(frame);
+        return true;
+    }
+
+    // Try open block
+    const unsigned blockIndex = GetCurrentBlock().ReadElement(*this, name, &type);
+    if (blockIndex != M_MAX_UNSIGNED)
+    {
+        Block blockFrame{ name, type, tape_, blockIndex };
+        sizeHint = blockFrame.GetSizeHint();
+        stack_.push_back(blockFrame);
+        return true;
+    }
+
+    return false;
+}
+
+bool JSONStreamInputArchive::EndBlock()
+{
+    if (stack_.empty())
+    {
+        SetErrorFormatted(ArchiveBase::fatalUnexpectedEndBlock);
+        return false;
+    }
+
+    stack_.pop_back();
+    if (stack_.empty())
+        CloseArchive();
+    return true;
+}
+
+bool JSONStreamInputArchive::SerializeKey(ea::string& key)
+{
+    if (!CheckEOFAndRoot("", ArchiveBase::keyElementName_))
+        return false;
+
+    return GetCurrentBlock().ReadCurrentKey(*this, key);
+}
+
+bool JSONStreamInputArchive::SerializeKey(unsigned& key)
+{
+    if (!CheckEOFAndRoot("", ArchiveBase::keyElementName_))
+        return false;
+
+    ea::string stringKey;
+    if (GetCurrentBlock().ReadCurrentKey(*this, stringKey))
+    {
+        key = ToUInt(stringKey);
+        return true;
+    }
+    return false;
+}
+
+bool JSONStreamInputArchive::Serialize(const char* name, long long& value)
+{
+    if (const JSONTapeEntry* entry = ReadElement(name))
+    {
+        if (entry->GetType() == JSON_STRING)
+        {
+            sscanf(entry->string_, "%lld", &value);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JSONStreamInputArchive::Serialize(const char* name, unsigned long long& value)
+{
+    if (const JSONTapeEntry* entry = ReadElement(name))
+    {
+        if (entry->GetType() == JSON_STRING)
+        {
+            sscanf(entry->string_, "%llu", &value);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JSONStreamInputArchive::Serialize(const char* name, ea::string& value)
+{
+    if (const JSONTapeEntry* entry = ReadElement(name))
+    {
+        if (entry->GetType() == JSON_STRING)
+        {
+            value = entry->GetString();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JSONStreamInputArchive::SerializeBytes(const char* name, void* bytes, unsigned size)
+{
+    if (const JSONTapeEntry* entry = ReadElement(name))
+    {
+        if (entry->GetType() == JSON_STRING)
+        {
+            if (!HexStringToBuffer(tempBuffer_, entry->GetString()))
+                return false;
+            if (size != tempBuffer_.size())
+                return false;
+            ea::copy(tempBuffer_.begin(), tempBuffer_.end(), static_cast<unsigned char*>(bytes));
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JSONStreamInputArchive::SerializeVLE(const char* name, unsigned& value)
+{
+    if (const JSONTapeEntry* entry = ReadElement(name))
+    {
+        if (entry->GetType() == JSON_NUMBER)
+        {
+            value = (unsigned)entry->number_;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JSONStreamInputArchive::CheckEOF(const char* elementName, const char* debugName)
+{
+    if (HasError())
+        return false;
+
+    if (!ValidateName(elementName))
+    {
+        SetErrorFormatted(ArchiveBase::fatalInvalidName, debugName);
+        return false;
+    }
+
+    if (IsEOF())
+    {
+        SetErrorFormatted(ArchiveBase::errorEOF_elementName, debugName);
+        return false;
+    }
+
+    return true;
+}
+
+bool JSONStreamInputArchive::CheckEOFAndRoot(const char* elementName, const char* debugName)
+{
+    if (!CheckEOF(elementName, debugName))
+        return false;
+
+    if (stack_.empty())
+    {
+        SetErrorFormatted(ArchiveBase::fatalRootBlockNotOpened_elementName, debugName);
+        assert(0);
+        return false;
+    }
+
+    return true;
+}
+
+const JSONTapeEntry* JSONStreamInputArchive::ReadElement(const char* name)
+{
+    if (!CheckEOFAndRoot(name, name))
+        return nullptr;
+
+    const unsigned index = GetCurrentBlock().ReadElement(*this, name, nullptr);
+    return index != M_MAX_UNSIGNED ? &tape_.GetEntry(index) : nullptr;
+}
+
+// Generate serialization implementation (JSON stream input)
+#define URHO3D_JSON_STREAM_IN_IMPL(type, jsonType, getter) \
+    bool JSONStreamInputArchive::Serialize(const char* name, type& value) \
+    { \
+        if (const JSONTapeEntry* entry = ReadElement(name)) \
+        { \
+            if (entry->GetType() == jsonType) \
+            { \
+                value = static_cast<type>(getter); \
+                return true; \
+            } \
+        } \
+        return false; \
+    }
+
+URHO3D_JSON_STREAM_IN_IMPL(bool, JSON_BOOL, entry->bool_);
+URHO3D_JSON_STREAM_IN_IMPL(signed char, JSON_NUMBER, (int)entry->number_);
+URHO3D_JSON_STREAM_IN_IMPL(short, JSON_NUMBER, (int)entry->number_);
+URHO3D_JSON_STREAM_IN_IMPL(int, JSON_NUMBER, (int)entry->number_);
+URHO3D_JSON_STREAM_IN_IMPL(unsigned char, JSON_NUMBER, (unsigned)entry->number_);
+URHO3D_JSON_STREAM_IN_IMPL(unsigned short, JSON_NUMBER, (unsigned)entry->number_);
+URHO3D_JSON_STREAM_IN_IMPL(unsigned int, JSON_NUMBER, (unsigned)entry->number_);
+URHO3D_JSON_STREAM_IN_IMPL(float, JSON_NUMBER, (float)entry->number_);
+URHO3D_JSON_STREAM_IN_IMPL(double, JSON_NUMBER, entry->number_);
+
+#undef URHO3D_JSON_STREAM_IN_IMPL
+
 }
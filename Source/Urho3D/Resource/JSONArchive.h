@@ -24,6 +24,7 @@
 
 #include "../IO/Archive.h"
 #include "../Resource/JSONFile.h"
+#include "../Resource/JSONStreamReader.h"
 #include "../Resource/JSONValue.h"
 
 namespace Urho3D
@@ -42,6 +43,14 @@ inline bool IsArchiveBlockTypeMatching(const JSONValue& value, ArchiveBlockType
         || IsArchiveBlockJSONObject(type) && (value.IsObject() || value.IsNull());
 }
 
+/// Return whether the block type matches JSONTapeEntry type.
+inline bool IsArchiveBlockTypeMatching(const JSONTapeEntry& value, ArchiveBlockType type)
+{
+    const JSONValueType valueType = value.GetType();
+    return IsArchiveBlockJSONArray(type) && (valueType == JSON_ARRAY || valueType == JSON_NULL)
+        || IsArchiveBlockJSONObject(type) && (valueType == JSON_OBJECT || valueType == JSON_NULL);
+}
+
 /// Base archive for JSON serialization.
 template <class T, bool IsInputBool>
 class JSONArchiveBase : public ArchiveBaseT<IsInputBool, true>
@@ -303,4 +312,105 @@ private:
     const JSONValue& rootValue_;
 };
 
+/// Archive stack frame helper for JSONStreamInputArchive.
+struct JSONStreamInputArchiveBlock
+{
+public:
+    /// Construct valid.
+    JSONStreamInputArchiveBlock(const char* name, ArchiveBlockType type, const JSONTape& tape, unsigned valueIndex);
+    /// Return name.
+    const ea::string_view GetName() const { return name_; }
+    /// Return block type.
+    ArchiveBlockType GetType() const { return type_; }
+    /// Return size hint.
+    unsigned GetSizeHint() const { return tape_->GetEntry(valueIndex_).size_; }
+    /// Return current child's key.
+    bool ReadCurrentKey(ArchiveBase& archive, ea::string& key);
+    /// Read current child and move to the next one. Return index of the value or M_MAX_UNSIGNED.
+    unsigned ReadElement(ArchiveBase& archive, const char* elementName, const ArchiveBlockType* elementBlockType);
+
+private:
+    /// Debug block name.
+    ea::string_view name_{};
+    /// Frame type.
+    ArchiveBlockType type_{};
+    /// Tape.
+    const JSONTape* tape_{};
+    /// Index of the block value.
+    unsigned valueIndex_{};
+    /// Index of the next child value (for arrays) or member key (for maps).
+    unsigned nextEntryIndex_{};
+    /// Number of read elements.
+    unsigned numReadElements_{};
+    /// Whether the key was read.
+    bool keyRead_{};
+};
+
+/// JSON input archive that reads a JSONTape instead of JSONValue tree.
+class URHO3D_API JSONStreamInputArchive : public JSONArchiveBase<JSONStreamInputArchiveBlock, true>
+{
+public:
+    /// Base type.
+    using Base = JSONArchiveBase<JSONStreamInputArchiveBlock, true>;
+
+    /// Construct from tape. The tape must outlive the archive.
+    JSONStreamInputArchive(Context* context, const JSONTape& tape)
+        : Base(context, nullptr)
+        , tape_(tape)
+    {
+    }
+
+    /// Begin archive block.
+    bool BeginBlock(const char* name, unsigned& sizeHint, bool safe, ArchiveBlockType type) final;
+    /// End archive block.
+    bool EndBlock() final;
+
+    /// Serialize string key. Used with Map block only.
+    bool SerializeKey(ea::string& key) final;
+    /// Serialize unsigned integer key. Used with Map block only.
+    bool SerializeKey(unsigned& key) final;
+
+    /// Serialize bool.
+    bool Serialize(const char* name, bool& value) final;
+    /// Serialize signed char.
+    bool Serialize(const char* name, signed char& value) final;
+    /// Serialize unsigned char.
+    bool Serialize(const char* name, unsigned char& value) final;
+    /// Serialize signed short.
+    bool Serialize(const char* name, short& value) final;
+    /// Serialize unsigned short.
+    bool Serialize(const char* name, unsigned short& value) final;
+    /// Serialize signed int.
+    bool Serialize(const char* name, int& value) final;
+    /// Serialize unsigned int.
+    bool Serialize(const char* name, unsigned int& value) final;
+    /// Serialize signed long.
+    bool Serialize(const char* name, long long& value) final;
+    /// Serialize unsigned long.
+    bool Serialize(const char* name, unsigned long long& value) final;
+    /// Serialize float.
+    bool Serialize(const char* name, float& value) final;
+    /// Serialize double.
+    bool Serialize(const char* name, double& value) final;
+    /// Serialize string.
+    bool Serialize(const char* name, ea::string& value) final;
+
+    /// Serialize bytes. Size is not encoded and should be provided externally!
+    bool SerializeBytes(const char* name, void* bytes, unsigned size) final;
+    /// Serialize Variable Length Encoded unsigned integer, up to 29 significant bits.
+    bool SerializeVLE(const char* name, unsigned& value) final;
+
+private:
+    /// Check EOF.
+    bool CheckEOF(const char* elementName, const char* debugName);
+    /// Check EOF and root block.
+    bool CheckEOFAndRoot(const char* elementName, const char* debugName);
+    /// Read value of the element.
+    const JSONTapeEntry* ReadElement(const char* name);
+    /// Temporary buffer.
+    ea::vector<unsigned char> tempBuffer_;
+    /// Tape.
+    const JSONTape& tape_;
+};
+
 }
@@ -0,0 +1,220 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Log.h"
+#include "../Resource/JSONStreamReader.h"
+
+#include <rapidjson/reader.h>
+#include <rapidjson/error/en.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Adapter of rapidjson SAX events to JSONStreamHandler.
+struct RapidJSONHandlerAdapter
+{
+    bool Null() { return handler_.OnNull(); }
+    bool Bool(bool value) { return handler_.OnBool(value); }
+    bool Int(int value) { return handler_.OnNumber(value); }
+    bool Uint(unsigned value) { return handler_.OnNumber(value); }
+    bool Int64(int64_t value) { return handler_.OnNumber(static_cast<double>(value)); }
+    bool Uint64(uint64_t value) { return handler_.OnNumber(static_cast<double>(value)); }
+    bool Double(double value) { return handler_.OnNumber(value); }
+    bool RawNumber(const char* str, rapidjson::SizeType length, bool copy) { return false; }
+    bool String(const char* str, rapidjson::SizeType length, bool copy) { return handler_.OnString({ str, length }); }
+    bool StartObject() { return handler_.OnStartObject(); }
+    bool Key(const char* str, rapidjson::SizeType length, bool copy) { return handler_.OnKey({ str, length }); }
+    bool EndObject(rapidjson::SizeType numMembers) { return handler_.OnEndObject(numMembers); }
+    bool StartArray() { return handler_.OnStartArray(); }
+    bool EndArray(rapidjson::SizeType numElements) { return handler_.OnEndArray(numElements); }
+
+    /// Handler.
+    JSONStreamHandler& handler_;
+};
+
+/// Maximum size of a value that fits into JSONTapeEntry.
+const unsigned MAX_TAPE_ENTRY_SIZE = (1u << 28) - 1;
+
+/// Handler that appends parsed values to the tape.
+class JSONTapeBuilder : public JSONStreamHandler
+{
+public:
+    /// Construct.
+    explicit JSONTapeBuilder(ea::vector<JSONTapeEntry>& entries) : entries_(entries) {}
+
+    bool OnNull() override { AddEntry(JSON_NULL).number_ = 0.0; return true; }
+    bool OnBool(bool value) override { AddEntry(JSON_BOOL).bool_ = value; return true; }
+    bool OnNumber(double value) override { AddEntry(JSON_NUMBER).number_ = value; return true; }
+    bool OnString(ea::string_view value) override { return AddString(value); }
+    bool OnKey(ea::string_view key) override { return AddString(key); }
+    bool OnStartObject() override { return StartContainer(JSON_OBJECT); }
+    bool OnEndObject(unsigned numMembers) override { return EndContainer(numMembers); }
+    bool OnStartArray() override { return StartContainer(JSON_ARRAY); }
+    bool OnEndArray(unsigned numElements) override { return EndContainer(numElements); }
+
+private:
+    /// Append entry without children.
+    JSONTapeEntry& AddEntry(JSONValueType type)
+    {
+        const unsigned index = entries_.size();
+        JSONTapeEntry& entry = entries_.push_back();
+        entry.type_ = type;
+        entry.size_ = 0;
+        entry.next_ = index + 1;
+        return entry;
+    }
+
+    /// Append string entry.
+    bool AddString(ea::string_view value)
+    {
+        if (value.size() > MAX_TAPE_ENTRY_SIZE)
+            return false;
+
+        JSONTapeEntry& entry = AddEntry(JSON_STRING);
+        entry.size_ = value.size();
+        entry.string_ = value.data();
+        return true;
+    }
+
+    /// Append array or object and wait for its end.
+    bool StartContainer(JSONValueType type)
+    {
+        openContainers_.push_back(entries_.size());
+        AddEntry(type).number_ = 0.0;
+        return true;
+    }
+
+    /// Finish array or object.
+    bool EndContainer(unsigned size)
+    {
+        if (openContainers_.empty() || size > MAX_TAPE_ENTRY_SIZE)
+            return false;
+
+        JSONTapeEntry& entry = entries_[openContainers_.back()];
+        openContainers_.pop_back();
+        entry.size_ = size;
+        entry.next_ = entries_.size();
+        return true;
+    }
+
+    /// Values.
+    ea::vector<JSONTapeEntry>& entries_;
+    /// Indices of arrays and objects that are not finished yet.
+    ea::vector<unsigned> openContainers_;
+};
+
+}
+
+JSONStreamReader::JSONStreamReader() = default;
+
+JSONStreamReader::~JSONStreamReader() = default;
+
+bool JSONStreamReader::Open(Deserializer& source)
+{
+    name_ = source.GetName();
+    size_ = source.GetSize();
+    parsed_ = false;
+    error_.clear();
+
+    buffer_.reset(new char[size_ + 1]);
+    if (source.Read(buffer_.get(), size_) != size_)
+    {
+        error_ = "Could not read JSON data from " + name_;
+        buffer_.reset();
+        size_ = 0;
+        return false;
+    }
+    buffer_[size_] = '\0';
+    return true;
+}
+
+bool JSONStreamReader::Parse(JSONStreamHandler& handler)
+{
+    URHO3D_PROFILE("ParseJSONStream");
+
+    if (!buffer_ || parsed_)
+    {
+        error_ = "JSON data of " + name_ + " is not opened or already parsed";
+        return false;
+    }
+
+    // Strings are unescaped and null-terminated in place
+    parsed_ = true;
+    RapidJSONHandlerAdapter adapter{ handler };
+    rapidjson::InsituStringStream stream(buffer_.get());
+    rapidjson::Reader reader;
+    const rapidjson::ParseResult result = reader.Parse<rapidjson::kParseInsituFlag | rapidjson::kParseCommentsFlag
+        | rapidjson::kParseTrailingCommasFlag>(stream, adapter);
+    if (result.IsError())
+    {
+        error_ = Format("Could not parse JSON data from {}: {} at offset {}", name_,
+            rapidjson::GetParseError_En(result.Code()), result.Offset());
+        return false;
+    }
+
+    return true;
+}
+
+bool JSONTape::Load(JSONStreamReader& reader)
+{
+    entries_.clear();
+
+    // Rough estimate for typical resource files, avoids most reallocations
+    entries_.reserve(reader.GetSize() / 12 + 1);
+
+    JSONTapeBuilder builder(entries_);
+    if (!reader.Parse(builder))
+    {
+        URHO3D_LOGERROR(reader.GetError());
+        entries_.clear();
+        return false;
+    }
+
+    return true;
+}
+
+unsigned JSONTape::FindMember(unsigned objectIndex, ea::string_view key) const
+{
+    const JSONTapeEntry& object = entries_[objectIndex];
+    if (object.GetType() != JSON_OBJECT)
+        return M_MAX_UNSIGNED;
+
+    unsigned index = objectIndex + 1;
+    for (unsigned i = 0; i < object.size_; ++i)
+    {
+        if (entries_[index].GetString() == key)
+            return index + 1;
+        index = entries_[index + 1].next_;
+    }
+    return M_MAX_UNSIGNED;
+}
+
+}
@@ -0,0 +1,147 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Resource/JSONValue.h"
+
+#include <EASTL/string_view.h>
+#include <EASTL/unique_ptr.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Deserializer;
+
+/// Receiver of JSON parsing events. Strings are views into the reader buffer and stay valid while the reader exists.
+class URHO3D_API JSONStreamHandler
+{
+public:
+    /// Destruct.
+    virtual ~JSONStreamHandler() = default;
+
+    /// Handle null value. Return false to stop parsing.
+    virtual bool OnNull() = 0;
+    /// Handle boolean value. Return false to stop parsing.
+    virtual bool OnBool(bool value) = 0;
+    /// Handle number value. Return false to stop parsing.
+    virtual bool OnNumber(double value) = 0;
+    /// Handle string value. Return false to stop parsing.
+    virtual bool OnString(ea::string_view value) = 0;
+    /// Handle object member key. Return false to stop parsing.
+    virtual bool OnKey(ea::string_view key) = 0;
+    /// Handle beginning of object. Return false to stop parsing.
+    virtual bool OnStartObject() = 0;
+    /// Handle end of object. Return false to stop parsing.
+    virtual bool OnEndObject(unsigned numMembers) = 0;
+    /// Handle beginning of array. Return false to stop parsing.
+    virtual bool OnStartArray() = 0;
+    /// Handle end of array. Return false to stop parsing.
+    virtual bool OnEndArray(unsigned numElements) = 0;
+};
+
+/// Streaming JSON reader. The source is parsed in place without building a document, strings are not copied.
+class URHO3D_API JSONStreamReader
+{
+public:
+    /// Construct.
+    JSONStreamReader();
+    /// Destruct.
+    ~JSONStreamReader();
+
+    /// Read source data into the internal buffer. Return true if successful.
+    bool Open(Deserializer& source);
+    /// Parse the data and report values to the handler. The buffer is modified, so the data may be parsed only once. Return true if successful.
+    bool Parse(JSONStreamHandler& handler);
+
+    /// Return name of the source.
+    const ea::string& GetName() const { return name_; }
+    /// Return size of the source data in bytes.
+    unsigned GetSize() const { return size_; }
+    /// Return last error message.
+    const ea::string& GetError() const { return error_; }
+
+private:
+    /// Name of the source.
+    ea::string name_;
+    /// Null-terminated source data.
+    ea::unique_ptr<char[]> buffer_;
+    /// Size of the source data.
+    unsigned size_{};
+    /// Whether the data was parsed.
+    bool parsed_{};
+    /// Last error message.
+    ea::string error_;
+};
+
+/// Value of a JSONTape.
+struct JSONTapeEntry
+{
+    /// Value type.
+    unsigned type_ : 4;
+    /// Number of elements for arrays, members for objects or characters for strings.
+    unsigned size_ : 28;
+    /// Index of the entry that follows this value and all its children.
+    unsigned next_;
+    /// Value.
+    union
+    {
+        /// Number value.
+        double number_;
+        /// Boolean value.
+        bool bool_;
+        /// Null-terminated string value.
+        const char* string_;
+    };
+
+    /// Return value type.
+    JSONValueType GetType() const { return static_cast<JSONValueType>(type_); }
+    /// Return string value.
+    ea::string_view GetString() const { return type_ == JSON_STRING ? ea::string_view(string_, size_) : ea::string_view(); }
+};
+
+/// Compact read-only JSON document stored as a flat array of values in document order.
+/// Object members are stored as a key string followed by the value. Strings are views into the reader buffer.
+class URHO3D_API JSONTape
+{
+public:
+    /// Parse data of the reader. The reader must outlive the tape. Return true if successful.
+    bool Load(JSONStreamReader& reader);
+
+    /// Return whether the tape is empty.
+    bool IsEmpty() const { return entries_.empty(); }
+    /// Return all values.
+    const ea::vector<JSONTapeEntry>& GetEntries() const { return entries_; }
+    /// Return value by index.
+    const JSONTapeEntry& GetEntry(unsigned index) const { return entries_[index]; }
+    /// Return index of the value of object member with given key, or M_MAX_UNSIGNED if not found.
+    unsigned FindMember(unsigned objectIndex, ea::string_view key) const;
+    /// Return memory used by the tape, excluding the reader buffer.
+    unsigned GetMemoryUse() const { return entries_.capacity() * sizeof(JSONTapeEntry); }
+
+private:
+    /// Values.
+    ea::vector<JSONTapeEntry> entries_;
+};
+
+}
@@ -87,6 +87,10 @@ public:
     void SetAsyncLoadState(AsyncLoadState newState);
     /// Set absolute file name.
     void SetAbsoluteFileName(const ea::string& fileName) { absoluteFileName_ = fileName; }
+    /// Set whether the resource is pinned. Pinned resources are never released by the ResourceCache memory budget.
+    void SetPinned(bool pinned) { pinned_ = pinned; }
+    /// Set frame of the last access through the ResourceCache. Called by ResourceCache.
+    void SetLastAccessFrame(unsigned frameNumber) { lastAccessFrame_ = frameNumber; }
 
     /// Return name.
     /// @property
@@ -109,6 +113,12 @@ public:
     /// Return native file name.
     const ea::string& GetNativeFileName() const { return absoluteFileName_; }
 
+    /// Return whether the resource is pinned.
+    bool IsPinned() const { return pinned_; }
+
+    /// Return frame of the last access through the ResourceCache.
+    unsigned GetLastAccessFrame() const { return lastAccessFrame_; }
+
 private:
     /// Name.
     ea::string name_;
@@ -122,6 +132,10 @@ private:
     unsigned memoryUse_;
     /// Asynchronous loading state.
     AsyncLoadState asyncLoadState_;
+    /// Frame of the last access through the ResourceCache.
+    unsigned lastAccessFrame_{};
+    /// Pinned flag.
+    bool pinned_{};
 };
 
 /// Base class for resources that support arbitrary metadata stored. Metadata serialization shall be implemented in derived classes.
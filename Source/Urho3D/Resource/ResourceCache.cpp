@@ -43,6 +43,7 @@
 #include "../DebugNew.h"
 
 #include <cstdio>
+#include <EASTL/sort.h>
 
 namespace Urho3D
 {
@@ -177,6 +178,7 @@ bool ResourceCache::AddManualResource(Resource* resource)
     }
 
     resource->ResetUseTimer();
+    MarkResourceAccessed(resource);
     resourceGroups_[resource->GetType()].resources_[resource->GetNameHash()] = resource;
     UpdateResourceGroup(resource->GetType());
     return true;
@@ -440,41 +442,117 @@ bool ResourceCache::ReloadResource(Resource* resource)
 
 void ResourceCache::ReloadResourceWithDependencies(const ea::string& fileName)
 {
-    StringHash fileNameHash(fileName);
-    // If the filename is a resource we keep track of, reload it
-    const SharedPtr<Resource>& resource = FindResource(fileNameHash);
-    if (resource)
-    {
-        URHO3D_LOGDEBUG("Reloading changed resource " + fileName);
-        ReloadResource(resource.Get());
-    }
-    // Always perform dependency resource check for resource loaded from XML file as it could be used in inheritance
-    if (!resource || GetExtension(resource->GetName()) == ".xml")
+    ReloadResourcesWithDependencies({ fileName });
+}
+
+void ResourceCache::ReloadResourcesWithDependencies(const ea::vector<ea::string>& fileNames)
+{
+    URHO3D_PROFILE("ReloadResourcesWithDependencies");
+
+    // Reloading a resource may modify the dependency tracking structure. Therefore collect the
+    // resources we need to reload first. Dependents are reloaded after the resources they depend on
+    ea::vector<SharedPtr<Resource> > changed;
+    ea::vector<SharedPtr<Resource> > dependents;
+    ea::hash_set<StringHash> collected;
+    for (const ea::string& fileName : fileNames)
     {
-        // Check if this is a dependency resource, reload dependents
-        auto j = dependentResources_.find(
-            fileNameHash);
-        if (j != dependentResources_.end())
+        StringHash fileNameHash(fileName);
+        // If the filename is a resource we keep track of, reload it
+        const SharedPtr<Resource>& resource = FindResource(fileNameHash);
+        if (resource && collected.insert(fileNameHash).second)
         {
-            // Reloading a resource may modify the dependency tracking structure. Therefore collect the
-            // resources we need to reload first
-            ea::vector<SharedPtr<Resource> > dependents;
-            dependents.reserve(j->second.size());
+            URHO3D_LOGDEBUG("Reloading changed resource " + fileName);
+            changed.push_back(resource);
+        }
+        // Always perform dependency resource check for resource loaded from XML file as it could be used in inheritance
+        if (!resource || GetExtension(resource->GetName()) == ".xml")
+        {
+            // Check if this is a dependency resource, reload dependents
+            auto j = dependentResources_.find(fileNameHash);
+            if (j == dependentResources_.end())
+                continue;
 
             for (auto k = j->second.begin(); k != j->second.end(); ++k)
             {
                 const SharedPtr<Resource>& dependent = FindResource(*k);
-                if (dependent)
+                if (dependent && collected.insert(*k).second)
+                {
+                    URHO3D_LOGDEBUG("Reloading resource " + dependent->GetName() + " depending on " + fileName);
                     dependents.push_back(dependent);
+                }
             }
+        }
+    }
 
-            for (unsigned k = 0; k < dependents.size(); ++k)
-            {
-                URHO3D_LOGDEBUG("Reloading resource " + dependents[k]->GetName() + " depending on " + fileName);
-                ReloadResource(dependents[k].Get());
-            }
+    // Dependent resource may also have changed itself, reload it only once, after its dependencies
+    for (const SharedPtr<Resource>& dependent : dependents)
+        changed.erase(ea::remove(changed.begin(), changed.end(), dependent), changed.end());
+
+    ReloadResources(changed);
+    ReloadResources(dependents);
+}
+
+unsigned ResourceCache::ReloadResources(const ea::vector<SharedPtr<Resource> >& resources)
+{
+    if (resources.empty())
+        return 0;
+
+    URHO3D_PROFILE("ReloadResources");
+
+    // Resources behave as if loaded in background, e.g. use GetTempResource() for their dependencies
+    for (Resource* resource : resources)
+    {
+        resource->SendEvent(E_RELOADSTARTED);
+        resource->SetAsyncLoadState(ASYNC_LOADING);
+    }
+
+    // Read the files and run BeginLoad() on worker threads
+    ea::vector<unsigned char> beginLoadSuccess(resources.size());
+    const auto beginLoad = [&](unsigned begin, unsigned end, unsigned /*threadIndex*/)
+    {
+        for (unsigned i = begin; i < end; ++i)
+        {
+            Resource* resource = resources[i];
+            SharedPtr<File> file = GetFile(resource->GetName(), false);
+            beginLoadSuccess[i] = file && resource->BeginLoad(*file);
+            resource->SetAsyncLoadState(beginLoadSuccess[i] ? ASYNC_SUCCESS : ASYNC_FAIL);
+        }
+    };
+
+    auto* workQueue = GetSubsystem<WorkQueue>();
+    if (workQueue && resources.size() > 1)
+        workQueue->ParallelFor(resources.size(), 1, beginLoad);
+    else
+        beginLoad(0, resources.size(), 0);
+
+    // Finish loading on the main thread in order
+    unsigned numReloaded = 0;
+    ea::hash_set<StringHash> affectedGroups;
+    for (unsigned i = 0; i < resources.size(); ++i)
+    {
+        Resource* resource = resources[i];
+        const bool success = beginLoadSuccess[i] && resource->EndLoad();
+        resource->SetAsyncLoadState(ASYNC_DONE);
+
+        if (success)
+        {
+            resource->ResetUseTimer();
+            affectedGroups.insert(resource->GetType());
+            resource->SendEvent(E_RELOADFINISHED);
+            ++numReloaded;
+        }
+        else
+        {
+            // If reloading failed, do not remove the resource from cache, to allow for a new live edit to
+            // attempt loading again
+            resource->SendEvent(E_RELOADFAILED);
         }
     }
+
+    for (StringHash type : affectedGroups)
+        UpdateResourceGroup(type);
+
+    return numReloaded;
 }
 
 void ResourceCache::SetMemoryBudget(StringHash type, unsigned long long budget)
@@ -482,6 +560,11 @@ void ResourceCache::SetMemoryBudget(StringHash type, unsigned long long budget)
     resourceGroups_[type].memoryBudget_ = budget;
 }
 
+void ResourceCache::SetMemoryLowWatermark(StringHash type, unsigned long long lowWatermark)
+{
+    resourceGroups_[type].memoryLowWatermark_ = lowWatermark;
+}
+
 void ResourceCache::SetAutoReloadResources(bool enable)
 {
     if (enable != autoReloadResources_)
@@ -594,6 +677,8 @@ Resource* ResourceCache::GetExistingResource(StringHash type, const ea::string&
     StringHash nameHash(sanitatedName);
 
     const SharedPtr<Resource>& existing = type == StringHash::ZERO ? FindResource(type, nameHash) : FindResource(nameHash);
+    if (existing)
+        MarkResourceAccessed(existing);
     return existing;
 }
 
@@ -620,7 +705,10 @@ Resource* ResourceCache::GetResource(StringHash type, const ea::string& name, bo
 
     const SharedPtr<Resource>& existing = FindResource(type, nameHash);
     if (existing)
+    {
+        MarkResourceAccessed(existing);
         return existing;
+    }
 
     SharedPtr<Resource> resource;
     // Make sure the pointer is non-null and is a Resource subclass
@@ -668,6 +756,7 @@ Resource* ResourceCache::GetResource(StringHash type, const ea::string& name, bo
 
     // Store to cache
     resource->ResetUseTimer();
+    MarkResourceAccessed(resource);
     resourceGroups_[type].resources_[nameHash] = resource;
     UpdateResourceGroup(type);
 
@@ -687,6 +776,11 @@ bool ResourceCache::BackgroundLoadResource(StringHash type, const ea::string& na
     if (FindResource(type, nameHash) != noResource)
         return false;
 
+    // A caller that is already in the cache is being reloaded by ReloadResources() and is not in the background load
+    // queue. It waits for its dependencies in EndLoad() instead
+    if (caller && FindResource(caller->GetType(), caller->GetNameHash()) == caller)
+        caller = nullptr;
+
     return backgroundLoader_->QueueResource(type, sanitatedName, sendEventOnFailure, caller);
 #else
     // When threading not supported, fall back to synchronous loading
@@ -802,12 +896,30 @@ unsigned long long ResourceCache::GetMemoryBudget(StringHash type) const
     return i != resourceGroups_.end() ? i->second.memoryBudget_ : 0;
 }
 
+unsigned long long ResourceCache::GetMemoryLowWatermark(StringHash type) const
+{
+    auto i = resourceGroups_.find(type);
+    return i != resourceGroups_.end() ? i->second.memoryLowWatermark_ : 0;
+}
+
 unsigned long long ResourceCache::GetMemoryUse(StringHash type) const
 {
     auto i = resourceGroups_.find(type);
     return i != resourceGroups_.end() ? i->second.memoryUse_ : 0;
 }
 
+unsigned ResourceCache::GetNumEvictedResources(StringHash type) const
+{
+    auto i = resourceGroups_.find(type);
+    return i != resourceGroups_.end() ? i->second.numEvicted_ : 0;
+}
+
+unsigned long long ResourceCache::GetEvictedMemory(StringHash type) const
+{
+    auto i = resourceGroups_.find(type);
+    return i != resourceGroups_.end() ? i->second.evictedMemory_ : 0;
+}
+
 unsigned long long ResourceCache::GetTotalMemoryUse() const
 {
     unsigned long long total = 0;
@@ -955,10 +1067,13 @@ void ResourceCache::ResetDependencies(Resource* resource)
 
 ea::string ResourceCache::PrintMemoryUsage() const
 {
-    ea::string output = "Resource Type                 Cnt       Avg       Max    Budget     Total\n\n";
+    ea::string output = "Resource Type                 Cnt Pinned Unused       Avg       Max    Budget     Total   Evicted\n\n";
     char outputLine[256];
 
     unsigned totalResourceCt = 0;
+    unsigned totalPinnedCt = 0;
+    unsigned totalUnusedCt = 0;
+    unsigned long long totalEvicted = 0;
     unsigned long long totalLargest = 0;
     unsigned long long totalAverage = 0;
     unsigned long long totalUse = GetTotalMemoryUse();
@@ -973,26 +1088,37 @@ ea::string ResourceCache::PrintMemoryUsage() const
         else
             average = 0;
         unsigned long long largest = 0;
+        unsigned pinnedCt = 0;
+        unsigned unusedCt = 0;
         for (auto resIt = cit->second.resources_.begin(); resIt != cit->second.resources_.end(); ++resIt)
         {
             if (resIt->second->GetMemoryUse() > largest)
                 largest = resIt->second->GetMemoryUse();
             if (largest > totalLargest)
                 totalLargest = largest;
+            if (resIt->second->IsPinned())
+                ++pinnedCt;
+            else if (resIt->second->Refs() == 1)
+                ++unusedCt;
         }
 
         totalResourceCt += resourceCt;
+        totalPinnedCt += pinnedCt;
+        totalUnusedCt += unusedCt;
+        totalEvicted += cit->second.evictedMemory_;
 
         const ea::string countString = ea::to_string(cit->second.resources_.size());
         const ea::string memUseString = GetFileSizeString(average);
         const ea::string memMaxString = GetFileSizeString(largest);
         const ea::string memBudgetString = GetFileSizeString(cit->second.memoryBudget_);
         const ea::string memTotalString = GetFileSizeString(cit->second.memoryUse_);
+        const ea::string memEvictedString = GetFileSizeString(cit->second.evictedMemory_);
         const ea::string resTypeName = context_->GetTypeName(cit->first);
 
         memset(outputLine, ' ', 256);
         outputLine[255] = 0;
-        sprintf(outputLine, "%-28s %4s %9s %9s %9s %9s\n", resTypeName.c_str(), countString.c_str(), memUseString.c_str(), memMaxString.c_str(), memBudgetString.c_str(), memTotalString.c_str());
+        sprintf(outputLine, "%-28s %4s %6u %6u %9s %9s %9s %9s %9s\n", resTypeName.c_str(), countString.c_str(), pinnedCt, unusedCt,
+            memUseString.c_str(), memMaxString.c_str(), memBudgetString.c_str(), memTotalString.c_str(), memEvictedString.c_str());
 
         output += ((const char*)outputLine);
     }
@@ -1004,10 +1130,12 @@ ea::string ResourceCache::PrintMemoryUsage() const
     const ea::string memUseString = GetFileSizeString(totalAverage);
     const ea::string memMaxString = GetFileSizeString(totalLargest);
     const ea::string memTotalString = GetFileSizeString(totalUse);
+    const ea::string memEvictedString = GetFileSizeString(totalEvicted);
 
     memset(outputLine, ' ', 256);
     outputLine[255] = 0;
-    sprintf(outputLine, "%-28s %4s %9s %9s %9s %9s\n", "All", countString.c_str(), memUseString.c_str(), memMaxString.c_str(), "-", memTotalString.c_str());
+    sprintf(outputLine, "%-28s %4s %6u %6u %9s %9s %9s %9s %9s\n", "All", countString.c_str(), totalPinnedCt, totalUnusedCt,
+        memUseString.c_str(), memMaxString.c_str(), "-", memTotalString.c_str(), memEvictedString.c_str());
     output += ((const char*)outputLine);
 
     return output;
@@ -1046,10 +1174,9 @@ void ResourceCache::ReleasePackageResources(PackageFile* package, bool force)
 {
     ea::hash_set<StringHash> affectedGroups;
 
-    const ea::unordered_map<ea::string, PackageEntry>& entries = package->GetEntries();
-    for (auto i = entries.begin(); i != entries.end(); ++i)
+    for (unsigned i = 0; i < package->GetNumFiles(); ++i)
     {
-        StringHash nameHash(i->first);
+        StringHash nameHash(package->GetEntryName(i));
 
         // We do not know the actual resource type, so search all type containers
         for (auto j = resourceGroups_.begin(); j !=
@@ -1079,46 +1206,57 @@ void ResourceCache::UpdateResourceGroup(StringHash type)
     if (i == resourceGroups_.end())
         return;
 
-    for (;;)
-    {
-        unsigned totalSize = 0;
-        unsigned oldestTimer = 0;
-        auto oldestResource = i->second.resources_.end();
+    ResourceGroup& group = i->second;
+    group.memoryUse_ = 0;
+    for (const auto& [nameHash, resource] : group.resources_)
+        group.memoryUse_ += resource->GetMemoryUse();
 
-        for (auto j = i->second.resources_.begin();
-             j != i->second.resources_.end(); ++j)
-        {
-            totalSize += j->second->GetMemoryUse();
-            unsigned useTimer = j->second->GetUseTimer();
-            if (useTimer > oldestTimer)
-            {
-                oldestTimer = useTimer;
-                oldestResource = j;
-            }
-        }
+    if (!group.memoryBudget_ || group.memoryUse_ <= group.memoryBudget_)
+        return;
 
-        i->second.memoryUse_ = totalSize;
+    // Release least recently used resources down to the low watermark. Resources referenced outside the cache
+    // count as accessed, they and pinned resources can not be released
+    ea::vector<ea::pair<unsigned, StringHash> > candidates;
+    for (const auto& [nameHash, resource] : group.resources_)
+    {
+        if (resource->Refs() > 1)
+            MarkResourceAccessed(resource);
+        else if (!resource->IsPinned())
+            candidates.emplace_back(resource->GetLastAccessFrame(), nameHash);
+    }
+    ea::sort(candidates.begin(), candidates.end());
 
-        // If memory budget defined and is exceeded, remove the oldest resource and loop again
-        // (resources in use always return a zero timer and can not be removed)
-        if (i->second.memoryBudget_ && i->second.memoryUse_ > i->second.memoryBudget_ &&
-            oldestResource != i->second.resources_.end())
-        {
-            URHO3D_LOGDEBUG("Resource group " + oldestResource->second->GetTypeName() + " over memory budget, releasing resource " +
-                     oldestResource->second->GetName());
-            i->second.resources_.erase(oldestResource);
-        }
-        else
+    const unsigned long long targetMemoryUse = group.memoryLowWatermark_ ? Min(group.memoryLowWatermark_, group.memoryBudget_) : group.memoryBudget_;
+    for (const auto& [lastAccessFrame, nameHash] : candidates)
+    {
+        if (group.memoryUse_ <= targetMemoryUse)
             break;
+
+        auto j = group.resources_.find(nameHash);
+        const unsigned memoryUse = j->second->GetMemoryUse();
+        URHO3D_LOGDEBUG("Resource group " + j->second->GetTypeName() + " over memory budget, releasing resource " +
+                 j->second->GetName());
+        group.resources_.erase(j);
+        group.memoryUse_ -= memoryUse;
+        group.evictedMemory_ += memoryUse;
+        ++group.numEvicted_;
     }
 }
 
 void ResourceCache::HandleBeginFrame(StringHash eventType, VariantMap& eventData)
 {
+    ++frameNumber_;
+
+    // Changes are processed in batches, so that many files changed at once are reloaded together
+    ea::vector<FileChange> changes;
+    ea::vector<ea::string> changedFileNames;
     for (unsigned i = 0; i < fileWatchers_.size(); ++i)
     {
-        FileChange change;
-        while (fileWatchers_[i]->GetNextChange(change))
+        if (!fileWatchers_[i]->GetNextBatch(changes))
+            continue;
+
+        changedFileNames.clear();
+        for (const FileChange& change : changes)
         {
             auto it = ignoreResourceAutoReload_.find(change.fileName_);
             if (it != ignoreResourceAutoReload_.end())
@@ -1126,15 +1264,19 @@ void ResourceCache::HandleBeginFrame(StringHash eventType, VariantMap& eventData
                 ignoreResourceAutoReload_.erase(it);
                 continue;
             }
+            changedFileNames.push_back(change.fileName_);
+        }
 
-            ReloadResourceWithDependencies(change.fileName_);
+        ReloadResourcesWithDependencies(changedFileNames);
 
-            // Finally send a general file changed event even if the file was not a tracked resource
+        // Finally send a general file changed event even if the file was not a tracked resource
+        for (const ea::string& fileName : changedFileNames)
+        {
             using namespace FileChanged;
 
             VariantMap& eventData = GetEventDataMap();
-            eventData[P_FILENAME] = fileWatchers_[i]->GetPath() + change.fileName_;
-            eventData[P_RESOURCENAME] = change.fileName_;
+            eventData[P_FILENAME] = fileWatchers_[i]->GetPath() + fileName;
+            eventData[P_RESOURCENAME] = fileName;
             SendEvent(E_FILECHANGED, eventData);
         }
     }
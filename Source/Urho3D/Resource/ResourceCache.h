@@ -54,8 +54,14 @@ struct ResourceGroup
 
     /// Memory budget.
     unsigned long long memoryBudget_;
+    /// Memory use to release down to when the budget is exceeded. Zero releases down to the budget.
+    unsigned long long memoryLowWatermark_{};
     /// Current memory use.
     unsigned long long memoryUse_;
+    /// Number of resources released due to the memory budget.
+    unsigned numEvicted_{};
+    /// Memory of resources released due to the memory budget.
+    unsigned long long evictedMemory_{};
     /// Resources.
     ea::unordered_map<StringHash, SharedPtr<Resource> > resources_;
 };
@@ -125,9 +131,15 @@ public:
     bool ReloadResource(Resource* resource);
     /// Reload a resource based on filename. Causes also reload of dependent resources if necessary.
     void ReloadResourceWithDependencies(const ea::string& fileName);
-    /// Set memory budget for a specific resource type, default 0 is unlimited.
+    /// Reload resources based on filenames. Causes also reload of dependent resources if necessary. Each resource is reloaded at most once.
+    void ReloadResourcesWithDependencies(const ea::vector<ea::string>& fileNames);
+    /// Reload resources in a batch. BeginLoad() runs in parallel on worker threads, EndLoad() on the calling thread. Return number of resources reloaded successfully.
+    unsigned ReloadResources(const ea::vector<SharedPtr<Resource> >& resources);
+    /// Set memory budget for a specific resource type, default 0 is unlimited. When exceeded, the least recently used unreferenced resources are released.
     /// @property
     void SetMemoryBudget(StringHash type, unsigned long long budget);
+    /// Set memory use to release down to when the budget of a resource type is exceeded, default 0 releases down to the budget.
+    void SetMemoryLowWatermark(StringHash type, unsigned long long lowWatermark);
     /// Enable or disable automatic reloading of resources as files are modified. Default false.
     /// @property
     void SetAutoReloadResources(bool enable);
@@ -192,9 +204,15 @@ public:
     /// Return memory budget for a resource type.
     /// @property
     unsigned long long GetMemoryBudget(StringHash type) const;
+    /// Return memory use to release down to when the budget of a resource type is exceeded.
+    unsigned long long GetMemoryLowWatermark(StringHash type) const;
     /// Return total memory use for a resource type.
     /// @property
     unsigned long long GetMemoryUse(StringHash type) const;
+    /// Return number of resources of a type released due to the memory budget.
+    unsigned GetNumEvictedResources(StringHash type) const;
+    /// Return memory of resources of a type released due to the memory budget.
+    unsigned long long GetEvictedMemory(StringHash type) const;
     /// Return total memory use for all resources.
     /// @property
     unsigned long long GetTotalMemoryUse() const;
@@ -261,8 +279,10 @@ private:
     const SharedPtr<Resource>& FindResource(StringHash nameHash);
     /// Release resources loaded from a package file.
     void ReleasePackageResources(PackageFile* package, bool force = false);
-    /// Update a resource group. Recalculate memory use and release resources if over memory budget.
+    /// Update a resource group. Recalculate memory use and release least recently used resources if over memory budget.
     void UpdateResourceGroup(StringHash type);
+    /// Mark resource accessed in the current frame.
+    void MarkResourceAccessed(Resource* resource) const { resource->SetLastAccessFrame(frameNumber_); }
     /// Handle begin frame event. Automatic resource reloads and the finalization of background loaded resources are processed here.
     void HandleBeginFrame(StringHash eventType, VariantMap& eventData);
     /// Search FileSystem for file.
@@ -296,6 +316,8 @@ private:
     mutable bool isRouting_;
     /// How many milliseconds maximum per frame to spend on finishing background loaded resources.
     int finishBackgroundResourcesMs_;
+    /// Current frame number for least recently used tracking.
+    unsigned frameNumber_{};
     /// List of resources that will not be auto-reloaded if reloading event triggers.
     ea::vector<ea::string> ignoreResourceAutoReload_;
 };
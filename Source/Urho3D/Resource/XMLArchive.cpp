@@ -588,4 +588,293 @@ URHO3D_XML_IN_IMPL(ea::string, GetAttribute);
 
 #undef URHO3D_XML_IN_IMPL
 
+XMLStreamInputArchiveBlock::XMLStreamInputArchiveBlock(const char* name, ArchiveBlockType type, const XMLTape& tape, unsigned elementIndex)
+    : name_(name)
+    , type_(type)
+    , tape_(&tape)
+    , elementIndex_(elementIndex)
+    , nextChild_(tape.GetFirstChild(elementIndex))
+{
+}
+
+bool XMLStreamInputArchiveBlock::ReadCurrentKey(ArchiveBase& archive, ea::string& key)
+{
+    if (type_ != ArchiveBlockType::Map)
+    {
+        archive.SetErrorFormatted(ArchiveBase::fatalUnexpectedKeySerialization);
+        assert(0);
+        return false;
+    }
+
+    if (keyRead_)
+    {
+        archive.SetErrorFormatted(ArchiveBase::fatalDuplicateKeySerialization);
+        assert(0);
+        return false;
+    }
+
+    if (nextChild_ == M_MAX_UNSIGNED)
+    {
+        archive.SetErrorFormatted(ArchiveBase::errorElementNotFound_elementName, ArchiveBase::keyElementName_);
+        return false;
+    }
+
+    const XMLTapeAttribute* keyValue = tape_->GetAttribute(nextChild_, keyAttribute);
+    if (!keyValue)
+    {
+        archive.SetErrorFormatted(ArchiveBase::errorMissingMapKey);
+        return false;
+    }
+
+    key = tape_->GetValue(*keyValue);
+    keyRead_ = true;
+    return true;
+}
+
+unsigned XMLStreamInputArchiveBlock::ReadElement(ArchiveBase& archive, const char* elementName)
+{
+    if (type_ != ArchiveBlockType::Unordered && nextChild_ == M_MAX_UNSIGNED)
+    {
+        archive.SetErrorFormatted(ArchiveBase::errorElementNotFound_elementName, elementName);
+        return M_MAX_UNSIGNED;
+    }
+
+    if (type_ == ArchiveBlockType::Unordered && !elementName)
+    {
+        archive.SetErrorFormatted(ArchiveBase::fatalMissingElementName);
+        assert(0);
+        return M_MAX_UNSIGNED;
+    }
+
+    if (type_ == ArchiveBlockType::Map && !keyRead_)
+    {
+        archive.SetErrorFormatted(ArchiveBase::fatalMissingKeySerialization);
+        assert(0);
+        return M_MAX_UNSIGNED;
+    }
+
+    unsigned element;
+    if (type_ == ArchiveBlockType::Unordered)
+        element = tape_->FindChild(elementIndex_, elementName);
+    else
+    {
+        element = nextChild_;
+        nextChild_ = tape_->GetNextSibling(elementIndex_, nextChild_);
+    }
+
+    if (element != M_MAX_UNSIGNED)
+        keyRead_ = false;
+
+    return element;
+}
+
+bool XMLStreamInputArchiveBlock::ReadElementOrAttribute(ArchiveBase& archive, const char* elementName, ea::string_view& value)
+{
+    if (type_ != ArchiveBlockType::Unordered)
+    {
+        const unsigned child = ReadElement(archive, elementName);
+        if (child == M_MAX_UNSIGNED)
+            return false;
+
+        // Missing value is read as empty string, same as XMLElement::GetAttribute
+        const XMLTapeAttribute* attribute = tape_->GetAttribute(child, "value");
+        value = attribute ? tape_->GetValue(*attribute) : "";
+        return true;
+    }
+
+    // Special case for Unordered
+    if (!elementName)
+    {
+        archive.SetErrorFormatted(ArchiveBase::fatalMissingElementName);
+        assert(0);
+        return false;
+    }
+
+    const XMLTapeAttribute* attribute = tape_->GetAttribute(elementIndex_, elementName);
+    if (!attribute)
+        return false;
+
+    value = tape_->GetValue(*attribute);
+    return true;
+}
+
+ea::string XMLStreamInputArchive::GetCurrentStackString()
+{
+    ea::string result;
+    for (const Block& block : stack_)
+    {
+        if (!result.empty())
+            result += "/";
+        result += ea::string{ block.GetName() };
+    }
+    return result;
+}
+
+bool XMLStreamInputArchive::BeginBlock(const char* name, unsigned& sizeHint, bool safe, ArchiveBlockType type)
+{
+    if (!CheckEOF(name, name))
+        return false;
+
+    // Open root block
+    if (stack_.empty())
+    {
+        if (serializeRootName_ && tape_.GetName(0) != ea::string_view(name ? name : "root"))
+        {
+            SetErrorFormatted(ArchiveBase::errorElementNotFound_elementName, name);
+            return false;
+        }
+
+        Block block{ name, type, tape_, 0 };
+        sizeHint = block.CalculateSizeHint();
+        stack_.push_back(block);
+        return true;
+    }
+
+    // Try open block
+    const unsigned blockElement = GetCurrentBlock().ReadElement(*this, name);
+    if (blockElement != M_MAX_UNSIGNED)
+    {
+        Block block{ name, type, tape_, blockElement };
+        sizeHint = block.CalculateSizeHint();
+        stack_.push_back(block);
+        return true;
+    }
+
+    return false;
+}
+
+bool XMLStreamInputArchive::EndBlock()
+{
+    if (stack_.empty())
+    {
+        SetErrorFormatted(ArchiveBase::fatalUnexpectedEndBlock);
+        return false;
+    }
+
+    stack_.pop_back();
+
+    if (stack_.empty())
+        CloseArchive();
+    return true;
+}
+
+bool XMLStreamInputArchive::SerializeKey(ea::string& key)
+{
+    if (!CheckEOFAndRoot("", ArchiveBase::keyElementName_))
+        return false;
+
+    return GetCurrentBlock().ReadCurrentKey(*this, key);
+}
+
+bool XMLStreamInputArchive::SerializeKey(unsigned& key)
+{
+    if (!CheckEOFAndRoot("", ArchiveBase::keyElementName_))
+        return false;
+
+    ea::string stringKey;
+    if (GetCurrentBlock().ReadCurrentKey(*this, stringKey))
+    {
+        key = ToUInt(stringKey);
+        return true;
+    }
+    return false;
+}
+
+bool XMLStreamInputArchive::SerializeBytes(const char* name, void* bytes, unsigned size)
+{
+    ea::string_view value;
+    if (ReadElement(name, value))
+    {
+        if (!HexStringToBuffer(tempBuffer_, value))
+            return false;
+        if (tempBuffer_.size() != size)
+            return false;
+        ea::copy(tempBuffer_.begin(), tempBuffer_.end(), static_cast<unsigned char*>(bytes));
+        return true;
+    }
+    return false;
+}
+
+bool XMLStreamInputArchive::SerializeVLE(const char* name, unsigned& value)
+{
+    ea::string_view stringValue;
+    if (ReadElement(name, stringValue))
+    {
+        value = ToUInt(stringValue.data());
+        return true;
+    }
+    return false;
+}
+
+bool XMLStreamInputArchive::CheckEOF(const char* elementName, const char* debugName)
+{
+    if (HasError())
+        return false;
+
+    if (!ValidateName(elementName))
+    {
+        SetErrorFormatted(ArchiveBase::fatalInvalidName, debugName);
+        return false;
+    }
+
+    if (IsEOF())
+    {
+        SetErrorFormatted(ArchiveBase::errorEOF_elementName, debugName);
+        return false;
+    }
+
+    return true;
+}
+
+bool XMLStreamInputArchive::CheckEOFAndRoot(const char* elementName, const char* debugName)
+{
+    if (!CheckEOF(elementName, debugName))
+        return false;
+
+    if (stack_.empty())
+    {
+        SetErrorFormatted(ArchiveBase::fatalRootBlockNotOpened_elementName, debugName);
+        assert(0);
+        return false;
+    }
+
+    return true;
+}
+
+bool XMLStreamInputArchive::ReadElement(const char* name, ea::string_view& value)
+{
+    if (!CheckEOFAndRoot(name, name))
+        return false;
+
+    return GetCurrentBlock().ReadElementOrAttribute(*this, name, value);
+}
+
+// Generate serialization implementation (XML stream input). Attribute values are null-terminated.
+#define URHO3D_XML_STREAM_IN_IMPL(type, function) \
+    bool XMLStreamInputArchive::Serialize(const char* name, type& value) \
+    { \
+        ea::string_view stringValue; \
+        if (ReadElement(name, stringValue)) \
+        { \
+            value = function(stringValue.data()); \
+            return true; \
+        } \
+        return false; \
+    }
+
+URHO3D_XML_STREAM_IN_IMPL(bool, ToBool);
+URHO3D_XML_STREAM_IN_IMPL(signed char, ToInt);
+URHO3D_XML_STREAM_IN_IMPL(short, ToInt);
+URHO3D_XML_STREAM_IN_IMPL(int, ToInt);
+URHO3D_XML_STREAM_IN_IMPL(long long, ToInt64);
+URHO3D_XML_STREAM_IN_IMPL(unsigned char, ToUInt);
+URHO3D_XML_STREAM_IN_IMPL(unsigned short, ToUInt);
+URHO3D_XML_STREAM_IN_IMPL(unsigned int, ToUInt);
+URHO3D_XML_STREAM_IN_IMPL(unsigned long long, ToUInt64);
+URHO3D_XML_STREAM_IN_IMPL(float, ToFloat);
+URHO3D_XML_STREAM_IN_IMPL(double, ToDouble);
+URHO3D_XML_STREAM_IN_IMPL(ea::string, ea::string);
+
+#undef URHO3D_XML_STREAM_IN_IMPL
+
 }
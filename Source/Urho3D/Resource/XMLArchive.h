@@ -25,6 +25,7 @@
 #include "../IO/Archive.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/XMLFile.h"
+#include "../Resource/XMLStreamReader.h"
 
 #include <EASTL/hash_set.h>
 
@@ -333,4 +334,127 @@ private:
     ea::vector<unsigned char> tempBuffer_;
 };
 
+/// XML stream input archive block. Internal.
+class XMLStreamInputArchiveBlock
+{
+public:
+    /// Construct valid.
+    XMLStreamInputArchiveBlock(const char* name, ArchiveBlockType type, const XMLTape& tape, unsigned elementIndex);
+    /// Return name.
+    const ea::string_view GetName() const { return name_; }
+    /// Return block type.
+    ArchiveBlockType GetType() const { return type_; }
+    /// Return size hint.
+    unsigned CalculateSizeHint() const { return tape_->GetElement(elementIndex_).numChildren_; }
+    /// Return current child's key.
+    bool ReadCurrentKey(ArchiveBase& archive, ea::string& key);
+    /// Read current child and move to the next one. Return M_MAX_UNSIGNED if not found.
+    unsigned ReadElement(ArchiveBase& archive, const char* elementName);
+    /// Read attribute (for Unordered blocks only) or the value of the element and move to the next one.
+    bool ReadElementOrAttribute(ArchiveBase& archive, const char* elementName, ea::string_view& value);
+
+private:
+    /// Block name.
+    ea::string_view name_;
+    /// Block type.
+    ArchiveBlockType type_{};
+    /// Tape.
+    const XMLTape* tape_{};
+    /// Block element index.
+    unsigned elementIndex_{};
+    /// Next child to read.
+    unsigned nextChild_{ M_MAX_UNSIGNED };
+
+    /// Whether the block key is read.
+    bool keyRead_{};
+};
+
+/// XML input archive that reads XMLTape produced by XMLStreamReader. Equivalent to XMLInputArchive for file root.
+class URHO3D_API XMLStreamInputArchive : public ArchiveBaseT<true, true>
+{
+public:
+    /// Construct from tape. The tape must outlive the archive.
+    XMLStreamInputArchive(Context* context, const XMLTape& tape, bool serializeRootName = true)
+        : context_(context)
+        , tape_(tape)
+        , serializeRootName_(serializeRootName)
+    {
+        assert(!tape_.IsEmpty());
+    }
+
+    /// Get context.
+    Context* GetContext() final { return context_; }
+    /// Return name of the archive.
+    ea::string_view GetName() const final { return ""; }
+
+    /// Whether the unordered element access is supported for Unordered blocks.
+    bool IsUnorderedSupportedNow() const final { return !stack_.empty() && stack_.back().GetType() == ArchiveBlockType::Unordered; }
+    /// Return current string stack.
+    ea::string GetCurrentStackString() final;
+
+    /// Begin archive block.
+    bool BeginBlock(const char* name, unsigned& sizeHint, bool safe, ArchiveBlockType type) final;
+    /// End archive block.
+    bool EndBlock() final;
+
+    /// Serialize string key. Used with Map block only.
+    bool SerializeKey(ea::string& key) final;
+    /// Serialize unsigned integer key. Used with Map block only.
+    bool SerializeKey(unsigned& key) final;
+
+    /// Serialize bool.
+    bool Serialize(const char* name, bool& value) final;
+    /// Serialize signed char.
+    bool Serialize(const char* name, signed char& value) final;
+    /// Serialize unsigned char.
+    bool Serialize(const char* name, unsigned char& value) final;
+    /// Serialize signed short.
+    bool Serialize(const char* name, short& value) final;
+    /// Serialize unsigned short.
+    bool Serialize(const char* name, unsigned short& value) final;
+    /// Serialize signed int.
+    bool Serialize(const char* name, int& value) final;
+    /// Serialize unsigned int.
+    bool Serialize(const char* name, unsigned int& value) final;
+    /// Serialize signed long.
+    bool Serialize(const char* name, long long& value) final;
+    /// Serialize unsigned long.
+    bool Serialize(const char* name, unsigned long long& value) final;
+    /// Serialize float.
+    bool Serialize(const char* name, float& value) final;
+    /// Serialize double.
+    bool Serialize(const char* name, double& value) final;
+    /// Serialize string.
+    bool Serialize(const char* name, ea::string& value) final;
+
+    /// Serialize bytes. Size is not encoded and should be provided externally!
+    bool SerializeBytes(const char* name, void* bytes, unsigned size) final;
+    /// Serialize Variable Length Encoded unsigned integer, up to 29 significant bits.
+    bool SerializeVLE(const char* name, unsigned& value) final;
+
+private:
+    /// Block type.
+    using Block = XMLStreamInputArchiveBlock;
+
+    /// Get current block.
+    Block& GetCurrentBlock() { return stack_.back(); }
+    /// Check EOF.
+    bool CheckEOF(const char* elementName, const char* debugName);
+    /// Check EOF and root block.
+    bool CheckEOFAndRoot(const char* elementName, const char* debugName);
+    /// Prepare to serialize element. Value is null-terminated.
+    bool ReadElement(const char* name, ea::string_view& value);
+
+    /// Context.
+    Context* context_{};
+    /// Tape.
+    const XMLTape& tape_;
+    /// Blocks stack.
+    ea::vector<Block> stack_;
+    /// Whether to serialize root name.
+    const bool serializeRootName_{};
+    /// Temporary buffer.
+    ea::vector<unsigned char> tempBuffer_;
+};
+
 }
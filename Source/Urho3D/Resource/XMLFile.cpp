@@ -84,11 +84,18 @@ bool XMLFile::BeginLoad(Deserializer& source)
         return false;
     }
 
-    ea::shared_array<char> buffer(new char[dataSize]);
-    if (source.Read(buffer.get(), dataSize) != dataSize)
+    // Read into a buffer allocated by pugixml and let the document parse it in place, avoiding an extra copy
+    auto* buffer = static_cast<char*>(pugi::get_memory_allocation_function()(dataSize));
+    if (!buffer)
         return false;
+    if (source.Read(buffer, dataSize) != dataSize)
+    {
+        pugi::get_memory_deallocation_function()(buffer);
+        return false;
+    }
 
-    if (!document_->load_buffer(buffer.get(), dataSize))
+    // The document takes ownership of the buffer even if parsing fails
+    if (!document_->load_buffer_inplace_own(buffer, dataSize))
     {
         URHO3D_LOGERROR("Could not parse XML data from " + source.GetName());
         document_->reset();
@@ -0,0 +1,648 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Core/StringUtils.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Log.h"
+#include "../Resource/XMLStreamReader.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Character class flags.
+enum XMLCharClass : unsigned char
+{
+    /// Whitespace.
+    XML_CHAR_SPACE = 1 << 0,
+    /// Character that terminates element or attribute name.
+    XML_CHAR_NAME_END = 1 << 1,
+    /// Character that needs processing in text.
+    XML_CHAR_TEXT_SPECIAL = 1 << 2,
+    /// Character that needs processing in attribute value.
+    XML_CHAR_ATTRIBUTE_SPECIAL = 1 << 3,
+};
+
+/// Lookup table of character classes.
+struct XMLCharClassTable
+{
+    constexpr XMLCharClassTable()
+    {
+        const unsigned char space = XML_CHAR_SPACE | XML_CHAR_NAME_END;
+        classes_[static_cast<unsigned char>(' ')] = space;
+        classes_[static_cast<unsigned char>('\t')] = space | XML_CHAR_ATTRIBUTE_SPECIAL;
+        classes_[static_cast<unsigned char>('\n')] = space | XML_CHAR_ATTRIBUTE_SPECIAL;
+        classes_[static_cast<unsigned char>('\r')] = space | XML_CHAR_TEXT_SPECIAL | XML_CHAR_ATTRIBUTE_SPECIAL;
+        classes_[static_cast<unsigned char>('&')] = XML_CHAR_TEXT_SPECIAL | XML_CHAR_ATTRIBUTE_SPECIAL;
+        classes_[static_cast<unsigned char>('\0')] = XML_CHAR_NAME_END;
+        classes_[static_cast<unsigned char>('/')] = XML_CHAR_NAME_END;
+        classes_[static_cast<unsigned char>('<')] = XML_CHAR_NAME_END;
+        classes_[static_cast<unsigned char>('>')] = XML_CHAR_NAME_END;
+        classes_[static_cast<unsigned char>('=')] = XML_CHAR_NAME_END;
+    }
+
+    /// Flags for each character.
+    unsigned char classes_[256]{};
+};
+
+static constexpr XMLCharClassTable charClasses;
+
+/// Return whether the character belongs to the class.
+inline bool IsXMLCharClass(char ch, XMLCharClass charClass) { return (charClasses.classes_[static_cast<unsigned char>(ch)] & charClass) != 0; }
+
+/// Return whether the character is XML whitespace.
+inline bool IsXMLSpace(char ch) { return IsXMLCharClass(ch, XML_CHAR_SPACE); }
+
+/// Return whether the character may be part of element or attribute name.
+inline bool IsXMLNameChar(char ch) { return !IsXMLCharClass(ch, XML_CHAR_NAME_END); }
+
+/// Write code point as UTF-8 and return pointer past the written data.
+char* WriteUTF8(char* dest, unsigned codePoint)
+{
+    if (codePoint < 0x80)
+        *dest++ = static_cast<char>(codePoint);
+    else if (codePoint < 0x800)
+    {
+        *dest++ = static_cast<char>(0xc0 | (codePoint >> 6));
+        *dest++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else if (codePoint < 0x10000)
+    {
+        *dest++ = static_cast<char>(0xe0 | (codePoint >> 12));
+        *dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        *dest++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    else
+    {
+        *dest++ = static_cast<char>(0xf0 | (codePoint >> 18));
+        *dest++ = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3f));
+        *dest++ = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3f));
+        *dest++ = static_cast<char>(0x80 | (codePoint & 0x3f));
+    }
+    return dest;
+}
+
+/// Decode entity at the source and write the result to the destination. Return false if the entity is unknown.
+/// Source and destination may overlap, the decoded entity is never longer than the source.
+bool DecodeEntity(const char*& source, const char* end, char*& dest)
+{
+    const char* semicolon = static_cast<const char*>(memchr(source, ';', end - source));
+    if (!semicolon)
+        return false;
+
+    const ea::string_view entity(source + 1, semicolon - source - 1);
+    if (entity == "lt")
+        *dest++ = '<';
+    else if (entity == "gt")
+        *dest++ = '>';
+    else if (entity == "amp")
+        *dest++ = '&';
+    else if (entity == "quot")
+        *dest++ = '"';
+    else if (entity == "apos")
+        *dest++ = '\'';
+    else if (entity.size() >= 2 && entity[0] == '#')
+    {
+        const bool hex = entity[1] == 'x';
+        const ea::string_view digits = entity.substr(hex ? 2 : 1);
+        if (digits.empty() || digits.size() > 8)
+            return false;
+
+        unsigned codePoint = 0;
+        for (char ch : digits)
+        {
+            unsigned digit;
+            if (ch >= '0' && ch <= '9')
+                digit = ch - '0';
+            else if (hex && ch >= 'a' && ch <= 'f')
+                digit = ch - 'a' + 10;
+            else if (hex && ch >= 'A' && ch <= 'F')
+                digit = ch - 'A' + 10;
+            else
+                return false;
+            codePoint = codePoint * (hex ? 16 : 10) + digit;
+        }
+        if (codePoint > 0x10ffff)
+            return false;
+        dest = WriteUTF8(dest, codePoint);
+    }
+    else
+        return false;
+
+    source = semicolon + 1;
+    return true;
+}
+
+/// Decode entities and normalize whitespace in place. Return the new end of the data.
+char* DecodeInPlace(char* begin, char* end, bool attribute)
+{
+    // Fast path for plain data
+    const XMLCharClass specialClass = attribute ? XML_CHAR_ATTRIBUTE_SPECIAL : XML_CHAR_TEXT_SPECIAL;
+    char* dest = begin;
+    while (dest != end && !IsXMLCharClass(*dest, specialClass))
+        ++dest;
+
+    const char* source = dest;
+    while (source != end)
+    {
+        const char ch = *source;
+        if (ch == '&')
+        {
+            if (!DecodeEntity(source, end, dest))
+                *dest++ = *source++;
+        }
+        else if (ch == '\r')
+        {
+            // Same as pugixml: CR LF and lone CR become single space in attributes and LF in text
+            *dest++ = attribute ? ' ' : '\n';
+            ++source;
+            if (source != end && *source == '\n')
+                ++source;
+        }
+        else if (attribute && (ch == '\n' || ch == '\t'))
+        {
+            *dest++ = ' ';
+            ++source;
+        }
+        else
+            *dest++ = *source++;
+    }
+    return dest;
+}
+
+/// In-situ XML tokenizer.
+class XMLTokenizer
+{
+public:
+    /// Construct.
+    XMLTokenizer(char* begin, char* end, XMLStreamHandler& handler)
+        : begin_(begin)
+        , ptr_(begin)
+        , end_(end)
+        , handler_(handler)
+    {
+    }
+
+    /// Parse the data. Return true if successful.
+    bool Parse()
+    {
+        // Skip UTF-8 BOM
+        if (end_ - ptr_ >= 3 && memcmp(ptr_, "\xef\xbb\xbf", 3) == 0)
+            ptr_ += 3;
+
+        bool rootParsed = false;
+        while (ptr_ != end_)
+        {
+            if (*ptr_ != '<')
+            {
+                if (!ParseText())
+                    return false;
+            }
+            else if (StartsWith("<?"))
+            {
+                if (!SkipPast("?>"))
+                    return SetError("Unterminated processing instruction");
+            }
+            else if (StartsWith("<!--"))
+            {
+                if (!SkipPast("-->"))
+                    return SetError("Unterminated comment");
+            }
+            else if (StartsWith("<![CDATA["))
+            {
+                if (!ParseCDATA())
+                    return false;
+            }
+            else if (StartsWith("<!"))
+            {
+                if (!SkipDeclaration())
+                    return false;
+            }
+            else if (StartsWith("</"))
+            {
+                if (!ParseEndTag())
+                    return false;
+            }
+            else
+            {
+                if (openElements_.empty() && rootParsed)
+                    return SetError("Multiple root elements");
+                rootParsed = true;
+                if (!ParseStartTag())
+                    return false;
+            }
+        }
+
+        if (!openElements_.empty())
+            return SetError("Unclosed element");
+        if (!rootParsed)
+            return SetError("No document element");
+        return true;
+    }
+
+    /// Return error message.
+    const ea::string& GetError() const { return error_; }
+    /// Return offset of the current position.
+    unsigned GetOffset() const { return static_cast<unsigned>(ptr_ - begin_); }
+
+private:
+    /// Set error and return false.
+    bool SetError(const char* message)
+    {
+        if (error_.empty())
+            error_ = message;
+        return false;
+    }
+
+    /// Return whether the remaining data starts with given string.
+    bool StartsWith(const char* prefix) const
+    {
+        const size_t length = strlen(prefix);
+        return static_cast<size_t>(end_ - ptr_) >= length && memcmp(ptr_, prefix, length) == 0;
+    }
+
+    /// Skip data up to and including the terminator. Return false if not found.
+    bool SkipPast(const char* terminator)
+    {
+        const ea::string_view remaining(ptr_, end_ - ptr_);
+        const size_t pos = remaining.find(terminator);
+        if (pos == ea::string_view::npos)
+            return false;
+        ptr_ += pos + strlen(terminator);
+        return true;
+    }
+
+    /// Skip whitespace.
+    void SkipSpace()
+    {
+        while (ptr_ != end_ && IsXMLSpace(*ptr_))
+            ++ptr_;
+    }
+
+    /// Parse element or attribute name.
+    ea::string_view ParseName()
+    {
+        char* nameBegin = ptr_;
+        while (ptr_ != end_ && IsXMLNameChar(*ptr_))
+            ++ptr_;
+        return { nameBegin, static_cast<size_t>(ptr_ - nameBegin) };
+    }
+
+    /// Parse text between tags.
+    bool ParseText()
+    {
+        // Most text is indentation between tags
+        char* textBegin = ptr_;
+        SkipSpace();
+        if (ptr_ == end_ || *ptr_ == '<')
+            return true;
+
+        char* textEnd = static_cast<char*>(memchr(ptr_, '<', end_ - ptr_));
+        if (!textEnd)
+            textEnd = end_;
+        ptr_ = textEnd;
+
+        if (openElements_.empty())
+            return SetError("Text outside of document element");
+
+        char* decodedEnd = DecodeInPlace(textBegin, textEnd, false);
+        if (!handler_.OnText({ textBegin, static_cast<size_t>(decodedEnd - textBegin) }))
+            return SetError("Parsing stopped by handler");
+        return true;
+    }
+
+    /// Parse CDATA section.
+    bool ParseCDATA()
+    {
+        ptr_ += 9;
+        char* textBegin = ptr_;
+        if (!SkipPast("]]>"))
+            return SetError("Unterminated CDATA section");
+        if (openElements_.empty())
+            return SetError("CDATA outside of document element");
+
+        if (!handler_.OnText({ textBegin, static_cast<size_t>(ptr_ - 3 - textBegin) }))
+            return SetError("Parsing stopped by handler");
+        return true;
+    }
+
+    /// Skip DOCTYPE or other declaration including the internal subset.
+    bool SkipDeclaration()
+    {
+        unsigned depth = 0;
+        char quote = 0;
+        for (++ptr_; ptr_ != end_; ++ptr_)
+        {
+            const char ch = *ptr_;
+            if (quote)
+            {
+                if (ch == quote)
+                    quote = 0;
+            }
+            else if (ch == '"' || ch == '\'')
+                quote = ch;
+            else if (ch == '[')
+                ++depth;
+            else if (ch == ']' && depth > 0)
+                --depth;
+            else if (ch == '>' && depth == 0)
+            {
+                ++ptr_;
+                return true;
+            }
+        }
+        return SetError("Unterminated declaration");
+    }
+
+    /// Parse start tag with attributes.
+    bool ParseStartTag()
+    {
+        ++ptr_;
+        const ea::string_view name = ParseName();
+        if (name.empty())
+            return SetError("Expected element name");
+        if (!handler_.OnStartElement(name))
+            return SetError("Parsing stopped by handler");
+
+        while (true)
+        {
+            SkipSpace();
+            if (ptr_ == end_)
+                return SetError("Unterminated start tag");
+
+            if (*ptr_ == '>')
+            {
+                ++ptr_;
+                openElements_.push_back(name);
+                return true;
+            }
+
+            if (*ptr_ == '/')
+            {
+                if (end_ - ptr_ < 2 || ptr_[1] != '>')
+                    return SetError("Expected '>' after '/'");
+                ptr_ += 2;
+                if (!handler_.OnEndElement(name))
+                    return SetError("Parsing stopped by handler");
+                return true;
+            }
+
+            if (!ParseAttribute())
+                return false;
+        }
+    }
+
+    /// Parse attribute of start tag.
+    bool ParseAttribute()
+    {
+        const ea::string_view name = ParseName();
+        if (name.empty())
+            return SetError("Expected attribute name");
+
+        SkipSpace();
+        if (ptr_ == end_ || *ptr_ != '=')
+            return SetError("Expected '=' after attribute name");
+        ++ptr_;
+        SkipSpace();
+        if (ptr_ == end_ || (*ptr_ != '"' && *ptr_ != '\''))
+            return SetError("Expected quoted attribute value");
+
+        const char quote = *ptr_++;
+        char* valueBegin = ptr_;
+
+        // Fast path for values without entities and whitespace to normalize
+        char* valueEnd = valueBegin;
+        while (valueEnd != end_ && *valueEnd != quote && !IsXMLCharClass(*valueEnd, XML_CHAR_ATTRIBUTE_SPECIAL))
+            ++valueEnd;
+        const bool needDecode = valueEnd != end_ && *valueEnd != quote;
+        if (needDecode)
+            valueEnd = static_cast<char*>(memchr(valueEnd, quote, end_ - valueEnd));
+        if (!valueEnd || valueEnd == end_)
+            return SetError("Unterminated attribute value");
+        ptr_ = valueEnd + 1;
+
+        // Overwrite the closing quote (or the tail of decoded data) so the value is null-terminated
+        char* decodedEnd = needDecode ? DecodeInPlace(valueBegin, valueEnd, true) : valueEnd;
+        *decodedEnd = '\0';
+        if (!handler_.OnAttribute(name, { valueBegin, static_cast<size_t>(decodedEnd - valueBegin) }))
+            return SetError("Parsing stopped by handler");
+        return true;
+    }
+
+    /// Parse end tag.
+    bool ParseEndTag()
+    {
+        ptr_ += 2;
+        const ea::string_view name = ParseName();
+        SkipSpace();
+        if (ptr_ == end_ || *ptr_ != '>')
+            return SetError("Expected '>' at the end of end tag");
+        ++ptr_;
+
+        if (openElements_.empty() || openElements_.back() != name)
+            return SetError("Mismatched end tag");
+        openElements_.pop_back();
+        if (!handler_.OnEndElement(name))
+            return SetError("Parsing stopped by handler");
+        return true;
+    }
+
+    /// Beginning of the data.
+    char* begin_{};
+    /// Current position.
+    char* ptr_{};
+    /// End of the data.
+    char* end_{};
+    /// Handler.
+    XMLStreamHandler& handler_;
+    /// Names of open elements.
+    ea::vector<ea::string_view> openElements_;
+    /// Error message.
+    ea::string error_;
+};
+
+/// Handler that appends parsed elements to the tape.
+class XMLTapeBuilder : public XMLStreamHandler
+{
+public:
+    /// Construct.
+    XMLTapeBuilder(const char* buffer, ea::vector<XMLTapeElement>& elements, ea::vector<XMLTapeAttribute>& attributes)
+        : buffer_(buffer)
+        , elements_(elements)
+        , attributes_(attributes)
+    {
+    }
+
+    bool OnStartElement(ea::string_view name) override
+    {
+        if (!openElements_.empty())
+            ++elements_[openElements_.back()].numChildren_;
+
+        openElements_.push_back(elements_.size());
+        XMLTapeElement& element = elements_.push_back();
+        element.nameOffset_ = GetOffset(name);
+        element.nameLength_ = name.size();
+        element.firstAttribute_ = attributes_.size();
+        return true;
+    }
+
+    bool OnAttribute(ea::string_view name, ea::string_view value) override
+    {
+        attributes_.push_back(XMLTapeAttribute{ GetOffset(name), static_cast<unsigned>(name.size()),
+            GetOffset(value), static_cast<unsigned>(value.size()) });
+        ++elements_[openElements_.back()].numAttributes_;
+        return true;
+    }
+
+    bool OnEndElement(ea::string_view name) override
+    {
+        elements_[openElements_.back()].next_ = elements_.size();
+        openElements_.pop_back();
+        return true;
+    }
+
+private:
+    /// Return offset of the string in the reader buffer.
+    unsigned GetOffset(ea::string_view value) const { return static_cast<unsigned>(value.data() - buffer_); }
+
+    /// Reader buffer.
+    const char* buffer_{};
+    /// Elements.
+    ea::vector<XMLTapeElement>& elements_;
+    /// Attributes.
+    ea::vector<XMLTapeAttribute>& attributes_;
+    /// Indices of elements that are not finished yet.
+    ea::vector<unsigned> openElements_;
+};
+
+}
+
+XMLStreamReader::XMLStreamReader() = default;
+
+XMLStreamReader::~XMLStreamReader() = default;
+
+bool XMLStreamReader::Open(Deserializer& source)
+{
+    name_ = source.GetName();
+    size_ = source.GetSize();
+    parsed_ = false;
+    error_.clear();
+
+    buffer_.reset(new char[size_ + 1]);
+    if (source.Read(buffer_.get(), size_) != size_)
+    {
+        error_ = "Could not read XML data from " + name_;
+        buffer_.reset();
+        size_ = 0;
+        return false;
+    }
+    buffer_[size_] = '\0';
+    return true;
+}
+
+bool XMLStreamReader::Parse(XMLStreamHandler& handler)
+{
+    URHO3D_PROFILE("ParseXMLStream");
+
+    if (!buffer_ || parsed_)
+    {
+        error_ = "XML data of " + name_ + " is not opened or already parsed";
+        return false;
+    }
+
+    // Entities are decoded and attribute values are null-terminated in place
+    parsed_ = true;
+    XMLTokenizer tokenizer(buffer_.get(), buffer_.get() + size_, handler);
+    if (!tokenizer.Parse())
+    {
+        error_ = Format("Could not parse XML data from {}: {} at offset {}", name_, tokenizer.GetError(), tokenizer.GetOffset());
+        return false;
+    }
+
+    return true;
+}
+
+bool XMLTape::Load(XMLStreamReader& reader)
+{
+    buffer_ = reader.GetData();
+    elements_.clear();
+    attributes_.clear();
+
+    // Rough estimate for typical resource files, avoids most reallocations
+    elements_.reserve(reader.GetSize() / 40 + 1);
+    attributes_.reserve(reader.GetSize() / 20 + 1);
+
+    XMLTapeBuilder builder(buffer_, elements_, attributes_);
+    if (!reader.Parse(builder))
+    {
+        URHO3D_LOGERROR(reader.GetError());
+        elements_.clear();
+        attributes_.clear();
+        return false;
+    }
+
+    return true;
+}
+
+const XMLTapeAttribute* XMLTape::GetAttribute(unsigned elementIndex, ea::string_view name) const
+{
+    const XMLTapeElement& element = elements_[elementIndex];
+    for (unsigned i = 0; i < element.numAttributes_; ++i)
+    {
+        const XMLTapeAttribute& attribute = attributes_[element.firstAttribute_ + i];
+        if (GetName(attribute) == name)
+            return &attribute;
+    }
+    return nullptr;
+}
+
+unsigned XMLTape::GetFirstChild(unsigned elementIndex) const
+{
+    return elements_[elementIndex].numChildren_ > 0 ? elementIndex + 1 : M_MAX_UNSIGNED;
+}
+
+unsigned XMLTape::GetNextSibling(unsigned parentIndex, unsigned childIndex) const
+{
+    const unsigned nextIndex = elements_[childIndex].next_;
+    return nextIndex < elements_[parentIndex].next_ ? nextIndex : M_MAX_UNSIGNED;
+}
+
+unsigned XMLTape::FindChild(unsigned elementIndex, ea::string_view name) const
+{
+    for (unsigned child = GetFirstChild(elementIndex); child != M_MAX_UNSIGNED; child = GetNextSibling(elementIndex, child))
+    {
+        if (GetName(child) == name)
+            return child;
+    }
+    return M_MAX_UNSIGNED;
+}
+
+}
@@ -0,0 +1,169 @@
+//
+// Copyright (c) 2017-2020 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Math/MathDefs.h"
+
+#include <EASTL/string.h>
+#include <EASTL/string_view.h>
+#include <EASTL/unique_ptr.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Deserializer;
+
+/// Receiver of XML parsing events. Names and values are views into the reader buffer and stay valid while the reader exists.
+/// Attribute values are null-terminated.
+class URHO3D_API XMLStreamHandler
+{
+public:
+    /// Destruct.
+    virtual ~XMLStreamHandler() = default;
+
+    /// Handle start tag of element. Return false to stop parsing.
+    virtual bool OnStartElement(ea::string_view name) = 0;
+    /// Handle attribute of the last started element. Return false to stop parsing.
+    virtual bool OnAttribute(ea::string_view name, ea::string_view value) = 0;
+    /// Handle end of element. Return false to stop parsing.
+    virtual bool OnEndElement(ea::string_view name) = 0;
+    /// Handle non-whitespace text or CDATA inside element. Return false to stop parsing.
+    virtual bool OnText(ea::string_view text) { return true; }
+};
+
+/// Streaming XML reader. The source is parsed in place without building a document, strings are not copied.
+/// Supports the subset of XML used by resources: elements, attributes, text, CDATA and standard entities.
+/// Processing instructions, comments and DOCTYPE are skipped.
+class URHO3D_API XMLStreamReader
+{
+public:
+    /// Construct.
+    XMLStreamReader();
+    /// Destruct.
+    ~XMLStreamReader();
+
+    /// Read source data into the internal buffer. Return true if successful.
+    bool Open(Deserializer& source);
+    /// Parse the data and report elements to the handler. The buffer is modified, so the data may be parsed only once. Return true if successful.
+    bool Parse(XMLStreamHandler& handler);
+
+    /// Return name of the source.
+    const ea::string& GetName() const { return name_; }
+    /// Return size of the source data in bytes.
+    unsigned GetSize() const { return size_; }
+    /// Return the source data. Modified in place by parsing.
+    const char* GetData() const { return buffer_.get(); }
+    /// Return last error message.
+    const ea::string& GetError() const { return error_; }
+
+private:
+    /// Name of the source.
+    ea::string name_;
+    /// Null-terminated source data.
+    ea::unique_ptr<char[]> buffer_;
+    /// Size of the source data.
+    unsigned size_{};
+    /// Whether the data was parsed.
+    bool parsed_{};
+    /// Last error message.
+    ea::string error_;
+};
+
+/// Element of a XMLTape. Strings are stored as offsets into the reader buffer.
+struct XMLTapeElement
+{
+    /// Offset of the element name.
+    unsigned nameOffset_{};
+    /// Length of the element name.
+    unsigned nameLength_{};
+    /// Index of the first attribute.
+    unsigned firstAttribute_{};
+    /// Number of attributes.
+    unsigned numAttributes_{};
+    /// Number of child elements.
+    unsigned numChildren_{};
+    /// Index of the element that follows this element and all its children.
+    unsigned next_{};
+};
+
+/// Attribute of a XMLTape. Strings are stored as offsets into the reader buffer.
+struct XMLTapeAttribute
+{
+    /// Offset of the attribute name.
+    unsigned nameOffset_{};
+    /// Length of the attribute name.
+    unsigned nameLength_{};
+    /// Offset of the null-terminated attribute value.
+    unsigned valueOffset_{};
+    /// Length of the attribute value.
+    unsigned valueLength_{};
+};
+
+/// Compact read-only XML document stored as flat arrays of elements in document order and their attributes.
+/// The first child of an element immediately follows it. Strings are views into the reader buffer.
+class URHO3D_API XMLTape
+{
+public:
+    /// Parse data of the reader. The reader must outlive the tape. Return true if successful.
+    bool Load(XMLStreamReader& reader);
+
+    /// Return whether the tape is empty.
+    bool IsEmpty() const { return elements_.empty(); }
+    /// Return all elements.
+    const ea::vector<XMLTapeElement>& GetElements() const { return elements_; }
+    /// Return element by index.
+    const XMLTapeElement& GetElement(unsigned index) const { return elements_[index]; }
+    /// Return element name.
+    ea::string_view GetName(unsigned elementIndex) const { return GetString(elements_[elementIndex].nameOffset_, elements_[elementIndex].nameLength_); }
+    /// Return attribute of element by name, or null if not found.
+    const XMLTapeAttribute* GetAttribute(unsigned elementIndex, ea::string_view name) const;
+    /// Return attribute name.
+    ea::string_view GetName(const XMLTapeAttribute& attribute) const { return GetString(attribute.nameOffset_, attribute.nameLength_); }
+    /// Return null-terminated attribute value.
+    ea::string_view GetValue(const XMLTapeAttribute& attribute) const { return GetString(attribute.valueOffset_, attribute.valueLength_); }
+    /// Return index of the first child element, or M_MAX_UNSIGNED if none.
+    unsigned GetFirstChild(unsigned elementIndex) const;
+    /// Return index of the next sibling of child element, or M_MAX_UNSIGNED if none.
+    unsigned GetNextSibling(unsigned parentIndex, unsigned childIndex) const;
+    /// Return index of the first child element with given name, or M_MAX_UNSIGNED if not found.
+    unsigned FindChild(unsigned elementIndex, ea::string_view name) const;
+    /// Return memory used by the tape, excluding the reader buffer.
+    unsigned GetMemoryUse() const
+    {
+        return elements_.capacity() * sizeof(XMLTapeElement) + attributes_.capacity() * sizeof(XMLTapeAttribute);
+    }
+
+private:
+    /// Return string from the reader buffer.
+    ea::string_view GetString(unsigned offset, unsigned length) const { return { buffer_ + offset, length }; }
+
+    /// Reader buffer.
+    const char* buffer_{};
+    /// Elements.
+    ea::vector<XMLTapeElement> elements_;
+    /// Attributes.
+    ea::vector<XMLTapeAttribute> attributes_;
+};
+
+}
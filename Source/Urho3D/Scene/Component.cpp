@@ -162,14 +162,27 @@ void Component::AddReplicationState(ComponentReplicationState* state)
     if (!networkState_)
         AllocateNetworkState();
 
+    MutexLock<SpinLockMutex> lock(networkState_->mutex_);
     networkState_->replicationStates_.push_back(state);
 }
 
+void Component::RemoveReplicationState(ComponentReplicationState* state)
+{
+    if (networkState_)
+    {
+        MutexLock<SpinLockMutex> lock(networkState_->mutex_);
+        networkState_->replicationStates_.erase_first(state);
+    }
+}
+
 void Component::PrepareNetworkUpdate()
 {
     if (!networkState_)
         AllocateNetworkState();
 
+    // Current values are about to change, serialize them again when needed
+    networkState_->encoded_.store(false, std::memory_order_relaxed);
+
     const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
     if (!attributes)
         return;
@@ -93,8 +93,12 @@ void LogicComponent::OnSceneSet(Scene* scene)
         UpdateEventSubscription();
     else
     {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+        if (updateScene_)
+        {
+            updateScene_->GetUpdateChannel().Unsubscribe(this);
+            updateScene_->GetPostUpdateChannel().Unsubscribe(this);
+            updateScene_ = nullptr;
+        }
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
         UnsubscribeFromEvent(E_PHYSICSPRESTEP);
         UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
@@ -110,28 +114,29 @@ void LogicComponent::UpdateEventSubscription()
         return;
 
     bool enabled = IsEnabledEffective();
+    updateScene_ = scene;
 
     bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
     if (needUpdate && !(currentEventMask_ & USE_UPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
+        scene->GetUpdateChannel().Subscribe<&LogicComponent::HandleSceneUpdate>(this);
         currentEventMask_ |= USE_UPDATE;
     }
     else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
     {
-        UnsubscribeFromEvent(scene, E_SCENEUPDATE);
+        scene->GetUpdateChannel().Unsubscribe(this);
         currentEventMask_ &= ~USE_UPDATE;
     }
 
     bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
     if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
     {
-        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
+        scene->GetPostUpdateChannel().Subscribe<&LogicComponent::HandleScenePostUpdate>(this);
         currentEventMask_ |= USE_POSTUPDATE;
     }
     else if (!needPostUpdate && (currentEventMask_ & USE_POSTUPDATE))
     {
-        UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
+        scene->GetPostUpdateChannel().Unsubscribe(this);
         currentEventMask_ &= ~USE_POSTUPDATE;
     }
 
@@ -166,10 +171,8 @@ void LogicComponent::UpdateEventSubscription()
 #endif
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandleSceneUpdate(const SceneUpdateEventData& eventData)
 {
-    using namespace SceneUpdate;
-
     // Execute user-defined delayed start function before first update
     if (!delayedStartCalled_)
     {
@@ -179,22 +182,20 @@ void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventDa
         // If did not need actual update events, unsubscribe now
         if (!(updateEventMask_ & USE_UPDATE))
         {
-            UnsubscribeFromEvent(GetScene(), E_SCENEUPDATE);
+            eventData.scene_->GetUpdateChannel().Unsubscribe(this);
             currentEventMask_ &= ~USE_UPDATE;
             return;
         }
     }
 
     // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    Update(eventData.timeStep_);
 }
 
-void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandleScenePostUpdate(const SceneUpdateEventData& eventData)
 {
-    using namespace ScenePostUpdate;
-
     // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
+    PostUpdate(eventData.timeStep_);
 }
 
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
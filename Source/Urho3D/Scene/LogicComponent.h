@@ -30,6 +30,8 @@
 namespace Urho3D
 {
 
+struct SceneUpdateEventData;
+
 enum UpdateEvent : unsigned
 {
     /// Bitmask for not using any events.
@@ -67,9 +69,9 @@ class URHO3D_API LogicComponent : public Component
     /// Called when the component is detached from a scene node, usually on destruction. Note that you will no longer have access to the node and scene at that point.
     virtual void Stop() { }
 
-    /// Called on scene update, variable timestep.
+    /// Called on scene update, variable timestep. Called through the scene update channel, before all E_SCENEUPDATE event handlers.
     virtual void Update(float timeStep);
-    /// Called on scene post-update, variable timestep.
+    /// Called on scene post-update, variable timestep. Called through the scene post-update channel, before all E_SCENEPOSTUPDATE event handlers.
     virtual void PostUpdate(float timeStep);
     /// Called on physics update, fixed timestep.
     virtual void FixedUpdate(float timeStep);
@@ -95,9 +97,9 @@ private:
     /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
     void UpdateEventSubscription();
     /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleSceneUpdate(const SceneUpdateEventData& eventData);
     /// Handle scene post-update event.
-    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    void HandleScenePostUpdate(const SceneUpdateEventData& eventData);
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_URHO2D)
     /// Handle physics pre-step event.
     void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
@@ -108,6 +110,8 @@ private:
     UpdateEventFlags updateEventMask_;
     /// Current event subscription mask.
     UpdateEventFlags currentEventMask_;
+    /// Scene whose update channels are subscribed to.
+    WeakPtr<Scene> updateScene_;
     /// Flag for delayed start.
     bool delayedStartCalled_;
 };
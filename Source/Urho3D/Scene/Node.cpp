@@ -88,7 +88,8 @@ void Node::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Scale", GetScale, SetScale, Vector3, Vector3::ONE, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Variables", VariantMap, vars_, Variant::emptyVariantMap, AM_FILE); // Network replication of vars uses custom data
     URHO3D_ACCESSOR_ATTRIBUTE("Network Position", GetNetPositionAttr, SetNetPositionAttr, Vector3, Vector3::ZERO,
-        AM_NET | AM_LATESTDATA | AM_NOEDIT);
+        AM_NET | AM_LATESTDATA | AM_NOEDIT)
+        .SetQuantization(0.001f);
     URHO3D_ACCESSOR_ATTRIBUTE("Network Rotation", GetNetRotationAttr, SetNetRotationAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
         AM_NET | AM_LATESTDATA | AM_NOEDIT);
     URHO3D_ACCESSOR_ATTRIBUTE("Network Parent Node", GetNetParentAttr, SetNetParentAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
@@ -437,9 +438,19 @@ void Node::AddReplicationState(NodeReplicationState* state)
     if (!networkState_)
         AllocateNetworkState();
 
+    MutexLock<SpinLockMutex> lock(networkState_->mutex_);
     networkState_->replicationStates_.push_back(state);
 }
 
+void Node::RemoveReplicationState(NodeReplicationState* state)
+{
+    if (networkState_)
+    {
+        MutexLock<SpinLockMutex> lock(networkState_->mutex_);
+        networkState_->replicationStates_.erase_first(state);
+    }
+}
+
 bool Node::SaveXML(Serializer& dest, const ea::string& indentation) const
 {
     SharedPtr<XMLFile> xml(context_->CreateObject<XMLFile>());
@@ -979,6 +990,8 @@ void Node::AddChild(Node* node, unsigned index)
             }
 
             oldParent->children_.erase_first(nodeShared);
+            if (scene_)
+                scene_->MarkTransformHierarchyDirty();
         }
     }
 
@@ -1855,6 +1868,9 @@ void Node::PrepareNetworkUpdate()
     if (!networkState_)
         AllocateNetworkState();
 
+    // Current values are about to change, serialize them again when needed
+    networkState_->encoded_.store(false, std::memory_order_relaxed);
+
     const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
     unsigned numAttributes = attributes->size();
 
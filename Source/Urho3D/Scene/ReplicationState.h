@@ -26,8 +26,11 @@
 #include <EASTL/unordered_map.h>
 
 #include "../Core/Attribute.h"
+#include "../Core/Mutex.h"
+#include "../IO/VectorBuffer.h"
 #include "../Math/StringHash.h"
 
+#include <atomic>
 #include <cstring>
 
 namespace Urho3D
@@ -117,6 +120,17 @@ struct URHO3D_API DirtyBits
     unsigned char count_{};
 };
 
+/// Latest data update received before the baseline it was encoded against. Used on the client only.
+struct PendingLatestData
+{
+    /// Index of the baseline.
+    unsigned char baselineIndex_{};
+    /// Server timestamp.
+    unsigned char timeStamp_{};
+    /// Message data, starting from the timestamp.
+    ea::vector<unsigned char> data_;
+};
+
 /// Per-object attribute state for network replication, allocated on demand.
 struct URHO3D_API NetworkState
 {
@@ -132,6 +146,24 @@ struct URHO3D_API NetworkState
     VariantMap previousVars_;
     /// Bitmask for intercepting network messages. Used on the client only.
     unsigned long long interceptMask_{};
+    /// Quantized latest data values last received in a reliable update. Used on the client only.
+    ea::vector<int> baseline_;
+    /// Number of reliable latest data baseline updates received, modulo 256. Used on the client only.
+    unsigned char baselineIndex_{};
+    /// Newest latest data update for each baseline that has not been received yet. Used on the client only.
+    ea::vector<PendingLatestData> pendingLatestData_;
+    /// Current network attribute values serialized once and shared by all connections.
+    VectorBuffer encodedValues_;
+    /// End offset of each serialized attribute value.
+    ea::vector<unsigned> encodedValueEnds_;
+    /// Attributes with non-default values, as of the serialized values.
+    DirtyBits nonDefaultAttributes_;
+    /// Quantized latest data attribute components, as of the serialized values.
+    ea::vector<int> quantizedValues_;
+    /// Whether the serialized values match the current values.
+    std::atomic<bool> encoded_{};
+    /// Guards serialization and replication state registration while connections are updated in parallel.
+    SpinLockMutex mutex_;
 };
 
 /// Base class for per-user network replication states.
@@ -139,6 +171,12 @@ struct URHO3D_API ReplicationState
 {
     /// Parent network connection.
     Connection* connection_;
+    /// Quantized latest data values last sent in a reliable update, used as the baseline for latest data deltas.
+    ea::vector<int> baseline_;
+    /// Number of reliable latest data baseline updates sent, modulo 256.
+    unsigned char baselineIndex_{};
+    /// Number of latest data updates sent against the current baseline.
+    unsigned baselineAge_{};
 };
 
 /// Per-user component network replication state.
@@ -42,6 +42,7 @@
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 #include "../Scene/SceneManager.h"
+#include "../Scene/ScenePrefab.h"
 #include "../Scene/SmoothedTransform.h"
 #include "../Scene/SplinePath.h"
 #include "../Scene/UnknownComponent.h"
@@ -661,6 +662,14 @@ Node* Scene::InstantiateJSON(const JSONValue& source, const Vector3& position, c
     }
 }
 
+Node* Scene::InstantiatePrefab(const ScenePrefab* prefab, const Vector3& position, const Quaternion& rotation, CreateMode mode)
+{
+    if (!prefab)
+        return nullptr;
+
+    return prefab->Instantiate(this, position, rotation, mode);
+}
+
 Node* Scene::InstantiateXML(Deserializer& source, const Vector3& position, const Quaternion& rotation, CreateMode mode)
 {
     SharedPtr<XMLFile> xml(context_->CreateObject<XMLFile>());
@@ -736,6 +745,17 @@ void Scene::SetAsyncLoadingMs(int ms)
     asyncLoadingMs_ = Max(ms, 1);
 }
 
+void Scene::SetTransformHierarchyEnabled(bool enable)
+{
+    if (enable == IsTransformHierarchyEnabled())
+        return;
+
+    if (enable)
+        transformHierarchy_ = ea::make_unique<TransformHierarchy>(this);
+    else
+        transformHierarchy_.reset();
+}
+
 void Scene::SetElapsedTime(float time)
 {
     elapsedTime_ = time;
@@ -851,7 +871,10 @@ void Scene::Update(float timeStep)
     eventData[P_SCENE] = this;
     eventData[P_TIMESTEP] = timeStep;
 
+    const SceneUpdateEventData updateData{ this, timeStep };
+
     // Update variable timestep logic
+    SendEvent(updateChannel_, updateData);
     SendEvent(E_SCENEUPDATE, eventData);
 
     // Update scene attribute animation.
@@ -875,14 +898,24 @@ void Scene::Update(float timeStep)
     }
 
     // Post-update variable timestep logic
+    SendEvent(postUpdateChannel_, updateData);
     SendEvent(E_SCENEPOSTUPDATE, eventData);
 
+    // Resolve world transforms moved by the update in one pass, before they are queried for rendering
+    UpdateWorldTransforms();
+
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
     // SetElapsedTime()
     elapsedTime_ += timeStep;
 }
 
+void Scene::UpdateWorldTransforms()
+{
+    if (transformHierarchy_)
+        transformHierarchy_->Update(GetSubsystem<WorkQueue>());
+}
+
 void Scene::BeginThreadedUpdate()
 {
     // Check the work queue subsystem whether it actually has created worker threads. If not, do not enter threaded mode.
@@ -989,6 +1022,7 @@ void Scene::NodeAdded(Node* node)
         oldScene->NodeRemoved(node);
 
     node->SetScene(this);
+    MarkTransformHierarchyDirty();
 
     // If the new node has an ID of zero (default), assign a replicated ID now
     unsigned id = node->GetID();
@@ -1066,6 +1100,7 @@ void Scene::NodeRemoved(Node* node)
         localNodes_.erase(id);
 
     node->ResetScene();
+    MarkTransformHierarchyDirty();
 
     // Remove node from tag cache
     if (!node->GetTags().empty())
@@ -1108,6 +1143,10 @@ void Scene::ComponentAdded(Component* component)
         }
 
         replicatedComponents_[id] = component;
+
+        // Components of nested child nodes are not marked by AddChild. Mark them here so that their NetworkState
+        // is allocated on the main thread before connections register to it in parallel
+        component->MarkNetworkUpdate();
     }
     else
     {
@@ -1171,6 +1210,9 @@ ea::string Scene::GetVarNamesAttr() const
 
 void Scene::PrepareNetworkUpdate()
 {
+    // Connections register to the network state concurrently, so allocate it beforehand
+    AllocateNetworkState();
+
     for (auto i = networkUpdateNodes_.begin(); i != networkUpdateNodes_.end(); ++i)
     {
         Node* node = GetNode(*i);
@@ -1626,6 +1668,7 @@ void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
     ObjectAnimation::RegisterObject(context);
+    ScenePrefab::RegisterObject(context);
     Node::RegisterObject(context);
     Scene::RegisterObject(context);
     SmoothedTransform::RegisterObject(context);
@@ -27,17 +27,20 @@
 #include <EASTL/span.h>
 #include <EASTL/unique_ptr.h>
 
+#include "../Core/EventChannel.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
 #include "../Scene/Node.h"
 #include "../Scene/SceneResolver.h"
+#include "../Scene/TransformHierarchy.h"
 
 namespace Urho3D
 {
 
 class File;
 class PackageFile;
+class ScenePrefab;
 class Texture2D;
 
 static const unsigned FIRST_REPLICATED_ID = 0x1;
@@ -86,6 +89,15 @@ struct AsyncProgress
     unsigned totalNodes_;
 };
 
+/// Payload of typed scene update and post-update events.
+struct SceneUpdateEventData
+{
+    /// Scene being updated.
+    Scene* scene_{};
+    /// Frame timestep, scaled by the scene time scale.
+    float timeStep_{};
+};
+
 /// Index of components in the Scene.
 using SceneComponentIndex = ea::hash_set<Component*>;
 
@@ -169,6 +181,8 @@ public:
     /// Instantiate scene content from JSON data. Return root node if successful.
     Node* InstantiateJSON
         (const JSONValue& source, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
+    /// Instantiate prefab as a child of the scene. Return root node if successful.
+    Node* InstantiatePrefab(const ScenePrefab* prefab, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
     /// Instantiate scene content from JSON data. Return root node if successful.
     Node* InstantiateJSON(Deserializer& source, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
 
@@ -192,6 +206,10 @@ public:
     /// Set maximum milliseconds per frame to spend on async scene loading.
     /// @property
     void SetAsyncLoadingMs(int ms);
+    /// Enable or disable batched world transform update at the end of the scene update. When enabled, the node hierarchy
+    /// is kept as a flat array ordered by depth and dirty world transforms are recalculated in one pass.
+    /// @property
+    void SetTransformHierarchyEnabled(bool enable);
     /// Add a required package file for networking. To be called on the server.
     void AddRequiredPackageFile(PackageFile* package);
     /// Clear required package files.
@@ -218,6 +236,9 @@ public:
     /// Return whether updates are enabled.
     /// @property
     bool IsUpdateEnabled() const { return updateEnabled_; }
+    /// Return whether batched world transform update is enabled.
+    /// @property
+    bool IsTransformHierarchyEnabled() const { return transformHierarchy_ != nullptr; }
 
     /// Return whether an asynchronous loading operation is in progress.
     /// @property
@@ -268,6 +289,10 @@ public:
 
     /// Update scene. Called by HandleUpdate.
     void Update(float timeStep);
+    /// Return typed scene update channel. Invoked right before E_SCENEUPDATE is sent, so channel subscribers run before all event subscribers.
+    EventChannel<SceneUpdateEventData>& GetUpdateChannel() { return updateChannel_; }
+    /// Return typed scene post-update channel. Invoked right before E_SCENEPOSTUPDATE is sent.
+    EventChannel<SceneUpdateEventData>& GetPostUpdateChannel() { return postUpdateChannel_; }
     /// Begin a threaded update. During threaded update components can choose to delay dirty processing.
     void BeginThreadedUpdate();
     /// End a threaded update. Notify components that marked themselves for delayed dirty processing.
@@ -277,6 +302,14 @@ public:
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
+    /// Recalculate dirty world transforms of all nodes. Does nothing unless batched world transform update is enabled.
+    void UpdateWorldTransforms();
+    /// Mark the transform hierarchy for rebuild. Called when nodes are added, removed or reparented.
+    void MarkTransformHierarchyDirty()
+    {
+        if (transformHierarchy_)
+            transformHierarchy_->MarkStructureDirty();
+    }
 
     /// Get free node ID, either non-local or local.
     unsigned GetFreeNodeID(CreateMode mode);
@@ -304,6 +337,8 @@ public:
     ea::string GetVarNamesAttr() const;
     /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
     void PrepareNetworkUpdate();
+    /// Return IDs of nodes marked for attribute check on the next network update.
+    const ea::hash_set<unsigned>& GetNetworkUpdateNodes() const { return networkUpdateNodes_; }
     /// Clean up all references to a network connection that is about to be removed.
     void CleanupConnection(Connection* connection);
     /// Mark a node for attribute check on the next network update.
@@ -368,10 +403,16 @@ private:
     ea::hash_set<unsigned> networkUpdateComponents_;
     /// Delayed dirty notification queue for components.
     ea::vector<Component*> delayedDirtyComponents_;
+    /// Flat transform hierarchy for batched world transform update. Null if disabled.
+    ea::unique_ptr<TransformHierarchy> transformHierarchy_;
     /// Mutex for the delayed dirty notification queue.
     Mutex sceneMutex_;
     /// Preallocated event data map for smoothing update events.
     VariantMap smoothingData_;
+    /// Typed scene update channel.
+    EventChannel<SceneUpdateEventData> updateChannel_;
+    /// Typed scene post-update channel.
+    EventChannel<SceneUpdateEventData> postUpdateChannel_;
     /// Next free non-local node ID.
     unsigned replicatedNodeID_;
     /// Next free non-local component ID.
@@ -0,0 +1,450 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Resource/JSONFile.h"
+#include "../Resource/XMLFile.h"
+#include "../Scene/ObjectAnimation.h"
+#include "../Scene/Scene.h"
+#include "../Scene/ScenePrefab.h"
+#include "../Scene/SceneResolver.h"
+#include "../Scene/UnknownComponent.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// File ID of the binary prefab format.
+static const char* PREFAB_FILE_ID = "UPRF";
+/// Version of the binary prefab format.
+static const unsigned PREFAB_FORMAT_VERSION = 1;
+
+static CreateMode GetObjectCreateMode(CreateMode mode, unsigned id)
+{
+    return (mode == REPLICATED && Scene::IsReplicatedID(id)) ? REPLICATED : LOCAL;
+}
+
+static void WarnInlineAnimation(const Animatable* object)
+{
+    ObjectAnimation* objectAnimation = object->GetObjectAnimation();
+    if (objectAnimation && objectAnimation->GetName().empty())
+        URHO3D_LOGWARNING("Inline object animation of " + object->GetTypeName() + " is not stored in prefab");
+}
+
+ScenePrefab::ScenePrefab(Context* context) :
+    Resource(context)
+{
+}
+
+ScenePrefab::~ScenePrefab() = default;
+
+void ScenePrefab::RegisterObject(Context* context)
+{
+    context->RegisterFactory<ScenePrefab>();
+}
+
+bool ScenePrefab::BeginLoad(Deserializer& source)
+{
+    Clear();
+
+    // Read everything at once, the format is detected from the data
+    ea::vector<unsigned char> data(source.GetSize());
+    if (data.empty() || source.Read(data.data(), data.size()) != data.size())
+    {
+        URHO3D_LOGERROR("Could not read prefab " + GetName());
+        return false;
+    }
+
+    MemoryBuffer buffer(data);
+    if (data.size() >= 4 && !memcmp(data.data(), PREFAB_FILE_ID, 4))
+        return LoadPrefab(buffer);
+
+    unsigned firstChar = 0;
+    while (firstChar < data.size() && isspace(data[firstChar]))
+        ++firstChar;
+
+    // Text data needs node objects to be parsed, which may only be created in the main thread
+    if (firstChar < data.size() && data[firstChar] == '<')
+    {
+        loadXMLFile_ = MakeShared<XMLFile>(context_);
+        return loadXMLFile_->Load(buffer);
+    }
+    else if (firstChar < data.size() && data[firstChar] == '{')
+    {
+        loadJSONFile_ = MakeShared<JSONFile>(context_);
+        return loadJSONFile_->Load(buffer);
+    }
+
+    loadNodeData_ = ea::move(data);
+    return true;
+}
+
+bool ScenePrefab::EndLoad()
+{
+    bool success = true;
+    if (loadXMLFile_)
+        success = LoadXML(loadXMLFile_->GetRoot());
+    else if (loadJSONFile_)
+        success = LoadJSON(loadJSONFile_->GetRoot());
+    else if (!loadNodeData_.empty())
+    {
+        MemoryBuffer buffer(loadNodeData_);
+        success = LoadNode(buffer);
+    }
+
+    loadXMLFile_.Reset();
+    loadJSONFile_.Reset();
+    loadNodeData_.clear();
+    return success;
+}
+
+bool ScenePrefab::Save(Serializer& dest) const
+{
+    if (!dest.WriteFileID(PREFAB_FILE_ID) || !dest.WriteUInt(PREFAB_FORMAT_VERSION))
+        return false;
+
+    const auto writeAttributes = [&](const PrefabObject& object)
+    {
+        const ea::vector<AttributeInfo>* attributes = context_->GetAttributes(object.type_);
+        dest.WriteVLE(object.numAttributes_);
+        for (unsigned i = object.firstAttribute_; i < object.firstAttribute_ + object.numAttributes_; ++i)
+        {
+            const PrefabAttribute& attribute = attributes_[i];
+            // Attributes are stored by name so that the data survives changes in attribute registration
+            dest.WriteStringHash(attributes->at(attribute.index_).nameHash_);
+            dest.WriteVariant(attribute.value_);
+        }
+    };
+
+    dest.WriteVLE(nodes_.size());
+    for (const PrefabObject& node : nodes_)
+    {
+        dest.WriteUInt(node.id_);
+        dest.WriteUInt(node.parentIndex_);
+        writeAttributes(node);
+
+        dest.WriteVLE(node.numComponents_);
+        for (unsigned i = node.firstComponent_; i < node.firstComponent_ + node.numComponents_; ++i)
+        {
+            const PrefabObject& component = components_[i];
+            dest.WriteStringHash(component.type_);
+            dest.WriteUInt(component.id_);
+            writeAttributes(component);
+        }
+    }
+
+    return true;
+}
+
+bool ScenePrefab::Capture(const Node* node)
+{
+    Clear();
+    if (!node)
+        return false;
+
+    CaptureNode(node, M_MAX_UNSIGNED);
+    return true;
+}
+
+bool ScenePrefab::LoadXML(const XMLElement& source)
+{
+    Clear();
+    if (!source)
+        return false;
+
+    // Load into a detached node keeping the original IDs, references are resolved on instantiation
+    auto node = MakeShared<Node>(context_);
+    node->SetID(source.GetUInt("id"));
+    SceneResolver resolver;
+    if (!node->LoadXML(source, resolver, true, false, REPLICATED))
+        return false;
+
+    return Capture(node);
+}
+
+bool ScenePrefab::LoadJSON(const JSONValue& source)
+{
+    Clear();
+    if (source.IsNull())
+        return false;
+
+    auto node = MakeShared<Node>(context_);
+    node->SetID(source.Get("id").GetUInt());
+    SceneResolver resolver;
+    if (!node->LoadJSON(source, resolver, true, false, REPLICATED))
+        return false;
+
+    return Capture(node);
+}
+
+bool ScenePrefab::LoadNode(Deserializer& source)
+{
+    Clear();
+
+    auto node = MakeShared<Node>(context_);
+    node->SetID(source.ReadUInt());
+    SceneResolver resolver;
+    if (!node->Load(source, resolver, true, false, REPLICATED))
+        return false;
+
+    return Capture(node);
+}
+
+void ScenePrefab::Clear()
+{
+    nodes_.clear();
+    components_.clear();
+    attributes_.clear();
+}
+
+Node* ScenePrefab::Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation, CreateMode mode) const
+{
+    URHO3D_PROFILE("InstantiatePrefab");
+
+    if (!parent || nodes_.empty())
+        return nullptr;
+
+    SceneResolver resolver;
+    ea::vector<Node*> createdNodes(nodes_.size());
+
+    // Nodes are stored in depth-first order, so the parent is always created before the child
+    for (unsigned i = 0; i < nodes_.size(); ++i)
+    {
+        const PrefabObject& nodeObject = nodes_[i];
+        Node* node = i == 0 ? parent->CreateChild(0, mode)
+            : createdNodes[nodeObject.parentIndex_]->CreateChild(0, GetObjectCreateMode(mode, nodeObject.id_));
+        createdNodes[i] = node;
+        resolver.AddNode(nodeObject.id_, node);
+        ApplyAttributes(node, nodeObject);
+
+        for (unsigned j = nodeObject.firstComponent_; j < nodeObject.firstComponent_ + nodeObject.numComponents_; ++j)
+        {
+            const PrefabObject& componentObject = components_[j];
+            Component* component = node->CreateComponent(componentObject.type_, GetObjectCreateMode(mode, componentObject.id_));
+            if (!component)
+                continue;
+
+            resolver.AddComponent(componentObject.id_, component);
+            ApplyAttributes(component, componentObject);
+        }
+    }
+
+    resolver.Resolve();
+
+    Node* root = createdNodes[0];
+    root->SetTransform(position, rotation);
+    root->ApplyAttributes();
+    return root;
+}
+
+void ScenePrefab::CaptureNode(const Node* node, unsigned parentIndex)
+{
+    WarnInlineAnimation(node);
+
+    PrefabObject nodeObject;
+    nodeObject.type_ = Node::GetTypeStatic();
+    nodeObject.id_ = node->GetID();
+    nodeObject.parentIndex_ = parentIndex;
+    CaptureAttributes(node, nodeObject);
+
+    nodeObject.firstComponent_ = components_.size();
+    for (Component* component : node->GetComponents())
+    {
+        if (component->IsTemporary())
+            continue;
+
+        // Attributes of unknown components have no fixed layout
+        if (component->GetTypeInfo() == UnknownComponent::GetTypeInfoStatic())
+        {
+            URHO3D_LOGWARNING("Unknown component " + component->GetTypeName() + " is not stored in prefab");
+            continue;
+        }
+
+        WarnInlineAnimation(component);
+
+        PrefabObject componentObject;
+        componentObject.type_ = component->GetType();
+        componentObject.id_ = component->GetID();
+        componentObject.parentIndex_ = nodes_.size();
+        CaptureAttributes(component, componentObject);
+        components_.push_back(componentObject);
+    }
+    nodeObject.numComponents_ = components_.size() - nodeObject.firstComponent_;
+
+    const unsigned nodeIndex = nodes_.size();
+    nodes_.push_back(nodeObject);
+
+    for (Node* child : node->GetChildren())
+    {
+        if (!child->IsTemporary())
+            CaptureNode(child, nodeIndex);
+    }
+}
+
+void ScenePrefab::CaptureAttributes(const Serializable* object, PrefabObject& dest)
+{
+    dest.firstAttribute_ = attributes_.size();
+
+    if (const ea::vector<AttributeInfo>* attributes = object->GetAttributes())
+    {
+        Variant value;
+        for (unsigned i = 0; i < attributes->size(); ++i)
+        {
+            const AttributeInfo& attr = attributes->at(i);
+            if (!attr.ShouldSave() || !attr.ShouldLoad())
+                continue;
+
+            // Skip default values the same way XML serialization does
+            object->OnGetAttribute(attr, value);
+            if (value == object->GetAttributeDefault(i) && !object->SaveDefaultAttributes(attr))
+                continue;
+
+            attributes_.push_back(PrefabAttribute{i, value});
+        }
+    }
+
+    dest.numAttributes_ = attributes_.size() - dest.firstAttribute_;
+}
+
+void ScenePrefab::ApplyAttributes(Serializable* object, const PrefabObject& source) const
+{
+    const ea::vector<AttributeInfo>* attributes = object->GetAttributes();
+    if (!attributes)
+        return;
+
+    for (unsigned i = source.firstAttribute_; i < source.firstAttribute_ + source.numAttributes_; ++i)
+    {
+        const PrefabAttribute& attribute = attributes_[i];
+        if (attribute.index_ < attributes->size())
+            object->OnSetAttribute(attributes->at(attribute.index_), attribute.value_);
+    }
+}
+
+bool ScenePrefab::LoadPrefab(Deserializer& source)
+{
+    if (source.ReadFileID() != PREFAB_FILE_ID)
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid prefab file");
+        return false;
+    }
+
+    const unsigned version = source.ReadUInt();
+    if (version > PREFAB_FORMAT_VERSION)
+    {
+        URHO3D_LOGERROR(Format("Unsupported prefab format version {} in {}", version, source.GetName()));
+        return false;
+    }
+
+    const unsigned numNodes = source.ReadVLE();
+    nodes_.reserve(numNodes);
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        PrefabObject nodeObject;
+        nodeObject.type_ = Node::GetTypeStatic();
+        nodeObject.id_ = source.ReadUInt();
+        nodeObject.parentIndex_ = source.ReadUInt();
+        if ((i == 0) != (nodeObject.parentIndex_ == M_MAX_UNSIGNED) || (i != 0 && nodeObject.parentIndex_ >= i))
+        {
+            URHO3D_LOGERROR("Invalid node hierarchy in prefab " + source.GetName());
+            Clear();
+            return false;
+        }
+
+        if (!LoadPrefabAttributes(source, nodeObject.type_, nodeObject))
+        {
+            Clear();
+            return false;
+        }
+
+        const unsigned numComponents = source.ReadVLE();
+        nodeObject.firstComponent_ = components_.size();
+        for (unsigned j = 0; j < numComponents; ++j)
+        {
+            PrefabObject componentObject;
+            componentObject.type_ = source.ReadStringHash();
+            componentObject.id_ = source.ReadUInt();
+            componentObject.parentIndex_ = i;
+            if (!LoadPrefabAttributes(source, componentObject.type_, componentObject))
+            {
+                Clear();
+                return false;
+            }
+
+            if (context_->GetTypeName(componentObject.type_).empty())
+            {
+                attributes_.resize(componentObject.firstAttribute_);
+                URHO3D_LOGWARNING("Skipping unknown component type " + componentObject.type_.ToString() + " in prefab " +
+                    source.GetName());
+                continue;
+            }
+
+            components_.push_back(componentObject);
+        }
+        nodeObject.numComponents_ = components_.size() - nodeObject.firstComponent_;
+
+        nodes_.push_back(nodeObject);
+    }
+
+    return true;
+}
+
+bool ScenePrefab::LoadPrefabAttributes(Deserializer& source, StringHash type, PrefabObject& dest)
+{
+    const ea::vector<AttributeInfo>* attributes = context_->GetAttributes(type);
+
+    dest.firstAttribute_ = attributes_.size();
+    const unsigned numAttributes = source.ReadVLE();
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (source.IsEof())
+        {
+            URHO3D_LOGERROR("Unexpected end of prefab " + source.GetName());
+            return false;
+        }
+
+        const StringHash nameHash = source.ReadStringHash();
+        const auto valueType = static_cast<VariantType>(source.ReadUByte());
+        Variant value = source.ReadVariant(valueType, context_);
+
+        unsigned index = 0;
+        const unsigned numTypeAttributes = attributes ? attributes->size() : 0;
+        while (index < numTypeAttributes && attributes->at(index).nameHash_ != nameHash)
+            ++index;
+
+        // Attributes that were removed or changed type since the prefab was saved are skipped
+        if (index == numTypeAttributes || attributes->at(index).type_ != valueType)
+            continue;
+
+        attributes_.push_back(PrefabAttribute{index, ea::move(value)});
+    }
+    dest.numAttributes_ = attributes_.size() - dest.firstAttribute_;
+
+    return true;
+}
+
+}
@@ -0,0 +1,137 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Variant.h"
+#include "../Resource/Resource.h"
+#include "../Scene/Node.h"
+
+namespace Urho3D
+{
+
+class JSONFile;
+class SceneResolver;
+class XMLFile;
+
+/// Attribute value stored in a prefab template.
+struct PrefabAttribute
+{
+    /// Index of the attribute in the attribute list of the object type.
+    unsigned index_{};
+    /// Attribute value.
+    Variant value_;
+};
+
+/// Node or component stored in a prefab template.
+struct PrefabObject
+{
+    /// Object type.
+    StringHash type_;
+    /// ID in the source data. Used to resolve references between objects of the prefab.
+    unsigned id_{};
+    /// Index of the parent node. For components, index of the owner node. M_MAX_UNSIGNED for the root node.
+    unsigned parentIndex_{M_MAX_UNSIGNED};
+    /// Index of the first attribute value.
+    unsigned firstAttribute_{};
+    /// Number of attribute values.
+    unsigned numAttributes_{};
+    /// Index of the first component. Nodes only.
+    unsigned firstComponent_{};
+    /// Number of components. Nodes only.
+    unsigned numComponents_{};
+};
+
+/// Node hierarchy template that is parsed once and instantiated many times. Loads from XML, JSON, binary node data or its own versioned binary format.
+class URHO3D_API ScenePrefab : public Resource
+{
+    URHO3D_OBJECT(ScenePrefab, Resource);
+
+public:
+    /// Construct.
+    explicit ScenePrefab(Context* context);
+    /// Destruct.
+    ~ScenePrefab() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Finish resource loading. Always called from the main thread. Return true if successful.
+    bool EndLoad() override;
+    /// Save resource in the versioned binary prefab format. Return true if successful.
+    bool Save(Serializer& dest) const override;
+
+    /// Build template from node hierarchy. Only attribute state of nodes and components is stored.
+    bool Capture(const Node* node);
+    /// Build template from XML node data.
+    bool LoadXML(const XMLElement& source);
+    /// Build template from JSON node data.
+    bool LoadJSON(const JSONValue& source);
+    /// Build template from binary node data as written by Node::Save.
+    bool LoadNode(Deserializer& source);
+    /// Remove all stored objects.
+    void Clear();
+
+    /// Instantiate the prefab as a child of the parent node. IDs are rewritten. Return root node if successful.
+    Node* Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED) const;
+
+    /// Return whether the template is empty.
+    bool IsEmpty() const { return nodes_.empty(); }
+    /// Return number of nodes.
+    unsigned GetNumNodes() const { return nodes_.size(); }
+    /// Return number of components.
+    unsigned GetNumComponents() const { return components_.size(); }
+    /// Return nodes in depth-first order. The first node is the root.
+    const ea::vector<PrefabObject>& GetNodes() const { return nodes_; }
+    /// Return components ordered by owner node.
+    const ea::vector<PrefabObject>& GetComponents() const { return components_; }
+    /// Return attribute values of all objects.
+    const ea::vector<PrefabAttribute>& GetAttributes() const { return attributes_; }
+
+private:
+    /// Append node and its children to the template.
+    void CaptureNode(const Node* node, unsigned parentIndex);
+    /// Append attribute values of the object that differ from defaults.
+    void CaptureAttributes(const Serializable* object, PrefabObject& dest);
+    /// Apply stored attribute values to the object.
+    void ApplyAttributes(Serializable* object, const PrefabObject& source) const;
+    /// Read template in the versioned binary prefab format.
+    bool LoadPrefab(Deserializer& source);
+    /// Read attribute values of an object in the versioned binary prefab format.
+    bool LoadPrefabAttributes(Deserializer& source, StringHash type, PrefabObject& dest);
+
+    /// Nodes in depth-first order.
+    ea::vector<PrefabObject> nodes_;
+    /// Components ordered by owner node.
+    ea::vector<PrefabObject> components_;
+    /// Attribute values of all objects.
+    ea::vector<PrefabAttribute> attributes_;
+    /// XML data waiting for the main thread.
+    SharedPtr<XMLFile> loadXMLFile_;
+    /// JSON data waiting for the main thread.
+    SharedPtr<JSONFile> loadJSONFile_;
+    /// Binary node data waiting for the main thread.
+    ea::vector<unsigned char> loadNodeData_;
+};
+
+}
@@ -25,9 +25,11 @@
 #include "../Core/Context.h"
 #include "../IO/Archive.h"
 #include "../IO/ArchiveSerialization.h"
+#include "../IO/BitStream.h"
 #include "../IO/Deserializer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
 #include "../IO/Serializer.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/XMLFile.h"
@@ -46,6 +48,106 @@ namespace Urho3D
 {
 
 static const unsigned MAX_STACK_ATTRIBUTE_COUNT = 128;
+/// Maximum number of quantized components in an attribute.
+static const unsigned MAX_QUANTIZED_COMPONENTS = 4;
+/// Number of latest data updates sent against a baseline before it may be updated.
+static const unsigned MIN_BASELINE_AGE = 8;
+
+/// Return number of quantized components of a network attribute, or zero if it is not a quantized latest data attribute.
+static unsigned GetNumQuantizedComponents(const AttributeInfo& attr)
+{
+    if (!(attr.mode_ & AM_LATESTDATA) || !attr.quantization_.IsEnabled())
+        return 0;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+    case VAR_DOUBLE:
+        return 1;
+    case VAR_VECTOR2:
+        return 2;
+    case VAR_VECTOR3:
+        return 3;
+    case VAR_VECTOR4:
+    case VAR_QUATERNION:
+    case VAR_COLOR:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+/// Return total number of quantized latest data components of network attributes.
+static unsigned GetNumQuantizedComponents(const ea::vector<AttributeInfo>& attributes)
+{
+    unsigned numComponents = 0;
+    for (const AttributeInfo& attr : attributes)
+        numComponents += GetNumQuantizedComponents(attr);
+    return numComponents;
+}
+
+/// Return number of bits of a component within the quantization range. Zero if the range is unbounded.
+static unsigned GetNumBoundedBits(const AttributeQuantization& quantization)
+{
+    if (!quantization.IsBounded())
+        return 0;
+    const auto numSteps = static_cast<unsigned>(RoundToInt((quantization.max_ - quantization.min_) / quantization.precision_));
+    return numSteps ? LogBaseTwo(numSteps) + 1 : 0;
+}
+
+/// Quantize the components of an attribute value.
+static void QuantizeValue(const AttributeInfo& attr, const Variant& value, int* dest)
+{
+    float components[MAX_QUANTIZED_COMPONENTS]{};
+    const unsigned numComponents = GetNumQuantizedComponents(attr);
+    if (value.GetType() == attr.type_)
+    {
+        switch (attr.type_)
+        {
+        case VAR_FLOAT: components[0] = value.GetFloat(); break;
+        case VAR_DOUBLE: components[0] = static_cast<float>(value.GetDouble()); break;
+        case VAR_VECTOR2: memcpy(components, value.GetVector2().Data(), numComponents * sizeof(float)); break;
+        case VAR_VECTOR3: memcpy(components, value.GetVector3().Data(), numComponents * sizeof(float)); break;
+        case VAR_VECTOR4: memcpy(components, value.GetVector4().Data(), numComponents * sizeof(float)); break;
+        case VAR_QUATERNION: memcpy(components, value.GetQuaternion().Data(), numComponents * sizeof(float)); break;
+        case VAR_COLOR: memcpy(components, value.GetColor().Data(), numComponents * sizeof(float)); break;
+        default: break;
+        }
+    }
+
+    const AttributeQuantization& quantization = attr.quantization_;
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        float component = components[i];
+        if (quantization.IsBounded())
+            component = Clamp(component, quantization.min_, quantization.max_) - quantization.min_;
+
+        const float maxSteps = static_cast<float>(BitWriter::MAX_ZIGZAG_VALUE);
+        dest[i] = static_cast<int>(Clamp(Round(component / quantization.precision_), -maxSteps, maxSteps));
+    }
+}
+
+/// Return attribute value from quantized components.
+static Variant DequantizeValue(const AttributeInfo& attr, const int* src)
+{
+    float components[MAX_QUANTIZED_COMPONENTS]{};
+    const AttributeQuantization& quantization = attr.quantization_;
+    const float offset = quantization.IsBounded() ? quantization.min_ : 0.0f;
+    for (unsigned i = 0; i < GetNumQuantizedComponents(attr); ++i)
+        components[i] = src[i] * quantization.precision_ + offset;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT: return components[0];
+    case VAR_DOUBLE: return static_cast<double>(components[0]);
+    case VAR_VECTOR2: return Vector2(components);
+    case VAR_VECTOR3: return Vector3(components);
+    case VAR_VECTOR4: return Vector4(components);
+    case VAR_QUATERNION: return Quaternion(components);
+    case VAR_COLOR: return Color(components);
+    default: return Variant::EMPTY;
+    }
+}
 
 static unsigned RemapAttributeIndex(const ea::vector<AttributeInfo>* attributes, const AttributeInfo& netAttr, unsigned netAttrIndex)
 {
@@ -1014,15 +1116,8 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
         return;
 
     unsigned numAttributes = attributes->size();
-    DirtyBits attributeBits;
-
-    // Compare against defaults
-    for (unsigned i = 0; i < numAttributes; ++i)
-    {
-        const AttributeInfo& attr = attributes->at(i);
-        if (networkState_->currentValues_[i] != attr.defaultValue_)
-            attributeBits.Set(i);
-    }
+    EncodeNetworkValues();
+    const DirtyBits& attributeBits = networkState_->nonDefaultAttributes_;
 
     // First write the change bitfield, then attribute data for non-default attributes
     dest.WriteUByte(timeStamp);
@@ -1031,7 +1126,7 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteEncodedNetworkValue(dest, i);
     }
 }
 
@@ -1051,40 +1146,231 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
 
     // First write the change bitfield, then attribute data for changed attributes
     // Note: the attribute bits should not contain LATESTDATA attributes
+    EncodeNetworkValues();
     dest.WriteUByte(timeStamp);
     dest.Write(attributeBits.data_, (numAttributes + 7) >> 3u);
 
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            WriteEncodedNetworkValue(dest, i);
     }
 }
 
-void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp)
+bool Serializable::WriteLatestDataUpdate(Serializer& dest, BitWriter& bits, unsigned char timeStamp, ReplicationState& state)
 {
     if (!networkState_)
     {
         URHO3D_LOGERROR("WriteLatestDataUpdate called without allocated NetworkState");
-        return;
+        return true;
     }
 
     const ea::vector<AttributeInfo>* attributes = networkState_->attributes_;
     if (!attributes)
-        return;
+        return true;
 
     unsigned numAttributes = attributes->size();
+    EncodeNetworkValues();
+
+    const ea::vector<int>& quantizedValues = networkState_->quantizedValues_;
+    if (state.baseline_.size() != quantizedValues.size())
+        return false;
+
+    // Bit-pack quantized attributes first, either as unchanged, as delta against the baseline or as absolute value
+    bits.Clear();
+    unsigned baselineOffset = 0;
+    unsigned deltaSize = 0;
+    unsigned absoluteSize = 0;
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes->at(i);
+        const unsigned numComponents = GetNumQuantizedComponents(attr);
+        if (!numComponents)
+            continue;
+
+        const int* values = &quantizedValues[baselineOffset];
+        const int* baseline = &state.baseline_[baselineOffset];
+        baselineOffset += numComponents;
+
+        const bool isChanged = !ea::equal(values, values + numComponents, baseline);
+        bits.WriteBool(isChanged);
+        if (!isChanged)
+            continue;
+
+        const unsigned numBoundedBits = GetNumBoundedBits(attr.quantization_);
+        unsigned attrDeltaSize = 0;
+        unsigned attrAbsoluteSize = 0;
+        bool canUseDelta = true;
+        for (unsigned j = 0; j < numComponents; ++j)
+        {
+            const long long delta = static_cast<long long>(values[j]) - baseline[j];
+            if (delta < -BitWriter::MAX_ZIGZAG_VALUE || delta > BitWriter::MAX_ZIGZAG_VALUE)
+                canUseDelta = false;
+            else
+                attrDeltaSize += BitWriter::GetZigZagSize(static_cast<int>(delta));
+            attrAbsoluteSize += numBoundedBits ? numBoundedBits : BitWriter::GetZigZagSize(values[j]);
+        }
+
+        const bool useDelta = canUseDelta && attrDeltaSize <= attrAbsoluteSize;
+        bits.WriteBool(useDelta);
+        for (unsigned j = 0; j < numComponents; ++j)
+        {
+            if (useDelta)
+                bits.WriteZigZag(values[j] - baseline[j]);
+            else if (numBoundedBits)
+                bits.WriteBits(static_cast<unsigned>(values[j]), numBoundedBits);
+            else
+                bits.WriteZigZag(values[j]);
+        }
+
+        deltaSize += canUseDelta ? attrDeltaSize : 2 * attrAbsoluteSize;
+        absoluteSize += attrAbsoluteSize;
+    }
+
+    // Request a baseline update once deltas have grown to more than half of the absolute values
+    if (state.baselineAge_ >= MIN_BASELINE_AGE && deltaSize > absoluteSize / 2)
+        return false;
+    ++state.baselineAge_;
 
     dest.WriteUByte(timeStamp);
+    if (!quantizedValues.empty())
+    {
+        dest.WriteUByte(state.baselineIndex_);
+        dest.WriteVLE(bits.GetSize());
+        dest.Write(bits.GetData(), bits.GetSize());
+    }
 
     for (unsigned i = 0; i < numAttributes; ++i)
     {
-        if (attributes->at(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+        const AttributeInfo& attr = attributes->at(i);
+        if ((attr.mode_ & AM_LATESTDATA) && !GetNumQuantizedComponents(attr))
+            WriteEncodedNetworkValue(dest, i);
     }
+
+    return true;
+}
+
+void Serializable::UpdateLatestDataBaseline(ReplicationState& state, bool initial)
+{
+    if (!networkState_ || !networkState_->attributes_)
+        return;
+
+    EncodeNetworkValues();
+    state.baseline_ = networkState_->quantizedValues_;
+    state.baselineIndex_ = initial ? 0 : state.baselineIndex_ + 1;
+    state.baselineAge_ = 0;
 }
 
-bool Serializable::ReadDeltaUpdate(Deserializer& source)
+void Serializable::GetLatestDataBaselineAttributes(DirtyBits& attributeBits) const
+{
+    const ea::vector<AttributeInfo>* attributes = GetNetworkAttributes();
+    if (!attributes)
+        return;
+
+    for (unsigned i = 0; i < attributes->size(); ++i)
+    {
+        if (GetNumQuantizedComponents(attributes->at(i)))
+            attributeBits.Set(i);
+    }
+}
+
+void Serializable::EncodeNetworkValues()
+{
+    if (networkState_->encoded_.load(std::memory_order_acquire))
+        return;
+
+    // Values are serialized by the first connection that needs them, the rest copy the bytes
+    MutexLock<SpinLockMutex> lock(networkState_->mutex_);
+    if (networkState_->encoded_.load(std::memory_order_relaxed))
+        return;
+
+    const ea::vector<AttributeInfo>& attributes = *networkState_->attributes_;
+    const unsigned numAttributes = attributes.size();
+
+    VectorBuffer& buffer = networkState_->encodedValues_;
+    buffer.Clear();
+    networkState_->encodedValueEnds_.resize(numAttributes);
+    networkState_->nonDefaultAttributes_.ClearAll();
+    networkState_->quantizedValues_.resize(GetNumQuantizedComponents(attributes));
+    unsigned quantizedOffset = 0;
+
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const Variant& value = networkState_->currentValues_[i];
+        buffer.WriteVariantData(value);
+        networkState_->encodedValueEnds_[i] = buffer.GetSize();
+
+        if (value != attributes[i].defaultValue_)
+            networkState_->nonDefaultAttributes_.Set(i);
+
+        if (const unsigned numComponents = GetNumQuantizedComponents(attributes[i]))
+        {
+            QuantizeValue(attributes[i], value, &networkState_->quantizedValues_[quantizedOffset]);
+            quantizedOffset += numComponents;
+        }
+    }
+
+    networkState_->encoded_.store(true, std::memory_order_release);
+}
+
+void Serializable::WriteEncodedNetworkValue(Serializer& dest, unsigned index) const
+{
+    const ea::vector<unsigned>& ends = networkState_->encodedValueEnds_;
+    const unsigned begin = index ? ends[index - 1] : 0;
+    dest.Write(networkState_->encodedValues_.GetData() + begin, ends[index] - begin);
+}
+
+void Serializable::StorePendingLatestData(unsigned char baselineIndex, unsigned char timeStamp, const unsigned char* data, unsigned size)
+{
+    ea::vector<PendingLatestData>& pendingLatestData = networkState_->pendingLatestData_;
+    auto iter = ea::find_if(pendingLatestData.begin(), pendingLatestData.end(),
+        [&](const PendingLatestData& pending) { return pending.baselineIndex_ == baselineIndex; });
+
+    if (iter == pendingLatestData.end())
+    {
+        pendingLatestData.emplace_back();
+        iter = pendingLatestData.end() - 1;
+        iter->baselineIndex_ = baselineIndex;
+    }
+    // Updates of the same baseline may arrive in any order, keep the newest one
+    else if (static_cast<signed char>(timeStamp - iter->timeStamp_) < 0)
+        return;
+
+    iter->timeStamp_ = timeStamp;
+    iter->data_.assign(data, data + size);
+}
+
+bool Serializable::ApplyPendingLatestData()
+{
+    ea::vector<PendingLatestData>& pendingLatestData = networkState_->pendingLatestData_;
+    if (pendingLatestData.empty())
+        return false;
+
+    const unsigned char currentIndex = networkState_->baselineIndex_;
+    ea::vector<unsigned char> data;
+    for (unsigned i = 0; i < pendingLatestData.size();)
+    {
+        PendingLatestData& pending = pendingLatestData[i];
+        const auto baselineDistance = static_cast<signed char>(pending.baselineIndex_ - currentIndex);
+        if (baselineDistance > 0)
+        {
+            ++i;
+            continue;
+        }
+
+        if (baselineDistance == 0)
+            data = ea::move(pending.data_);
+        pendingLatestData.erase_unsorted(pendingLatestData.begin() + i);
+    }
+
+    if (data.empty())
+        return false;
+
+    MemoryBuffer buffer(data);
+    return ReadLatestDataUpdate(buffer);
+}
+
+bool Serializable::ReadDeltaUpdate(Deserializer& source, bool initial)
 {
     const ea::vector<AttributeInfo>* attributes = GetNetworkAttributes();
     if (!attributes)
@@ -1094,18 +1380,39 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
     DirtyBits attributeBits;
     bool changed = false;
 
+    // Quantized latest data values received reliably form the baseline for the following latest data updates
+    const unsigned numBaselineComponents = GetNumQuantizedComponents(*attributes);
+    if (numBaselineComponents && !networkState_)
+        AllocateNetworkState();
+    if (initial && networkState_)
+    {
+        networkState_->baseline_.resize(numBaselineComponents);
+        networkState_->baselineIndex_ = 0;
+        networkState_->pendingLatestData_.clear();
+    }
+    unsigned baselineOffset = 0;
+    bool baselineChanged = false;
+
     unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
     unsigned char timeStamp = source.ReadUByte();
     source.Read(attributeBits.data_, (numAttributes + 7) >> 3u);
 
     for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
     {
+        const AttributeInfo& attr = attributes->at(i);
+        const unsigned numComponents = GetNumQuantizedComponents(attr);
         if (attributeBits.IsSet(i))
         {
-            const AttributeInfo& attr = attributes->at(i);
+            const Variant value = source.ReadVariant(attr.type_);
+            if (numComponents && networkState_->baseline_.size() == numBaselineComponents)
+            {
+                QuantizeValue(attr, value, &networkState_->baseline_[baselineOffset]);
+                baselineChanged = true;
+            }
+
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, value);
                 changed = true;
             }
             else
@@ -1117,16 +1424,28 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = value;
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
+        else if (numComponents && initial)
+            QuantizeValue(attr, attr.defaultValue_, &networkState_->baseline_[baselineOffset]);
+
+        baselineOffset += numComponents;
+    }
+
+    // Latest data updates that arrived before this baseline are newer than it
+    if (baselineChanged && !initial)
+    {
+        ++networkState_->baselineIndex_;
+        if (ApplyPendingLatestData())
+            changed = true;
     }
 
     return changed;
 }
 
-bool Serializable::ReadLatestDataUpdate(Deserializer& source)
+bool Serializable::ReadLatestDataUpdate(MemoryBuffer& source)
 {
     const ea::vector<AttributeInfo>* attributes = GetNetworkAttributes();
     if (!attributes)
@@ -1136,16 +1455,71 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
     bool changed = false;
 
     unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
+    const unsigned messageStart = source.GetPosition();
     unsigned char timeStamp = source.ReadUByte();
 
+    // Quantized attributes are bit-packed before the other values
+    const unsigned numBaselineComponents = GetNumQuantizedComponents(*attributes);
+    const unsigned char* bitData = nullptr;
+    unsigned bitDataSize = 0;
+    if (numBaselineComponents)
+    {
+        const unsigned char baselineIndex = source.ReadUByte();
+        bitDataSize = Min(source.ReadVLE(), source.GetSize() - source.GetPosition());
+        bitData = source.GetData() + source.GetPosition();
+        source.Seek(source.GetPosition() + bitDataSize);
+        if (!networkState_ || networkState_->baseline_.size() != numBaselineComponents)
+            return false;
+
+        // The baseline is sent reliably ordered and latest data reliably unordered. An update encoded against an older
+        // baseline is superseded by that baseline, an update encoded against a newer one waits until it arrives
+        const auto baselineDistance = static_cast<signed char>(baselineIndex - networkState_->baselineIndex_);
+        if (baselineDistance < 0)
+            return false;
+        if (baselineDistance > 0)
+        {
+            StorePendingLatestData(baselineIndex, timeStamp, source.GetData() + messageStart, source.GetSize() - messageStart);
+            return false;
+        }
+    }
+    BitReader bits(bitData, bitDataSize);
+    unsigned baselineOffset = 0;
+
     for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
     {
         const AttributeInfo& attr = attributes->at(i);
         if (attr.mode_ & AM_LATESTDATA)
         {
+            Variant value;
+            if (const unsigned numComponents = GetNumQuantizedComponents(attr))
+            {
+                // Unchanged from the baseline, delta against the baseline, or absolute value
+                int components[MAX_QUANTIZED_COMPONENTS];
+                const int* baseline = &networkState_->baseline_[baselineOffset];
+                const bool isChanged = bits.ReadBool();
+                const bool isDelta = isChanged && bits.ReadBool();
+                const unsigned numBoundedBits = GetNumBoundedBits(attr.quantization_);
+                for (unsigned j = 0; j < numComponents; ++j)
+                {
+                    if (!isChanged)
+                        components[j] = baseline[j];
+                    else if (isDelta)
+                        components[j] = baseline[j] + bits.ReadZigZag();
+                    else if (numBoundedBits)
+                        components[j] = static_cast<int>(bits.ReadBits(numBoundedBits));
+                    else
+                        components[j] = bits.ReadZigZag();
+                }
+
+                value = DequantizeValue(attr, components);
+                baselineOffset += numComponents;
+            }
+            else
+                value = source.ReadVariant(attr.type_);
+
             if (!(interceptMask & (1ULL << i)))
             {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
+                OnSetAttribute(attr, value);
                 changed = true;
             }
             else
@@ -1157,7 +1531,7 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
                 eventData[P_TIMESTAMP] = (unsigned)timeStamp;
                 eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
                 eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
+                eventData[P_VALUE] = value;
                 SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
             }
         }
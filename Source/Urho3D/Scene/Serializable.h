@@ -32,8 +32,10 @@ namespace Urho3D
 
 class Archive;
 class ArchiveBlock;
+class BitWriter;
 class Connection;
 class Deserializer;
+class MemoryBuffer;
 class Serializer;
 class XMLElement;
 class JSONValue;
@@ -123,12 +125,16 @@ public:
     void WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp);
     /// Write a delta network update according to dirty attribute bits.
     void WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp);
-    /// Write a latest data network update.
-    void WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp);
-    /// Read and apply a network delta update. Return true if attributes were changed.
-    bool ReadDeltaUpdate(Deserializer& source);
-    /// Read and apply a network latest data update. Return true if attributes were changed.
-    bool ReadLatestDataUpdate(Deserializer& source);
+    /// Write a latest data network update. Quantized attributes are written as deltas against the baseline of the replication state. Return false without writing if the baseline should be updated first.
+    bool WriteLatestDataUpdate(Serializer& dest, BitWriter& bits, unsigned char timeStamp, ReplicationState& state);
+    /// Set the latest data baseline of a replication state to the current values, after sending them in an initial or delta update.
+    void UpdateLatestDataBaseline(ReplicationState& state, bool initial);
+    /// Set the bits of the quantized latest data attributes. A delta update must contain all of them to update the baseline.
+    void GetLatestDataBaselineAttributes(DirtyBits& attributeBits) const;
+    /// Read and apply a network delta update. The initial update resets the latest data baseline. Return true if attributes were changed.
+    bool ReadDeltaUpdate(Deserializer& source, bool initial = false);
+    /// Read and apply a network latest data update. An update encoded against a newer baseline than the last one received is applied once that baseline arrives. Return true if attributes were changed.
+    bool ReadLatestDataUpdate(MemoryBuffer& source);
 
     /// Return attribute value by index. Return empty if illegal index.
     /// @property{get_attributes}
@@ -157,6 +163,15 @@ public:
     NetworkState* GetNetworkState() const { return networkState_.get(); }
 
 protected:
+    /// Serialize current network attribute values unless already done since they last changed. Safe to call from multiple threads.
+    void EncodeNetworkValues();
+    /// Copy serialized network attribute value.
+    void WriteEncodedNetworkValue(Serializer& dest, unsigned index) const;
+    /// Keep a latest data update that was encoded against a baseline not received yet.
+    void StorePendingLatestData(unsigned char baselineIndex, unsigned char timeStamp, const unsigned char* data, unsigned size);
+    /// Apply the pending latest data update of the current baseline and discard the outdated ones. Return true if attributes were changed.
+    bool ApplyPendingLatestData();
+
     /// Network attribute state.
     ea::unique_ptr<NetworkState> networkState_;
 
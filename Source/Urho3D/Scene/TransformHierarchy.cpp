@@ -0,0 +1,145 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#include "../Scene/Scene.h"
+#include "../Scene/TransformHierarchy.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Minimum number of nodes processed by single batch of threaded update.
+static const unsigned MIN_NODES_PER_BATCH = 1024;
+
+TransformHierarchy::TransformHierarchy(Scene* scene)
+    : scene_(scene)
+{
+}
+
+void TransformHierarchy::Update(WorkQueue* workQueue)
+{
+    URHO3D_PROFILE("UpdateTransformHierarchy");
+
+    if (structureDirty_)
+        Rebuild();
+
+    const unsigned numThreads = workQueue ? workQueue->GetNumThreads() + 1 : 1;
+    for (unsigned level = 0; level < GetNumLevels(); ++level)
+    {
+        // Parents are always on the previous level, so nodes of one level are independent
+        const unsigned begin = levelOffsets_[level];
+        const unsigned end = levelOffsets_[level + 1];
+        const unsigned count = end - begin;
+        if (numThreads > 1 && count > MIN_NODES_PER_BATCH)
+        {
+            const unsigned batchSize = Max(count / (numThreads * 4), MIN_NODES_PER_BATCH);
+            workQueue->ParallelFor(count, batchSize, [this, begin](unsigned batchBegin, unsigned batchEnd, unsigned)
+            {
+                UpdateRange(begin + batchBegin, begin + batchEnd);
+            });
+        }
+        else
+            UpdateRange(begin, end);
+    }
+}
+
+void TransformHierarchy::Rebuild()
+{
+    URHO3D_PROFILE("RebuildTransformHierarchy");
+
+    nodes_.clear();
+    parentIndices_.clear();
+    levelOffsets_.clear();
+
+    for (Node* child : scene_->GetChildren())
+    {
+        nodes_.push_back(child);
+        parentIndices_.push_back(M_MAX_UNSIGNED);
+    }
+
+    // Breadth-first traversal, each pass over the previous level appends the next one
+    unsigned levelBegin = 0;
+    while (levelBegin < nodes_.size())
+    {
+        const unsigned levelEnd = nodes_.size();
+        levelOffsets_.push_back(levelBegin);
+        for (unsigned i = levelBegin; i < levelEnd; ++i)
+        {
+            for (Node* child : nodes_[i]->GetChildren())
+            {
+                nodes_.push_back(child);
+                parentIndices_.push_back(i);
+            }
+        }
+        levelBegin = levelEnd;
+    }
+    levelOffsets_.push_back(nodes_.size());
+
+    worldTransforms_.resize(nodes_.size());
+    worldRotations_.resize(nodes_.size());
+    updated_.resize(nodes_.size());
+    structureDirty_ = false;
+}
+
+void TransformHierarchy::UpdateRange(unsigned begin, unsigned end)
+{
+    for (unsigned i = begin; i < end; ++i)
+    {
+        Node* node = nodes_[i];
+        updated_[i] = node->dirty_;
+        if (!node->dirty_)
+            continue;
+
+        Matrix3x4& worldTransform = worldTransforms_[i];
+        Quaternion& worldRotation = worldRotations_[i];
+
+        // Parent is either updated by this pass, or clean and holds a valid world transform already
+        const unsigned parentIndex = parentIndices_[i];
+        if (parentIndex == M_MAX_UNSIGNED)
+        {
+            worldTransform = node->GetTransform();
+            worldRotation = node->rotation_;
+        }
+        else if (updated_[parentIndex])
+        {
+            worldTransform = worldTransforms_[parentIndex] * node->GetTransform();
+            worldRotation = worldRotations_[parentIndex] * node->rotation_;
+        }
+        else
+        {
+            const Node* parent = nodes_[parentIndex];
+            worldTransform = parent->worldTransform_ * node->GetTransform();
+            worldRotation = parent->worldRotation_ * node->rotation_;
+        }
+
+        node->worldTransform_ = worldTransform;
+        node->worldRotation_ = worldRotation;
+        node->dirty_ = false;
+    }
+}
+
+}
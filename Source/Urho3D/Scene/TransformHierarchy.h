@@ -0,0 +1,81 @@
+//
+// Copyright (c) 2008-2020 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Math/Matrix3x4.h"
+#include "../Math/Quaternion.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class Node;
+class Scene;
+class WorkQueue;
+
+/// Flat view of the scene node hierarchy ordered by depth. Updates world transforms of dirty nodes in one linear pass
+/// instead of recursing through the nodes. Nodes keep their own transforms, so the Node API works unchanged.
+class URHO3D_API TransformHierarchy
+{
+public:
+    /// Construct.
+    explicit TransformHierarchy(Scene* scene);
+
+    /// Mark the hierarchy to be rebuilt before the next update. Should be called when nodes are added, removed or reparented.
+    void MarkStructureDirty() { structureDirty_ = true; }
+    /// Recalculate world transforms of all dirty nodes. Depth levels are split between worker threads if a work queue is given.
+    void Update(WorkQueue* workQueue);
+
+    /// Return number of nodes.
+    unsigned GetNumNodes() const { return nodes_.size(); }
+    /// Return number of depth levels.
+    unsigned GetNumLevels() const { return levelOffsets_.empty() ? 0 : levelOffsets_.size() - 1; }
+
+private:
+    /// Collect nodes in depth order.
+    void Rebuild();
+    /// Recalculate world transforms of dirty nodes in range.
+    void UpdateRange(unsigned begin, unsigned end);
+
+    /// Scene.
+    Scene* scene_{};
+    /// Nodes ordered by depth. Nodes of the same depth are adjacent.
+    ea::vector<Node*> nodes_;
+    /// Index of the parent node, or M_MAX_UNSIGNED for the children of the scene.
+    ea::vector<unsigned> parentIndices_;
+    /// Start of each depth level in the node array, followed by the number of nodes.
+    ea::vector<unsigned> levelOffsets_;
+    /// World transforms of the nodes updated by the last pass.
+    ea::vector<Matrix3x4> worldTransforms_;
+    /// World rotations of the nodes updated by the last pass.
+    ea::vector<Quaternion> worldRotations_;
+    /// Whether the node was updated by the current pass.
+    ea::vector<unsigned char> updated_;
+    /// Whether the hierarchy needs to be rebuilt.
+    bool structureDirty_{true};
+};
+
+}
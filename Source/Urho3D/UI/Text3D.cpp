@@ -780,7 +780,7 @@ void Text3D::CalculateFixedScreenSize(const FrameInfo& frame)
 
     customWorldTransform_ = Matrix3x4(worldPosition, frame.camera_->GetFaceCameraRotation(
         worldPosition, node_->GetWorldRotation(), faceCameraMode_, minAngle_), worldScale);
-    worldBoundingBoxDirty_ = true;
+    MarkWorldBoundingBoxDirty();
 }
 
 }
@@ -334,7 +334,7 @@ void Renderer2D::HandleBeginViewUpdate(StringHash eventType, VariantMap& eventDa
 
     auto* camera = static_cast<Camera*>(eventData[P_CAMERA].GetPtr());
     frustum_ = camera->GetFrustum();
-    viewMask_ = camera->GetViewMask();
+    SetViewMask(camera->GetViewMask());
 
     // Check visibility
     {